@@ -0,0 +1,220 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      AccuracyEvaluator.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for AccuracyEvaluator class
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "AccuracyEvaluator.hpp"
+#include "DetectionInterpolator.hpp"
+
+AccuracyEvaluator::AccuracyEvaluator(float minimumIou, int32_t evaluated) :
+    matchIou(minimumIou), classId(evaluated) {
+}
+
+auto AccuracyEvaluator::addImage(const std::vector<Detection>& labels, \
+        const std::vector<Detection>& detections) -> void {
+  for (const auto& label : labels) {
+    labelCount += label.classId == classId ? 1 : 0;
+  }
+  order.clear();
+  for (size_t i = 0; i < detections.size(); ++i) {
+    if (detections[i].classId == classId) {
+      order.push_back(static_cast<int>(i));
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), \
+                   [&detections](int first, int second) {
+    return detections[first].score > detections[second].score;
+  });
+  matched.assign(labels.size(), false);
+  for (int index : order) {
+    const Detection& detection = detections[index];
+    int best = -1;
+    float bestIou = matchIou;
+    for (size_t j = 0; j < labels.size(); ++j) {
+      if (matched[j] || labels[j].classId != classId) {
+        continue;
+      }
+      float overlap = DetectionInterpolator::iou(detection, labels[j]);
+      if (overlap >= bestIou) {
+        best = static_cast<int>(j);
+        bestIou = overlap;
+      }
+    }
+    if (best >= 0) {
+      matched[best] = true;
+    }
+    ranked.push_back({detection.score, best >= 0});
+  }
+}
+
+auto AccuracyEvaluator::getMetrics() const -> EvaluationMetrics {
+  EvaluationMetrics metrics;
+  metrics.labels = labelCount;
+  metrics.detections = ranked.size();
+  std::vector<Ranked> sorted(ranked);
+  std::stable_sort(sorted.begin(), sorted.end(), \
+                   [](const Ranked& first, const Ranked& second) {
+    return first.score > second.score;
+  });
+  /* Precision after every detection, made monotonic from the end */
+  std::vector<double> precisions(sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    metrics.truePositives += sorted[i].truePositive ? 1 : 0;
+    precisions[i] = static_cast<double>(metrics.truePositives) / (i + 1);
+  }
+  for (size_t i = sorted.size(); i > 1; --i) {
+    precisions[i - 2] = std::max(precisions[i - 2], precisions[i - 1]);
+  }
+  /* Every true positive adds one label to the recall */
+  if (labelCount > 0) {
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      if (sorted[i].truePositive) {
+        metrics.averagePrecision += precisions[i] / labelCount;
+      }
+    }
+    metrics.recall = static_cast<double>(metrics.truePositives) / \
+                     labelCount;
+  }
+  if (!sorted.empty()) {
+    metrics.precision = static_cast<double>(metrics.truePositives) / \
+                        sorted.size();
+  }
+  return metrics;
+}
+
+auto AccuracyEvaluator::reset() -> void {
+  labelCount = 0;
+  ranked.clear();
+}
+
+auto AccuracyEvaluator::loadLabels(const std::string& path, \
+                                   std::vector<Detection>& labels) -> bool {
+  labels.clear();
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    Detection label;
+    label.score = 1;
+    if (!(fields >> label.x1 >> label.y1 >> label.x2 >> label.y2) || \
+        label.x2 <= label.x1 || label.y2 <= label.y1) {
+      return false;
+    }
+    if (!(fields >> label.classId)) {
+      label.classId = 0;
+    }
+    labels.push_back(label);
+  }
+  return true;
+}
+
+auto AccuracyEvaluator::labelPath(const std::string& imagePath) \
+        -> std::string {
+  size_t dot = imagePath.rfind('.');
+  size_t slash = imagePath.rfind('/');
+  if (dot == std::string::npos || \
+      (slash != std::string::npos && dot < slash)) {
+    return imagePath + ".txt";
+  }
+  return imagePath.substr(0, dot) + ".txt";
+}
+
+auto AccuracyEvaluator::markParetoFront(\
+        std::vector<EvaluationResult>& results) -> void {
+  for (auto& result : results) {
+    result.paretoOptimal = true;
+    for (const auto& other : results) {
+      double precision = other.metrics.averagePrecision;
+      double rate = other.framesPerSecond;
+      if (precision >= result.metrics.averagePrecision && \
+          rate >= result.framesPerSecond && \
+          (precision > result.metrics.averagePrecision || \
+           rate > result.framesPerSecond)) {
+        result.paretoOptimal = false;
+        break;
+      }
+    }
+  }
+}
+
+auto AccuracyEvaluator::printTable(\
+        const std::vector<EvaluationResult>& results, \
+        std::ostream& output) -> void {
+  std::vector<const EvaluationResult*> rows;
+  size_t width = std::string("configuration").size();
+  for (const auto& result : results) {
+    rows.push_back(&result);
+    width = std::max(width, result.configuration.size());
+  }
+  std::stable_sort(rows.begin(), rows.end(), \
+                   [](const EvaluationResult* first, \
+                      const EvaluationResult* second) {
+    return first->framesPerSecond > second->framesPerSecond;
+  });
+  output << "  " << std::left << std::setw(width) << "configuration" \
+    << std::right << "      AP  precision  recall  frames/s" << std::endl;
+  for (const EvaluationResult* row : rows) {
+    output << (row->paretoOptimal ? "* " : "  ") << std::left \
+      << std::setw(width) << row->configuration << std::right \
+      << std::fixed << std::setprecision(3) << std::setw(8) \
+      << row->metrics.averagePrecision << std::setw(11) \
+      << row->metrics.precision << std::setw(8) << row->metrics.recall \
+      << std::setprecision(2) << std::setw(10) << row->framesPerSecond \
+      << std::defaultfloat << std::endl;
+  }
+  output << "* Pareto front: no other configuration is at least as " \
+    << "accurate and as fast" << std::endl;
+}
+
+auto AccuracyEvaluator::writeCsv(\
+        const std::vector<EvaluationResult>& results, \
+        std::ostream& output) -> void {
+  output << "configuration,labels,detections,true_positives,precision," \
+    << "recall,average_precision,frames_per_second,pareto" << std::endl;
+  for (const auto& result : results) {
+    const EvaluationMetrics& metrics = result.metrics;
+    output << result.configuration << ',' << metrics.labels << ',' \
+      << metrics.detections << ',' << metrics.truePositives << ',' \
+      << metrics.precision << ',' << metrics.recall << ',' \
+      << metrics.averagePrecision << ',' << result.framesPerSecond << ',' \
+      << (result.paretoOptimal ? 1 : 0) << std::endl;
+  }
+}
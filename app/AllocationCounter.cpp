@@ -0,0 +1,174 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AllocationCounter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for AllocationCounter class, the counting
+ *            replacements of the global operator new and delete and the
+ *            counting allocator of the OpenCV images
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <opencv2/core.hpp>
+
+#include "AllocationCounter.hpp"
+
+namespace {
+/* Allocations and bytes allocated by all the threads */
+std::atomic<uint64_t> totalAllocations(0);
+std::atomic<uint64_t> totalBytes(0);
+/* Allocations of the current thread, trivially initialized so that it
+   can be used from operator new at any time */
+thread_local uint64_t threadCount = 0;
+/* Image buffers allocated by all the threads and by the current thread */
+std::atomic<uint64_t> totalMatAllocations(0);
+thread_local uint64_t threadMatCount = 0;
+
+/**
+ * @brief Allocates memory and counts the allocation
+ *
+ * @param size Number of bytes to allocate
+ *
+ * @return Allocated memory or nullptr if the allocation fails
+ */
+void* countedAllocation(std::size_t size) {
+  totalAllocations.fetch_add(1, std::memory_order_relaxed);
+  totalBytes.fetch_add(size, std::memory_order_relaxed);
+  threadCount += 1;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+/**
+ * @brief Allocator of the OpenCV images counting the buffers it allocates,
+ *        the standard allocator of OpenCV doing the allocation
+ */
+class CountingMatAllocator : public cv::MatAllocator {
+ public:
+  cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, \
+                         size_t* step, cv::AccessFlag flags, \
+                         cv::UMatUsageFlags usageFlags) const override {
+    /* Headers of user data own no buffer */
+    if (data == nullptr) {
+      totalMatAllocations.fetch_add(1, std::memory_order_relaxed);
+      threadMatCount += 1;
+    }
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, \
+                                                step, flags, usageFlags);
+  }
+
+  bool allocate(cv::UMatData* data, cv::AccessFlag flags, \
+                cv::UMatUsageFlags usageFlags) const override {
+    return cv::Mat::getStdAllocator()->allocate(data, flags, usageFlags);
+  }
+
+  void deallocate(cv::UMatData* data) const override {
+    cv::Mat::getStdAllocator()->deallocate(data);
+  }
+};
+
+/**
+ * @brief Makes the counting allocator the default one of the images when
+ *        the test or benchmark starts
+ */
+struct MatAllocatorInstaller {
+  MatAllocatorInstaller() {
+    static CountingMatAllocator allocator;
+    cv::Mat::setDefaultAllocator(&allocator);
+  }
+} matAllocatorInstaller;
+}  // namespace
+
+auto AllocationCounter::allocations() -> uint64_t {
+  return totalAllocations.load(std::memory_order_relaxed);
+}
+
+auto AllocationCounter::allocatedBytes() -> uint64_t {
+  return totalBytes.load(std::memory_order_relaxed);
+}
+
+auto AllocationCounter::threadAllocations() -> uint64_t {
+  return threadCount;
+}
+
+auto AllocationCounter::matAllocations() -> uint64_t {
+  return totalMatAllocations.load(std::memory_order_relaxed);
+}
+
+auto AllocationCounter::threadMatAllocations() -> uint64_t {
+  return threadMatCount;
+}
+
+void* operator new(std::size_t size) {
+  void* memory = countedAllocation(size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size) {
+  void* memory = countedAllocation(size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAllocation(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
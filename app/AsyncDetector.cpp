@@ -0,0 +1,276 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AsyncDetector.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for AsyncDetector class
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "AsyncDetector.hpp"
+#include "DetectionModule.hpp"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Detects the frames of a batch one at a time
+ */
+AsyncDetector::BatchDetectorFactory batchOf(\
+        AsyncDetector::DetectorFactory factory) {
+  return [factory]() -> AsyncDetector::BatchDetectFunction {
+    AsyncDetector::DetectFunction detect = factory();
+    if (!detect) {
+      return AsyncDetector::BatchDetectFunction();
+    }
+    return [detect](const std::vector<cv::Mat>& frames, \
+                    const std::vector<int>& frameIDs, \
+                    std::vector<std::vector<Detection>>& detections) {
+      detections.resize(frames.size());
+      for (size_t i = 0; i < frames.size(); ++i) {
+        detections[i] = detect(frames[i], frameIDs[i]);
+      }
+    };
+  };
+}
+}  // namespace
+
+AsyncDetector::AsyncDetector(DetectorFactory factory, int workers, \
+                             size_t maxInFlight) \
+  : AsyncDetector(batchOf(factory), workers, maxInFlight, 1, 0) {
+}
+
+AsyncDetector::AsyncDetector(BatchDetectorFactory factory, int workers, \
+        size_t maxInFlight, size_t maxBatchSize, int maxWaitMs) \
+  : detectorFactory(factory), maxBatchSize(std::max<size_t>(maxBatchSize, 1)),
+    maxWait(std::max(maxWaitMs, 0)) {
+  /* A batch can't be larger than the frames in flight */
+  maxInFlight = std::max(maxInFlight, this->maxBatchSize);
+  slots.resize(maxInFlight);
+  for (size_t i = maxInFlight; i > 0; --i) {
+    freeSlots.push_back(i - 1);
+  }
+  for (int i = 0; i < std::max(workers, 1); ++i) {
+    this->workers.push_back(std::thread(&AsyncDetector::runWorker, this));
+  }
+}
+
+AsyncDetector::AsyncDetector(const RunOptions& options, int workers, \
+                             size_t maxInFlight, MetricsRegistry* registry) \
+  : AsyncDetector(moduleFactory(options, workers, registry), workers, \
+                  maxInFlight, static_cast<size_t>(options.maxBatch), \
+                  options.batchWaitMs) {
+}
+
+AsyncDetector::~AsyncDetector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  jobQueued.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+auto AsyncDetector::moduleFactory(const RunOptions& options, \
+                                  int workers, MetricsRegistry* registry) \
+    -> BatchDetectorFactory {
+  /* Every worker takes the next part of the inference CPUs */
+  std::shared_ptr<std::atomic<int>> nextWorker = \
+      std::make_shared<std::atomic<int>>(0);
+  return [options, workers, nextWorker, registry]() -> BatchDetectFunction {
+    /* Pinned before the network is created, so that its memory is on
+    the node of the worker. A worker that can't be pinned runs anywhere */
+    options.placement.pinCurrentThread(kInferenceThreads, \
+                                       nextWorker->fetch_add(1), workers);
+    std::shared_ptr<DetectionModule> module = \
+        std::make_shared<DetectionModule>();
+    module->setOptions(options);
+    module->warmUp();
+    /* The workers add to the same counters and stage histograms, the
+    warm up frame is left out of them */
+    module->setMetrics(registry);
+    return [module](const std::vector<cv::Mat>& frames, \
+                    const std::vector<int>& frameIDs, \
+                    std::vector<std::vector<Detection>>& detections) {
+      module->detectBatch(frames, frameIDs, detections);
+    };
+  };
+}
+
+auto AsyncDetector::submit(const cv::Mat& frame, int frameID) \
+    -> std::future<std::vector<Detection>> {
+  Job job;
+  job.frameID = frameID;
+  job.promise = std::make_shared<std::promise<std::vector<Detection>>>();
+  std::future<std::vector<Detection>> result = job.promise->get_future();
+  enqueue(frame, std::move(job));
+  return result;
+}
+
+auto AsyncDetector::submit(const cv::Mat& frame, int frameID, \
+                           Callback callback) -> void {
+  Job job;
+  job.frameID = frameID;
+  job.callback = std::move(callback);
+  enqueue(frame, std::move(job));
+}
+
+auto AsyncDetector::enqueue(const cv::Mat& frame, Job job) -> void {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (freeSlots.empty()) {
+    stats.blockedSubmits += 1;
+    jobCompleted.wait(lock, [this]() { return !freeSlots.empty(); });
+  }
+  job.slot = freeSlots.back();
+  freeSlots.pop_back();
+  pending += 1;
+  stats.framesSubmitted += 1;
+  stats.maxInFlight = std::max<uint64_t>(stats.maxInFlight, pending);
+  /* The slot belongs to this call until the job is queued, the copy
+   * reuses the buffer of the previous frame of the slot */
+  lock.unlock();
+  frame.copyTo(slots[job.slot]);
+  job.queued = Clock::now();
+  lock.lock();
+  jobs.push_back(std::move(job));
+  lock.unlock();
+  /* A worker may be waiting for its batch to fill */
+  jobQueued.notify_all();
+}
+
+auto AsyncDetector::runWorker() -> void {
+  BatchDetectFunction detect;
+  try {
+    detect = detectorFactory();
+  } catch (...) {
+    /* Without a detector the jobs taken by this worker fail */
+  }
+  std::vector<Job> batch;
+  std::vector<cv::Mat> frames;
+  std::vector<int> frameIDs;
+  std::vector<std::vector<Detection>> detections;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    jobQueued.wait(lock, [this]() { return !jobs.empty() || stopping; });
+    if (jobs.empty()) {
+      return;
+    }
+    if (jobs.size() < maxBatchSize && !stopping) {
+      /* Wait for more frames, at most until the oldest one is late */
+      Clock::time_point deadline = jobs.front().queued + maxWait;
+      jobQueued.wait_until(lock, deadline, [this]() {
+        return jobs.size() >= maxBatchSize || jobs.empty() || stopping;
+      });
+      if (jobs.empty()) {
+        /* Another worker took the frames */
+        continue;
+      }
+    }
+    size_t count = std::min(jobs.size(), maxBatchSize);
+    Clock::time_point start = Clock::now();
+    batch.clear();
+    frames.clear();
+    frameIDs.clear();
+    for (size_t i = 0; i < count; ++i) {
+      Job& job = jobs.front();
+      stats.queueDelay.record(std::chrono::duration<double, std::milli>(\
+          start - job.queued).count());
+      frames.push_back(slots[job.slot]);
+      frameIDs.push_back(job.frameID);
+      batch.push_back(std::move(job));
+      jobs.pop_front();
+    }
+    stats.batches += 1;
+    if (stats.batchSizes.size() <= count) {
+      stats.batchSizes.resize(count + 1, 0);
+    }
+    stats.batchSizes[count] += 1;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      if (!detect) {
+        throw std::runtime_error("AsyncDetector: detector not created");
+      }
+      detect(frames, frameIDs, detections);
+      if (detections.size() != count) {
+        throw std::runtime_error("AsyncDetector: batch results missing");
+      }
+    } catch (...) {
+      error = std::current_exception();
+      detections.assign(count, std::vector<Detection>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+      Job& job = batch[i];
+      if (job.promise) {
+        if (error) {
+          job.promise->set_exception(error);
+        } else {
+          job.promise->set_value(detections[i]);
+        }
+      } else if (job.callback) {
+        job.callback(job.frameID, detections[i], !error);
+      }
+    }
+    frames.clear();
+
+    lock.lock();
+    for (const auto& job : batch) {
+      freeSlots.push_back(job.slot);
+    }
+    pending -= count;
+    stats.framesCompleted += count;
+    if (error) {
+      stats.framesFailed += count;
+    }
+    jobCompleted.notify_all();
+  }
+}
+
+auto AsyncDetector::waitIdle() -> void {
+  std::unique_lock<std::mutex> lock(mutex);
+  jobCompleted.wait(lock, [this]() { return pending == 0; });
+}
+
+auto AsyncDetector::inFlight() -> size_t {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending;
+}
+
+auto AsyncDetector::getStats() -> AsyncDetectorStats {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
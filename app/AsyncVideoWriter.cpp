@@ -0,0 +1,250 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AsyncVideoWriter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for AsyncVideoWriter class
+ */
+
+#include <chrono>
+#include <string>
+#include <opencv2/imgcodecs.hpp>
+
+#include "AsyncVideoWriter.hpp"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Milliseconds elapsed between two time points
+ */
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+ * @brief Path of a part of a video after the first, <name>_part<n>.avi
+ */
+std::string partPath(const std::string& path, int part) {
+  size_t dot = path.rfind('.');
+  size_t slash = path.rfind('/');
+  if (dot == std::string::npos || \
+      (slash != std::string::npos && dot < slash)) {
+    dot = path.size();
+  }
+  return path.substr(0, dot) + "_part" + std::to_string(part) + \
+         path.substr(dot);
+}
+}  // namespace
+
+AsyncVideoWriter::AsyncVideoWriter() {
+}
+
+AsyncVideoWriter::~AsyncVideoWriter() {
+  close();
+}
+
+auto AsyncVideoWriter::open(const std::string& filePath, double fps, \
+        cv::Size frameSize, size_t queueCapacity, \
+        int encoderThreads) -> bool {
+  close();
+  if (queueCapacity == 0) {
+    queueCapacity = 1;
+  }
+  if (encoderThreads > 0) {
+    if (!aviWriter.open(filePath, frameSize.width, frameSize.height, fps)) {
+      return false;
+    }
+  } else {
+    videoWriter.open(filePath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), \
+                     fps, frameSize, true);
+    if (!videoWriter.isOpened()) {
+      return false;
+    }
+  }
+  size = frameSize;
+  path = filePath;
+  frameRate = fps;
+  parts = 1;
+  slots.assign(queueCapacity, Slot());
+  submitted = 0;
+  encodeNext = 0;
+  written = 0;
+  closing = false;
+  stats = VideoWriterStats();
+  stats.files = 1;
+  for (int i = 0; i < encoderThreads; ++i) {
+    encoders.push_back(std::thread(&AsyncVideoWriter::encodeFrames, this));
+  }
+  writer = std::thread(&AsyncVideoWriter::writeFrames, this);
+  return true;
+}
+
+auto AsyncVideoWriter::isOpened() const -> bool {
+  return writer.joinable();
+}
+
+auto AsyncVideoWriter::write(int frameID, const cv::Mat& frame) -> bool {
+  if (!isOpened() || frame.size() != size || \
+      (submitted > 0 && frameID <= lastFrameID)) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  Slot& slot = slots[submitted % slots.size()];
+  if (slot.state != kFree) {
+    /* Queue is full, wait until the oldest frame is written */
+    Clock::time_point start = Clock::now();
+    slotChanged.wait(lock, [&slot]() { return slot.state == kFree; });
+    stats.blockedWrites += 1;
+    stats.blockedMs += elapsedMs(start, Clock::now());
+  }
+  lock.unlock();
+  /* The slot is only used by this thread until it is queued */
+  frame.copyTo(slot.image);
+  lock.lock();
+  slot.frameID = frameID;
+  slot.state = kQueued;
+  lastFrameID = frameID;
+  submitted += 1;
+  stats.framesSubmitted = submitted;
+  if (submitted - written > stats.maxQueueDepth) {
+    stats.maxQueueDepth = submitted - written;
+  }
+  lock.unlock();
+  slotChanged.notify_all();
+  return true;
+}
+
+auto AsyncVideoWriter::encodeFrames() -> void {
+  const std::vector<int> parameters{cv::IMWRITE_JPEG_QUALITY, 95};
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    slotChanged.wait(lock, [this]() {
+      return encodeNext < submitted || closing;
+    });
+    if (encodeNext >= submitted) {
+      return;
+    }
+    Slot& slot = slots[encodeNext % slots.size()];
+    encodeNext += 1;
+    slot.state = kEncoding;
+    lock.unlock();
+    Clock::time_point start = Clock::now();
+    cv::imencode(".jpg", slot.image, slot.jpeg, parameters);
+    double encodeTime = elapsedMs(start, Clock::now());
+    lock.lock();
+    slot.state = kEncoded;
+    stats.encodeMs += encodeTime;
+    slotChanged.notify_all();
+  }
+}
+
+auto AsyncVideoWriter::writeFrames() -> void {
+  const bool encoded = !encoders.empty();
+  const SlotState ready = encoded ? kEncoded : kQueued;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    slotChanged.wait(lock, [this, ready]() {
+      return (written < submitted && \
+              slots[written % slots.size()].state == ready) || \
+             (closing && written == submitted);
+    });
+    if (written == submitted) {
+      return;
+    }
+    /* Frames are taken in submission order, which is frame ID order */
+    Slot& slot = slots[written % slots.size()];
+    lock.unlock();
+    bool frameWritten = true;
+    if (encoded) {
+      frameWritten = writeEncoded(slot.jpeg);
+    } else {
+      Clock::time_point start = Clock::now();
+      videoWriter.write(slot.image);
+      double encodeTime = elapsedMs(start, Clock::now());
+      lock.lock();
+      stats.encodeMs += encodeTime;
+      lock.unlock();
+    }
+    lock.lock();
+    slot.state = kFree;
+    written += 1;
+    if (frameWritten) {
+      stats.framesWritten += 1;
+    } else {
+      stats.framesFailed += 1;
+    }
+    stats.files = static_cast<uint64_t>(parts);
+    slotChanged.notify_all();
+  }
+}
+
+auto AsyncVideoWriter::writeEncoded(const std::vector<uchar>& jpeg) \
+    -> bool {
+  /* A frame too large for an empty file fails without a new part */
+  if (aviWriter.isOpened() && aviWriter.frameCount() > 0 && \
+      !aviWriter.fits(jpeg.size())) {
+    aviWriter.close();
+    parts += 1;
+    if (!aviWriter.open(partPath(path, parts), size.width, size.height, \
+                        frameRate)) {
+      return false;
+    }
+  }
+  return aviWriter.writeFrame(jpeg.data(), jpeg.size());
+}
+
+auto AsyncVideoWriter::setMaxFileSize(uint64_t bytes) -> void {
+  aviWriter.setMaxFileSize(bytes);
+}
+
+auto AsyncVideoWriter::close() -> void {
+  if (!isOpened()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closing = true;
+  }
+  slotChanged.notify_all();
+  writer.join();
+  for (auto& encoder : encoders) {
+    encoder.join();
+  }
+  encoders.clear();
+  if (aviWriter.isOpened()) {
+    aviWriter.close();
+  }
+  if (videoWriter.isOpened()) {
+    videoWriter.release();
+  }
+}
+
+auto AsyncVideoWriter::getStats() -> VideoWriterStats {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
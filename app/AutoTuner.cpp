@@ -0,0 +1,188 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AutoTuner.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for AutoTuner class
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <opencv2/core.hpp>
+
+#include "AsyncDetector.hpp"
+#include "AutoTuner.hpp"
+#include "LatencyHistogram.hpp"
+
+AutoTuner::AutoTuner(MeasureFunction measureFunction, double cap) : \
+    measure(measureFunction), latencyCapMs(cap) {
+}
+
+AutoTuner::~AutoTuner() {
+}
+
+auto AutoTuner::listCandidates(const RunOptions& base, int cores, \
+        const std::vector<int>& inputSizes, \
+        std::vector<RunOptions>& candidates) -> void {
+  candidates.clear();
+  cores = std::max(1, cores);
+  for (int inputSize : inputSizes) {
+    for (int threads = 1; threads <= cores; threads *= 2) {
+      for (int workers = 1; threads * workers <= cores; workers *= 2) {
+        for (int batch = 1; batch <= 4; batch *= 2) {
+          RunOptions options = base;
+          options.inputSize = inputSize;
+          options.opencvThreads = threads;
+          options.serverWorkers = workers;
+          options.maxBatch = batch;
+          candidates.push_back(options);
+        }
+      }
+    }
+  }
+}
+
+auto AutoTuner::tune(const RunOptions& base, int cores, \
+        const std::vector<int>& inputSizes, std::ostream& log) -> bool {
+  measured = false;
+  std::vector<RunOptions> candidates;
+  listCandidates(base, cores, inputSizes, candidates);
+  log << "threads workers batch size filter   frames/s   p50 ms   p99 ms" \
+    << std::endl;
+  for (const auto& candidate : candidates) {
+    evaluate(candidate, log);
+  }
+  /* The filter only changes the pre processing, so it is compared on the
+  best configuration instead of multiplying the candidates */
+  RunOptions configuration = best;
+  for (char filterType : {'G', 'M', 'B'}) {
+    if (filterType != configuration.filterType) {
+      configuration.filterType = filterType;
+      evaluate(configuration, log);
+    }
+  }
+  return measured && bestMeasurement.p99Ms <= latencyCapMs;
+}
+
+auto AutoTuner::getBest() const -> const RunOptions& {
+  return best;
+}
+
+auto AutoTuner::getBestMeasurement() const -> const TuningMeasurement& {
+  return bestMeasurement;
+}
+
+auto AutoTuner::evaluate(const RunOptions& options, \
+                         std::ostream& log) -> void {
+  TuningMeasurement measurement = measure(options);
+  std::ios::fmtflags flags = log.flags();
+  std::streamsize precision = log.precision();
+  log << std::setw(7) << options.opencvThreads << std::setw(8) \
+    << options.serverWorkers << std::setw(6) << options.maxBatch \
+    << std::setw(5) << options.inputSize << std::setw(7) \
+    << options.filterType << std::fixed << std::setprecision(2) \
+    << std::setw(11) << measurement.framesPerSecond << std::setprecision(1) \
+    << std::setw(9) << measurement.p50Ms << std::setw(9) \
+    << measurement.p99Ms << (measurement.p99Ms > latencyCapMs ? \
+    "  over the cap" : "") << std::endl;
+  log.flags(flags);
+  log.precision(precision);
+  if (!measured || isBetter(measurement)) {
+    best = options;
+    bestMeasurement = measurement;
+    measured = true;
+  }
+}
+
+auto AutoTuner::isBetter(const TuningMeasurement& measurement) const \
+    -> bool {
+  bool withinCap = measurement.p99Ms <= latencyCapMs;
+  bool bestWithinCap = bestMeasurement.p99Ms <= latencyCapMs;
+  if (withinCap != bestWithinCap) {
+    return withinCap;
+  }
+  if (withinCap) {
+    return measurement.framesPerSecond > bestMeasurement.framesPerSecond;
+  }
+  return measurement.p99Ms < bestMeasurement.p99Ms;
+}
+
+auto AutoTuner::detectorBenchmark(const cv::Mat& frame, \
+                                  int frames) -> MeasureFunction {
+  cv::Mat image = frame.clone();
+  return [image, frames](const RunOptions& options) -> TuningMeasurement {
+    typedef std::chrono::steady_clock Clock;
+    cv::setNumThreads(options.opencvThreads);
+    size_t inFlight = static_cast<size_t>(options.serverWorkers) * \
+                      options.maxBatch;
+    LatencyHistogram latency;
+    /* Frames completed, the submissions wait for a free slot themselves
+    so that the latency starts when the frame enters the detector */
+    size_t completed = 0;
+    std::mutex mutex;
+    std::condition_variable frameCompleted;
+    TuningMeasurement measurement;
+    {
+      AsyncDetector detector(options, options.serverWorkers, inFlight);
+      /* The workers are loaded and warmed up by the first frames */
+      for (size_t i = 0; i < inFlight; ++i) {
+        detector.submit(image, -1, [](int, const std::vector<Detection>&, \
+                                      bool) {});
+      }
+      detector.waitIdle();
+      Clock::time_point start = Clock::now();
+      for (int i = 0; i < frames; ++i) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          frameCompleted.wait(lock, [&completed, i, inFlight]() {
+            return static_cast<size_t>(i) - completed < inFlight;
+          });
+        }
+        Clock::time_point submitted = Clock::now();
+        detector.submit(image, i, [&latency, &mutex, &completed, \
+            &frameCompleted, submitted](int, const std::vector<Detection>&, \
+                                        bool) {
+          std::chrono::duration<double, std::milli> elapsed = \
+              Clock::now() - submitted;
+          std::lock_guard<std::mutex> lock(mutex);
+          latency.record(elapsed.count());
+          completed += 1;
+          frameCompleted.notify_one();
+        });
+      }
+      detector.waitIdle();
+      std::chrono::duration<double> elapsed = Clock::now() - start;
+      measurement.framesPerSecond = frames / elapsed.count();
+    }
+    measurement.p50Ms = latency.percentile(0.50);
+    measurement.p99Ms = latency.percentile(0.99);
+    return measurement;
+  };
+}
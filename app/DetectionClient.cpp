@@ -0,0 +1,107 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionClient.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for DetectionClient class
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "DetectionClient.hpp"
+
+DetectionClient::DetectionClient() {
+}
+
+DetectionClient::~DetectionClient() {
+  disconnect();
+}
+
+auto DetectionClient::connect(const std::string& socketPath) -> bool {
+  disconnect();
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::strncpy(address.sun_path, socketPath.c_str(), \
+               sizeof(address.sun_path) - 1);
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return false;
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), \
+                sizeof(address)) != 0) {
+    disconnect();
+    return false;
+  }
+  return true;
+}
+
+auto DetectionClient::disconnect() -> void {
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+auto DetectionClient::detectEncoded(const void* data, size_t size, \
+                        std::vector<Detection>& detections) -> uint16_t {
+  protocol::RequestHeader header;
+  header.type = protocol::kEncodedImage;
+  header.payloadSize = static_cast<uint32_t>(size);
+  return request(header, data, detections);
+}
+
+auto DetectionClient::detectRaw(const void* pixels, uint32_t width, \
+        uint32_t height, std::vector<Detection>& detections) -> uint16_t {
+  protocol::RequestHeader header;
+  header.type = protocol::kRawBgrFrame;
+  header.width = width;
+  header.height = height;
+  header.payloadSize = width * height * 3;
+  return request(header, pixels, detections);
+}
+
+auto DetectionClient::request(protocol::RequestHeader& header, \
+        const void* payload, std::vector<Detection>& detections) -> uint16_t {
+  detections.clear();
+  header.requestID = nextRequestID++;
+  protocol::ResponseHeader response;
+  if (fd < 0 || !protocol::writeRequest(fd, header, payload) || \
+      !protocol::readResponse(fd, response, detections) || \
+      response.requestID != header.requestID) {
+    disconnect();
+    return protocol::kServerError;
+  }
+  return response.status;
+}
@@ -0,0 +1,428 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      DetectionDelta.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for DeltaEncoder and DeltaDecoder classes
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "DetectionDelta.hpp"
+#include "DetectionInterpolator.hpp"
+
+namespace {
+/* Smallest overlap of an untracked box still written as moved */
+const float kMoveIou = 0.3f;
+
+/**
+ * @brief Rounds a score to the 4 decimals written, so that the encoder
+ *        holds the scores the decoder reads
+ */
+float roundScore(float score) {
+  return static_cast<float>(std::round(score * 10000.0) / 10000.0);
+}
+
+/**
+ * @brief Checks if two boxes can be the same object
+ */
+bool sameObject(const Detection& first, const Detection& second) {
+  return first.classId == second.classId && \
+         first.trackID == second.trackID;
+}
+
+/**
+ * @brief Reads a box, with its class and track if asked
+ */
+bool readBox(std::istream& fields, Detection& detection, bool full) {
+  fields >> detection.x1 >> detection.y1 >> detection.x2 >> detection.y2 \
+    >> detection.score;
+  if (full) {
+    fields >> detection.classId >> detection.trackID;
+  }
+  return !fields.fail();
+}
+}  // namespace
+
+DeltaEncoder::DeltaEncoder(std::ostream& stream, int interval, \
+                           int pixels, float scoreChange) :
+    output(stream), keyframeInterval(std::max(interval, 1)), \
+    tolerance(std::max(pixels, 0)), scoreTolerance(scoreChange) {
+}
+
+auto DeltaEncoder::encode(int frameID, const Detection* detections, \
+                          size_t count) -> bool {
+  writeHeader();
+  if (frameID < nextFrameID) {
+    return false;
+  }
+  /* Frames without detections are not in the detections of a run */
+  while (nextFrameID < frameID) {
+    encodeFrame(nextFrameID, nullptr, 0);
+    nextFrameID += 1;
+  }
+  encodeFrame(frameID, detections, count);
+  nextFrameID = frameID + 1;
+  return true;
+}
+
+auto DeltaEncoder::encodeAll(const std::vector<Detection>& detections) \
+        -> bool {
+  size_t start = 0;
+  while (start < detections.size()) {
+    size_t end = start + 1;
+    while (end < detections.size() && \
+           detections[end].frameID == detections[start].frameID) {
+      end += 1;
+    }
+    if (!encode(detections[start].frameID, detections.data() + start, \
+                end - start)) {
+      return false;
+    }
+    start = end;
+  }
+  return true;
+}
+
+auto DeltaEncoder::finish(int lastFrameID) -> void {
+  writeHeader();
+  if (lastFrameID >= nextFrameID) {
+    encode(lastFrameID, nullptr, 0);
+  }
+  output << "E " << nextFrameID - 1 << '\n';
+  output.flush();
+}
+
+auto DeltaEncoder::getStats() const -> const DeltaStats& {
+  return stats;
+}
+
+auto DeltaEncoder::printReport(std::ostream& report) const -> void {
+  double written = stats.boxes > 0 ? \
+                   100.0 * stats.boxesWritten / stats.boxes : 0;
+  std::ios::fmtflags flags = report.flags();
+  std::streamsize precision = report.precision();
+  report << "Delta output: " << stats.frames << " frames, " \
+    << stats.keyframes << " written in full, " << stats.boxesWritten \
+    << " of " << stats.boxes << " boxes written (" << std::fixed \
+    << std::setprecision(1) << written << "%)" << std::endl;
+  report.flags(flags);
+  report.precision(precision);
+}
+
+auto DeltaEncoder::writeHeader() -> void {
+  if (started) {
+    return;
+  }
+  output << std::fixed << std::setprecision(4);
+  output << "hodm-delta 1 " << keyframeInterval << ' ' << tolerance \
+    << ' ' << scoreTolerance << '\n';
+  started = true;
+}
+
+auto DeltaEncoder::writeBox(const Detection& detection) -> void {
+  output << detection.x1 << ' ' << detection.y1 << ' ' << detection.x2 \
+    << ' ' << detection.y2 << ' ' << detection.score << ' ' \
+    << detection.classId << ' ' << detection.trackID << '\n';
+}
+
+auto DeltaEncoder::encodeFrame(int frameID, const Detection* detections, \
+                               size_t count) -> void {
+  stats.frames += 1;
+  stats.boxes += count;
+  if (stats.frames == 1 || frameID - keyframeID >= keyframeInterval) {
+    keyframeID = frameID;
+    stats.keyframes += 1;
+    stats.boxesWritten += count;
+    output << "K " << frameID << ' ' << count << '\n';
+    held.clear();
+    for (size_t i = 0; i < count; ++i) {
+      held.push_back(detections[i]);
+      held.back().score = roundScore(held.back().score);
+      writeBox(held.back());
+    }
+    return;
+  }
+  match.assign(held.size(), -1);
+  unchanged.assign(held.size(), false);
+  matched.assign(count, false);
+  /* Boxes within tolerance of a held box first, they are not written */
+  for (size_t i = 0; i < count; ++i) {
+    const Detection& box = detections[i];
+    for (size_t j = 0; j < held.size(); ++j) {
+      if (match[j] < 0 && sameObject(box, held[j]) && \
+          std::abs(box.x1 - held[j].x1) <= tolerance && \
+          std::abs(box.y1 - held[j].y1) <= tolerance && \
+          std::abs(box.x2 - held[j].x2) <= tolerance && \
+          std::abs(box.y2 - held[j].y2) <= tolerance && \
+          std::fabs(box.score - held[j].score) <= scoreTolerance) {
+        match[j] = static_cast<int>(i);
+        unchanged[j] = true;
+        matched[i] = true;
+        break;
+      }
+    }
+  }
+  /* Then the boxes that moved, onto the held box they overlap most */
+  size_t moved = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (matched[i]) {
+      continue;
+    }
+    const Detection& box = detections[i];
+    int best = -1;
+    float bestIou = kMoveIou;
+    for (size_t j = 0; j < held.size(); ++j) {
+      if (match[j] >= 0 || !sameObject(box, held[j])) {
+        continue;
+      }
+      float overlap = DetectionInterpolator::iou(box, held[j]);
+      if (box.trackID != Detection::kNoTrack || overlap >= bestIou) {
+        best = static_cast<int>(j);
+        bestIou = overlap;
+        if (box.trackID != Detection::kNoTrack) {
+          break;
+        }
+      }
+    }
+    if (best >= 0) {
+      match[best] = static_cast<int>(i);
+      matched[i] = true;
+      moved += 1;
+    }
+  }
+  size_t removedCount = 0;
+  for (int index : match) {
+    removedCount += index < 0 ? 1 : 0;
+  }
+  size_t added = 0;
+  for (size_t i = 0; i < count; ++i) {
+    added += matched[i] ? 0 : 1;
+  }
+  if (moved == 0 && removedCount == 0 && added == 0) {
+    return;
+  }
+  stats.boxesWritten += moved + added;
+  output << "F " << frameID << ' ' << moved << ' ' << removedCount << ' ' \
+    << added << '\n';
+  next.clear();
+  for (size_t j = 0; j < held.size(); ++j) {
+    if (match[j] >= 0 && !unchanged[j]) {
+      Detection box = detections[match[j]];
+      box.score = roundScore(box.score);
+      output << "~ " << j << ' ' << box.x1 << ' ' << box.y1 << ' ' \
+        << box.x2 << ' ' << box.y2 << ' ' << box.score << '\n';
+      next.push_back(box);
+    } else if (match[j] >= 0) {
+      next.push_back(held[j]);
+    }
+  }
+  for (size_t j = 0; j < held.size(); ++j) {
+    if (match[j] < 0) {
+      output << "- " << j << '\n';
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (!matched[i]) {
+      Detection box = detections[i];
+      box.score = roundScore(box.score);
+      output << "+ ";
+      writeBox(box);
+      next.push_back(box);
+    }
+  }
+  held.swap(next);
+}
+
+auto DeltaDecoder::open(const std::string& path) -> bool {
+  input.close();
+  input.clear();
+  input.open(path);
+  keyframes.clear();
+  lastFrameID = -1;
+  decodedFrameID = -1;
+  held.clear();
+  std::string line;
+  if (!input.is_open() || !std::getline(input, line) || \
+      line.compare(0, 13, "hodm-delta 1 ") != 0) {
+    return false;
+  }
+  /* Index the full frames, the last frame being that of the end record,
+  or that of the last record of an unfinished file */
+  std::streamoff position = input.tellg();
+  while (std::getline(input, line)) {
+    if (!line.empty() && (line[0] == 'K' || line[0] == 'F' || \
+                          line[0] == 'E')) {
+      int frameID = std::atoi(line.c_str() + 1);
+      if (line[0] == 'K') {
+        keyframes[frameID] = position;
+      }
+      lastFrameID = std::max(lastFrameID, frameID);
+    }
+    position = input.tellg();
+  }
+  input.clear();
+  return true;
+}
+
+auto DeltaDecoder::getLastFrameID() const -> int {
+  return lastFrameID;
+}
+
+auto DeltaDecoder::readFrame(int frameID, \
+                             std::vector<Detection>& detections) -> bool {
+  detections.clear();
+  if (frameID < 0 || frameID > lastFrameID) {
+    return false;
+  }
+  auto keyframe = keyframes.upper_bound(frameID);
+  if (keyframe == keyframes.begin()) {
+    return false;
+  }
+  --keyframe;
+  /* Start over from the full frame unless the frames decoded lead to
+  the frame asked */
+  if (decodedFrameID > frameID || decodedFrameID < keyframe->first) {
+    input.clear();
+    input.seekg(keyframe->second);
+    held.clear();
+    decodedFrameID = keyframe->first - 1;
+  }
+  if (!advance(frameID)) {
+    return false;
+  }
+  for (Detection detection : held) {
+    detection.frameID = frameID;
+    detections.push_back(detection);
+  }
+  return true;
+}
+
+auto DeltaDecoder::readAll(std::vector<Detection>& detections) -> bool {
+  detections.clear();
+  std::vector<Detection> frame;
+  for (int frameID = 0; frameID <= lastFrameID; ++frameID) {
+    if (!readFrame(frameID, frame)) {
+      return false;
+    }
+    detections.insert(detections.end(), frame.begin(), frame.end());
+  }
+  return true;
+}
+
+auto DeltaDecoder::advance(int frameID) -> bool {
+  std::string line;
+  while (true) {
+    std::streamoff position = input.tellg();
+    if (!std::getline(input, line)) {
+      input.clear();
+      break;
+    }
+    if (line.empty()) {
+      continue;
+    }
+    int recordFrameID = std::atoi(line.c_str() + 1);
+    if (line[0] == 'E' || recordFrameID > frameID) {
+      input.seekg(position);
+      break;
+    }
+    if (!applyRecord(line)) {
+      return false;
+    }
+  }
+  decodedFrameID = frameID;
+  return true;
+}
+
+auto DeltaDecoder::applyRecord(const std::string& line) -> bool {
+  std::istringstream header(line.substr(1));
+  int frameID = 0;
+  std::string boxLine;
+  if (line[0] == 'K') {
+    size_t count = 0;
+    if (!(header >> frameID >> count)) {
+      return false;
+    }
+    held.clear();
+    for (size_t i = 0; i < count; ++i) {
+      Detection detection;
+      std::getline(input, boxLine);
+      std::istringstream fields(boxLine);
+      if (!readBox(fields, detection, true)) {
+        return false;
+      }
+      held.push_back(detection);
+    }
+    return true;
+  }
+  size_t moved = 0;
+  size_t removedCount = 0;
+  size_t added = 0;
+  if (line[0] != 'F' || !(header >> frameID >> moved >> removedCount >> \
+                          added)) {
+    return false;
+  }
+  removed.assign(held.size(), false);
+  size_t index = 0;
+  for (size_t i = 0; i < moved + removedCount; ++i) {
+    std::getline(input, boxLine);
+    std::istringstream fields(boxLine.size() > 1 ? boxLine.substr(1) : "");
+    if (!(fields >> index) || index >= held.size()) {
+      return false;
+    }
+    if (i < moved) {
+      if (boxLine[0] != '~' || !readBox(fields, held[index], false)) {
+        return false;
+      }
+    } else if (boxLine[0] == '-') {
+      removed[index] = true;
+    } else {
+      return false;
+    }
+  }
+  size_t kept = 0;
+  for (size_t j = 0; j < held.size(); ++j) {
+    if (!removed[j]) {
+      held[kept++] = held[j];
+    }
+  }
+  held.resize(kept);
+  for (size_t i = 0; i < added; ++i) {
+    Detection detection;
+    std::getline(input, boxLine);
+    std::istringstream fields(boxLine.size() > 1 ? boxLine.substr(1) : "");
+    if (boxLine.empty() || boxLine[0] != '+' || \
+        !readBox(fields, detection, true)) {
+      return false;
+    }
+    held.push_back(detection);
+  }
+  return true;
+}
@@ -0,0 +1,143 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionInterpolator.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for DetectionInterpolator class
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "DetectionInterpolator.hpp"
+
+namespace {
+/**
+ * @brief Linear interpolation of a coordinate, rounded to a pixel
+ */
+int32_t lerp(int32_t from, int32_t to, double t) {
+  return static_cast<int32_t>(std::lround(from + (to - from) * t));
+}
+}  // namespace
+
+DetectionInterpolator::DetectionInterpolator(float minimumIou) :
+    matchIou(minimumIou) {
+}
+
+auto DetectionInterpolator::iou(const Detection& first, \
+                                const Detection& second) -> float {
+  int64_t width = std::min(first.x2, second.x2) - \
+                  std::max(first.x1, second.x1);
+  int64_t height = std::min(first.y2, second.y2) - \
+                   std::max(first.y1, second.y1);
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+  int64_t intersection = width * height;
+  int64_t firstArea = static_cast<int64_t>(first.x2 - first.x1) * \
+                      (first.y2 - first.y1);
+  int64_t secondArea = static_cast<int64_t>(second.x2 - second.x1) * \
+                       (second.y2 - second.y1);
+  return static_cast<float>(intersection) / \
+         static_cast<float>(firstArea + secondArea - intersection);
+}
+
+auto DetectionInterpolator::setKeyFrames(int firstFrameID, \
+        const std::vector<Detection>& firstDetections, int lastFrameID, \
+        const std::vector<Detection>& lastDetections) -> void {
+  firstID = firstFrameID;
+  lastID = std::max(lastFrameID, firstFrameID);
+  first.assign(firstDetections.begin(), firstDetections.end());
+  last.assign(lastDetections.begin(), lastDetections.end());
+  /* Every overlapping pair of the same class, largest overlap first */
+  candidates.clear();
+  for (size_t i = 0; i < first.size(); ++i) {
+    for (size_t j = 0; j < last.size(); ++j) {
+      if (first[i].classId != last[j].classId) {
+        continue;
+      }
+      float overlap = iou(first[i], last[j]);
+      if (overlap >= matchIou) {
+        candidates.push_back({overlap, static_cast<int>(i), \
+                              static_cast<int>(j)});
+      }
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(), \
+      [](const Candidate& a, const Candidate& b) { return a.iou > b.iou; });
+  pairs.clear();
+  firstPaired.assign(first.size(), false);
+  lastPaired.assign(last.size(), false);
+  for (const auto& candidate : candidates) {
+    if (firstPaired[candidate.first] || lastPaired[candidate.last]) {
+      continue;
+    }
+    firstPaired[candidate.first] = true;
+    lastPaired[candidate.last] = true;
+    pairs.push_back({candidate.first, candidate.last});
+  }
+  for (size_t i = 0; i < first.size(); ++i) {
+    if (!firstPaired[i]) {
+      pairs.push_back({static_cast<int>(i), -1});
+    }
+  }
+  for (size_t j = 0; j < last.size(); ++j) {
+    if (!lastPaired[j]) {
+      pairs.push_back({-1, static_cast<int>(j)});
+    }
+  }
+}
+
+auto DetectionInterpolator::interpolate(int frameID, \
+        std::vector<Detection>& detections) const -> void {
+  double t = 0;
+  if (lastID > firstID) {
+    t = static_cast<double>(frameID - firstID) / (lastID - firstID);
+  }
+  for (const auto& pair : pairs) {
+    Detection detection;
+    if (pair.first >= 0 && pair.last >= 0) {
+      const Detection& from = first[pair.first];
+      const Detection& to = last[pair.last];
+      detection = from;
+      detection.x1 = lerp(from.x1, to.x1, t);
+      detection.y1 = lerp(from.y1, to.y1, t);
+      detection.x2 = lerp(from.x2, to.x2, t);
+      detection.y2 = lerp(from.y2, to.y2, t);
+      detection.score = static_cast<float>(from.score + \
+                                           (to.score - from.score) * t);
+    } else if (pair.first >= 0 && t < 0.5) {
+      detection = first[pair.first];
+    } else if (pair.last >= 0 && t >= 0.5) {
+      detection = last[pair.last];
+    } else {
+      continue;
+    }
+    detection.frameID = frameID;
+    detections.push_back(detection);
+  }
+}
@@ -30,98 +30,1052 @@
  * @brief     Definition for DetectionModule class
  */
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <csignal>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include "DetectionModule.hpp"
 
+namespace {
+/* Set by SIGINT and SIGTERM to end a headless camera feed */
+volatile std::sig_atomic_t feedStopRequested = 0;
+
+/**
+ * @brief Handler of SIGINT and SIGTERM during a headless camera feed
+ */
+void requestFeedStop(int) {
+  feedStopRequested = 1;
+}
+
+/**
+ * @brief Gives the name of the annotated image of an input image
+ *
+ * @param imagePath Path of the input image
+ *
+ * @return Name of the input without directory and extension, followed by
+ *         Detection.jpg
+ */
+std::string outputImageName(const std::string& imagePath) {
+  size_t start = imagePath.rfind('/');
+  start = (start == std::string::npos) ? 0 : start + 1;
+  size_t end = imagePath.rfind('.');
+  if (end == std::string::npos || end < start) {
+    end = imagePath.size();
+  }
+  return imagePath.substr(start, end - start) + "Detection.jpg";
+}
+
+/**
+ * @brief Describes a frame of a stream as a YUV image, if its format can
+ *        go straight into the network
+ *
+ * @param pixels Pixels of the frame
+ * @param reader Reader giving the format and size of the frame
+ * @param image Filled with the layout, data and size of the frame
+ *
+ * @return false for BGR and gray frames, and for odd sizes
+ */
+bool describeYuvFrame(const std::vector<unsigned char>& pixels, \
+                      const FrameStreamReader& reader, YuvImage& image) {
+  switch (reader.getFormat()) {
+    case FrameStreamReader::kYuv420p:
+      image.layout = YuvImage::kI420;
+      break;
+    case FrameStreamReader::kNv12:
+      image.layout = YuvImage::kNv12;
+      break;
+    case FrameStreamReader::kYuyv:
+      image.layout = YuvImage::kYuyv;
+      break;
+    default:
+      return false;
+  }
+  image.data = pixels.data();
+  image.width = reader.getWidth();
+  image.height = reader.getHeight();
+  return YuvConverter::isValid(image);
+}
+
+/**
+ * @brief Converts a frame with a Y plane and interleaved U and V at half
+ *        resolution to BGR, whatever the parity of its size
+ *
+ * The chroma of odd sizes is rounded up, so the even part of the frame is
+ * converted and its last column and row are repeated.
+ *
+ * @param luma Y plane of the frame
+ * @param chroma Interleaved U and V, rounded up to cover the frame
+ * @param image Set to the BGR image of the size of the Y plane
+ *
+ * @return false if the frame is smaller than 2x2
+ */
+bool convertTwoPlanes(const cv::Mat& luma, const cv::Mat& chroma, \
+                      cv::Mat& image) {
+  int evenWidth = luma.cols & ~1;
+  int evenHeight = luma.rows & ~1;
+  if (evenWidth == 0 || evenHeight == 0) {
+    return false;
+  }
+  cv::cvtColorTwoPlane(luma(cv::Rect(0, 0, evenWidth, evenHeight)), \
+      chroma(cv::Rect(0, 0, evenWidth / 2, evenHeight / 2)), image, \
+      cv::COLOR_YUV2BGR_NV12);
+  if (evenWidth != luma.cols || evenHeight != luma.rows) {
+    cv::copyMakeBorder(image, image, 0, luma.rows - evenHeight, 0, \
+                       luma.cols - evenWidth, cv::BORDER_REPLICATE);
+  }
+  return true;
+}
+}  // namespace
+
 DetectionModule::DetectionModule() {
     /* Default input choice */
     inputChoice = 1;
+    /* Identity intrinsic matrix for the transformation */
+    intrinsic = cv::Matx33f::eye();
+    intrinsicInverse = intrinsic.inv();
+    /* Room for all the boxes of the three YOLO layers at 416x416 */
+    arena.reserve(3 * (13 * 13 + 26 * 26 + 52 * 52));
 }
 
 auto DetectionModule::getFrame(std::string filePath, int cameraID, \
                         std::string outputDirectory, int choice) -> int {
   int frameID = 0;
   inputChoice = choice;
-  char filterType = 'G';
+  /* Detections are drawn only on the images and videos written */
+  drawing = !options.headless;
+  /* Frames are read into their own buffer, the processed image is a
+  buffer of the arena, so neither is reallocated between frames */
+  cv::Mat capturedImage;
   cv::Mat image;
   /* The conditions below check the input type entered by the user and
      then read the data accordingly and feed it to the network */
   if (inputChoice == 1) {
-    image = cv::imread(filePath);
-    if (!image.data) {
-      std::cout << "ERROR: Invalid image input" << std::endl;
-      return 0;
-    }
-    image = preProcessImage(image, filterType);
-    int flag = detectObjects(image);
-    if (flag != 0) {
-      image = postProcessImage(image, frameID);
-    }
-    frameID += 1;
-    cv::imwrite(outputDirectory + "testImageDetection.jpg", image);
-  } else if (inputChoice == 2) {
-      videoFrames = cv::VideoCapture(filePath);
-      /* Check if the file entered by the user is correct */
-      if (!videoFrames.isOpened()) {
-        std::cout << "Error: Invalid video file" << std::endl;
+    std::vector<std::string> imagePaths;
+    if (!ImageLoader::listImages(filePath, imagePaths)) {
+      /* A single image */
+      if (!processImageFile(filePath, outputDirectory + \
+                            "testImageDetection.jpg", frameID)) {
+        std::cout << "ERROR: Invalid image input" << std::endl;
         return 0;
       }
-      videoWriter.open(outputDirectory + "testVideoDetection.avi", \
-      cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 15.0, \
-      cv::Size(416, 416), true);
-      /* Read frames and pass each frame as an image to the network */
-      while (videoFrames.read(image)) {
-        if (image.empty()) {
-          break;
+    } else {
+      /* A directory of images, processed as a batch */
+      if (!options.cacheFile.empty() && !openCache()) {
+        std::cout << "Warning: " << options.cacheFile << " is not a " \
+          << "result cache, it is not used" << std::endl;
+      }
+      for (const auto& imagePath : imagePaths) {
+        if (processCachedImage(imagePath, outputDirectory + \
+                               outputImageName(imagePath), frameID)) {
+          frameID += 1;
+        } else {
+          std::cout << "Skipping " << imagePath << std::endl;
         }
-        image = preProcessImage(image, filterType);
-        int flag = detectObjects(image);
-        if (flag != 0) {
-          image = postProcessImage(image, frameID);
+      }
+      imageLoader.printReport(std::cout);
+      if (resultCache.isOpen()) {
+        if (!resultCache.save()) {
+          std::cout << "Error: Can't write the result cache" << std::endl;
         }
-        frameID += 1;
-        videoWriter.write(image);
+        resultCache.printReport(std::cout);
       }
+    }
+  } else if (inputChoice == 2) {
+    if (!processVideo(filePath, outputDirectory)) {
+      return 0;
+    }
+  } else if (inputChoice == 4) {
+    if (!processSharedFrames(filePath)) {
+      std::cout << "Error: Can't open the shared memory ring " << filePath \
+        << std::endl;
+      return 0;
+    }
   } else if (inputChoice == 3) {
     if (cameraID < 0) {
       return 0;
     } else {
       /* Check if the cameraID entered by the user is correct */
-      videoFrames = cv::VideoCapture(cameraID);
+      {
+        ScopedPlacement placement(options.placement, kCaptureThreads);
+        videoFrames = cv::VideoCapture(cameraID);
+      }
       if (!videoFrames.isOpened()) {
         std::cout << "Error: Invalid camera ID" << std::endl;
         return 0;
       }
+      /* Frames are drawn and shown on the render thread, at most at the
+      display rate, so the detection never waits for the window */
+      drawing = false;
+      FrameRenderer renderer;
+      void (*previousInterrupt)(int) = SIG_DFL;
+      void (*previousTerminate)(int) = SIG_DFL;
+      feedStopRequested = 0;
+      if (options.headless) {
+        /* Without a window, SIGINT or SIGTERM end the feed */
+        previousInterrupt = std::signal(SIGINT, requestFeedStop);
+        previousTerminate = std::signal(SIGTERM, requestFeedStop);
+      } else {
+        ScopedPlacement placement(options.placement, kOutputThreads);
+        renderer.start(options.displayFps);
+      }
+      /* Frames replaced before being shown, already counted as dropped */
+      uint64_t reportedSkips = 0;
       /* Read frames and pass each frame as an image to the network */
-      while (videoFrames.read(image)) {
-        image = preProcessImage(image, filterType);
-        int flag = detectObjects(image);
-        if (flag != 0) {
-          image = postProcessImage(image, frameID);
-        }
+      while (!feedStopRequested && readFrame(capturedImage, frameID)) {
+        image = processFrame(capturedImage, frameID);
         frameID += 1;
-        cv::imshow("Box", image);
+        if (!options.headless) {
+          ScopedStage stage(profiler, "render");
+          renderer.submit(image, frameDetections, zoneOutlines);
+        }
+        if (displayDropsMetric != nullptr && !options.headless) {
+          uint64_t skipped = renderer.getStats().framesSkipped;
+          displayDropsMetric->add(skipped - reportedSkips);
+          reportedSkips = skipped;
+        }
         /* Press esc to stop the feed from the camera */
-        char c = static_cast<char>(cv::waitKey(25));
-        if (c == 27) {
+        if (renderer.closeRequested()) {
           break;
         }
       }
+      if (options.headless) {
+        std::signal(SIGINT, previousInterrupt);
+        std::signal(SIGTERM, previousTerminate);
+      } else {
+        renderer.stop();
+        reportRenderer(renderer.getStats());
+      }
     }
   }
-  io.saveOutput(finalDetections, outputDirectory);
+  /* A video writes its detections before finishing its checkpoint */
+  if (inputChoice != 2) {
+    saveDetections(outputDirectory);
+  }
+  reportProfile(outputDirectory);
   return 1;
 }
 
+auto DetectionModule::processVideo(const std::string& filePath, \
+        const std::string& outputDirectory) -> bool {
+  {
+    /* The decoder threads started by the capture keep its CPUs */
+    ScopedPlacement placement(options.placement, kCaptureThreads);
+    videoFrames = cv::VideoCapture(filePath);
+  }
+  /* Check if the file entered by the user is correct */
+  if (!videoFrames.isOpened()) {
+    std::cout << "Error: Invalid video file" << std::endl;
+    return false;
+  }
+  /* A long job commits its progress regularly and can continue from the
+  last commit */
+  CheckpointState state;
+  VideoCheckpoint checkpoint;
+  size_t jobStart = finalDetections.size();
+  if (!options.checkpointFile.empty()) {
+    std::vector<Detection> committedDetections;
+    if (!checkpoint.open(options.checkpointFile, videoJobKey(filePath), \
+                         options.resume, state, committedDetections)) {
+      std::cout << "Warning: Can't write the checkpoint " \
+        << options.checkpointFile << ", the job is not checkpointed" \
+        << std::endl;
+    } else if (checkpoint.isResumed()) {
+      std::cout << "Resuming from frame " << state.nextFrameID << std::endl;
+      if (!seekFrame(filePath, state.nextFrameID)) {
+        std::cout << "Error: Can't seek to frame " << state.nextFrameID \
+          << std::endl;
+        return false;
+      }
+      finalDetections.insert(finalDetections.end(), \
+                             committedDetections.begin(), \
+                             committedDetections.end());
+    } else if (options.resume) {
+      std::cout << "No checkpoint of this video in " \
+        << options.checkpointFile << ", starting from the first frame" \
+        << std::endl;
+    }
+  }
+  /* Frames are encoded and written on other threads, in order. With
+  checkpoints, every commit starts a new segment of the video */
+  std::string videoPath = outputDirectory + "testVideoDetection.avi";
+  if (checkpoint.isOpen()) {
+    videoPath = videoSegmentPath(outputDirectory, state.segmentIndex);
+  }
+  if (!options.headless) {
+    ScopedPlacement placement(options.placement, kOutputThreads);
+    if (!videoWriter.open(videoPath, 15.0, network.getInputSize(), \
+                          options.writeQueue, options.encoderThreads)) {
+      std::cout << "Error: Can't write the output video" << std::endl;
+    }
+  }
+  /* Only one frame in frameStride is detected, the boxes of the others
+  are interpolated between the detected key frames */
+  int stride = std::max(options.frameStride, 1);
+  int firstFrameID = state.nextFrameID;
+  int frameID = firstFrameID;
+  int detectedFrames = 0;
+  int keyFrameID = state.keyFrameID;
+  int committedFrameID = frameID;
+  keyDetections.swap(state.keyDetections);
+  cv::Mat capturedImage;
+  cv::Mat image;
+  while (true) {
+    if (frameID % stride != 0) {
+      if (!skipFrame(frameID)) {
+        break;
+      }
+      frameID += 1;
+      continue;
+    }
+    /* Read frames and pass each frame as an image to the network */
+    if (!readFrame(capturedImage, frameID) || capturedImage.empty()) {
+      break;
+    }
+    size_t keyStart = finalDetections.size();
+    image = processFrame(capturedImage, frameID);
+    detectedFrames += 1;
+    if (keyFrameID >= 0 && frameID - keyFrameID > 1) {
+      interpolateFrames(keyFrameID, keyDetections, frameID, \
+                        frameDetections, keyStart);
+    }
+    keyFrameID = frameID;
+    keyDetections.assign(frameDetections.begin(), frameDetections.end());
+    if (videoWriter.isOpened()) {
+      ScopedStage stage(profiler, "write");
+      videoWriter.write(frameID, image);
+    }
+    frameID += 1;
+    if (checkpoint.isOpen() && \
+        frameID - committedFrameID >= options.checkpointInterval) {
+      ScopedStage stage(profiler, "checkpoint");
+      /* The segment is complete before the checkpoint counts it */
+      bool writing = videoWriter.isOpened();
+      videoWriter.close();
+      state.nextFrameID = frameID;
+      state.keyFrameID = keyFrameID;
+      state.keyDetections.assign(keyDetections.begin(), keyDetections.end());
+      state.segmentIndex += 1;
+      if (!checkpoint.commit(state, finalDetections.data() + jobStart, \
+                             finalDetections.size() - jobStart)) {
+        std::cout << "Warning: Can't write the checkpoint " \
+          << options.checkpointFile << std::endl;
+      }
+      committedFrameID = frameID;
+      if (writing) {
+        ScopedPlacement placement(options.placement, kOutputThreads);
+        videoWriter.open(videoSegmentPath(outputDirectory, \
+            state.segmentIndex), 15.0, network.getInputSize(), \
+            options.writeQueue, options.encoderThreads);
+      }
+    }
+  }
+  if (keyFrameID >= 0 && frameID - keyFrameID > 1) {
+    /* The boxes of the last key frame are held until the end */
+    interpolateFrames(keyFrameID, keyDetections, frameID, \
+                      keyDetections, finalDetections.size());
+  }
+  if (stride > 1) {
+    std::cout << "Detected " << detectedFrames << " of " \
+      << frameID - firstFrameID << " frames";
+    if (firstFrameID > 0) {
+      std::cout << " from frame " << firstFrameID;
+    }
+    std::cout << ", the boxes of the others are interpolated" << std::endl;
+  }
+  videoWriter.close();
+  reportVideoWriter();
+  if (!saveDetections(outputDirectory)) {
+    if (checkpoint.isOpen()) {
+      std::cout << "The job can be resumed from " << options.checkpointFile \
+        << std::endl;
+    }
+    return false;
+  }
+  /* The whole video is done and written, there is nothing left to
+  resume */
+  checkpoint.finish();
+  return true;
+}
+
+auto DetectionModule::seekFrame(const std::string& filePath, \
+                                int frameID) -> bool {
+  if (frameID == 0) {
+    return true;
+  }
+  if (videoFrames.set(cv::CAP_PROP_POS_FRAMES, frameID) && \
+      static_cast<int>(videoFrames.get(cv::CAP_PROP_POS_FRAMES)) == frameID) {
+    return true;
+  }
+  /* Not every container seeks to an exact frame, the frames before it are
+  grabbed instead, which is still much faster than detecting them */
+  {
+    ScopedPlacement placement(options.placement, kCaptureThreads);
+    videoFrames = cv::VideoCapture(filePath);
+  }
+  for (int i = 0; i < frameID; ++i) {
+    if (!videoFrames.grab()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto DetectionModule::videoSegmentPath(const std::string& outputDirectory, \
+                                       int segmentIndex) -> std::string {
+  std::ostringstream path;
+  path << outputDirectory << "testVideoDetection_" << std::setw(3) \
+    << std::setfill('0') << segmentIndex << ".avi";
+  return path.str();
+}
+
+auto DetectionModule::videoJobKey(const std::string& filePath) -> uint64_t {
+  std::ostringstream job;
+  job << describeSettings() << ";stride " << std::max(options.frameStride, 1) \
+    << ';' << filePath;
+  struct stat status;
+  if (stat(filePath.c_str(), &status) == 0) {
+    job << ';' << status.st_size << ';' << status.st_mtime;
+  }
+  std::string description = job.str();
+  return ResultCache::hash(description.data(), description.size(), 0);
+}
+
+auto DetectionModule::processSharedFrames(const std::string& ringName) \
+    -> bool {
+  FrameRing ring;
+  if (!ring.open(ringName)) {
+    return false;
+  }
+  char filterType = options.filterType;
+  /* Only the detections are kept, the frames are not shown */
+  drawing = false;
+  RingFrame ringFrame;
+  uint64_t processed = 0;
+  uint64_t overwritten = 0;
+  uint64_t reportedDrops = 0;
+  int frameID = 0;
+  while (true) {
+    FrameRing::ReadStatus status;
+    {
+      profiler.beginFrame(frameID);
+      ScopedStage stage(profiler, "capture");
+      status = ring.acquire(ringFrame, 1000);
+    }
+    if (status == FrameRing::kClosed) {
+      break;
+    } else if (status == FrameRing::kTimeout) {
+      if (!ring.writerAlive()) {
+        break;
+      }
+      continue;
+    }
+    frameID += 1;
+    if (busyDropsMetric != nullptr) {
+      busyDropsMetric->add(ring.droppedFrames() - reportedDrops);
+      reportedDrops = ring.droppedFrames();
+    }
+    ScopedStage stage(profiler, "frame");
+    /* The frame is read where it lies in the shared memory, the first
+    copy is the resized image made by the pre processing */
+    cv::Mat sharedImage(ringFrame.height, ringFrame.width, CV_8UC3, \
+        const_cast<unsigned char*>(ringFrame.pixels), ringFrame.step);
+    cv::Mat image;
+    if (options.zones.empty()) {
+      image = preProcessImage(sharedImage, filterType);
+    } else {
+      prepareZones(sharedImage, filterType);
+    }
+    if (!ring.release(ringFrame)) {
+      /* The writer reused the slot meanwhile, the image may be torn */
+      overwritten += 1;
+      if (tornDropsMetric != nullptr) {
+        tornDropsMetric->add();
+      }
+      continue;
+    }
+    if (!options.zones.empty()) {
+      detectZones(ringFrame.frameID);
+    } else if (detectObjects(image) != 0) {
+      postProcessImage(image, ringFrame.frameID);
+    }
+    processed += 1;
+  }
+  std::cout << "Shared memory: " << processed << " frames processed, " \
+    << ring.droppedFrames() << " skipped while busy, " << overwritten \
+    << " overwritten while read" << std::endl;
+  return true;
+}
+
+auto DetectionModule::processImageFile(const std::string& filePath, \
+        const std::string& outputPath, int frameID) -> bool {
+  cv::Mat image;
+  int decodeFactor = 1;
+  profiler.beginFrame(frameID);
+  {
+    ScopedStage stage(profiler, "capture");
+    image = imageLoader.load(filePath, decodeFactor);
+  }
+  if (!image.data) {
+    return false;
+  }
+  image = processFrame(image, frameID);
+  if (!options.headless) {
+    ScopedStage stage(profiler, "write");
+    cv::imwrite(outputPath, image);
+  }
+  return true;
+}
+
+auto DetectionModule::describeSettings() -> std::string {
+  std::ostringstream settings;
+  settings << network.describeModel() << ';' << confidenceThreshold << ';' \
+    << nmsThreshold << ';' << options.filterType << ';' \
+    << options.inputSize << ';' << options.reducedDecode;
+  for (const auto& zone : options.zones.getZones()) {
+    settings << ";zone";
+    for (const auto& corner : zone) {
+      settings << ' ' << corner.x << ',' << corner.y;
+    }
+  }
+  return settings.str();
+}
+
+auto DetectionModule::openCache() -> bool {
+  std::string description = describeSettings();
+  cacheFingerprint = ResultCache::hash(description.data(), \
+                                       description.size(), 0);
+  return resultCache.open(options.cacheFile, options.cacheEntries);
+}
+
+auto DetectionModule::processCachedImage(const std::string& filePath, \
+        const std::string& outputPath, int frameID) -> bool {
+  uint64_t key = 0;
+  if (!resultCache.isOpen() || \
+      !ResultCache::hashFile(filePath, cacheFingerprint, key)) {
+    return processImageFile(filePath, outputPath, frameID);
+  }
+  /* A hit skips the decoding and the network, unless the annotated image
+  has to be made again */
+  struct stat status;
+  if ((options.headless || stat(outputPath.c_str(), &status) == 0) && \
+      resultCache.find(key, cachedDetections)) {
+    for (auto& detection : cachedDetections) {
+      detection.frameID = frameID;
+    }
+    finalDetections.insert(finalDetections.end(), cachedDetections.begin(), \
+                           cachedDetections.end());
+    return true;
+  }
+  size_t first = finalDetections.size();
+  if (!processImageFile(filePath, outputPath, frameID)) {
+    return false;
+  }
+  resultCache.store(key, finalDetections.data() + first, \
+                    finalDetections.size() - first);
+  return true;
+}
+
+auto DetectionModule::convertStreamFrame(std::vector<unsigned char>& pixels, \
+        const FrameStreamReader& reader, cv::Mat& image) -> bool {
+  int width = reader.getWidth();
+  int height = reader.getHeight();
+  switch (reader.getFormat()) {
+    case FrameStreamReader::kBgr24:
+      image = cv::Mat(height, width, CV_8UC3, pixels.data());
+      return true;
+    case FrameStreamReader::kYuv420p:
+      if (width % 2 != 0 || height % 2 != 0) {
+        /* The U and V planes are interleaved as in NV12 */
+        int chromaWidth = (width + 1) / 2;
+        int chromaHeight = (height + 1) / 2;
+        unsigned char* planes = pixels.data() + width * height;
+        cv::Mat chroma[] = {
+            cv::Mat(chromaHeight, chromaWidth, CV_8UC1, planes), \
+            cv::Mat(chromaHeight, chromaWidth, CV_8UC1, \
+                    planes + chromaWidth * chromaHeight)};
+        cv::Mat interleaved;
+        cv::merge(chroma, 2, interleaved);
+        return convertTwoPlanes(cv::Mat(height, width, CV_8UC1, \
+                                        pixels.data()), interleaved, image);
+      }
+      cv::cvtColor(cv::Mat(height * 3 / 2, width, CV_8UC1, pixels.data()), \
+                   image, cv::COLOR_YUV2BGR_I420);
+      return true;
+    case FrameStreamReader::kNv12:
+      if (width % 2 != 0 || height % 2 != 0) {
+        return convertTwoPlanes(\
+            cv::Mat(height, width, CV_8UC1, pixels.data()), \
+            cv::Mat((height + 1) / 2, (width + 1) / 2, CV_8UC2, \
+                    pixels.data() + width * height), image);
+      }
+      cv::cvtColor(cv::Mat(height * 3 / 2, width, CV_8UC1, pixels.data()), \
+                   image, cv::COLOR_YUV2BGR_NV12);
+      return true;
+    case FrameStreamReader::kYuyv: {
+      /* Rows of an odd width end with a whole pair, whose second pixel
+      is dropped */
+      int pairedWidth = (width + 1) / 2 * 2;
+      cv::cvtColor(cv::Mat(height, pairedWidth, CV_8UC2, pixels.data()), \
+                   image, cv::COLOR_YUV2BGR_YUYV);
+      if (pairedWidth != width) {
+        image = image.colRange(0, width);
+      }
+      return true;
+    }
+    case FrameStreamReader::kGray:
+      cv::cvtColor(cv::Mat(height, width, CV_8UC1, pixels.data()), image, \
+                   cv::COLOR_GRAY2BGR);
+      return true;
+    default:
+      return false;
+  }
+}
+
+auto DetectionModule::processStream(const std::string& path) -> bool {
+  FrameStreamReader reader;
+  FrameStreamReader::PixelFormat rawFormat = FrameStreamReader::kUnknown;
+  if (!options.rawFormat.empty()) {
+    rawFormat = FrameStreamReader::parseFormat(options.rawFormat);
+    if (rawFormat == FrameStreamReader::kUnknown) {
+      std::cerr << "Error: Unknown raw format " << options.rawFormat \
+        << std::endl;
+      return false;
+    }
+  }
+  if (!reader.open(path, rawFormat, options.rawWidth, options.rawHeight)) {
+    std::cerr << "Error: Can't read a Y4M or raw stream from " << path \
+      << (rawFormat != FrameStreamReader::kUnknown && options.rawWidth == 0 \
+          ? " (--raw-size is missing)" : "");
+    if (!reader.getError().empty()) {
+      std::cerr << " (" << reader.getError() << ")";
+    }
+    std::cerr << std::endl;
+    return false;
+  }
+  std::vector<unsigned char> pixels;
+  cv::Mat image;
+  YuvImage yuvImage;
+  bool direct = false;
+  int frameID = 0;
+  while (true) {
+    {
+      profiler.beginFrame(frameID);
+      ScopedStage stage(profiler, "capture");
+      if (!reader.readFrame(pixels)) {
+        break;
+      }
+      /* YUV frames go straight into the network, the others and the
+      frames cropped to zones are converted to BGR first */
+      direct = options.zones.empty() && \
+               describeYuvFrame(pixels, reader, yuvImage);
+      if (!direct && !convertStreamFrame(pixels, reader, image)) {
+        std::cerr << "Error: Can't convert the frames of the stream" \
+          << std::endl;
+        return false;
+      }
+    }
+    std::vector<Detection> detections = direct ? \
+        detectYuv(yuvImage, frameID) : detect(image, frameID);
+    ScopedStage stage(profiler, "write");
+    io.streamDetections(frameID, detections);
+    frameID += 1;
+  }
+  if (reader.isTruncated()) {
+    std::cerr << "Warning: The stream ends in the middle of a frame" \
+      << std::endl;
+  }
+  std::cerr << "Processed " << frameID << " frames of " \
+    << reader.getWidth() << "x" << reader.getHeight() << std::endl;
+  if (profiler.isEnabled()) {
+    profiler.printSummary(std::cerr);
+  }
+  return true;
+}
+
+auto DetectionModule::readFrame(cv::Mat& image, int frameID) -> bool {
+  profiler.beginFrame(frameID);
+  ScopedStage stage(profiler, "capture");
+  return videoFrames.read(image);
+}
+
+auto DetectionModule::skipFrame(int frameID) -> bool {
+  profiler.beginFrame(frameID);
+  ScopedStage stage(profiler, "capture");
+  return videoFrames.grab();
+}
+
+auto DetectionModule::interpolateFrames(int firstID, \
+        const std::vector<Detection>& first, int lastID, \
+        const std::vector<Detection>& last, size_t position) -> void {
+  ScopedStage stage(profiler, "interpolate");
+  interpolator.setKeyFrames(firstID, first, lastID, last);
+  interpolatedDetections.clear();
+  for (int frameID = firstID + 1; frameID < lastID; ++frameID) {
+    interpolator.interpolate(frameID, interpolatedDetections);
+  }
+  transformDetections(interpolatedDetections);
+  /* Before the detections of the last key frame, in frame order */
+  finalDetections.insert(finalDetections.begin() + position, \
+                         interpolatedDetections.begin(), \
+                         interpolatedDetections.end());
+}
+
+auto DetectionModule::processFrame(cv::Mat image, int frameID) -> cv::Mat {
+  char filterType = options.filterType;
+  frameDetections.clear();
+  ScopedStage stage(profiler, "frame");
+  if (!options.zones.empty()) {
+    prepareZones(image, filterType);
+    return detectZones(frameID);
+  }
+  image = preProcessImage(image, filterType);
+  int flag = detectObjects(image);
+  if (flag != 0) {
+    image = postProcessImage(image, frameID);
+  }
+  return image;
+}
+
+auto DetectionModule::prepareZones(const cv::Mat& image, \
+                                   char filterType) -> void {
+  ScopedStage stage(profiler, "zones");
+  zoneFrameSize = image.size();
+  options.zones.getRegions(zoneFrameSize, options.maxBatch, zoneRegions);
+  /* Every region is pre processed as an image of its own, in buffers
+  reused from frame to frame */
+  batchImages.resize(zoneRegions.size());
+  for (size_t i = 0; i < zoneRegions.size(); ++i) {
+    preProcessImage(image(zoneRegions[i]), filterType).copyTo(batchImages[i]);
+  }
+  cv::Size size = network.getInputSize();
+  zoneImage = arena.mat(FrameArena::kOverviewImage, size, image.type());
+  VisionModule::reshape(image, size, zoneImage);
+}
+
+auto DetectionModule::detectZones(int frameID) -> cv::Mat {
+  arena.clear();
+  int batchSize = static_cast<int>(zoneRegions.size());
+  int flag = 0;
+  if (batchSize > 0) {
+    ScopedStage stage(profiler, "createNetworkInput");
+    flag = network.createNetworkInput(batchImages);
+  }
+  if (flag != 0 && runNetwork() != 0) {
+    ScopedStage stage(profiler, "decode");
+    for (int i = 0; i < batchSize; ++i) {
+      const cv::Rect& region = zoneRegions[i];
+      Network::splitBatchOutput(detectedObjects, batchSize, i, zoneOutput);
+      decodeNetworkOutput(zoneOutput, region.size(), zoneBoxes, zoneScores, \
+                          zoneClassIds);
+      for (size_t j = 0; j < zoneBoxes.size(); ++j) {
+        /* Back to the coordinates of the full frame */
+        cv::Rect box = zoneBoxes[j];
+        box.x += region.x;
+        box.y += region.y;
+        if (options.zones.contains(box)) {
+          arena.predictedBoxes().push_back(box);
+          arena.confidenceScores().push_back(zoneScores[j]);
+          arena.classIds().push_back(zoneClassIds[j]);
+        }
+      }
+    }
+  }
+  std::vector<Detection>& detections = arena.detections();
+  {
+    ScopedStage stage(profiler, "nms");
+    VisionModule::nonMaximalSuppression(zoneFrameSize, frameID, \
+                arena.predictedBoxes(), arena.confidenceScores(), \
+                arena.classIds(), detections);
+    /* Detections are given at the network size, as without zones */
+    for (auto& detection : detections) {
+      detection.x1 = detection.x1 * zoneImage.cols / zoneFrameSize.width;
+      detection.y1 = detection.y1 * zoneImage.rows / zoneFrameSize.height;
+      detection.x2 = detection.x2 * zoneImage.cols / zoneFrameSize.width;
+      detection.y2 = detection.y2 * zoneImage.rows / zoneFrameSize.height;
+    }
+  }
+  const auto& zones = options.zones.getZones();
+  zoneOutlines.resize(zones.size());
+  for (size_t i = 0; i < zones.size(); ++i) {
+    zoneOutlines[i].resize(zones[i].size());
+    for (size_t j = 0; j < zones[i].size(); ++j) {
+      zoneOutlines[i][j] = cv::Point(\
+          zones[i][j].x * zoneImage.cols / zoneFrameSize.width, \
+          zones[i][j].y * zoneImage.rows / zoneFrameSize.height);
+    }
+  }
+  frameDetections.assign(detections.begin(), detections.end());
+  if (drawing) {
+    ScopedStage stage(profiler, "draw");
+    cv::polylines(zoneImage, zoneOutlines, true, cv::Scalar(255, 170, 0));
+    VisionModule::drawDetections(zoneImage, detections);
+  }
+  storeDetections(detections);
+  return zoneImage;
+}
+
+auto DetectionModule::detect(const cv::Mat& image, \
+                             int frameID) -> std::vector<Detection> {
+  /* Detections accumulated by getFrame or processFrame are kept */
+  size_t first = finalDetections.size();
+  /* Only the detections are returned, so nothing is drawn */
+  bool wasDrawing = drawing;
+  drawing = false;
+  processFrame(image, frameID);
+  drawing = wasDrawing;
+  std::vector<Detection> detections(finalDetections.begin() + first, \
+                                    finalDetections.end());
+  finalDetections.resize(first);
+  return detections;
+}
+
+auto DetectionModule::detectYuv(const YuvImage& image, \
+                                int frameID) -> std::vector<Detection> {
+  std::vector<Detection> detections;
+  ScopedStage stage(profiler, "frame");
+  {
+    ScopedStage inputStage(profiler, "createNetworkInput");
+    if (network.createNetworkInput(image) == 0) {
+      return detections;
+    }
+  }
+  char filterType = options.filterType;
+  if (filterType == 'G' || filterType == 'M' || filterType == 'B') {
+    /* The same filter as preProcessImage, applied to the planes of the
+    blob since there is no BGR image to filter */
+    ScopedStage filterStage(profiler, "preProcessImage");
+    network.getInputPlanes(inputPlanes);
+    for (auto& plane : inputPlanes) {
+      if (filterType == 'G') {
+        VisionModule::applyGaussianFilter(plane, cv::Size(3, 3), 0, plane);
+      } else if (filterType == 'B') {
+        VisionModule::applyFilter(plane, cv::Size(3, 3), plane);
+      } else {
+        /* The median doesn't filter in place */
+        cv::Mat& filteredPlane = arena.mat(FrameArena::kFilteredImage, \
+                                           plane.size(), plane.type());
+        VisionModule::applyMedianFilter(plane, 3, filteredPlane);
+        filteredPlane.copyTo(plane);
+      }
+    }
+  }
+  if (runNetwork() == 0) {
+    return detections;
+  }
+  size_t first = finalDetections.size();
+  storeDetections(suppressDetections(network.getInputSize(), frameID));
+  detections.assign(finalDetections.begin() + first, finalDetections.end());
+  finalDetections.resize(first);
+  return detections;
+}
+
+auto DetectionModule::detectBatch(const std::vector<cv::Mat>& images, \
+        const std::vector<int>& frameIDs, \
+        std::vector<std::vector<Detection>>& detections) -> void {
+  detections.resize(images.size());
+  if (images.size() == 1 || !options.zones.empty()) {
+    /* With zones, the regions of every image already make a batch */
+    for (size_t i = 0; i < images.size(); ++i) {
+      detections[i] = detect(images[i], frameIDs[i]);
+    }
+    return;
+  }
+  char filterType = options.filterType;
+  int batchSize = static_cast<int>(images.size());
+  ScopedStage stage(profiler, "batch");
+  /* The pre processed images are kept for the whole batch, in buffers
+   * reused from batch to batch */
+  batchImages.resize(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    preProcessImage(images[i], filterType).copyTo(batchImages[i]);
+  }
+  std::vector<cv::Mat> batchOutput;
+  {
+    ScopedStage inputStage(profiler, "createNetworkInput");
+    if (network.createNetworkInput(batchImages) == 0) {
+      for (auto& imageDetections : detections) {
+        imageDetections.clear();
+      }
+      return;
+    }
+  }
+  {
+    ScopedStage forwardStage(profiler, "forward");
+    network.applyYOLONetwork(batchOutput);
+  }
+  bool wasDrawing = drawing;
+  drawing = false;
+  for (int i = 0; i < batchSize; ++i) {
+    Network::splitBatchOutput(batchOutput, batchSize, i, detectedObjects);
+    size_t first = finalDetections.size();
+    postProcessImage(batchImages[i], frameIDs[i]);
+    detections[i].assign(finalDetections.begin() + first, \
+                         finalDetections.end());
+    finalDetections.resize(first);
+  }
+  drawing = wasDrawing;
+}
+
+auto DetectionModule::warmUp() -> void {
+  detect(cv::Mat::zeros(network.getInputSize(), CV_8UC3), 0);
+}
+
+auto DetectionModule::reportProfile(std::string outputDirectory) -> void {
+  if (!profiler.isEnabled()) {
+    return;
+  }
+  profiler.printSummary(std::cout);
+  std::string tracePath = outputDirectory + "trace.json";
+  if (profiler.exportChromeTrace(tracePath)) {
+    std::cout << "Trace of the run is stored in " << tracePath << std::endl;
+  } else {
+    std::cout << "Can't write the trace file " << tracePath << std::endl;
+  }
+}
+
+auto DetectionModule::saveDetections(const std::string& outputDirectory) \
+    -> bool {
+  if (options.deltaOutput) {
+    return io.saveDeltaOutput(finalDetections, outputDirectory, \
+                              options.deltaKeyframes, options.deltaTolerance);
+  }
+  return io.saveOutput(finalDetections, outputDirectory);
+}
+
+auto DetectionModule::reportVideoWriter() -> void {
+  VideoWriterStats stats = videoWriter.getStats();
+  if (stats.framesFailed > 0) {
+    std::cout << "Error: " << stats.framesFailed << " frames could not be " \
+      << "written to the output video" << std::endl;
+  }
+  if (stats.files > 1) {
+    std::cout << "The output video is split in " << stats.files \
+      << " files of at most 1 GB" << std::endl;
+  }
+  if (!profiler.isEnabled()) {
+    return;
+  }
+  std::cout << "Video writer: " << stats.framesWritten << " frames written, " \
+    << "encoding took " << stats.encodeMs << " ms, detection waited " \
+    << stats.blockedWrites << " times for " << stats.blockedMs \
+    << " ms, at most " << stats.maxQueueDepth << " frames queued" \
+    << std::endl;
+}
+
+auto DetectionModule::reportRenderer(const RendererStats& stats) -> void {
+  if (!profiler.isEnabled()) {
+    return;
+  }
+  std::cout << "Renderer: " << stats.framesShown << " of " \
+    << stats.framesSubmitted << " frames shown, " << stats.framesSkipped \
+    << " replaced by a newer frame first" << std::endl;
+}
+
+auto DetectionModule::reserveDetections(size_t count) -> void {
+  finalDetections.reserve(count);
+}
+
+auto DetectionModule::takeDetections() -> std::vector<Detection> {
+  std::vector<Detection> detections;
+  detections.swap(finalDetections);
+  return detections;
+}
+
+auto DetectionModule::getFrameDetections() const \
+        -> const std::vector<Detection>& {
+  return frameDetections;
+}
+
+auto DetectionModule::setOptions(const RunOptions& runOptions) -> void {
+  options = runOptions;
+  profiler.setEnabled(options.profile);
+  profiler.setCountersEnabled(options.perfCounters);
+  imageLoader.setReducedDecode(options.reducedDecode);
+  imageLoader.setCalibrationInterval(options.decodeCalibration);
+  confidenceThreshold = options.confidenceThreshold;
+  nmsThreshold = options.nmsThreshold;
+  VisionModule::setThresholds(confidenceThreshold, nmsThreshold);
+  network.setThresholds(confidenceThreshold, nmsThreshold);
+  if (!options.modelConfiguration.empty()) {
+    network.setModelFiles(options.modelConfiguration, options.modelWeights);
+  }
+  cv::Size inputSize(options.inputSize, options.inputSize);
+  network.setInputSize(inputSize);
+  imageLoader.setTargetSize(inputSize);
+  /* The three YOLO layers have one cell per 32, 16 and 8 pixels */
+  int cells = options.inputSize / 32;
+  arena.reserve(3 * (cells * cells) * (1 + 4 + 16));
+}
+
+auto DetectionModule::getProfiler() -> Profiler& {
+  return profiler;
+}
+
+auto DetectionModule::getArena() -> FrameArena& {
+  return arena;
+}
+
+auto DetectionModule::getNetwork() -> Network& {
+  return network;
+}
+
+auto DetectionModule::setMetrics(MetricsRegistry* registry) -> void {
+  if (metrics != nullptr) {
+    metrics->removeSamples(this);
+  }
+  metrics = registry;
+  profiler.setMetrics(registry);
+  if (registry == nullptr) {
+    framesMetric = nullptr;
+    detectionsMetric = nullptr;
+    frameDetectionsMetric = nullptr;
+    displayDropsMetric = nullptr;
+    busyDropsMetric = nullptr;
+    tornDropsMetric = nullptr;
+    return;
+  }
+  framesMetric = &registry->counter("hodm_frames_processed_total", \
+      "Frames through the detection.");
+  detectionsMetric = &registry->counter("hodm_detections_total", \
+      "Persons detected.");
+  frameDetectionsMetric = &registry->gauge("hodm_frame_detections", \
+      "Persons detected in the last frame.");
+  std::string dropsHelp = "Frames dropped, by reason.";
+  displayDropsMetric = &registry->counter("hodm_frames_dropped_total", \
+      dropsHelp, {{"reason", "display"}});
+  busyDropsMetric = &registry->counter("hodm_frames_dropped_total", \
+      dropsHelp, {{"reason", "ring_busy"}});
+  tornDropsMetric = &registry->counter("hodm_frames_dropped_total", \
+      dropsHelp, {{"reason", "ring_overwritten"}});
+  /* Read when the registry is scraped, the writer keeps its own counts */
+  registry->sample(MetricsRegistry::kGauge, \
+      "hodm_video_writer_queue_depth", \
+      "Frames waiting to be written to the output video.", \
+      MetricsRegistry::Labels(), [this]() {
+        VideoWriterStats stats = videoWriter.getStats();
+        return static_cast<double>(stats.framesSubmitted - \
+                                   stats.framesWritten);
+      }, this);
+}
+
 auto DetectionModule::getInput() -> void {
-  inputChoice = io.getInputChoice();
   std::string filePath, outputDirectory;
-  int cameraID;
+  int cameraID = -1;
   /* Take the input about the file according to the inputChoice */
-  if (inputChoice == 1 || inputChoice == 2) {
-    filePath = io.getInputFilePath();
+  if (!options.sharedMemoryRing.empty()) {
+    /* Frames come from another process, only the output is asked for */
+    inputChoice = 4;
+    filePath = options.sharedMemoryRing;
   } else {
-    cameraID = io.getDeviceID();
+    inputChoice = io.getInputChoice();
+    if (inputChoice == 1 || inputChoice == 2) {
+      filePath = io.getInputFilePath();
+    } else {
+      cameraID = io.getDeviceID();
+    }
   }
   outputDirectory = io.getOutputFilePath();
   int exitStatus = getFrame(filePath, cameraID, outputDirectory, inputChoice);
@@ -132,104 +1086,183 @@ auto DetectionModule::getInput() -> void {
 
 auto DetectionModule::preProcessImage(cv::Mat image, \
                                       char filterType) -> cv::Mat {
+  ScopedStage stage(profiler, "preProcessImage");
   /* Sixe of the image after reshaping */
-  cv::Size size(416, 416);
-  image = VisionModule::reshape(image, size);
+  cv::Size size = network.getInputSize();
+  cv::Mat& resizedImage = arena.mat(FrameArena::kResizedImage, size, \
+                                    image.type());
+  VisionModule::reshape(image, size, resizedImage);
+  if (filterType != 'G' && filterType != 'M' && filterType != 'B') {
+    return resizedImage;
+  }
+  cv::Mat& filteredImage = arena.mat(FrameArena::kFilteredImage, size, \
+                                     image.type());
+  /* 3x3 kernels specialized for 8 bit pixels, OpenCV filtering the other
+   * pixel types */
   if (filterType == 'G') {
-    /* The kernel dimension for gaussian filter */
-    cv::Size kernelDim(3, 3);
-    float sigma = 0;
-    image = VisionModule::applyGaussianFilter(image, kernelDim, sigma);
+    if (!VisionModule::smooth<GaussianKernel<3, uint8_t>>(resizedImage, \
+                                                         filteredImage)) {
+      /* The kernel dimension for gaussian filter */
+      cv::Size kernelDim(3, 3);
+      float sigma = 0;
+      VisionModule::applyGaussianFilter(resizedImage, kernelDim, sigma, \
+                                        filteredImage);
+    }
   } else if (filterType == 'M') {
-    /* The kernel dimension for median filter */
-    int kernelDim = 3;
-    image = VisionModule::applyMedianFilter(image, kernelDim);
-  } else if (filterType == 'B') {
-    /* The kernel dimension for standard/mean filter */
-    cv::Size kernelDim(3, 3);
-    image = VisionModule::applyFilter(image, kernelDim);
+    if (!VisionModule::smooth<MedianKernel<3, uint8_t>>(resizedImage, \
+                                                       filteredImage)) {
+      /* The kernel dimension for median filter */
+      int kernelDim = 3;
+      VisionModule::applyMedianFilter(resizedImage, kernelDim, \
+                                      filteredImage);
+    }
+  } else {
+    if (!VisionModule::smooth<BoxKernel<3, uint8_t>>(resizedImage, \
+                                                    filteredImage)) {
+      /* The kernel dimension for standard/mean filter */
+      cv::Size kernelDim(3, 3);
+      VisionModule::applyFilter(resizedImage, kernelDim, filteredImage);
+    }
   }
-  return image;
+  return filteredImage;
 }
 
 auto DetectionModule::detectObjects(cv::Mat image) -> int {
   /* Converts the image in consideration to blob */
-  int flag = network.createNetworkInput(image);
+  int flag;
+  {
+    ScopedStage stage(profiler, "createNetworkInput");
+    flag = network.createNetworkInput(image);
+  }
   if (flag == 1) {
-    detectedObjects = network.applyYOLONetwork();
-    /* Check if any objects are detected in the passed image or not */
-    if ((detectedObjects).size() == 0) {
-      return 0;
-    }
+    return runNetwork();
+  }
+  return 1;
+}
+
+auto DetectionModule::runNetwork() -> int {
+  Profiler::Clock::time_point forwardStart = Profiler::Clock::now();
+  {
+    ScopedStage stage(profiler, "forward");
+    network.applyYOLONetwork(detectedObjects);
+  }
+  if (profiler.isEnabled()) {
+    /* Per layer timings are laid out from the start of the forward pass */
+    std::vector<std::string> layerNames;
+    std::vector<double> layerTimes;
+    network.getLayerTimings(layerNames, layerTimes);
+    profiler.recordLayers(profiler.currentFrame(), forwardStart, \
+                          layerNames, layerTimes);
+  }
+  /* Check if any objects are detected in the passed image or not */
+  if ((detectedObjects).size() == 0) {
+    return 0;
   }
   return 1;
 }
 
 auto DetectionModule::postProcessImage(cv::Mat frame, int frameID) -> cv::Mat {
-  std::vector<int> classIds;
-  std::vector<float> confidenceScores;
-  std::vector<cv::Rect> predictedBoxes;
+  std::vector<Detection>& detections = suppressDetections(frame.size(), \
+                                                          frameID);
+  frameDetections.assign(detections.begin(), detections.end());
+  if (drawing) {
+    ScopedStage stage(profiler, "draw");
+    VisionModule::drawDetections(frame, detections);
+  }
+  storeDetections(detections);
+  return frame;
+}
+
+auto DetectionModule::suppressDetections(cv::Size frameSize, \
+        int frameID) -> std::vector<Detection>& {
+  arena.clear();
+  std::vector<Detection>& detections = arena.detections();
+  ScopedStage stage(profiler, "decode");
+  decodeNetworkOutput(detectedObjects, frameSize, arena.predictedBoxes(), \
+                      arena.confidenceScores(), arena.classIds());
+  stage.next("nms");
+  VisionModule::nonMaximalSuppression(frameSize, frameID, \
+              arena.predictedBoxes(), arena.confidenceScores(), \
+              arena.classIds(), detections);
+  return detections;
+}
+
+auto DetectionModule::storeDetections(\
+        std::vector<Detection>& detections) -> void {
+  ScopedStage stage(profiler, "transform");
+  if (framesMetric != nullptr) {
+    framesMetric->add();
+    detectionsMetric->add(detections.size());
+    frameDetectionsMetric->set(static_cast<double>(detections.size()));
+  }
+  transformDetections(detections);
+  finalDetections.insert(finalDetections.end(), detections.begin(), \
+                         detections.end());
+}
+
+auto DetectionModule::decodeNetworkOutput(\
+        const std::vector<cv::Mat>& networkOutput, cv::Size frameSize, \
+        std::vector<cv::Rect>& predictedBoxes, \
+        std::vector<float>& confidenceScores, \
+        std::vector<int>& classIds) -> void {
+  predictedBoxes.clear();
+  confidenceScores.clear();
+  classIds.clear();
   /* Iterate over all the bounding boxes prediced by the network */
-  for (auto objects : detectedObjects) {
-    float* object = reinterpret_cast<float*>(objects.data);
+  for (const auto& objects : networkOutput) {
+    const float* object = reinterpret_cast<const float*>(objects.data);
     for (int i = 0; i < objects.rows; ++i, object += objects.cols) {
-      cv::Mat predictedScores = objects.row(i).colRange(5, objects.cols);
-      cv::Point classId;
-      double confidence;
-      /* Find the global minimum and maximum in an array */
-      cv::minMaxLoc(predictedScores, 0, &confidence, 0, &classId);
+      /* Best class score of the box, read in place */
+      int classId = 0;
+      float confidence = 0;
+      for (int j = 5; j < objects.cols; ++j) {
+        if (object[j] > confidence) {
+          confidence = object[j];
+          classId = j - 5;
+        }
+      }
       /* Checks if the bounding box's confidence score is greated then
       threshold or not and if yes then store it */
       if (confidence > confidenceThreshold) {
         int centerCoordinateX = static_cast<int>(object[0] * \
-                                                    frame.cols);
-        int centerCoordinateY = static_cast<int>(object[0] * \
-                                                    frame.rows);
+                                                    frameSize.width);
+        int centerCoordinateY = static_cast<int>(object[1] * \
+                                                    frameSize.height);
         int boxWidth = static_cast<int>(object[2] * \
-                                                    frame.cols);
+                                                    frameSize.width);
         int boxHeight = static_cast<int>(object[3] * \
-                                                    frame.rows);
+                                                    frameSize.height);
         int topLeftX = (centerCoordinateX - boxWidth/2);
         /* if calculated topLeftX is -ve then make it zero */
         if (topLeftX < 0) topLeftX = 0;
         int topLeftY = (centerCoordinateY - boxHeight/2);
         /* if calculated topLeftY is -ve then make it zero */
         if (topLeftY < 0) topLeftY = 0;
-        classIds.push_back(classId.x);
-        confidenceScores.push_back(static_cast<float>(confidence));
+        classIds.push_back(classId);
+        confidenceScores.push_back(confidence);
         predictedBoxes.push_back(cv::Rect(topLeftX, topLeftY, \
                                                 boxWidth, boxHeight));
       }
     }
   }
-  std::vector< std::vector <int> > Detections = \
-              VisionModule::nonMaximalSuppression(frame, \
-              predictedBoxes, confidenceScores, classIds, frameID);
-  /* Intrinsic Matrix for the transformation */
-  cv::Mat intrinsic = cv::Mat::eye(3, 3, CV_32F);
+}
+
+auto DetectionModule::transformDetections(\
+        std::vector<Detection>& detections) -> void {
   /* Iterates over each detection and get the detectons in robot's
   perspective frame */
-  for (auto values : Detections) {
-    cv::Mat coordinates = cv::Mat(2, 1, CV_32F, \
-        {static_cast<float>(values[1]), static_cast<float>(values[2])});
-    cv::Mat imagetoCamera = tf.imageToCamera(intrinsic, coordinates);
-    cv::Mat endtoBase = tf.endToBase(imagetoCamera);
-    cv::Mat cameratoImage = tf.cameraToImage(intrinsic, endtoBase);
-    int newx1 = cameratoImage.at<float>(0, 0);
-    int newy1 = cameratoImage.at<float>(1, 0);
-    cv::Mat coordinates1 = cv::Mat(2, 1, CV_32F, \
-        {static_cast<float>(values[3]), static_cast<float>(values[4])});
-    cv::Mat imagetoCamera1 = tf.imageToCamera(intrinsic, coordinates1);
-    cv::Mat endtoBase1 = tf.endToBase(imagetoCamera1);
-    cv::Mat cameratoImage1 = tf.cameraToImage(intrinsic, endtoBase1);
-    int newx2 = cameratoImage1.at<float>(0, 0);
-    int newy2 = cameratoImage1.at<float>(1, 0);
-    /* Storing the detections to temporary variable for next step */
-    std::vector <int> transformedDetections{values[0], newx1, newy1, \
-                                    newx2, newy2};
-    finalDetections.push_back(transformedDetections);
+  for (auto& detection : detections) {
+    cv::Point2f topLeft = tf.transformImagePoint(intrinsic, \
+        intrinsicInverse, cv::Point2f(detection.x1, detection.y1));
+    cv::Point2f bottomRight = tf.transformImagePoint(intrinsic, \
+        intrinsicInverse, cv::Point2f(detection.x2, detection.y2));
+    detection.x1 = static_cast<int32_t>(topLeft.x);
+    detection.y1 = static_cast<int32_t>(topLeft.y);
+    detection.x2 = static_cast<int32_t>(bottomRight.x);
+    detection.y2 = static_cast<int32_t>(bottomRight.y);
   }
-  return frame;
 }
+
 DetectionModule::~DetectionModule() {
+  setMetrics(nullptr);
 }
@@ -0,0 +1,213 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionProtocol.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition of the binary protocol of the detection server
+ */
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "DetectionProtocol.hpp"
+
+namespace protocol {
+
+namespace {
+/**
+ * @brief Stores a little endian 16 bit value
+ */
+void putUint16(unsigned char* bytes, uint16_t value) {
+  bytes[0] = static_cast<unsigned char>(value & 0xFF);
+  bytes[1] = static_cast<unsigned char>(value >> 8);
+}
+
+/**
+ * @brief Stores a little endian 32 bit value
+ */
+void putUint32(unsigned char* bytes, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    bytes[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+/**
+ * @brief Loads a little endian 16 bit value
+ */
+uint16_t getUint16(const unsigned char* bytes) {
+  return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+/**
+ * @brief Loads a little endian 32 bit value
+ */
+uint32_t getUint32(const unsigned char* bytes) {
+  return static_cast<uint32_t>(bytes[0]) | \
+         (static_cast<uint32_t>(bytes[1]) << 8) | \
+         (static_cast<uint32_t>(bytes[2]) << 16) | \
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+}  // namespace
+
+auto readExact(int fd, void* data, size_t size) -> bool {
+  unsigned char* bytes = static_cast<unsigned char*>(data);
+  while (size > 0) {
+    ssize_t count = read(fd, bytes, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+auto writeExact(int fd, const void* data, size_t size) -> bool {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  while (size > 0) {
+    /* A closed peer must not raise SIGPIPE */
+    ssize_t count = send(fd, bytes, size, MSG_NOSIGNAL);
+    if (count < 0 && errno == ENOTSOCK) {
+      count = write(fd, bytes, size);
+    }
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+auto writeRequest(int fd, const RequestHeader& header, \
+                  const void* payload) -> bool {
+  unsigned char bytes[kRequestHeaderSize];
+  putUint32(bytes, kMagic);
+  putUint16(bytes + 4, kVersion);
+  putUint16(bytes + 6, header.type);
+  putUint32(bytes + 8, header.requestID);
+  putUint32(bytes + 12, header.width);
+  putUint32(bytes + 16, header.height);
+  putUint32(bytes + 20, header.payloadSize);
+  return writeExact(fd, bytes, sizeof(bytes)) && \
+         writeExact(fd, payload, header.payloadSize);
+}
+
+auto readRequest(int fd, RequestHeader& header, \
+                 std::vector<unsigned char>& payload, bool& valid) -> bool {
+  valid = true;
+  unsigned char bytes[kRequestHeaderSize];
+  if (!readExact(fd, bytes, sizeof(bytes))) {
+    return false;
+  }
+  header.type = getUint16(bytes + 6);
+  header.requestID = getUint32(bytes + 8);
+  header.width = getUint32(bytes + 12);
+  header.height = getUint32(bytes + 16);
+  header.payloadSize = getUint32(bytes + 20);
+  if (getUint32(bytes) != kMagic || getUint16(bytes + 4) != kVersion || \
+      header.payloadSize > kMaxPayloadSize) {
+    valid = false;
+    return false;
+  }
+  payload.resize(header.payloadSize);
+  return readExact(fd, payload.data(), payload.size());
+}
+
+auto writeResponse(int fd, const ResponseHeader& header, \
+                   const std::vector<Detection>& detections) -> bool {
+  std::vector<unsigned char> bytes(kResponseHeaderSize + \
+                                   kDetectionSize * detections.size());
+  putUint32(bytes.data(), kMagic);
+  putUint16(bytes.data() + 4, kVersion);
+  putUint16(bytes.data() + 6, header.status);
+  putUint32(bytes.data() + 8, header.requestID);
+  putUint32(bytes.data() + 12, static_cast<uint32_t>(detections.size()));
+  unsigned char* record = bytes.data() + kResponseHeaderSize;
+  for (const auto& detection : detections) {
+    uint32_t score;
+    std::memcpy(&score, &detection.score, sizeof(score));
+    const uint32_t values[8] = {static_cast<uint32_t>(detection.frameID), \
+        static_cast<uint32_t>(detection.x1), \
+        static_cast<uint32_t>(detection.y1), \
+        static_cast<uint32_t>(detection.x2), \
+        static_cast<uint32_t>(detection.y2), score, \
+        static_cast<uint32_t>(detection.classId), \
+        static_cast<uint32_t>(detection.trackID)};
+    for (int i = 0; i < 8; ++i, record += 4) {
+      putUint32(record, values[i]);
+    }
+  }
+  return writeExact(fd, bytes.data(), bytes.size());
+}
+
+auto readResponse(int fd, ResponseHeader& header, \
+                  std::vector<Detection>& detections) -> bool {
+  unsigned char bytes[kResponseHeaderSize];
+  if (!readExact(fd, bytes, sizeof(bytes))) {
+    return false;
+  }
+  if (getUint32(bytes) != kMagic || getUint16(bytes + 4) != kVersion) {
+    return false;
+  }
+  header.status = getUint16(bytes + 6);
+  header.requestID = getUint32(bytes + 8);
+  header.count = getUint32(bytes + 12);
+  if (header.count > kMaxPayloadSize / kDetectionSize) {
+    return false;
+  }
+  std::vector<unsigned char> records(kDetectionSize * header.count);
+  if (!readExact(fd, records.data(), records.size())) {
+    return false;
+  }
+  detections.resize(header.count);
+  const unsigned char* record = records.data();
+  for (auto& detection : detections) {
+    detection.frameID = static_cast<int32_t>(getUint32(record));
+    detection.x1 = static_cast<int32_t>(getUint32(record + 4));
+    detection.y1 = static_cast<int32_t>(getUint32(record + 8));
+    detection.x2 = static_cast<int32_t>(getUint32(record + 12));
+    detection.y2 = static_cast<int32_t>(getUint32(record + 16));
+    uint32_t score = getUint32(record + 20);
+    std::memcpy(&detection.score, &score, sizeof(score));
+    detection.classId = static_cast<int32_t>(getUint32(record + 24));
+    detection.trackID = static_cast<int32_t>(getUint32(record + 28));
+    record += kDetectionSize;
+  }
+  return true;
+}
+
+}  // namespace protocol
@@ -0,0 +1,205 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionServer.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for DetectionServer class
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "DetectionServer.hpp"
+
+DetectionServer::DetectionServer(HandlerFactory factory, int workers) : \
+    handlerFactory(factory), workerCount(std::max(1, workers)), \
+    running(false) {
+}
+
+DetectionServer::~DetectionServer() {
+  stop();
+}
+
+auto DetectionServer::start(const std::string& socketPath) -> bool {
+  if (running) {
+    return false;
+  }
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::strncpy(address.sun_path, socketPath.c_str(), \
+               sizeof(address.sun_path) - 1);
+  listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listenFd < 0) {
+    return false;
+  }
+  unlink(socketPath.c_str());
+  if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), \
+           sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  path = socketPath;
+  stats = ServerStats();
+  running = true;
+  for (int i = 0; i < workerCount; ++i) {
+    workers.push_back(std::thread(&DetectionServer::serveConnections, this));
+  }
+  acceptor = std::thread(&DetectionServer::acceptConnections, this);
+  return true;
+}
+
+auto DetectionServer::stop() -> void {
+  if (!running) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+    /* Wake up the workers blocked reading from their clients */
+    for (int fd : activeConnections) {
+      shutdown(fd, SHUT_RDWR);
+    }
+  }
+  connectionQueued.notify_all();
+  acceptor.join();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+  for (int fd : pendingConnections) {
+    close(fd);
+  }
+  pendingConnections.clear();
+  close(listenFd);
+  listenFd = -1;
+  unlink(path.c_str());
+}
+
+auto DetectionServer::isRunning() const -> bool {
+  return running;
+}
+
+auto DetectionServer::getStats() -> ServerStats {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+auto DetectionServer::acceptConnections() -> void {
+  pollfd listening;
+  listening.fd = listenFd;
+  listening.events = POLLIN;
+  while (running) {
+    /* Wake up regularly to notice that the server stops */
+    int ready = poll(&listening, 1, 100);
+    if (ready <= 0) {
+      continue;
+    }
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+      close(fd);
+      break;
+    }
+    pendingConnections.push_back(fd);
+    stats.connections += 1;
+    connectionQueued.notify_one();
+  }
+}
+
+auto DetectionServer::serveConnections() -> void {
+  RequestHandler handler = handlerFactory();
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    connectionQueued.wait(lock, [this]() {
+      return !pendingConnections.empty() || !running;
+    });
+    if (!running) {
+      return;
+    }
+    int fd = pendingConnections.front();
+    pendingConnections.pop_front();
+    activeConnections.push_back(fd);
+    lock.unlock();
+    serveConnection(fd, handler);
+    lock.lock();
+    activeConnections.erase(std::find(activeConnections.begin(), \
+                                      activeConnections.end(), fd));
+    close(fd);
+  }
+}
+
+auto DetectionServer::serveConnection(int fd, \
+                                const RequestHandler& handler) -> void {
+  protocol::RequestHeader request;
+  std::vector<unsigned char> payload;
+  std::vector<Detection> detections;
+  bool valid = true;
+  while (protocol::readRequest(fd, request, payload, valid)) {
+    protocol::ResponseHeader response;
+    response.requestID = request.requestID;
+    detections.clear();
+    response.status = handler(request, payload, detections);
+    if (response.status != protocol::kOk) {
+      detections.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stats.requests += 1;
+      if (response.status != protocol::kOk) {
+        stats.failedRequests += 1;
+      }
+    }
+    if (!protocol::writeResponse(fd, response, detections)) {
+      return;
+    }
+  }
+  if (!valid) {
+    /* Tell the client why the connection is closed */
+    protocol::ResponseHeader response;
+    response.status = protocol::kBadRequest;
+    response.requestID = request.requestID;
+    detections.clear();
+    protocol::writeResponse(fd, response, detections);
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.requests += 1;
+    stats.failedRequests += 1;
+  }
+}
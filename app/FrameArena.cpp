@@ -0,0 +1,84 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameArena.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for FrameArena class
+ */
+
+#include "FrameArena.hpp"
+
+FrameArena::FrameArena() : mats(kMatSlotCount) {
+}
+
+FrameArena::~FrameArena() {
+}
+
+auto FrameArena::mat(MatSlot slot, cv::Size size, int type) -> cv::Mat& {
+  cv::Mat& image = mats[slot];
+  /* create() keeps the buffer when size and type are unchanged */
+  const uchar* previousData = image.data;
+  image.create(size, type);
+  if (image.data != previousData) {
+    allocationCount += 1;
+  }
+  return image;
+}
+
+auto FrameArena::predictedBoxes() -> std::vector<cv::Rect>& {
+  return boxes;
+}
+
+auto FrameArena::confidenceScores() -> std::vector<float>& {
+  return scores;
+}
+
+auto FrameArena::classIds() -> std::vector<int>& {
+  return classes;
+}
+
+auto FrameArena::detections() -> std::vector<Detection>& {
+  return frameDetections;
+}
+
+auto FrameArena::clear() -> void {
+  boxes.clear();
+  scores.clear();
+  classes.clear();
+  frameDetections.clear();
+}
+
+auto FrameArena::reserve(size_t count) -> void {
+  boxes.reserve(count);
+  scores.reserve(count);
+  classes.reserve(count);
+  frameDetections.reserve(count);
+}
+
+auto FrameArena::matAllocations() const -> uint64_t {
+  return allocationCount;
+}
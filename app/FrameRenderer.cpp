@@ -0,0 +1,162 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRenderer.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for FrameRenderer class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "FrameRenderer.hpp"
+
+namespace {
+/**
+ * @brief Shows the frames in the window of the application
+ */
+int showInWindow(const cv::Mat& image, int waitMs) {
+  if (!image.empty()) {
+    cv::imshow("Box", image);
+  }
+  return cv::waitKey(waitMs);
+}
+}  // namespace
+
+FrameRenderer::FrameRenderer() : FrameRenderer(showInWindow) {
+}
+
+FrameRenderer::FrameRenderer(ShowFunction showFunction) :
+    show(showFunction), escapePressed(false) {
+}
+
+FrameRenderer::~FrameRenderer() {
+  stop();
+}
+
+auto FrameRenderer::start(double maxFps) -> void {
+  stop();
+  int waitMs = static_cast<int>(std::lround(1000.0 / std::max(maxFps, 1.0)));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = true;
+    hasPending = false;
+    stats = RendererStats();
+  }
+  escapePressed = false;
+  renderer = std::thread(&FrameRenderer::renderFrames, this, \
+                         std::max(waitMs, 1));
+}
+
+auto FrameRenderer::stop() -> void {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+      return;
+    }
+    running = false;
+  }
+  frameReady.notify_all();
+  renderer.join();
+}
+
+auto FrameRenderer::isRunning() const -> bool {
+  std::lock_guard<std::mutex> lock(mutex);
+  return running;
+}
+
+auto FrameRenderer::submit(const cv::Mat& frame, \
+        const std::vector<Detection>& frameDetections, \
+        const std::vector<std::vector<cv::Point>>& frameOutlines) -> void {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+      return;
+    }
+    stats.framesSubmitted += 1;
+    if (hasPending) {
+      stats.framesSkipped += 1;
+    }
+    /* The buffers keep their size from frame to frame */
+    frame.copyTo(pendingImage);
+    pendingDetections.assign(frameDetections.begin(), frameDetections.end());
+    pendingOutlines = frameOutlines;
+    hasPending = true;
+  }
+  frameReady.notify_one();
+}
+
+auto FrameRenderer::closeRequested() const -> bool {
+  return escapePressed;
+}
+
+auto FrameRenderer::getStats() -> RendererStats {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+auto FrameRenderer::renderFrames(int waitMs) -> void {
+  bool windowShown = false;
+  while (true) {
+    bool hasFrame = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (!windowShown) {
+        /* There are no window events to handle before the first frame */
+        frameReady.wait(lock, [this] { return !running || hasPending; });
+      }
+      if (!running) {
+        break;
+      }
+      if (hasPending) {
+        cv::swap(image, pendingImage);
+        detections.swap(pendingDetections);
+        outlines.swap(pendingOutlines);
+        hasPending = false;
+        hasFrame = true;
+      }
+    }
+    if (hasFrame) {
+      if (!outlines.empty()) {
+        cv::polylines(image, outlines, true, cv::Scalar(255, 170, 0));
+      }
+      painter.drawDetections(image, detections);
+      windowShown = true;
+    }
+    /* Waiting for a key paces the frames shown */
+    int key = show(hasFrame ? image : cv::Mat(), waitMs);
+    if (hasFrame) {
+      std::lock_guard<std::mutex> lock(mutex);
+      stats.framesShown += 1;
+    }
+    if ((key & 0xff) == 27) {
+      escapePressed = true;
+    }
+  }
+}
@@ -0,0 +1,341 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRing.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for FrameRing class
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include "FrameRing.hpp"
+
+namespace {
+/* "HODR" read as a little endian value */
+const uint32_t kRingMagic = 0x52444F48;
+const uint32_t kRingVersion = 1;
+/* Slots and pixels start on cache lines */
+const size_t kAlignment = 64;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, \
+              "the ring needs lock free 64 bit atomics across processes");
+
+/**
+ * @brief Start of the shared memory, followed by the slots
+ */
+struct RingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slotCount;
+  uint32_t width;
+  uint32_t height;
+  uint32_t step;
+  uint64_t slotSize;
+  int32_t writerPid;
+  std::atomic<uint32_t> closed;
+  /* Number of frames published so far */
+  std::atomic<uint64_t> published;
+};
+
+/**
+ * @brief Start of a slot, followed by the pixels
+ */
+struct SlotHeader {
+  /* 2 * sequence + 1 while written, 2 * sequence + 2 once complete */
+  std::atomic<uint64_t> sequence;
+  int64_t timestampUs;
+  int32_t frameID;
+};
+
+size_t alignUp(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+const size_t kHeaderSize = alignUp(sizeof(RingHeader));
+const size_t kSlotHeaderSize = alignUp(sizeof(SlotHeader));
+
+std::string objectName(const std::string& name) {
+  return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+int64_t monotonicUs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+}  // namespace
+
+FrameRing::FrameRing() {
+}
+
+FrameRing::~FrameRing() {
+  close();
+}
+
+auto FrameRing::create(const std::string& name, uint32_t slotCount, \
+                       int width, int height) -> bool {
+  close();
+  if (slotCount < 2 || width <= 0 || height <= 0) {
+    return false;
+  }
+  ringName = objectName(name);
+  size_t step = static_cast<size_t>(width) * 3;
+  size_t slotSize = kSlotHeaderSize + alignUp(step * height);
+  size_t size = kHeaderSize + slotSize * slotCount;
+  shm_unlink(ringName.c_str());
+  int fd = shm_open(ringName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    ::close(fd);
+    shm_unlink(ringName.c_str());
+    return false;
+  }
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, \
+                       fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    shm_unlink(ringName.c_str());
+    return false;
+  }
+  mapping = static_cast<unsigned char*>(address);
+  mappingSize = size;
+  writer = true;
+  /* ftruncate zero fills, so every slot starts with sequence 0: empty */
+  for (uint32_t i = 0; i < slotCount; ++i) {
+    new (mapping + kHeaderSize + i * slotSize) SlotHeader();
+  }
+  RingHeader* header = new (mapping) RingHeader();
+  header->slotCount = slotCount;
+  header->width = static_cast<uint32_t>(width);
+  header->height = static_cast<uint32_t>(height);
+  header->step = static_cast<uint32_t>(step);
+  header->slotSize = slotSize;
+  header->writerPid = static_cast<int32_t>(getpid());
+  header->closed.store(0);
+  header->published.store(0);
+  header->version = kRingVersion;
+  /* Readers check the magic last, once the rest is set */
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kRingMagic;
+  return true;
+}
+
+auto FrameRing::open(const std::string& name) -> bool {
+  close();
+  ringName = objectName(name);
+  int fd = shm_open(ringName.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || \
+      static_cast<size_t>(status.st_size) < kHeaderSize) {
+    ::close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(status.st_size);
+  void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    return false;
+  }
+  mapping = static_cast<unsigned char*>(address);
+  mappingSize = size;
+  const RingHeader* header = reinterpret_cast<const RingHeader*>(mapping);
+  if (header->magic != kRingMagic || header->version != kRingVersion || \
+      kHeaderSize + header->slotSize * header->slotCount > size) {
+    close();
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  /* Start with the newest frame */
+  uint64_t published = header->published.load(std::memory_order_acquire);
+  nextSequence = published > 0 ? published - 1 : 0;
+  dropped = 0;
+  return true;
+}
+
+auto FrameRing::close() -> void {
+  if (mapping == nullptr) {
+    return;
+  }
+  if (writer) {
+    RingHeader* header = reinterpret_cast<RingHeader*>(mapping);
+    header->closed.store(1, std::memory_order_release);
+    shm_unlink(ringName.c_str());
+  }
+  munmap(mapping, mappingSize);
+  mapping = nullptr;
+  mappingSize = 0;
+  writer = false;
+}
+
+auto FrameRing::slot(uint64_t sequence) const -> unsigned char* {
+  const RingHeader* header = reinterpret_cast<const RingHeader*>(mapping);
+  return mapping + kHeaderSize + \
+         (sequence % header->slotCount) * header->slotSize;
+}
+
+auto FrameRing::beginWrite() -> unsigned char* {
+  if (mapping == nullptr || !writer) {
+    return nullptr;
+  }
+  RingHeader* header = reinterpret_cast<RingHeader*>(mapping);
+  uint64_t sequence = header->published.load(std::memory_order_relaxed);
+  unsigned char* start = slot(sequence);
+  SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(start);
+  slotHeader->sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+  /* Readers must see the odd sequence before any pixel changes */
+  std::atomic_thread_fence(std::memory_order_release);
+  return start + kSlotHeaderSize;
+}
+
+auto FrameRing::commitWrite(int frameID) -> void {
+  if (mapping == nullptr || !writer) {
+    return;
+  }
+  RingHeader* header = reinterpret_cast<RingHeader*>(mapping);
+  uint64_t sequence = header->published.load(std::memory_order_relaxed);
+  SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(slot(sequence));
+  slotHeader->frameID = frameID;
+  slotHeader->timestampUs = monotonicUs();
+  slotHeader->sequence.store(2 * sequence + 2, std::memory_order_release);
+  header->published.store(sequence + 1, std::memory_order_release);
+}
+
+auto FrameRing::write(const unsigned char* pixels, size_t step, \
+                      int frameID) -> bool {
+  unsigned char* destination = beginWrite();
+  if (destination == nullptr) {
+    return false;
+  }
+  size_t rowSize = static_cast<size_t>(width()) * 3;
+  for (int row = 0; row < height(); ++row) {
+    std::memcpy(destination + row * rowSize, pixels + row * step, rowSize);
+  }
+  commitWrite(frameID);
+  return true;
+}
+
+auto FrameRing::acquire(RingFrame& frame, int timeoutMs) -> ReadStatus {
+  const RingHeader* header = reinterpret_cast<const RingHeader*>(mapping);
+  if (header == nullptr) {
+    return kClosed;
+  }
+  int64_t deadline = monotonicUs() + static_cast<int64_t>(timeoutMs) * 1000;
+  while (true) {
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (nextSequence < published) {
+      /* The slot after the newest frame may be being rewritten, a reader
+       * that far behind jumps to the newest frame */
+      if (published - nextSequence >= header->slotCount) {
+        dropped += published - 1 - nextSequence;
+        nextSequence = published - 1;
+      }
+      uint64_t sequence = nextSequence;
+      const unsigned char* start = slot(sequence);
+      const SlotHeader* slotHeader = \
+          reinterpret_cast<const SlotHeader*>(start);
+      if (slotHeader->sequence.load(std::memory_order_acquire) == \
+          2 * sequence + 2) {
+        frame.pixels = start + kSlotHeaderSize;
+        frame.width = static_cast<int>(header->width);
+        frame.height = static_cast<int>(header->height);
+        frame.step = header->step;
+        frame.frameID = slotHeader->frameID;
+        frame.timestampUs = slotHeader->timestampUs;
+        frame.sequence = sequence;
+        nextSequence = sequence + 1;
+        return kFrame;
+      }
+      /* Overwritten in the meantime, look at the ring again */
+      continue;
+    }
+    if (header->closed.load(std::memory_order_acquire) != 0) {
+      return kClosed;
+    }
+    if (monotonicUs() >= deadline) {
+      return kTimeout;
+    }
+    usleep(100);
+  }
+}
+
+auto FrameRing::release(const RingFrame& frame) -> bool {
+  if (mapping == nullptr) {
+    return false;
+  }
+  /* The pixels must be read before the sequence is checked again */
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const SlotHeader* slotHeader = \
+      reinterpret_cast<const SlotHeader*>(slot(frame.sequence));
+  return slotHeader->sequence.load(std::memory_order_relaxed) == \
+         2 * frame.sequence + 2;
+}
+
+auto FrameRing::writerAlive() const -> bool {
+  if (mapping == nullptr) {
+    return false;
+  }
+  const RingHeader* header = reinterpret_cast<const RingHeader*>(mapping);
+  return kill(header->writerPid, 0) == 0 || errno == EPERM;
+}
+
+auto FrameRing::droppedFrames() const -> uint64_t {
+  return dropped;
+}
+
+auto FrameRing::width() const -> int {
+  return mapping == nullptr ? 0 : static_cast<int>(\
+      reinterpret_cast<const RingHeader*>(mapping)->width);
+}
+
+auto FrameRing::height() const -> int {
+  return mapping == nullptr ? 0 : static_cast<int>(\
+      reinterpret_cast<const RingHeader*>(mapping)->height);
+}
+
+auto FrameRing::slotCount() const -> uint32_t {
+  return mapping == nullptr ? 0 : \
+      reinterpret_cast<const RingHeader*>(mapping)->slotCount;
+}
+
+auto FrameRing::frameSize() const -> size_t {
+  return static_cast<size_t>(width()) * height() * 3;
+}
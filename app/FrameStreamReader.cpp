@@ -0,0 +1,309 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameStreamReader.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for FrameStreamReader class
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "FrameStreamReader.hpp"
+
+namespace {
+const char kY4mSignature[] = "YUV4MPEG2";
+/* Size of the read ahead buffer */
+const size_t kBufferSize = 64 * 1024;
+/* Longest header or FRAME line accepted */
+const size_t kMaxLineSize = 4096;
+}  // namespace
+
+FrameStreamReader::FrameStreamReader() : buffer(kBufferSize) {
+}
+
+FrameStreamReader::~FrameStreamReader() {
+  close();
+}
+
+auto FrameStreamReader::open(const std::string& path, \
+        PixelFormat rawFormat, int width, int height) -> bool {
+  close();
+  if (path == "-") {
+    return openDescriptor(STDIN_FILENO, rawFormat, width, height);
+  }
+  /* Opening a FIFO waits for its writer */
+  int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0) {
+    return false;
+  }
+  if (!openDescriptor(descriptor, rawFormat, width, height)) {
+    ::close(descriptor);
+    return false;
+  }
+  ownsDescriptor = true;
+  return true;
+}
+
+auto FrameStreamReader::openDescriptor(int descriptor, \
+        PixelFormat rawFormat, int width, int height) -> bool {
+  close();
+  fd = descriptor;
+  bufferStart = 0;
+  bufferEnd = 0;
+  truncated = false;
+  fps = 0;
+  error.clear();
+  if (rawFormat != kUnknown) {
+    y4m = false;
+    format = rawFormat;
+    this->width = width;
+    this->height = height;
+    if (width <= 0 || height <= 0) {
+      fd = -1;
+      return false;
+    }
+    return true;
+  }
+  y4m = true;
+  std::string header;
+  if (!readLine(header) || !parseY4mHeader(header)) {
+    fd = -1;
+    return false;
+  }
+  return true;
+}
+
+auto FrameStreamReader::close() -> void {
+  if (fd >= 0 && ownsDescriptor) {
+    ::close(fd);
+  }
+  fd = -1;
+  ownsDescriptor = false;
+}
+
+auto FrameStreamReader::parseY4mHeader(const std::string& header) -> bool {
+  std::istringstream fields(header);
+  std::string field;
+  fields >> field;
+  if (field != kY4mSignature) {
+    return false;
+  }
+  width = 0;
+  height = 0;
+  /* 4:2:0 is the default of Y4M */
+  format = kYuv420p;
+  while (fields >> field) {
+    const char* value = field.c_str() + 1;
+    switch (field[0]) {
+      case 'W':
+        width = std::atoi(value);
+        break;
+      case 'H':
+        height = std::atoi(value);
+        break;
+      case 'F': {
+        int numerator = 0, denominator = 0;
+        char separator = 0;
+        std::istringstream rate(value);
+        if (rate >> numerator >> separator >> denominator && \
+            separator == ':' && denominator > 0) {
+          fps = static_cast<double>(numerator) / denominator;
+        }
+        break;
+      }
+      case 'C':
+        /* 420, 420jpeg, 420mpeg2, 420paldv only differ by the chroma
+        siting, mono has no chroma. The others, like the more than 8 bit
+        420p10, have frames of another size */
+        if (std::strcmp(value, "420") == 0 || \
+            std::strcmp(value, "420jpeg") == 0 || \
+            std::strcmp(value, "420mpeg2") == 0 || \
+            std::strcmp(value, "420paldv") == 0) {
+          format = kYuv420p;
+        } else if (std::strcmp(value, "mono") == 0) {
+          format = kGray;
+        } else {
+          error = "unsupported Y4M colourspace " + field + \
+                  ", only 8 bit 4:2:0 and mono are read";
+          return false;
+        }
+        break;
+      case 'I':
+        /* Interlaced frames are read as progressive ones */
+        break;
+      default:
+        /* Aspect ratio, comments and extensions are ignored */
+        break;
+    }
+  }
+  return width > 0 && height > 0;
+}
+
+auto FrameStreamReader::readFrame(std::vector<unsigned char>& frame) \
+    -> bool {
+  if (fd < 0) {
+    return false;
+  }
+  if (y4m) {
+    std::string line;
+    if (!readLine(line)) {
+      return false;
+    }
+    if (line.compare(0, 5, "FRAME") != 0) {
+      /* Lost the frame boundaries, stop rather than read garbage */
+      truncated = true;
+      return false;
+    }
+  }
+  frame.resize(frameSize(format, width, height));
+  if (frame.empty()) {
+    return false;
+  }
+  /* The first byte tells an end of stream apart from a cut frame */
+  if (!readExact(frame.data(), 1)) {
+    truncated = y4m;
+    return false;
+  }
+  if (!readExact(frame.data() + 1, frame.size() - 1)) {
+    truncated = true;
+    return false;
+  }
+  return true;
+}
+
+auto FrameStreamReader::readExact(unsigned char* data, size_t size) \
+    -> bool {
+  size_t buffered = std::min(size, bufferEnd - bufferStart);
+  std::memcpy(data, buffer.data() + bufferStart, buffered);
+  bufferStart += buffered;
+  data += buffered;
+  size -= buffered;
+  /* The rest of a large frame is read straight into it */
+  while (size > 0) {
+    ssize_t count = ::read(fd, data, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    data += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+auto FrameStreamReader::readLine(std::string& line) -> bool {
+  line.clear();
+  while (line.size() < kMaxLineSize) {
+    if (bufferStart == bufferEnd) {
+      ssize_t count = ::read(fd, buffer.data(), buffer.size());
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        return false;
+      }
+      bufferStart = 0;
+      bufferEnd = static_cast<size_t>(count);
+    }
+    unsigned char character = buffer[bufferStart++];
+    if (character == '\n') {
+      return true;
+    }
+    line.push_back(static_cast<char>(character));
+  }
+  return false;
+}
+
+auto FrameStreamReader::parseFormat(const std::string& name) \
+    -> PixelFormat {
+  if (name == "bgr24") {
+    return kBgr24;
+  } else if (name == "yuv420p" || name == "i420") {
+    return kYuv420p;
+  } else if (name == "gray") {
+    return kGray;
+  } else if (name == "nv12") {
+    return kNv12;
+  } else if (name == "yuyv422" || name == "yuyv") {
+    return kYuyv;
+  }
+  return kUnknown;
+}
+
+auto FrameStreamReader::frameSize(PixelFormat format, int width, \
+                                  int height) -> size_t {
+  size_t pixels = static_cast<size_t>(width) * height;
+  switch (format) {
+    case kBgr24:
+      return pixels * 3;
+    case kYuv420p:
+    case kNv12:
+      /* Chroma planes round odd sizes up */
+      return pixels + 2 * static_cast<size_t>((width + 1) / 2) * \
+             ((height + 1) / 2);
+    case kGray:
+      return pixels;
+    case kYuyv:
+      /* Every pair of pixels takes four bytes */
+      return 4 * static_cast<size_t>((width + 1) / 2) * height;
+    default:
+      return 0;
+  }
+}
+
+auto FrameStreamReader::getFormat() const -> PixelFormat {
+  return format;
+}
+
+auto FrameStreamReader::getWidth() const -> int {
+  return width;
+}
+
+auto FrameStreamReader::getHeight() const -> int {
+  return height;
+}
+
+auto FrameStreamReader::getFps() const -> double {
+  return fps;
+}
+
+auto FrameStreamReader::isTruncated() const -> bool {
+  return truncated;
+}
+
+auto FrameStreamReader::getError() const -> const std::string& {
+  return error;
+}
@@ -30,10 +30,92 @@
  * @brief     Definition for IOHandler class 
  */
 
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
 
+#include "DetectionDelta.hpp"
 #include "IOHandler.hpp"
 
+namespace {
+/**
+ * @brief Parses the integer value of an option
+ *
+ * @param text Text of the value
+ * @param minimum Smallest valid value
+ * @param value Filled with the value if it is valid
+ *
+ * @return true if the text is an integer not smaller than minimum
+ */
+bool parseInteger(const char* text, int minimum, int& value) {
+  char* end = nullptr;
+  long parsed = std::strtol(text, &end, 10);
+  if (end == text || *end != '\0' || parsed < minimum || parsed > 1000000) {
+    return false;
+  }
+  value = static_cast<int>(parsed);
+  return true;
+}
+
+/**
+ * @brief Parses a threshold between 0 and 1
+ *
+ * @param text Text of the value
+ * @param value Filled with the threshold if it is valid
+ *
+ * @return true if the text is a number between 0 and 1
+ */
+bool parseFraction(const char* text, float& value) {
+  char* end = nullptr;
+  float parsed = std::strtof(text, &end);
+  if (end == text || *end != '\0' || !(parsed >= 0 && parsed <= 1)) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+/**
+ * @brief Parses a size written as <width>x<height>
+ *
+ * @param text Text of the value
+ * @param width Filled with the width if the size is valid
+ * @param height Filled with the height if the size is valid
+ *
+ * @return true if both dimensions are positive integers
+ */
+bool parseSize(const char* text, int& width, int& height) {
+  std::string size(text);
+  size_t separator = size.find('x');
+  if (separator == std::string::npos) {
+    return false;
+  }
+  std::string widthText = size.substr(0, separator);
+  std::string heightText = size.substr(separator + 1);
+  return parseInteger(widthText.c_str(), 1, width) && \
+         parseInteger(heightText.c_str(), 1, height);
+}
+
+/**
+ * @brief Parses the noise filter of the pre processing
+ *
+ * @param text Text of the value
+ * @param filterType Filled with the filter if it is valid
+ *
+ * @return true for G, M or B
+ */
+bool parseFilter(const char* text, char& filterType) {
+  std::string filter(text);
+  if (filter != "G" && filter != "M" && filter != "B") {
+    return false;
+  }
+  filterType = filter[0];
+  return true;
+}
+}  // namespace
+
 IOHandler::IOHandler() : inputStream(std::cin),
     outputStream(std::cout) {}
 IOHandler::IOHandler(std::istream& input, std::ostream& output) :
@@ -97,8 +179,8 @@ auto IOHandler::getOutputFilePath() -> std::string {
   return directoryPath;
 }
 
-auto IOHandler::saveOutput(std::vector< std::vector<int> > finalDetections, \
-                            std::string outputDirectory) -> void {
+auto IOHandler::saveOutput(const std::vector<Detection>& finalDetections, \
+                            const std::string& outputDirectory) -> bool {
   std::ofstream textFile;
   /* Name appended to the outputDirectory */
   textFile.open(outputDirectory + "DetectionsFile.txt");
@@ -106,19 +188,366 @@ auto IOHandler::saveOutput(std::vector< std::vector<int> > finalDetections, \
   /* Loop to check write the detections in the desired directory. Also
   checks if the textfile path exists or not */
   if (textFile) {
-    for (auto detections : finalDetections) {
-      textFile << "FrameID: " << std::to_string(detections[0]) << " " \
-        << "ObjectID: " << std::to_string(counter) << " Box_Coordinates: " \
-        << std::to_string(detections[1]) << " " \
-        << std::to_string(detections[2]) << " " \
-        << std::to_string(detections[3]) << " " \
-        << std::to_string(detections[4]) << "\n";
+    textFile << std::fixed << std::setprecision(4);
+    for (const auto& detection : finalDetections) {
+      textFile << "FrameID: " << detection.frameID << " " \
+        << "ObjectID: " << counter << " Box_Coordinates: " \
+        << detection.x1 << " " << detection.y1 << " " \
+        << detection.x2 << " " << detection.y2 \
+        << " Score: " << detection.score;
+      if (detection.trackID != Detection::kNoTrack) {
+        textFile << " TrackID: " << detection.trackID;
+      }
+      textFile << "\n";
       counter += 1;
     }
     textFile.close();
-    std::cout << "Thank you for using the Human Detection Module." \
+    if (!textFile) {
+      outputStream << "Error: Can't write the detections" << std::endl;
+      return false;
+    }
+    outputStream << "Thank you for using the Human Detection Module." \
       << " Your outputs are stored in " << outputDirectory << std::endl;
-  } else {
-    std::cout << "Can't find the output directory!" << std::endl;
+    return true;
+  }
+  outputStream << "Can't find the output directory!" << std::endl;
+  return false;
+}
+
+auto IOHandler::saveDeltaOutput(const std::vector<Detection>& finalDetections, \
+        const std::string& outputDirectory, int keyframeInterval, \
+        int tolerance) -> bool {
+  std::ofstream textFile(outputDirectory + "DetectionsDelta.txt");
+  if (!textFile) {
+    outputStream << "Can't find the output directory!" << std::endl;
+    return false;
+  }
+  DeltaEncoder encoder(textFile, keyframeInterval, tolerance);
+  if (!encoder.encodeAll(finalDetections)) {
+    outputStream << "Error: The detections are not in frame order" \
+      << std::endl;
+    return false;
+  }
+  encoder.finish(finalDetections.empty() ? -1 : \
+                 finalDetections.back().frameID);
+  textFile.close();
+  if (!textFile) {
+    outputStream << "Error: Can't write the detections" << std::endl;
+    return false;
+  }
+  encoder.printReport(outputStream);
+  outputStream << "Thank you for using the Human Detection Module." \
+    << " Your outputs are stored in " << outputDirectory << std::endl;
+  return true;
+}
+
+auto IOHandler::streamDetections(int frameID, \
+        const std::vector<Detection>& detections) -> void {
+  std::ostringstream line;
+  line << std::fixed << std::setprecision(4);
+  line << "{\"frame\":" << frameID << ",\"detections\":[";
+  for (size_t i = 0; i < detections.size(); ++i) {
+    const Detection& detection = detections[i];
+    line << (i > 0 ? "," : "") << "{\"x1\":" << detection.x1 \
+      << ",\"y1\":" << detection.y1 << ",\"x2\":" << detection.x2 \
+      << ",\"y2\":" << detection.y2 << ",\"score\":" << detection.score;
+    if (detection.trackID != Detection::kNoTrack) {
+      line << ",\"track\":" << detection.trackID;
+    }
+    line << "}";
+  }
+  line << "]}\n";
+  outputStream << line.str() << std::flush;
+}
+
+auto IOHandler::printUsage(const std::string& applicationName) -> void {
+  outputStream << "Usage: " << applicationName << " [options]" << std::endl;
+  outputStream << "  --profile          record stage timings, print a " \
+    << "summary and write trace.json to the output directory" << std::endl;
+  outputStream << "  --counters         also count the cycles, instructions, " \
+    << "cache and branch misses of every stage (implies --profile)" \
+    << std::endl;
+  outputStream << "  --headless         don't draw, show or write annotated " \
+    << "frames, only save the detections" << std::endl;
+  outputStream << "  --display-fps <n>  show at most n camera frames per " \
+    << "second (default 25)" << std::endl;
+  outputStream << "  --stride <n>       detect one video frame in n and " \
+    << "interpolate the boxes of the others (default 1)" << std::endl;
+  outputStream << "  --checkpoint <file>  commit the progress of a video " \
+    << "to file" << std::endl;
+  outputStream << "  --checkpoint-every <n>  commit at most once every n " \
+    << "frames (default 1000)" << std::endl;
+  outputStream << "  --resume           continue the video from its " \
+    << "checkpoint" << std::endl;
+  outputStream << "  --delta            write only the changes of the " \
+    << "boxes between frames to DetectionsDelta.txt" << std::endl;
+  outputStream << "  --delta-keyframes <n>  write every box at least once " \
+    << "every n frames (default 300, implies --delta)" << std::endl;
+  outputStream << "  --delta-tolerance <n>  don't write boxes that moved " \
+    << "by at most n pixels (default 2, implies --delta)" << std::endl;
+  outputStream << "  --confidence <f>   smallest confidence of a detection " \
+    << "(default 0.9)" << std::endl;
+  outputStream << "  --nms <f>          largest overlap of two detections " \
+    << "(default 0.9)" << std::endl;
+  outputStream << "  --model <cfg> <weights>  Darknet model to detect with " \
+    << "(default ../modelFiles/yolov3.*)" << std::endl;
+  outputStream << "  --metrics-port <n> serve Prometheus metrics on " \
+    << "http://127.0.0.1:<n>/metrics" << std::endl;
+  outputStream << "  --metrics-file <file>  write the metrics to file every " \
+    << "--metrics-interval seconds (default 15)" << std::endl;
+  outputStream << "  --pin-capture <cpus>     run the capture and video " \
+    << "decoder threads on cpus, a list like 0-3,8" << std::endl;
+  outputStream << "  --pin-preprocess <cpus>  run the threads decoding the " \
+    << "server requests on cpus" << std::endl;
+  outputStream << "  --pin-inference <cpus>   run the network and the " \
+    << "OpenCV threads on cpus, split between the server workers" \
+    << std::endl;
+  outputStream << "  --pin-output <cpus>      run the video writer, display " \
+    << "and metrics threads on cpus" << std::endl;
+  outputStream << "  --encoders <n>     encode the output video with n " \
+    << "JPEG encoder threads (default 0, encoded by the writer thread)" \
+    << std::endl;
+  outputStream << "  --write-queue <n>  number of frames that can wait to " \
+    << "be written before detection blocks (default 8)" << std::endl;
+  outputStream << "  --full-decode      decode still images at full " \
+    << "resolution" << std::endl;
+  outputStream << "  --decode-calibration <n>  also decode one reduced " \
+    << "image in n at full resolution to estimate the time saved " \
+    << "(default 16, 0 to disable)" << std::endl;
+  outputStream << "  --serve <socket>   serve detections on a Unix domain " \
+    << "socket instead of asking for an input" << std::endl;
+  outputStream << "  --workers <n>      number of server workers, each " \
+    << "loading its own network (default 1)" << std::endl;
+  outputStream << "  --batch <n>        detect up to n frames of different " \
+    << "requests in one forward pass (default 1)" << std::endl;
+  outputStream << "  --batch-wait <ms>  longest time a frame waits for its " \
+    << "batch to fill (default 5)" << std::endl;
+  outputStream << "  --shm <name>       read the frames in place from the " \
+    << "shared memory ring of hodm-ringwriter" << std::endl;
+  outputStream << "  --stream <path>    read a Y4M or raw frame stream from " \
+    << "a FIFO or file (- for stdin) and write the detections of every " \
+    << "frame as JSON lines on stdout" << std::endl;
+  outputStream << "  --raw-format <f>   the stream holds raw bgr24, yuv420p, " \
+    << "nv12, yuyv422 or gray frames" << std::endl;
+  outputStream << "  --raw-size <W>x<H> size of the raw frames" << std::endl;
+  outputStream << "  --roi <file>       detect only in the rectangles and " \
+    << "polygons listed in the file" << std::endl;
+  outputStream << "  --threads <n>      threads of the OpenCV functions " \
+    << "and network layers (default 0, chosen by OpenCV)" << std::endl;
+  outputStream << "  --filter <G|M|B>   gaussian, median or box noise " \
+    << "filter of the pre processing (default G)" << std::endl;
+  outputStream << "  --input-size <n>   width and height of the network " \
+    << "input, a multiple of 32 (default 416)" << std::endl;
+  outputStream << "  --tuning <file>    read the options measured by " \
+    << "hodm-tune (default hodm-tuning.conf if present)" << std::endl;
+  outputStream << "  --cache <file>     reuse the detections of the images " \
+    << "of a directory seen in earlier runs" << std::endl;
+  outputStream << "  --cache-size <n>   number of images kept in the cache, " \
+    << "least recently used first out (default 10000)" << std::endl;
+}
+
+auto IOHandler::parseArguments(int argc, char** argv, \
+                               RunOptions& options) -> bool {
+  /* A tuning profile is read first, so that the other arguments override
+  it */
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::string(argv[i]) == "--tuning" && \
+        !loadTuningProfile(argv[i + 1], options)) {
+      outputStream << "Error: Can't read the tuning profile " \
+        << argv[i + 1] << std::endl;
+      return false;
+    }
+  }
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--profile") {
+      options.profile = true;
+    } else if (argument == "--counters") {
+      options.profile = true;
+      options.perfCounters = true;
+    } else if (argument == "--headless") {
+      options.headless = true;
+    } else if (argument == "--display-fps" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.displayFps)) {
+      i += 1;
+    } else if (argument == "--stride" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.frameStride)) {
+      i += 1;
+    } else if (argument == "--checkpoint" && hasValue) {
+      options.checkpointFile = argv[i + 1];
+      i += 1;
+    } else if (argument == "--checkpoint-every" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.checkpointInterval)) {
+      i += 1;
+    } else if (argument == "--resume") {
+      options.resume = true;
+    } else if (argument == "--delta") {
+      options.deltaOutput = true;
+    } else if (argument == "--delta-keyframes" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.deltaKeyframes)) {
+      options.deltaOutput = true;
+      i += 1;
+    } else if (argument == "--delta-tolerance" && hasValue && \
+               parseInteger(argv[i + 1], 0, options.deltaTolerance)) {
+      options.deltaOutput = true;
+      i += 1;
+    } else if (argument == "--confidence" && hasValue && \
+               parseFraction(argv[i + 1], options.confidenceThreshold)) {
+      i += 1;
+    } else if (argument == "--nms" && hasValue && \
+               parseFraction(argv[i + 1], options.nmsThreshold)) {
+      i += 1;
+    } else if (argument == "--model" && i + 2 < argc) {
+      options.modelConfiguration = argv[i + 1];
+      options.modelWeights = argv[i + 2];
+      i += 2;
+    } else if (argument == "--metrics-port" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.metricsPort) && \
+               options.metricsPort <= 65535) {
+      i += 1;
+    } else if (argument == "--metrics-file" && hasValue) {
+      options.metricsFile = argv[i + 1];
+      i += 1;
+    } else if (argument == "--metrics-interval" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.metricsInterval)) {
+      i += 1;
+    } else if (argument == "--pin-capture" && hasValue && \
+               options.placement.setCpus(kCaptureThreads, argv[i + 1])) {
+      i += 1;
+    } else if (argument == "--pin-preprocess" && hasValue && \
+               options.placement.setCpus(kPreprocessThreads, argv[i + 1])) {
+      i += 1;
+    } else if (argument == "--pin-inference" && hasValue && \
+               options.placement.setCpus(kInferenceThreads, argv[i + 1])) {
+      i += 1;
+    } else if (argument == "--pin-output" && hasValue && \
+               options.placement.setCpus(kOutputThreads, argv[i + 1])) {
+      i += 1;
+    } else if (argument == "--encoders" && hasValue && \
+               parseInteger(argv[i + 1], 0, options.encoderThreads)) {
+      i += 1;
+    } else if (argument == "--write-queue" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.writeQueue)) {
+      i += 1;
+    } else if (argument == "--full-decode") {
+      options.reducedDecode = false;
+    } else if (argument == "--decode-calibration" && hasValue && \
+               parseInteger(argv[i + 1], 0, options.decodeCalibration)) {
+      i += 1;
+    } else if (argument == "--serve" && hasValue) {
+      options.serveSocket = argv[i + 1];
+      i += 1;
+    } else if (argument == "--workers" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.serverWorkers)) {
+      i += 1;
+    } else if (argument == "--batch" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.maxBatch)) {
+      i += 1;
+    } else if (argument == "--batch-wait" && hasValue && \
+               parseInteger(argv[i + 1], 0, options.batchWaitMs)) {
+      i += 1;
+    } else if (argument == "--shm" && hasValue) {
+      options.sharedMemoryRing = argv[i + 1];
+      i += 1;
+    } else if (argument == "--stream" && hasValue) {
+      options.streamInput = argv[i + 1];
+      i += 1;
+    } else if (argument == "--raw-format" && hasValue) {
+      options.rawFormat = argv[i + 1];
+      i += 1;
+    } else if (argument == "--raw-size" && hasValue && \
+               parseSize(argv[i + 1], options.rawWidth, options.rawHeight)) {
+      i += 1;
+    } else if (argument == "--roi" && hasValue) {
+      if (!options.zones.load(argv[i + 1])) {
+        outputStream << "Error: Can't read the zones of " << argv[i + 1] \
+          << std::endl;
+        return false;
+      }
+      i += 1;
+    } else if (argument == "--threads" && hasValue && \
+               parseInteger(argv[i + 1], 0, options.opencvThreads)) {
+      i += 1;
+    } else if (argument == "--filter" && hasValue && \
+               parseFilter(argv[i + 1], options.filterType)) {
+      i += 1;
+    } else if (argument == "--input-size" && hasValue && \
+               parseInteger(argv[i + 1], 32, options.inputSize) && \
+               options.inputSize % 32 == 0) {
+      i += 1;
+    } else if (argument == "--tuning" && hasValue) {
+      /* Read before the other arguments */
+      i += 1;
+    } else if (argument == "--cache" && hasValue) {
+      options.cacheFile = argv[i + 1];
+      i += 1;
+    } else if (argument == "--cache-size" && hasValue && \
+               parseInteger(argv[i + 1], 1, options.cacheEntries)) {
+      i += 1;
+    } else {
+      outputStream << "Unknown argument: " << argument << std::endl;
+      printUsage(argv[0]);
+      return false;
+    }
+  }
+  if (options.resume && options.checkpointFile.empty()) {
+    outputStream << "Error: --resume needs a --checkpoint file" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+auto IOHandler::loadTuningProfile(const std::string& path, \
+                                  RunOptions& options) -> bool {
+  std::ifstream profile(path);
+  if (!profile.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(profile, line)) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+    size_t separator = line.find('=');
+    if (separator == std::string::npos) {
+      return false;
+    }
+    std::string name = line.substr(start, separator - start);
+    std::string value = line.substr(separator + 1);
+    /* Only the tuned options, so that a profile can't change the mode */
+    if (name != "threads" && name != "workers" && name != "batch" && \
+        name != "filter" && name != "input-size") {
+      return false;
+    }
+    std::string flag = "--" + name;
+    char* arguments[] = {const_cast<char*>(path.c_str()), \
+                         const_cast<char*>(flag.c_str()), \
+                         const_cast<char*>(value.c_str())};
+    if (!parseArguments(3, arguments, options)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto IOHandler::saveTuningProfile(const std::string& path, \
+        const RunOptions& options, const std::string& comment) -> bool {
+  std::ofstream profile(path);
+  if (!profile.is_open()) {
+    return false;
+  }
+  std::istringstream lines(comment);
+  std::string line;
+  while (std::getline(lines, line)) {
+    profile << "# " << line << "\n";
   }
+  profile << "threads=" << options.opencvThreads << "\n" \
+    << "workers=" << options.serverWorkers << "\n" \
+    << "batch=" << options.maxBatch << "\n" \
+    << "filter=" << options.filterType << "\n" \
+    << "input-size=" << options.inputSize << "\n";
+  profile.flush();
+  return static_cast<bool>(profile);
 }
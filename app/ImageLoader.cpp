@@ -0,0 +1,273 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ImageLoader.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for ImageLoader class
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <opencv2/imgcodecs.hpp>
+
+#include "ImageLoader.hpp"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Milliseconds elapsed since a time point
+ */
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(\
+                                    Clock::now() - start).count();
+}
+
+/**
+ * @brief Reads a big endian 16 bit value from a stream
+ */
+bool readUint16(std::istream& input, int& value) {
+  unsigned char bytes[2];
+  if (!input.read(reinterpret_cast<char*>(bytes), 2)) {
+    return false;
+  }
+  value = (bytes[0] << 8) | bytes[1];
+  return true;
+}
+
+/**
+ * @brief Finds the size in the start of frame segment of a JPEG stream
+ *        positioned after the SOI marker
+ */
+bool readJpegSize(std::istream& input, cv::Size& size) {
+  while (input) {
+    int marker = input.get();
+    if (marker != 0xFF) {
+      return false;
+    }
+    /* Markers may be preceded by any number of fill bytes */
+    while (marker == 0xFF) {
+      marker = input.get();
+    }
+    if (marker == EOF || marker == 0xD9 || marker == 0xDA) {
+      /* End of image or start of scan before any frame header */
+      return false;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      /* Markers without a segment */
+      continue;
+    }
+    int length = 0;
+    if (!readUint16(input, length) || length < 2) {
+      return false;
+    }
+    /* Start of frame markers, except DHT (C4), JPG (C8) and DAC (CC) */
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && \
+        marker != 0xC8 && marker != 0xCC) {
+      int height = 0;
+      int width = 0;
+      input.get();
+      if (!readUint16(input, height) || !readUint16(input, width)) {
+        return false;
+      }
+      size = cv::Size(width, height);
+      return width > 0 && height > 0;
+    }
+    input.seekg(length - 2, std::ios::cur);
+  }
+  return false;
+}
+}  // namespace
+
+ImageLoader::ImageLoader() : targetSize(416, 416) {
+}
+
+ImageLoader::~ImageLoader() {
+}
+
+auto ImageLoader::readHeader(const std::string& filePath, cv::Size& size, \
+                             Format& format) -> bool {
+  format = kUnknown;
+  std::ifstream input(filePath, std::ios::binary);
+  unsigned char signature[8];
+  if (!input.read(reinterpret_cast<char*>(signature), 2)) {
+    return false;
+  }
+  if (signature[0] == 0xFF && signature[1] == 0xD8) {
+    format = kJpeg;
+    return readJpegSize(input, size);
+  }
+  const unsigned char pngSignature[8] = {0x89, 'P', 'N', 'G', \
+                                         '\r', '\n', 0x1A, '\n'};
+  if (!input.read(reinterpret_cast<char*>(signature + 2), 6) || \
+      !std::equal(signature, signature + 8, pngSignature)) {
+    return false;
+  }
+  format = kPng;
+  /* IHDR is the first chunk, after its length and type */
+  unsigned char header[16];
+  if (!input.read(reinterpret_cast<char*>(header), 16)) {
+    return false;
+  }
+  int width = (header[8] << 24) | (header[9] << 16) | (header[10] << 8) | \
+              header[11];
+  int height = (header[12] << 24) | (header[13] << 16) | \
+               (header[14] << 8) | header[15];
+  size = cv::Size(width, height);
+  return width > 0 && height > 0;
+}
+
+auto ImageLoader::reducedFactor(cv::Size source, cv::Size target) -> int {
+  for (int factor : {8, 4, 2}) {
+    /* Decoded size is rounded up */
+    int width = (source.width + factor - 1) / factor;
+    int height = (source.height + factor - 1) / factor;
+    if (width >= target.width && height >= target.height) {
+      return factor;
+    }
+  }
+  return 1;
+}
+
+auto ImageLoader::setTargetSize(cv::Size size) -> void {
+  targetSize = size;
+}
+
+auto ImageLoader::setReducedDecode(bool enabled) -> void {
+  reducedDecode = enabled;
+}
+
+auto ImageLoader::setCalibrationInterval(int interval) -> void {
+  calibrationInterval = interval;
+}
+
+auto ImageLoader::load(const std::string& filePath, int& factor) -> cv::Mat {
+  factor = 1;
+  cv::Size size;
+  Format format;
+  if (reducedDecode && readHeader(filePath, size, format) && \
+      format == kJpeg) {
+    factor = reducedFactor(size, targetSize);
+  }
+  int flags = cv::IMREAD_COLOR;
+  if (factor == 2) {
+    flags = cv::IMREAD_REDUCED_COLOR_2;
+  } else if (factor == 4) {
+    flags = cv::IMREAD_REDUCED_COLOR_4;
+  } else if (factor == 8) {
+    flags = cv::IMREAD_REDUCED_COLOR_8;
+  }
+  Clock::time_point start = Clock::now();
+  cv::Mat image = cv::imread(filePath, flags);
+  double decodeTime = elapsedMs(start);
+  if (image.empty()) {
+    factor = 1;
+    return image;
+  }
+  stats.images += 1;
+  stats.decodeMs += decodeTime;
+  if (factor == 1) {
+    return image;
+  }
+  stats.reducedImages += 1;
+  stats.reducedDecodeMs += decodeTime;
+  if (calibrationInterval > 0 && \
+      (stats.reducedImages - 1) % calibrationInterval == 0) {
+    /* Measure what the full resolution decode would have cost */
+    start = Clock::now();
+    cv::Mat fullImage = cv::imread(filePath, cv::IMREAD_COLOR);
+    stats.calibratedFullMs += elapsedMs(start);
+    stats.calibratedReducedMs += decodeTime;
+    stats.calibratedImages += 1;
+  }
+  return image;
+}
+
+auto ImageLoader::getStats() const -> const DecodeStats& {
+  return stats;
+}
+
+auto ImageLoader::estimatedSavedMs() const -> double {
+  if (stats.calibratedImages == 0 || stats.calibratedReducedMs <= 0) {
+    return 0;
+  }
+  double ratio = stats.calibratedFullMs / stats.calibratedReducedMs;
+  return stats.reducedDecodeMs * ratio - stats.reducedDecodeMs;
+}
+
+auto ImageLoader::printReport(std::ostream& output) const -> void {
+  output << std::fixed << std::setprecision(1);
+  output << "Decoded " << stats.images << " images in " << stats.decodeMs \
+    << " ms, " << stats.reducedImages << " at a reduced resolution" \
+    << std::endl;
+  if (stats.calibratedImages > 0) {
+    double saved = estimatedSavedMs();
+    output << "Full resolution decoding is estimated at " \
+      << stats.decodeMs + saved << " ms (from " << stats.calibratedImages \
+      << " calibration images), " << saved << " ms saved" << std::endl;
+  }
+}
+
+auto ImageLoader::listImages(const std::string& directory, \
+        std::vector<std::string>& imagePaths) -> bool {
+  struct stat status;
+  if (stat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode)) {
+    return false;
+  }
+  DIR* handle = opendir(directory.c_str());
+  if (handle == nullptr) {
+    return false;
+  }
+  std::string prefix = directory;
+  if (!prefix.empty() && prefix.back() != '/') {
+    prefix += '/';
+  }
+  for (dirent* entry = readdir(handle); entry != nullptr; \
+       entry = readdir(handle)) {
+    std::string name = entry->d_name;
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+      continue;
+    }
+    std::string extension = name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), \
+                   [](unsigned char c) { return std::tolower(c); });
+    if (extension == "jpg" || extension == "jpeg" || extension == "png" || \
+        extension == "bmp") {
+      imagePaths.push_back(prefix + name);
+    }
+  }
+  closedir(handle);
+  std::sort(imagePaths.begin(), imagePaths.end());
+  return true;
+}
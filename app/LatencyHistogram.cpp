@@ -0,0 +1,145 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      LatencyHistogram.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for LatencyHistogram class
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "LatencyHistogram.hpp"
+
+namespace {
+/* Smallest latency resolved by the histogram, 1 microsecond */
+const double kLowestLatency = 0.001;
+/* Ratio between upper boundaries of consecutive buckets (2% precision) */
+const double kBucketGrowth = 1.02;
+/* Enough buckets to cover 1 microsecond to several days */
+const int kBucketCount = 1400;
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : buckets(kBucketCount, 0) {
+}
+
+LatencyHistogram::~LatencyHistogram() {
+}
+
+auto LatencyHistogram::bucketIndex(double milliseconds) -> int {
+  if (milliseconds <= kLowestLatency) {
+    return 0;
+  }
+  int index = static_cast<int>(std::ceil(std::log(milliseconds / \
+                        kLowestLatency) / std::log(kBucketGrowth)));
+  return std::min(index, kBucketCount - 1);
+}
+
+auto LatencyHistogram::bucketUpperBound(int index) -> double {
+  return kLowestLatency * std::pow(kBucketGrowth, index);
+}
+
+auto LatencyHistogram::record(double milliseconds) -> void {
+  if (milliseconds < 0) {
+    milliseconds = 0;
+  }
+  buckets[bucketIndex(milliseconds)] += 1;
+  if (sampleCount == 0 || milliseconds < sampleMin) {
+    sampleMin = milliseconds;
+  }
+  if (sampleCount == 0 || milliseconds > sampleMax) {
+    sampleMax = milliseconds;
+  }
+  sampleCount += 1;
+  sampleSum += milliseconds;
+}
+
+auto LatencyHistogram::merge(const LatencyHistogram& other) -> void {
+  if (other.sampleCount == 0) {
+    return;
+  }
+  for (int i = 0; i < kBucketCount; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+  if (sampleCount == 0 || other.sampleMin < sampleMin) {
+    sampleMin = other.sampleMin;
+  }
+  if (sampleCount == 0 || other.sampleMax > sampleMax) {
+    sampleMax = other.sampleMax;
+  }
+  sampleCount += other.sampleCount;
+  sampleSum += other.sampleSum;
+}
+
+auto LatencyHistogram::reset() -> void {
+  std::fill(buckets.begin(), buckets.end(), 0);
+  sampleCount = 0;
+  sampleSum = 0;
+  sampleMin = 0;
+  sampleMax = 0;
+}
+
+auto LatencyHistogram::percentile(double fraction) const -> double {
+  if (sampleCount == 0) {
+    return 0;
+  }
+  fraction = std::max(0.0, std::min(1.0, fraction));
+  /* Rank of the sample we are looking for, counted from 1 */
+  uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * sampleCount));
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      /* Bucket boundaries can lie outside the observed range */
+      return std::max(sampleMin, std::min(sampleMax, bucketUpperBound(i)));
+    }
+  }
+  return sampleMax;
+}
+
+auto LatencyHistogram::count() const -> uint64_t {
+  return sampleCount;
+}
+
+auto LatencyHistogram::mean() const -> double {
+  return sampleCount == 0 ? 0 : sampleSum / sampleCount;
+}
+
+auto LatencyHistogram::min() const -> double {
+  return sampleMin;
+}
+
+auto LatencyHistogram::max() const -> double {
+  return sampleMax;
+}
+
+auto LatencyHistogram::sum() const -> double {
+  return sampleSum;
+}
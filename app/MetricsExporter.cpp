@@ -0,0 +1,238 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MetricsExporter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for MetricsExporter class
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "MetricsExporter.hpp"
+
+namespace {
+/* Largest request header read, longer requests are refused */
+const size_t kMaxRequestSize = 8192;
+
+/**
+ * @brief Builds an HTTP response closing the connection
+ */
+std::string httpResponse(const std::string& status, \
+                         const std::string& contentType, \
+                         const std::string& body, bool withBody) {
+  std::string response = "HTTP/1.1 " + status + "\r\n" \
+      "Content-Type: " + contentType + "\r\n" \
+      "Content-Length: " + std::to_string(body.size()) + "\r\n" \
+      "Connection: close\r\n\r\n";
+  if (withBody) {
+    response += body;
+  }
+  return response;
+}
+}  // namespace
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry) : \
+    metrics(registry), running(false), requests(0) {
+}
+
+MetricsExporter::~MetricsExporter() {
+  stop();
+}
+
+auto MetricsExporter::start(int port, const std::string& dumpPath, \
+                            double dumpSeconds) -> bool {
+  if (running || (port < 0 && dumpPath.empty()) || port > 65535) {
+    return false;
+  }
+  if (port >= 0) {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+      return false;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    /* Only local scrapers, the metrics are not meant to be public */
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    socklen_t length = sizeof(address);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), \
+             sizeof(address)) != 0 || listen(listenFd, 16) != 0 || \
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), \
+                    &length) != 0) {
+      close(listenFd);
+      listenFd = -1;
+      return false;
+    }
+    listenPort = ntohs(address.sin_port);
+  }
+  dumpFile = dumpPath;
+  dumpInterval = dumpSeconds > 0 ? dumpSeconds : 15;
+  requests = 0;
+  running = true;
+  worker = std::thread(&MetricsExporter::run, this);
+  return true;
+}
+
+auto MetricsExporter::stop() -> void {
+  if (!running) {
+    return;
+  }
+  running = false;
+  worker.join();
+  if (listenFd >= 0) {
+    close(listenFd);
+    listenFd = -1;
+  }
+  listenPort = -1;
+  if (!dumpFile.empty()) {
+    dump();
+  }
+}
+
+auto MetricsExporter::isRunning() const -> bool {
+  return running;
+}
+
+auto MetricsExporter::getPort() const -> int {
+  return listenPort;
+}
+
+auto MetricsExporter::getRequests() const -> uint64_t {
+  return requests;
+}
+
+auto MetricsExporter::dump() -> bool {
+  if (dumpFile.empty()) {
+    return false;
+  }
+  std::string temporaryFile = dumpFile + ".tmp";
+  {
+    std::ofstream output(temporaryFile.c_str());
+    if (!output) {
+      return false;
+    }
+    metrics.write(output);
+    if (!output) {
+      return false;
+    }
+  }
+  return std::rename(temporaryFile.c_str(), dumpFile.c_str()) == 0;
+}
+
+auto MetricsExporter::run() -> void {
+  typedef std::chrono::steady_clock Clock;
+  auto interval = std::chrono::duration_cast<Clock::duration>(\
+      std::chrono::duration<double>(dumpInterval));
+  Clock::time_point nextDump = Clock::now() + interval;
+  pollfd listening;
+  listening.fd = listenFd;
+  listening.events = POLLIN;
+  while (running) {
+    /* Wake up regularly to dump and to notice that the exporter stops */
+    int ready = poll(&listening, listenFd >= 0 ? 1 : 0, 100);
+    if (ready > 0) {
+      int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd >= 0) {
+        serveConnection(fd);
+        close(fd);
+      }
+    }
+    if (!dumpFile.empty() && Clock::now() >= nextDump) {
+      dump();
+      nextDump = Clock::now() + interval;
+    }
+  }
+}
+
+auto MetricsExporter::serveConnection(int fd) -> void {
+  /* A slow client can't hold the exporter for long */
+  timeval timeout;
+  timeout.tv_sec = 1;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && \
+         request.size() < kMaxRequestSize) {
+    ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      return;
+    }
+    request.append(buffer, received);
+  }
+  requests += 1;
+  std::string line = request.substr(0, request.find("\r\n"));
+  size_t methodEnd = line.find(' ');
+  size_t targetEnd = line.find(' ', methodEnd + 1);
+  if (methodEnd == std::string::npos || targetEnd == std::string::npos || \
+      request.size() >= kMaxRequestSize) {
+    sendAll(fd, httpResponse("400 Bad Request", "text/plain", \
+                             "Bad request\n", true));
+    return;
+  }
+  std::string method = line.substr(0, methodEnd);
+  std::string target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+  target = target.substr(0, target.find('?'));
+  if (method != "GET" && method != "HEAD") {
+    sendAll(fd, httpResponse("405 Method Not Allowed", "text/plain", \
+                             "Only GET is allowed\n", true));
+  } else if (target != "/metrics") {
+    sendAll(fd, httpResponse("404 Not Found", "text/plain", \
+                             "Metrics are at /metrics\n", method == "GET"));
+  } else {
+    sendAll(fd, httpResponse("200 OK", \
+        "text/plain; version=0.0.4; charset=utf-8", metrics.render(), \
+        method == "GET"));
+  }
+}
+
+auto MetricsExporter::sendAll(int fd, const std::string& data) -> bool {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t written = send(fd, data.data() + sent, data.size() - sent, \
+                           MSG_NOSIGNAL);
+    if (written <= 0) {
+      return false;
+    }
+    sent += written;
+  }
+  return true;
+}
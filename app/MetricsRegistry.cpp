@@ -0,0 +1,376 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MetricsRegistry.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for MetricsRegistry class and its metrics
+ */
+
+#include <unistd.h>
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "MetricsRegistry.hpp"
+
+namespace {
+/**
+ * @brief Series whose value is given by a function when it is written
+ */
+class SampledMetric : public Metric {
+ public:
+  explicit SampledMetric(MetricsRegistry::Sampler valueSampler) : \
+      sampler(valueSampler) {
+  }
+
+  void write(std::ostream& output, const std::string& name, \
+             const std::string& labels) const override {
+    writeSample(output, name, labels, formatValue(sampler()));
+  }
+
+ private:
+  MetricsRegistry::Sampler sampler;
+};
+
+/**
+ * @brief Adds to an atomic double, which has no fetch_add before C++20
+ */
+void atomicAdd(std::atomic<double>& value, double amount) {
+  double current = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(current, current + amount, \
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief Prometheus name of a metric type
+ */
+const char* typeName(MetricsRegistry::MetricType type) {
+  if (type == MetricsRegistry::kCounter) {
+    return "counter";
+  } else if (type == MetricsRegistry::kGauge) {
+    return "gauge";
+  }
+  return "histogram";
+}
+}  // namespace
+
+Metric::~Metric() {
+}
+
+auto Metric::formatValue(double value) -> std::string {
+  if (std::isnan(value)) {
+    return "NaN";
+  } else if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.15g", value);
+  return text;
+}
+
+auto Metric::writeSample(std::ostream& output, const std::string& name, \
+                         const std::string& labels, \
+                         const std::string& value) -> void {
+  output << name;
+  if (!labels.empty()) {
+    output << '{' << labels << '}';
+  }
+  output << ' ' << value << '\n';
+}
+
+auto MetricCounter::get() const -> uint64_t {
+  return value.load(std::memory_order_relaxed);
+}
+
+auto MetricCounter::write(std::ostream& output, const std::string& name, \
+                          const std::string& labels) const -> void {
+  writeSample(output, name, labels, std::to_string(get()));
+}
+
+auto MetricGauge::add(double amount) -> void {
+  atomicAdd(value, amount);
+}
+
+auto MetricGauge::get() const -> double {
+  return value.load(std::memory_order_relaxed);
+}
+
+auto MetricGauge::write(std::ostream& output, const std::string& name, \
+                        const std::string& labels) const -> void {
+  writeSample(output, name, labels, formatValue(get()));
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& upperBounds) : \
+    bounds(upperBounds), \
+    buckets(new std::atomic<uint64_t>[upperBounds.size() + 1]) {
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+  for (size_t i = 0; i <= bounds.size(); ++i) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+auto MetricHistogram::addToSum(double value) -> void {
+  atomicAdd(total, value);
+}
+
+auto MetricHistogram::count() const -> uint64_t {
+  uint64_t observations = 0;
+  for (size_t i = 0; i <= bounds.size(); ++i) {
+    observations += buckets[i].load(std::memory_order_relaxed);
+  }
+  return observations;
+}
+
+auto MetricHistogram::sum() const -> double {
+  return total.load(std::memory_order_relaxed);
+}
+
+auto MetricHistogram::write(std::ostream& output, const std::string& name, \
+                            const std::string& labels) const -> void {
+  /* Prometheus buckets count the observations up to their bound */
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i <= bounds.size(); ++i) {
+    cumulative += buckets[i].load(std::memory_order_relaxed);
+    std::string bound = i < bounds.size() ? formatValue(bounds[i]) : "+Inf";
+    writeSample(output, name + "_bucket", prefix + "le=\"" + bound + "\"", \
+                std::to_string(cumulative));
+  }
+  writeSample(output, name + "_sum", labels, formatValue(sum()));
+  writeSample(output, name + "_count", labels, std::to_string(cumulative));
+}
+
+MetricsRegistry::MetricsRegistry() {
+}
+
+MetricsRegistry::~MetricsRegistry() {
+}
+
+auto MetricsRegistry::counter(const std::string& name, \
+                              const std::string& help, \
+                              const Labels& labels) -> MetricCounter& {
+  std::lock_guard<std::mutex> lock(mutex);
+  Series* series = findSeries(kCounter, name, help, labels, false);
+  if (series == nullptr) {
+    return static_cast<MetricCounter&>(detach(new MetricCounter()));
+  }
+  if (!series->metric) {
+    series->metric.reset(new MetricCounter());
+  }
+  return static_cast<MetricCounter&>(*series->metric);
+}
+
+auto MetricsRegistry::gauge(const std::string& name, \
+                            const std::string& help, \
+                            const Labels& labels) -> MetricGauge& {
+  std::lock_guard<std::mutex> lock(mutex);
+  Series* series = findSeries(kGauge, name, help, labels, false);
+  if (series == nullptr) {
+    return static_cast<MetricGauge&>(detach(new MetricGauge()));
+  }
+  if (!series->metric) {
+    series->metric.reset(new MetricGauge());
+  }
+  return static_cast<MetricGauge&>(*series->metric);
+}
+
+auto MetricsRegistry::histogram(const std::string& name, \
+                                const std::string& help, \
+                                const std::vector<double>& upperBounds, \
+                                const Labels& labels) -> MetricHistogram& {
+  std::lock_guard<std::mutex> lock(mutex);
+  Series* series = findSeries(kHistogram, name, help, labels, false);
+  if (series == nullptr) {
+    return static_cast<MetricHistogram&>(detach(\
+        new MetricHistogram(upperBounds)));
+  }
+  if (!series->metric) {
+    series->metric.reset(new MetricHistogram(upperBounds));
+  }
+  return static_cast<MetricHistogram&>(*series->metric);
+}
+
+auto MetricsRegistry::sample(MetricType type, const std::string& name, \
+                             const std::string& help, const Labels& labels, \
+                             Sampler sampler, const void* owner) -> bool {
+  if (type == kHistogram || !sampler) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  Series* series = findSeries(type, name, help, labels, true);
+  if (series == nullptr) {
+    return false;
+  }
+  series->owner = owner;
+  series->metric.reset(new SampledMetric(sampler));
+  return true;
+}
+
+auto MetricsRegistry::removeSamples(const void* owner) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& family : families) {
+    family.series.erase(std::remove_if(family.series.begin(), \
+        family.series.end(), [owner](const Series& series) {
+          return series.sampled && series.owner == owner;
+        }), family.series.end());
+  }
+}
+
+auto MetricsRegistry::addProcessMetrics() -> void {
+  sample(kGauge, "process_resident_memory_bytes", \
+         "Resident memory size in bytes.", Labels(), residentMemoryBytes);
+}
+
+auto MetricsRegistry::write(std::ostream& output) const -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const auto& family : families) {
+    if (family.series.empty()) {
+      continue;
+    }
+    output << "# HELP " << family.name << ' ' \
+      << escape(family.help, false) << '\n';
+    output << "# TYPE " << family.name << ' ' << typeName(family.type) \
+      << '\n';
+    for (const auto& series : family.series) {
+      if (series.metric) {
+        series.metric->write(output, family.name, series.labels);
+      }
+    }
+  }
+}
+
+auto MetricsRegistry::render() const -> std::string {
+  std::ostringstream output;
+  write(output);
+  return output.str();
+}
+
+auto MetricsRegistry::latencyBounds() -> std::vector<double> {
+  return {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, \
+          0.5, 1, 2.5, 5, 10};
+}
+
+auto MetricsRegistry::isValidName(const std::string& name, \
+                                  bool metric) -> bool {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+    return false;
+  }
+  for (char c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && \
+        !(metric && c == ':')) {
+      return false;
+    }
+  }
+  /* Names starting with two underscores are reserved */
+  return name.compare(0, 2, "__") != 0;
+}
+
+auto MetricsRegistry::residentMemoryBytes() -> double {
+  /* Second field of statm, in pages */
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return static_cast<double>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+auto MetricsRegistry::findSeries(MetricType type, const std::string& name, \
+                                 const std::string& help, \
+                                 const Labels& labels, \
+                                 bool sampled) -> Series* {
+  std::string rendered;
+  if (!isValidName(name, true) || !renderLabels(labels, rendered)) {
+    return nullptr;
+  }
+  auto family = std::find_if(families.begin(), families.end(), \
+      [&name](const Family& known) { return known.name == name; });
+  if (family == families.end()) {
+    Family added;
+    added.name = name;
+    added.help = help;
+    added.type = type;
+    families.push_back(std::move(added));
+    family = families.end() - 1;
+  } else if (family->type != type) {
+    return nullptr;
+  }
+  for (auto& series : family->series) {
+    if (series.labels == rendered) {
+      return series.sampled == sampled ? &series : nullptr;
+    }
+  }
+  Series added;
+  added.labels = rendered;
+  added.sampled = sampled;
+  added.owner = nullptr;
+  family->series.push_back(std::move(added));
+  return &family->series.back();
+}
+
+auto MetricsRegistry::detach(Metric* metric) -> Metric& {
+  detached.emplace_back(metric);
+  return *metric;
+}
+
+auto MetricsRegistry::renderLabels(const Labels& labels, \
+                                   std::string& rendered) -> bool {
+  rendered.clear();
+  for (const auto& label : labels) {
+    if (!isValidName(label.first, false) || label.first == "le") {
+      return false;
+    }
+    if (!rendered.empty()) {
+      rendered += ',';
+    }
+    rendered += label.first + "=\"" + escape(label.second, true) + "\"";
+  }
+  return true;
+}
+
+auto MetricsRegistry::escape(const std::string& text, \
+                             bool quotes) -> std::string {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else if (c == '"' && quotes) {
+      escaped += "\\\"";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
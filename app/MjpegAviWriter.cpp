@@ -0,0 +1,241 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MjpegAviWriter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for MjpegAviWriter class
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "MjpegAviWriter.hpp"
+
+namespace {
+/* Flags of the main header and of the index entries */
+const uint32_t kHasIndex = 0x10;
+const uint32_t kKeyFrame = 0x10;
+/* Sizes of the fixed headers */
+const uint32_t kAvihSize = 56;
+const uint32_t kStrhSize = 56;
+const uint32_t kStrfSize = 40;
+/* Scale of the frame rate, so that rates like 29.97 are kept */
+const uint32_t kRateScale = 1000;
+/* Sizes of the header of a chunk and of an index entry */
+const uint64_t kChunkHeaderSize = 8;
+const uint64_t kIndexEntrySize = 16;
+}  // namespace
+
+MjpegAviWriter::MjpegAviWriter() {
+}
+
+MjpegAviWriter::~MjpegAviWriter() {
+  close();
+}
+
+auto MjpegAviWriter::open(const std::string& filePath, int width, \
+                          int height, double fps) -> bool {
+  close();
+  if (width <= 0 || height <= 0 || fps <= 0) {
+    return false;
+  }
+  file.open(filePath, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  index.clear();
+  maxFrameSize = 0;
+  const uint32_t strlSize = 4 + 8 + kStrhSize + 8 + kStrfSize;
+  const uint32_t hdrlSize = 4 + 8 + kAvihSize + 8 + strlSize;
+
+  writeFourcc("RIFF");
+  riffSizePosition = file.tellp();
+  writeUint32(0);
+  writeFourcc("AVI ");
+
+  writeFourcc("LIST");
+  writeUint32(hdrlSize);
+  writeFourcc("hdrl");
+  /* Main header */
+  writeFourcc("avih");
+  writeUint32(kAvihSize);
+  writeUint32(static_cast<uint32_t>(std::lround(1000000.0 / fps)));
+  writeUint32(0);
+  writeUint32(0);
+  writeUint32(kHasIndex);
+  totalFramesPosition = file.tellp();
+  writeUint32(0);
+  writeUint32(0);
+  writeUint32(1);
+  avihBufferSizePosition = file.tellp();
+  writeUint32(0);
+  writeUint32(static_cast<uint32_t>(width));
+  writeUint32(static_cast<uint32_t>(height));
+  for (int i = 0; i < 4; ++i) {
+    writeUint32(0);
+  }
+
+  writeFourcc("LIST");
+  writeUint32(strlSize);
+  writeFourcc("strl");
+  /* Stream header */
+  writeFourcc("strh");
+  writeUint32(kStrhSize);
+  writeFourcc("vids");
+  writeFourcc("MJPG");
+  writeUint32(0);
+  writeUint16(0);
+  writeUint16(0);
+  writeUint32(0);
+  writeUint32(kRateScale);
+  writeUint32(static_cast<uint32_t>(std::lround(fps * kRateScale)));
+  writeUint32(0);
+  streamLengthPosition = file.tellp();
+  writeUint32(0);
+  strhBufferSizePosition = file.tellp();
+  writeUint32(0);
+  writeUint32(0xFFFFFFFF);
+  writeUint32(0);
+  writeUint16(0);
+  writeUint16(0);
+  writeUint16(static_cast<uint16_t>(width));
+  writeUint16(static_cast<uint16_t>(height));
+  /* Stream format, a BITMAPINFOHEADER */
+  writeFourcc("strf");
+  writeUint32(kStrfSize);
+  writeUint32(kStrfSize);
+  writeUint32(static_cast<uint32_t>(width));
+  writeUint32(static_cast<uint32_t>(height));
+  writeUint16(1);
+  writeUint16(24);
+  writeFourcc("MJPG");
+  writeUint32(static_cast<uint32_t>(width * height * 3));
+  for (int i = 0; i < 4; ++i) {
+    writeUint32(0);
+  }
+
+  writeFourcc("LIST");
+  moviSizePosition = file.tellp();
+  writeUint32(0);
+  moviTypePosition = file.tellp();
+  writeFourcc("movi");
+  return static_cast<bool>(file);
+}
+
+auto MjpegAviWriter::isOpened() const -> bool {
+  return file.is_open();
+}
+
+auto MjpegAviWriter::writeFrame(const unsigned char* jpeg, \
+                                size_t size) -> bool {
+  if (!fits(size)) {
+    return false;
+  }
+  IndexEntry entry;
+  entry.offset = static_cast<uint32_t>(file.tellp() - moviTypePosition);
+  entry.size = static_cast<uint32_t>(size);
+  writeFourcc("00dc");
+  writeUint32(entry.size);
+  file.write(reinterpret_cast<const char*>(jpeg), size);
+  /* Chunks are aligned on 2 bytes */
+  if (size % 2 != 0) {
+    file.put(0);
+  }
+  if (entry.size > maxFrameSize) {
+    maxFrameSize = entry.size;
+  }
+  index.push_back(entry);
+  return static_cast<bool>(file);
+}
+
+auto MjpegAviWriter::fits(size_t size) -> bool {
+  if (!file.is_open()) {
+    return false;
+  }
+  /* The chunk, padded to 2 bytes, then the index with one more entry */
+  uint64_t end = static_cast<uint64_t>(file.tellp()) + kChunkHeaderSize + \
+                 size + size % 2 + kChunkHeaderSize + \
+                 (index.size() + 1) * kIndexEntrySize;
+  return end <= maxFileSize;
+}
+
+auto MjpegAviWriter::setMaxFileSize(uint64_t bytes) -> void {
+  maxFileSize = std::min<uint64_t>(bytes, UINT32_MAX);
+}
+
+auto MjpegAviWriter::close() -> void {
+  if (!file.is_open()) {
+    return;
+  }
+  std::streamoff moviEnd = file.tellp();
+  writeFourcc("idx1");
+  writeUint32(static_cast<uint32_t>(index.size() * 16));
+  for (const auto& entry : index) {
+    writeFourcc("00dc");
+    writeUint32(kKeyFrame);
+    writeUint32(entry.offset);
+    writeUint32(entry.size);
+  }
+  std::streamoff fileEnd = file.tellp();
+  patchUint32(riffSizePosition, static_cast<uint32_t>(fileEnd - 8));
+  patchUint32(totalFramesPosition, frameCount());
+  patchUint32(avihBufferSizePosition, maxFrameSize + 8);
+  patchUint32(streamLengthPosition, frameCount());
+  patchUint32(strhBufferSizePosition, maxFrameSize + 8);
+  patchUint32(moviSizePosition, \
+              static_cast<uint32_t>(moviEnd - moviTypePosition));
+  file.close();
+}
+
+auto MjpegAviWriter::frameCount() const -> uint32_t {
+  return static_cast<uint32_t>(index.size());
+}
+
+auto MjpegAviWriter::writeUint32(uint32_t value) -> void {
+  char bytes[4];
+  for (int i = 0; i < 4; ++i) {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+  file.write(bytes, 4);
+}
+
+auto MjpegAviWriter::writeUint16(uint16_t value) -> void {
+  char bytes[2] = {static_cast<char>(value & 0xFF), \
+                   static_cast<char>((value >> 8) & 0xFF)};
+  file.write(bytes, 2);
+}
+
+auto MjpegAviWriter::writeFourcc(const char* fourcc) -> void {
+  file.write(fourcc, 4);
+}
+
+auto MjpegAviWriter::patchUint32(std::streamoff position, \
+                                 uint32_t value) -> void {
+  file.seekp(position);
+  writeUint32(value);
+  file.seekp(0, std::ios::end);
+}
@@ -30,19 +30,53 @@
  * @brief     Definition for Network class
  */
 
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 #include "../include/Network.hpp"
 
 Network::Network() {
+    /* Store the path of configuration and weight files */
+    configurationFilePath = "../modelFiles/yolov3.cfg";
+    weightsFilePath = "../modelFiles/yolov3.weights";
 }
 
 Network::~Network() {
 }
 
+auto Network::isInputSized(const cv::Mat& image) -> bool {
+    return image.type() == CV_8UC3 && image.isContinuous() && \
+           image.cols == imageWidth && image.rows == imageHeight;
+}
+
+auto Network::fillBlobImage(const cv::Mat& image, float* planes) -> void {
+    const int planeSize = imageWidth * imageHeight;
+    const float scale = 1 / 255.0f;
+    float* red = planes;
+    float* green = red + planeSize;
+    float* blue = green + planeSize;
+    const uchar* pixel = image.data;
+    /* Interleaved BGR to planar RGB scaled to [0, 1] */
+    for (int i = 0; i < planeSize; ++i, pixel += 3) {
+      blue[i] = pixel[0] * scale;
+      green[i] = pixel[1] * scale;
+      red[i] = pixel[2] * scale;
+    }
+}
+
 auto Network::createNetworkInput(cv::Mat image) -> int {
     /* Checks if the given image is valid or not */
     if (!image.data) {
       return 0;
+    } else if (isInputSized(image)) {
+      /* Image already has the input size, fill the blob in place so that
+      it is reused between frames */
+      int blobShape[] = {1, 3, imageHeight, imageWidth};
+      blob.create(4, blobShape, CV_32F);
+      fillBlobImage(image, reinterpret_cast<float*>(blob.data));
+      return 1;
     } else {
       /* Make a blob for the input to the network */
       blob = cv::dnn::blobFromImage(image, 1/255.0, \
@@ -52,11 +86,120 @@ auto Network::createNetworkInput(cv::Mat image) -> int {
     }
 }
 
-auto Network::applyYOLONetwork() -> std::vector<cv::Mat> {
-    std::vector<cv::Mat> detectedObjects;
-    /* Store the path of configuration and weight files */
-    configurationFilePath = "../modelFiles/yolov3.cfg";
-    weightsFilePath = "../modelFiles/yolov3.weights";
+auto Network::createNetworkInput(const std::vector<cv::Mat>& images) -> int {
+    if (images.empty()) {
+      return 0;
+    }
+    bool sized = true;
+    for (const auto& image : images) {
+      if (!image.data) {
+        return 0;
+      }
+      sized = sized && isInputSized(image);
+    }
+    if (sized) {
+      /* Every image is one plane triple of the reused blob */
+      int blobShape[] = {static_cast<int>(images.size()), 3, imageHeight, \
+                         imageWidth};
+      blob.create(4, blobShape, CV_32F);
+      float* planes = reinterpret_cast<float*>(blob.data);
+      for (const auto& image : images) {
+        fillBlobImage(image, planes);
+        planes += 3 * imageWidth * imageHeight;
+      }
+    } else {
+      blob = cv::dnn::blobFromImages(images, 1/255.0, \
+      cv::Size(imageWidth, imageHeight), \
+      cv::Scalar(0, 0, 0), true, false);
+    }
+    return 1;
+}
+
+auto Network::createNetworkInput(const YuvImage& image) -> int {
+    if (!YuvConverter::isValid(image)) {
+      return 0;
+    }
+    int blobShape[] = {1, 3, imageHeight, imageWidth};
+    blob.create(4, blobShape, CV_32F);
+    yuvConverter.convertToPlanes(image, imageWidth, imageHeight, \
+                                 reinterpret_cast<float*>(blob.data));
+    return 1;
+}
+
+auto Network::splitBatchOutput(const std::vector<cv::Mat>& networkOutput, \
+        int batchSize, int index, std::vector<cv::Mat>& imageOutput) -> void {
+    imageOutput.resize(networkOutput.size());
+    for (size_t i = 0; i < networkOutput.size(); ++i) {
+      const cv::Mat& output = networkOutput[i];
+      if (output.dims == 3) {
+        /* Output of a batch is batch x boxes x (5 + classes) */
+        imageOutput[i] = cv::Mat(output.size[1], output.size[2], CV_32F, \
+            const_cast<float*>(output.ptr<float>(index)));
+      } else {
+        /* Boxes of the images follow each other */
+        int rows = output.rows / batchSize;
+        imageOutput[i] = output.rowRange(index * rows, (index + 1) * rows);
+      }
+    }
+}
+
+auto Network::setInputSize(cv::Size size) -> void {
+    imageWidth = size.width;
+    imageHeight = size.height;
+}
+
+auto Network::setModelFiles(const std::string& configuration, \
+                            const std::string& weights) -> void {
+    if (configuration == configurationFilePath && \
+        weights == weightsFilePath) {
+        return;
+    }
+    configurationFilePath = configuration;
+    weightsFilePath = weights;
+    /* Read from the new files on the next forward pass */
+    yoloNetwork = cv::dnn::Net();
+}
+
+auto Network::setThresholds(float confidence, float nms) -> void {
+    confidenceThreshold = confidence;
+    nmsThreshold = nms;
+}
+
+auto Network::getInputSize() -> cv::Size {
+    return cv::Size(imageWidth, imageHeight);
+}
+
+auto Network::getInputBlob() -> const cv::Mat& {
+    return blob;
+}
+
+auto Network::getInputPlanes(std::vector<cv::Mat>& planes) -> void {
+    planes.resize(3);
+    float* plane = reinterpret_cast<float*>(blob.data);
+    for (auto& channel : planes) {
+      channel = cv::Mat(imageHeight, imageWidth, CV_32F, plane);
+      plane += imageWidth * imageHeight;
+    }
+}
+
+auto Network::describeModel() -> std::string {
+    std::ostringstream description;
+    for (const auto& path : {configurationFilePath, weightsFilePath}) {
+      /* Size and modification time stand for the content, so that the
+      weights are not read */
+      struct stat status;
+      description << path << ':';
+      if (stat(path.c_str(), &status) == 0) {
+        description << status.st_size << ':' << status.st_mtime;
+      }
+      description << ';';
+    }
+    description << imageWidth << 'x' << imageHeight << ';' \
+      << confidenceThreshold << ';' << nmsThreshold;
+    return description.str();
+}
+
+auto Network::loadNetwork() -> void {
     /* Load the weights and the config file to the Network */
     yoloNetwork = cv::dnn::readNetFromDarknet(\
             configurationFilePath, weightsFilePath);
@@ -64,19 +207,61 @@ auto Network::applyYOLONetwork() -> std::vector<cv::Mat> {
     yoloNetwork.setPreferableBackend(cv::dnn::DNN_BACKEND_DEFAULT);
     /* Set the target processor */
     yoloNetwork.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-    /* Pass the input to the network */
-    yoloNetwork.setInput(blob);
     std::vector<int> outLayers{yoloNetwork.getUnconnectedOutLayers()};
     std::vector<cv::String> outLayerNames{yoloNetwork.getLayerNames()};
-    std::vector<cv::String> outLayerNamesCopy;
-    /* Make a copy of names of the layers */
-    outLayerNamesCopy.resize(outLayerNames.size());
-    int i = 0;
+    /* Keep the names of the output layers for the forward passes */
+    outputLayerNames.clear();
     for (auto names : outLayers) {
-        outLayerNamesCopy[i] = outLayerNames[names - 1];
-        i++;
+        outputLayerNames.push_back(outLayerNames[names - 1]);
     }
-    /* Forward pass of the network */
-    yoloNetwork.forward(detectedObjects, outLayerNamesCopy);
+}
+
+auto Network::applyYOLONetwork() -> std::vector<cv::Mat> {
+    std::vector<cv::Mat> detectedObjects;
+    applyYOLONetwork(detectedObjects);
     return detectedObjects;
 }
+
+auto Network::applyYOLONetwork(std::vector<cv::Mat>& detectedObjects) \
+                                                                  -> void {
+    if (forward) {
+        forward(blob, detectedObjects);
+        return;
+    }
+    /* The network is loaded only once, on the first forward pass */
+    if (yoloNetwork.empty()) {
+        loadNetwork();
+    }
+    /* Pass the input to the network */
+    yoloNetwork.setInput(blob);
+    /* Forward pass of the network */
+    yoloNetwork.forward(detectedObjects, outputLayerNames);
+}
+
+auto Network::setForward(ForwardFunction forwardFunction) -> void {
+    forward = forwardFunction;
+}
+
+auto Network::getLayerTimings(std::vector<std::string>& layerNames, \
+                              std::vector<double>& layerTimes) -> double {
+    layerNames.clear();
+    layerTimes.clear();
+    /* No layer ran without the network */
+    if (forward || yoloNetwork.empty()) {
+        return 0;
+    }
+    std::vector<double> layerTicks;
+    /* Ticks spent in the whole network and in each layer */
+    double totalTicks = static_cast<double>(\
+                            yoloNetwork.getPerfProfile(layerTicks));
+    double ticksPerMilli = cv::getTickFrequency() / 1000.0;
+    std::vector<cv::String> names{yoloNetwork.getLayerNames()};
+    size_t layerCount = std::min(names.size(), layerTicks.size());
+    layerNames.resize(layerCount);
+    layerTimes.resize(layerCount);
+    for (size_t i = 0; i < layerCount; ++i) {
+        layerNames[i] = names[i];
+        layerTimes[i] = layerTicks[i] / ticksPerMilli;
+    }
+    return totalTicks / ticksPerMilli;
+}
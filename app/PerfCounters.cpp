@@ -0,0 +1,212 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      PerfCounters.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for PerfCounters class
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "PerfCounters.hpp"
+
+namespace {
+#ifdef __linux__
+/* Hardware event counted by every counter */
+const uint64_t kEvents[PerfCounters::kCounterCount] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * @brief Opens one counter of the calling thread
+ *
+ * @param event Hardware event to count
+ * @param group Descriptor of the group leader, -1 to open a leader
+ *
+ * @return File descriptor of the counter, -1 on failure
+ */
+int openCounter(uint64_t event, int group) {
+  perf_event_attr attributes;
+  std::memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = PERF_TYPE_HARDWARE;
+  attributes.config = event;
+  attributes.disabled = (group == -1) ? 1 : 0;
+  /* User space only, which perf_event_paranoid 2 still allows */
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  attributes.read_format = PERF_FORMAT_GROUP | \
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, \
+                                  -1, group, 0));
+}
+
+/**
+ * @brief Explains why perf_event_open failed
+ *
+ * @param error Value of errno after the call
+ *
+ * @return Description of the failure
+ */
+std::string describeError(int error) {
+  switch (error) {
+    case EACCES:
+    case EPERM:
+      return "not permitted, see /proc/sys/kernel/perf_event_paranoid";
+    case ENOENT:
+    case EOPNOTSUPP:
+      return "not offered by this CPU or virtual machine";
+    case ENOSYS:
+      return "not supported by the kernel";
+    default:
+      return std::strerror(error);
+  }
+}
+#endif
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  for (int i = 0; i < kCounterCount; ++i) {
+    descriptors[i] = -1;
+    positions[i] = -1;
+  }
+#ifdef __linux__
+  for (int i = 0; i < kCounterCount; ++i) {
+    descriptors[i] = openCounter(kEvents[i], leader);
+    if (descriptors[i] == -1) {
+      if (error.empty()) {
+        error = std::string("can't open the ") + counterName(\
+            static_cast<Counter>(i)) + " counter: " + describeError(errno);
+      }
+      continue;
+    }
+    if (leader == -1) {
+      leader = descriptors[i];
+    }
+    positions[i] = groupSize++;
+  }
+  if (leader != -1) {
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#else
+  error = "hardware counters are only read on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int i = 0; i < kCounterCount; ++i) {
+    if (descriptors[i] != -1) {
+      close(descriptors[i]);
+    }
+  }
+#endif
+}
+
+auto PerfCounters::isAvailable() const -> bool {
+  return leader != -1;
+}
+
+auto PerfCounters::getError() const -> std::string {
+  return error;
+}
+
+auto PerfCounters::read(Reading& reading) const -> bool {
+  reading = Reading();
+#ifdef __linux__
+  if (leader == -1) {
+    return false;
+  }
+  /* Number of counters, time enabled, time running, then the values */
+  uint64_t buffer[3 + kCounterCount];
+  ssize_t size = ::read(leader, buffer, sizeof(buffer));
+  if (size < static_cast<ssize_t>(3 * sizeof(uint64_t)) || \
+      buffer[0] != static_cast<uint64_t>(groupSize)) {
+    return false;
+  }
+  /* Scale up when the kernel had to share the counters with others */
+  double scale = 1.0;
+  if (buffer[2] > 0 && buffer[2] < buffer[1]) {
+    scale = static_cast<double>(buffer[1]) / buffer[2];
+  }
+  for (int i = 0; i < kCounterCount; ++i) {
+    if (positions[i] == -1) {
+      continue;
+    }
+    reading.values[i] = static_cast<uint64_t>(buffer[3 + positions[i]] * \
+                                              scale);
+    reading.available |= 1u << i;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+auto PerfCounters::forThread() -> PerfCounters& {
+  static thread_local PerfCounters counters;
+  return counters;
+}
+
+auto PerfCounters::difference(const Reading& start, const Reading& end) \
+                                                            -> Reading {
+  Reading delta;
+  delta.available = start.available & end.available;
+  for (int i = 0; i < kCounterCount; ++i) {
+    if ((delta.available & (1u << i)) && end.values[i] >= start.values[i]) {
+      delta.values[i] = end.values[i] - start.values[i];
+    }
+  }
+  return delta;
+}
+
+auto PerfCounters::counterName(Counter counter) -> const char* {
+  switch (counter) {
+    case kCycles:
+      return "cycles";
+    case kInstructions:
+      return "instructions";
+    case kCacheMisses:
+      return "cache misses";
+    case kBranchMisses:
+      return "branch misses";
+    default:
+      return "unknown";
+  }
+}
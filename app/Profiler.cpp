@@ -0,0 +1,510 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      Profiler.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for Profiler and ScopedStage classes
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include "Profiler.hpp"
+
+namespace {
+/* Number of layers listed in the summary */
+const size_t kSummaryLayers = 10;
+
+/**
+ * @brief Escapes a string so that it can be placed inside JSON quotes
+ *
+ * @param text String to escape
+ *
+ * @return Escaped string
+ */
+std::string escapeJson(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Prints one row of the summary table
+ *
+ * @return void
+ */
+void printRow(std::ostream& output, const std::string& name, \
+              const LatencyHistogram& histogram) {
+  output << std::left << std::setw(28) << name << std::right \
+    << std::setw(8) << histogram.count() \
+    << std::setw(10) << histogram.mean() \
+    << std::setw(10) << histogram.percentile(0.50) \
+    << std::setw(10) << histogram.percentile(0.95) \
+    << std::setw(10) << histogram.percentile(0.99) \
+    << std::setw(10) << histogram.max() << "\n";
+}
+
+/**
+ * @brief Prints one value of the counter table, or "-" when the counter
+ *        it comes from is not available
+ *
+ * @return void
+ */
+void printCount(std::ostream& output, int width, unsigned available, \
+                PerfCounters::Counter counter, double value) {
+  output << std::setw(width);
+  if (available & (1u << counter)) {
+    output << value;
+  } else {
+    output << "-";
+  }
+}
+}  // namespace
+
+Profiler::Profiler() : origin(Clock::now()) {
+}
+
+Profiler::~Profiler() {
+}
+
+auto Profiler::setEnabled(bool enable) -> void {
+  enabled = enable;
+}
+
+auto Profiler::isEnabled() const -> bool {
+  return enabled;
+}
+
+auto Profiler::setMetrics(MetricsRegistry* registry) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  metrics = registry;
+  /* The names keep their slot, only their histogram changes */
+  for (auto& slot : stageMetrics) {
+    const char* stage = slot.stage.load(std::memory_order_acquire);
+    if (stage != nullptr) {
+      slot.metric.store(registryMetric(stage), std::memory_order_release);
+    }
+  }
+}
+
+auto Profiler::isTiming() const -> bool {
+  return enabled.load(std::memory_order_relaxed) || \
+         metrics.load(std::memory_order_relaxed) != nullptr;
+}
+
+auto Profiler::setCountersEnabled(bool enable) -> bool {
+  bool available = true;
+  std::string error;
+  if (enable) {
+    PerfCounters& counters = PerfCounters::forThread();
+    available = counters.isAvailable();
+    error = counters.getError();
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  counting = enable && available;
+  counterError = enable ? error : std::string();
+  return enable && available;
+}
+
+auto Profiler::countersEnabled() const -> bool {
+  return enabled.load(std::memory_order_relaxed) && \
+         counting.load(std::memory_order_relaxed);
+}
+
+auto Profiler::beginFrame(int frame) -> void {
+  frameID.store(frame, std::memory_order_relaxed);
+}
+
+auto Profiler::currentFrame() const -> int {
+  return frameID.load(std::memory_order_relaxed);
+}
+
+auto Profiler::nameIndex(const std::string& name, \
+                         std::vector<std::string>& names, \
+                         std::map<std::string, int>& indexes) -> int {
+  auto found = indexes.find(name);
+  if (found != indexes.end()) {
+    return found->second;
+  }
+  int index = static_cast<int>(names.size());
+  names.push_back(name);
+  indexes[name] = index;
+  return index;
+}
+
+auto Profiler::stageIndex(const std::string& stage) -> int {
+  int index = nameIndex(stage, stages, stageIndexes);
+  if (index == static_cast<int>(stageHistograms.size())) {
+    stageHistograms.emplace_back();
+    stageCounts.emplace_back();
+  }
+  return index;
+}
+
+auto Profiler::stageMetric(const char* stage) -> MetricHistogram* {
+  if (metrics.load(std::memory_order_acquire) == nullptr) {
+    return nullptr;
+  }
+  size_t first = reinterpret_cast<uintptr_t>(stage) % kStageMetricSlots;
+  for (size_t i = 0; i < kStageMetricSlots; ++i) {
+    StageMetric& slot = stageMetrics[(first + i) % kStageMetricSlots];
+    const char* name = slot.stage.load(std::memory_order_acquire);
+    if (name == stage) {
+      return slot.metric.load(std::memory_order_acquire);
+    } else if (name == nullptr) {
+      break;
+    }
+  }
+  /* First time the name is seen, give it a slot if one is left */
+  std::lock_guard<std::mutex> lock(mutex);
+  MetricHistogram* metric = registryMetric(stage);
+  for (size_t i = 0; i < kStageMetricSlots; ++i) {
+    StageMetric& slot = stageMetrics[(first + i) % kStageMetricSlots];
+    const char* name = slot.stage.load(std::memory_order_relaxed);
+    if (name == stage) {
+      break;
+    } else if (name == nullptr) {
+      slot.metric.store(metric, std::memory_order_relaxed);
+      slot.stage.store(stage, std::memory_order_release);
+      break;
+    }
+  }
+  return metric;
+}
+
+auto Profiler::registryMetric(const std::string& stage) -> MetricHistogram* {
+  MetricsRegistry* registry = metrics.load(std::memory_order_relaxed);
+  if (registry == nullptr) {
+    return nullptr;
+  }
+  return &registry->histogram("hodm_stage_duration_seconds", \
+                              "Duration of the pipeline stages in seconds.", \
+                              MetricsRegistry::latencyBounds(), \
+                              {{"stage", stage}});
+}
+
+auto Profiler::threadIndex() -> int {
+  std::thread::id id = std::this_thread::get_id();
+  auto found = threadIndexes.find(id);
+  if (found != threadIndexes.end()) {
+    return found->second;
+  }
+  int index = static_cast<int>(threadIndexes.size()) + 1;
+  threadIndexes[id] = index;
+  return index;
+}
+
+auto Profiler::addEvent(const TraceEvent& event) -> void {
+  if (events.size() < eventLimit) {
+    events.push_back(event);
+  } else {
+    droppedEvents += 1;
+  }
+}
+
+auto Profiler::record(const char* stage, int frame, \
+                      Clock::time_point start, Clock::time_point end) -> void {
+  if (!isTiming()) {
+    return;
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(\
+                                                    end - start).count();
+  MetricHistogram* metric = stageMetric(stage);
+  if (metric != nullptr) {
+    metric->observe(duration / 1e6);
+  }
+  if (!enabled) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  int index = stageIndex(stage);
+  stageHistograms[index].record(duration / 1000.0);
+  TraceEvent event;
+  event.nameIndex = index;
+  event.isLayer = false;
+  event.startMicros = std::chrono::duration_cast<std::chrono::microseconds>(\
+                                                    start - origin).count();
+  event.durationMicros = duration;
+  event.frameID = frame;
+  event.threadIndex = threadIndex();
+  addEvent(event);
+}
+
+auto Profiler::recordCounters(const std::string& stage, \
+                              const PerfCounters::Reading& counts) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return;
+  }
+  StageCounts& total = stageCounts[stageIndex(stage)];
+  total.runs += 1;
+  total.available &= counts.available;
+  for (int i = 0; i < PerfCounters::kCounterCount; ++i) {
+    total.values[i] += counts.values[i];
+  }
+}
+
+auto Profiler::stageCounters(const std::string& stage, uint64_t& runs) \
+                                          const -> PerfCounters::Reading {
+  std::lock_guard<std::mutex> lock(mutex);
+  PerfCounters::Reading sum;
+  runs = 0;
+  auto found = stageIndexes.find(stage);
+  if (found == stageIndexes.end() || stageCounts[found->second].runs == 0) {
+    return sum;
+  }
+  const StageCounts& total = stageCounts[found->second];
+  runs = total.runs;
+  sum.available = total.available;
+  for (int i = 0; i < PerfCounters::kCounterCount; ++i) {
+    sum.values[i] = total.values[i];
+  }
+  return sum;
+}
+
+auto Profiler::recordLayers(int frame, Clock::time_point start, \
+                            const std::vector<std::string>& layerNames, \
+                            const std::vector<double>& layerTimes) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!enabled) {
+    return;
+  }
+  int thread = threadIndex();
+  /* Layers are laid out back to back from the start of the forward pass */
+  double offsetMicros = std::chrono::duration_cast<\
+      std::chrono::microseconds>(start - origin).count();
+  size_t layerCount = std::min(layerNames.size(), layerTimes.size());
+  for (size_t i = 0; i < layerCount; ++i) {
+    int index = nameIndex(layerNames[i], layers, layerIndexes);
+    if (index == static_cast<int>(layerHistograms.size())) {
+      layerHistograms.emplace_back();
+    }
+    layerHistograms[index].record(layerTimes[i]);
+    TraceEvent event;
+    event.nameIndex = index;
+    event.isLayer = true;
+    event.startMicros = static_cast<int64_t>(offsetMicros);
+    event.durationMicros = static_cast<int64_t>(layerTimes[i] * 1000.0);
+    event.frameID = frame;
+    event.threadIndex = thread;
+    addEvent(event);
+    offsetMicros += layerTimes[i] * 1000.0;
+  }
+}
+
+auto Profiler::stageHistogram(const std::string& stage) const \
+                                                    -> LatencyHistogram {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = stageIndexes.find(stage);
+  if (found == stageIndexes.end()) {
+    return LatencyHistogram();
+  }
+  return stageHistograms[found->second];
+}
+
+auto Profiler::stageNames() const -> std::vector<std::string> {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stages;
+}
+
+auto Profiler::traceEventCount() const -> size_t {
+  std::lock_guard<std::mutex> lock(mutex);
+  return events.size();
+}
+
+auto Profiler::setTraceEventLimit(size_t limit) -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  eventLimit = limit;
+}
+
+auto Profiler::reset() -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  origin = Clock::now();
+  stages.clear();
+  layers.clear();
+  stageIndexes.clear();
+  layerIndexes.clear();
+  stageHistograms.clear();
+  layerHistograms.clear();
+  stageCounts.clear();
+  events.clear();
+  droppedEvents = 0;
+}
+
+auto Profiler::printSummary(std::ostream& output) const -> void {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::ios::fmtflags flags = output.flags();
+  std::streamsize precision = output.precision();
+  output << std::fixed << std::setprecision(3);
+  output << std::left << std::setw(28) << "Stage (ms)" << std::right \
+    << std::setw(8) << "count" << std::setw(10) << "mean" \
+    << std::setw(10) << "p50" << std::setw(10) << "p95" \
+    << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+  for (size_t i = 0; i < stages.size(); ++i) {
+    printRow(output, stages[i], stageHistograms[i]);
+  }
+  if (!layers.empty()) {
+    /* List the layers that take the most time overall */
+    std::vector<size_t> order(layers.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return layerHistograms[a].sum() > layerHistograms[b].sum();
+    });
+    output << "Slowest layers:\n";
+    for (size_t i = 0; i < order.size() && i < kSummaryLayers; ++i) {
+      printRow(output, "  " + layers[order[i]], layerHistograms[order[i]]);
+    }
+  }
+  printCounters(output);
+  if (droppedEvents > 0) {
+    output << droppedEvents << " trace events dropped after reaching the " \
+      << "limit of " << eventLimit << "\n";
+  }
+  output.flags(flags);
+  output.precision(precision);
+}
+
+auto Profiler::printCounters(std::ostream& output) const -> void {
+  if (!counterError.empty()) {
+    output << "Hardware counters unavailable (" << counterError << "), " \
+      << (counting ? "some stages are not counted" : "only timings are " \
+          "reported") << "\n";
+  }
+  bool counted = false;
+  for (const auto& total : stageCounts) {
+    counted = counted || total.runs > 0;
+  }
+  if (!counted) {
+    return;
+  }
+  output << std::left << std::setw(28) << "Stage (per frame)" << std::right \
+    << std::setw(8) << "count" << std::setw(10) << "Mcycles" \
+    << std::setw(10) << "Minstr" << std::setw(10) << "IPC" \
+    << std::setw(12) << "cache miss" << std::setw(12) << "branch miss" \
+    << "\n";
+  for (size_t i = 0; i < stages.size(); ++i) {
+    const StageCounts& total = stageCounts[i];
+    if (total.runs == 0) {
+      continue;
+    }
+    output << std::left << std::setw(28) << stages[i] << std::right \
+      << std::setw(8) << total.runs;
+    double runs = static_cast<double>(total.runs);
+    printCount(output, 10, total.available, PerfCounters::kCycles, \
+               total.values[PerfCounters::kCycles] / 1e6 / runs);
+    printCount(output, 10, total.available, PerfCounters::kInstructions, \
+               total.values[PerfCounters::kInstructions] / 1e6 / runs);
+    unsigned bothCounts = (1u << PerfCounters::kCycles) | \
+                          (1u << PerfCounters::kInstructions);
+    bool hasIpc = (total.available & bothCounts) == bothCounts && \
+                  total.values[PerfCounters::kCycles] > 0;
+    double ipc = hasIpc ? static_cast<double>(\
+        total.values[PerfCounters::kInstructions]) / \
+        total.values[PerfCounters::kCycles] : 0;
+    printCount(output, 10, hasIpc ? bothCounts : 0u, PerfCounters::kCycles, \
+               ipc);
+    printCount(output, 12, total.available, PerfCounters::kCacheMisses, \
+               total.values[PerfCounters::kCacheMisses] / runs);
+    printCount(output, 12, total.available, PerfCounters::kBranchMisses, \
+               total.values[PerfCounters::kBranchMisses] / runs);
+    output << "\n";
+  }
+}
+
+auto Profiler::exportChromeTrace(const std::string& filePath) const -> bool {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::ofstream traceFile(filePath);
+  if (!traceFile) {
+    return false;
+  }
+  traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& event : events) {
+    const std::string& name = event.isLayer ? layers[event.nameIndex] \
+                                            : stages[event.nameIndex];
+    traceFile << (first ? "\n" : ",\n") \
+      << "{\"name\":\"" << escapeJson(name) << "\"," \
+      << "\"cat\":\"" << (event.isLayer ? "layer" : "stage") << "\"," \
+      << "\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadIndex << "," \
+      << "\"ts\":" << event.startMicros << "," \
+      << "\"dur\":" << event.durationMicros << "," \
+      << "\"args\":{\"frameID\":" << event.frameID << "}}";
+    first = false;
+  }
+  traceFile << "\n]}\n";
+  return static_cast<bool>(traceFile);
+}
+
+ScopedStage::ScopedStage(Profiler& stageProfiler, const char* stageName) :
+    profiler(stageProfiler), stage(stageName),
+    active(stageProfiler.isTiming()), counting(false) {
+  if (active) {
+    counting = profiler.countersEnabled() && \
+        PerfCounters::forThread().read(startCounts);
+    start = Profiler::Clock::now();
+  }
+}
+
+ScopedStage::~ScopedStage() {
+  if (active) {
+    finish();
+  }
+}
+
+auto ScopedStage::finish() -> Profiler::Clock::time_point {
+  Profiler::Clock::time_point now = Profiler::Clock::now();
+  if (counting) {
+    PerfCounters::Reading endCounts;
+    if (PerfCounters::forThread().read(endCounts)) {
+      profiler.recordCounters(stage, PerfCounters::difference(startCounts, \
+                                                              endCounts));
+      startCounts = endCounts;
+    }
+  }
+  profiler.record(stage, profiler.currentFrame(), start, now);
+  return now;
+}
+
+auto ScopedStage::next(const char* nextStage) -> void {
+  if (active) {
+    start = finish();
+  }
+  stage = nextStage;
+}
@@ -0,0 +1,154 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      RegionOfInterest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for RegionOfInterest class
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <opencv2/imgproc.hpp>
+
+#include "RegionOfInterest.hpp"
+
+auto RegionOfInterest::load(const std::string& path) -> bool {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    zones.clear();
+    return false;
+  }
+  return read(file);
+}
+
+auto RegionOfInterest::read(std::istream& input) -> bool {
+  zones.clear();
+  std::string line;
+  while (std::getline(input, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    if (!(fields >> kind) || kind[0] == '#') {
+      continue;
+    }
+    bool valid = false;
+    if (kind == "rect") {
+      cv::Rect zone;
+      valid = static_cast<bool>(fields >> zone.x >> zone.y >> zone.width \
+                                       >> zone.height) && \
+              zone.width > 0 && zone.height > 0;
+      if (valid) {
+        addRectangle(zone);
+      }
+    } else if (kind == "polygon") {
+      std::vector<cv::Point> corners;
+      std::string corner;
+      valid = true;
+      while (valid && fields >> corner) {
+        cv::Point point;
+        char extra;
+        valid = std::sscanf(corner.c_str(), "%d,%d%c", &point.x, &point.y, \
+                            &extra) == 2;
+        corners.push_back(point);
+      }
+      valid = valid && addPolygon(corners);
+    }
+    std::string rest;
+    if (!valid || fields >> rest) {
+      zones.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+auto RegionOfInterest::addRectangle(const cv::Rect& zone) -> void {
+  zones.push_back({zone.tl(), cv::Point(zone.x + zone.width, zone.y), \
+                   zone.br(), cv::Point(zone.x, zone.y + zone.height)});
+}
+
+auto RegionOfInterest::addPolygon(const std::vector<cv::Point>& zone) \
+    -> bool {
+  if (zone.size() < 3) {
+    return false;
+  }
+  zones.push_back(zone);
+  return true;
+}
+
+auto RegionOfInterest::empty() const -> bool {
+  return zones.empty();
+}
+
+auto RegionOfInterest::getZones() const \
+    -> const std::vector<std::vector<cv::Point>>& {
+  return zones;
+}
+
+auto RegionOfInterest::getRegions(cv::Size frameSize, int maxRegions, \
+        std::vector<cv::Rect>& regions) const -> void {
+  regions.clear();
+  cv::Rect frame(0, 0, frameSize.width, frameSize.height);
+  for (const auto& zone : zones) {
+    cv::Rect region = cv::boundingRect(zone) & frame;
+    if (region.area() > 0) {
+      regions.push_back(region);
+    }
+  }
+  /* Overlapping regions would send the same pixels twice */
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < regions.size() && !merged; ++i) {
+      for (size_t j = i + 1; j < regions.size() && !merged; ++j) {
+        if ((regions[i] & regions[j]).area() > 0) {
+          regions[i] |= regions[j];
+          regions.erase(regions.begin() + j);
+          merged = true;
+        }
+      }
+    }
+  }
+  if (static_cast<int>(regions.size()) > std::max(1, maxRegions)) {
+    cv::Rect region = regions[0];
+    for (const auto& other : regions) {
+      region |= other;
+    }
+    regions.assign(1, region);
+  }
+}
+
+auto RegionOfInterest::contains(const cv::Rect& box) const -> bool {
+  cv::Point2f center(box.x + box.width / 2.0f, box.y + box.height / 2.0f);
+  for (const auto& zone : zones) {
+    if (cv::pointPolygonTest(zone, center, false) >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,278 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ResultCache.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for ResultCache class
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <utility>
+
+#include "ResultCache.hpp"
+
+namespace {
+/* Magic and version at the start of the file */
+const char kMagic[8] = {'H', 'O', 'D', 'M', 'R', 'C', '0', '1'};
+/* Detections of one image beyond this mean the file is corrupt */
+const uint32_t kMaxDetections = 1 << 16;
+/* Multipliers of the hash */
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline uint64_t rotate(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * @brief Mixes the bits of the final hash
+ */
+inline uint64_t finalize(uint64_t value) {
+  value ^= value >> 33;
+  value *= kPrime2;
+  value ^= value >> 29;
+  value *= kPrime1;
+  value ^= value >> 32;
+  return value;
+}
+
+/**
+ * @brief Hashes the whole 8 byte words of a buffer into a running state,
+ *        for hashing a file chunk by chunk
+ */
+inline uint64_t hashWords(const unsigned char* data, size_t words, \
+                          uint64_t state) {
+  for (size_t i = 0; i < words; ++i, data += 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    state = rotate(state ^ (word * kPrime2), 31) * kPrime1;
+  }
+  return state;
+}
+
+/**
+ * @brief Hashes the last bytes and the length into the state
+ */
+inline uint64_t hashTail(const unsigned char* data, size_t size, \
+                         uint64_t length, uint64_t state) {
+  uint64_t word = 0;
+  std::memcpy(&word, data, size);
+  state = rotate(state ^ (word * kPrime2), 31) * kPrime1;
+  return finalize(state ^ length);
+}
+}  // namespace
+
+ResultCache::ResultCache() {
+}
+
+ResultCache::~ResultCache() {
+  if (modified) {
+    save();
+  }
+}
+
+auto ResultCache::open(const std::string& path, size_t maxEntries) -> bool {
+  entries.clear();
+  index.clear();
+  stats = CacheStats();
+  filePath.clear();
+  modified = false;
+  capacity = maxEntries > 0 ? maxEntries : 1;
+  std::ifstream file(path, std::ios::binary);
+  if (file.is_open()) {
+    char magic[sizeof(kMagic)];
+    uint64_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || \
+        std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || \
+        !file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+      return false;
+    }
+    for (uint64_t i = 0; i < count && entries.size() < capacity; ++i) {
+      Entry entry;
+      uint32_t detectionCount = 0;
+      if (!file.read(reinterpret_cast<char*>(&entry.key), \
+                     sizeof(entry.key)) || \
+          !file.read(reinterpret_cast<char*>(&detectionCount), \
+                     sizeof(detectionCount)) || \
+          detectionCount > kMaxDetections) {
+        break;
+      }
+      entry.detections.resize(detectionCount);
+      if (!file.read(reinterpret_cast<char*>(entry.detections.data()), \
+                     detectionCount * sizeof(Detection))) {
+        break;
+      }
+      if (index.count(entry.key) == 0) {
+        entries.push_back(std::move(entry));
+        index[entries.back().key] = std::prev(entries.end());
+      }
+    }
+  }
+  filePath = path;
+  return true;
+}
+
+auto ResultCache::isOpen() const -> bool {
+  return !filePath.empty();
+}
+
+auto ResultCache::hash(const void* data, size_t size, \
+                       uint64_t seed) -> uint64_t {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  size_t words = size / 8;
+  uint64_t state = hashWords(bytes, words, seed + kPrime1);
+  return hashTail(bytes + words * 8, size % 8, size, state);
+}
+
+auto ResultCache::hashFile(const std::string& path, uint64_t seed, \
+                           uint64_t& key) -> bool {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  /* Chunks are a multiple of 8 bytes, so that the file hashes as one
+  buffer would */
+  std::vector<unsigned char> chunk(1 << 16);
+  uint64_t state = seed + kPrime1;
+  uint64_t length = 0;
+  size_t read = 0;
+  bool failed = false;
+  while (true) {
+    read = std::fread(chunk.data(), 1, chunk.size(), file);
+    length += read;
+    if (read < chunk.size()) {
+      failed = std::ferror(file) != 0;
+      break;
+    }
+    state = hashWords(chunk.data(), chunk.size() / 8, state);
+  }
+  std::fclose(file);
+  if (failed) {
+    return false;
+  }
+  state = hashWords(chunk.data(), read / 8, state);
+  key = hashTail(chunk.data() + read / 8 * 8, read % 8, length, state);
+  return true;
+}
+
+auto ResultCache::find(uint64_t key, \
+                       std::vector<Detection>& detections) -> bool {
+  auto found = index.find(key);
+  if (found == index.end()) {
+    stats.misses += 1;
+    return false;
+  }
+  stats.hits += 1;
+  /* Most recently used first, so that it is evicted last */
+  entries.splice(entries.begin(), entries, found->second);
+  detections = found->second->detections;
+  modified = true;
+  return true;
+}
+
+auto ResultCache::store(uint64_t key, const Detection* detections, \
+                        size_t count) -> void {
+  auto found = index.find(key);
+  if (found != index.end()) {
+    entries.splice(entries.begin(), entries, found->second);
+    found->second->detections.assign(detections, detections + count);
+  } else {
+    entries.push_front(Entry{key, std::vector<Detection>(detections, \
+                                                         detections + count)});
+    index[key] = entries.begin();
+    evict();
+  }
+  modified = true;
+}
+
+auto ResultCache::evict() -> void {
+  while (entries.size() > capacity) {
+    index.erase(entries.back().key);
+    entries.pop_back();
+    stats.evictions += 1;
+  }
+}
+
+auto ResultCache::save() -> bool {
+  if (!isOpen()) {
+    return false;
+  }
+  /* Written next to the cache and renamed, so that an interrupted run
+  leaves the previous cache */
+  std::string temporaryPath = filePath + ".tmp";
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    uint64_t count = entries.size();
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& entry : entries) {
+      uint32_t detectionCount = static_cast<uint32_t>(\
+          entry.detections.size());
+      file.write(reinterpret_cast<const char*>(&entry.key), \
+                 sizeof(entry.key));
+      file.write(reinterpret_cast<const char*>(&detectionCount), \
+                 sizeof(detectionCount));
+      file.write(reinterpret_cast<const char*>(entry.detections.data()), \
+                 detectionCount * sizeof(Detection));
+    }
+    if (!file.flush()) {
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  modified = false;
+  return true;
+}
+
+auto ResultCache::size() const -> size_t {
+  return entries.size();
+}
+
+auto ResultCache::getStats() const -> const CacheStats& {
+  return stats;
+}
+
+auto ResultCache::printReport(std::ostream& output) const -> void {
+  uint64_t lookups = stats.hits + stats.misses;
+  double hitRate = lookups > 0 ? 100.0 * stats.hits / lookups : 0;
+  std::ios::fmtflags flags = output.flags();
+  std::streamsize precision = output.precision();
+  output << "Result cache: " << stats.hits << " hits, " << stats.misses \
+    << " misses (" << std::fixed << std::setprecision(1) << hitRate \
+    << "% hit rate), " << stats.evictions << " evicted, " \
+    << entries.size() << " entries" << std::endl;
+  output.flags(flags);
+  output.precision(precision);
+}
@@ -0,0 +1,310 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+
+/**
+ * @file      ThreadPlacement.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for ThreadPlacement and ScopedPlacement classes
+ */
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "ThreadPlacement.hpp"
+
+namespace {
+/* Directory of the NUMA nodes of the machine */
+const char kNodeDirectory[] = "/sys/devices/system/node";
+
+/* Names of the roles in the descriptions */
+const char* const kRoleNames[kThreadRoles] = {"capture", "preprocess", \
+                                              "inference", "output"};
+
+/**
+ * @brief Parses a CPU number
+ *
+ * @return false if the text is not a number of a CPU of a cpu_set_t
+ */
+bool parseCpu(const std::string& text, int& cpu) {
+  if (text.empty() || text.size() > 4 || \
+      text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  cpu = std::atoi(text.c_str());
+  return cpu < CPU_SETSIZE;
+}
+}  // namespace
+
+ThreadPlacement::ThreadPlacement() : roleCpus(kThreadRoles) {
+  loadTopology(kNodeDirectory);
+}
+
+auto ThreadPlacement::setCpus(ThreadRole role, \
+                              const std::string& cpuList) -> bool {
+  std::vector<int> cpus;
+  if (!cpuList.empty() && !parseCpuList(cpuList, cpus)) {
+    return false;
+  }
+  roleCpus[role] = cpus;
+  return true;
+}
+
+auto ThreadPlacement::getCpus(ThreadRole role) const \
+    -> const std::vector<int>& {
+  return roleCpus[role];
+}
+
+auto ThreadPlacement::isPinned(ThreadRole role) const -> bool {
+  return !roleCpus[role].empty();
+}
+
+auto ThreadPlacement::empty() const -> bool {
+  for (const auto& cpus : roleCpus) {
+    if (!cpus.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ThreadPlacement::workerCpus(ThreadRole role, int worker, \
+                                 int workers) const -> std::vector<int> {
+  std::vector<int> cpus = roleCpus[role];
+  if (cpus.empty()) {
+    return cpus;
+  }
+  /* Neighbouring workers get neighbouring CPUs of the same node */
+  std::sort(cpus.begin(), cpus.end());
+  std::stable_sort(cpus.begin(), cpus.end(), [this](int a, int b) {
+    return nodeOf(a) < nodeOf(b);
+  });
+  size_t count = cpus.size();
+  size_t parts = static_cast<size_t>(std::max(workers, 1));
+  size_t index = static_cast<size_t>(std::max(worker, 0)) % parts;
+  if (parts >= count) {
+    return std::vector<int>(1, cpus[index % count]);
+  }
+  return std::vector<int>(cpus.begin() + index * count / parts, \
+                          cpus.begin() + (index + 1) * count / parts);
+}
+
+auto ThreadPlacement::threadsPerWorker(ThreadRole role, \
+                                       int workers) const -> int {
+  if (roleCpus[role].empty()) {
+    return 0;
+  }
+  return std::max(static_cast<int>(roleCpus[role].size()) / \
+                  std::max(workers, 1), 1);
+}
+
+auto ThreadPlacement::pinCurrentThread(ThreadRole role, int worker, \
+                                       int workers) const -> bool {
+  std::vector<int> cpus = workerCpus(role, worker, workers);
+  if (cpus.empty()) {
+    return true;
+  }
+  if (!setCurrentCpus(cpus)) {
+    return false;
+  }
+  int node = nodeOf(cpus.front());
+  for (int cpu : cpus) {
+    if (nodeOf(cpu) != node) {
+      return true;
+    }
+  }
+  /* Where the thread allocates is only a preference, the CPUs are what
+  was asked for */
+  if (node >= 0) {
+    preferNode(node);
+  }
+  return true;
+}
+
+auto ThreadPlacement::nodeOf(int cpu) const -> int {
+  auto node = cpuNodes.find(cpu);
+  return node == cpuNodes.end() ? -1 : node->second;
+}
+
+auto ThreadPlacement::loadTopology(const std::string& nodeDirectory) \
+    -> bool {
+  cpuNodes.clear();
+  DIR* directory = opendir(nodeDirectory.c_str());
+  if (directory == nullptr) {
+    return false;
+  }
+  while (struct dirent* entry = readdir(directory)) {
+    std::string name = entry->d_name;
+    int node = 0;
+    if (name.compare(0, 4, "node") != 0 || !parseCpu(name.substr(4), node)) {
+      continue;
+    }
+    std::ifstream file(nodeDirectory + "/" + name + "/cpulist");
+    std::string line;
+    std::vector<int> cpus;
+    /* A node without CPUs has an empty list */
+    if (std::getline(file, line) && parseCpuList(line, cpus)) {
+      for (int cpu : cpus) {
+        cpuNodes[cpu] = node;
+      }
+    }
+  }
+  closedir(directory);
+  return !cpuNodes.empty();
+}
+
+auto ThreadPlacement::describe() const -> std::string {
+  std::ostringstream description;
+  for (int role = 0; role < kThreadRoles; ++role) {
+    const std::vector<int>& cpus = roleCpus[role];
+    if (cpus.empty()) {
+      continue;
+    }
+    std::set<int> nodes;
+    for (int cpu : cpus) {
+      nodes.insert(nodeOf(cpu));
+    }
+    if (description.tellp() > 0) {
+      description << ", ";
+    }
+    description << kRoleNames[role] << " " << formatCpuList(cpus);
+    if (nodes.count(-1) == 0) {
+      description << (nodes.size() > 1 ? " (nodes " : " (node ") \
+        << formatCpuList(std::vector<int>(nodes.begin(), nodes.end())) \
+        << ")";
+    }
+  }
+  return description.str();
+}
+
+auto ThreadPlacement::parseCpuList(const std::string& text, \
+                                   std::vector<int>& cpus) -> bool {
+  cpus.clear();
+  std::set<int> seen;
+  std::istringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    /* Lines read from sysfs end with a newline */
+    item.erase(item.find_last_not_of(" \n") + 1);
+    size_t dash = item.find('-');
+    int first = 0;
+    int last = 0;
+    if (dash == std::string::npos) {
+      if (!parseCpu(item, first)) {
+        return false;
+      }
+      last = first;
+    } else if (!parseCpu(item.substr(0, dash), first) || \
+               !parseCpu(item.substr(dash + 1), last) || last < first) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      if (seen.insert(cpu).second) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return !cpus.empty();
+}
+
+auto ThreadPlacement::formatCpuList(std::vector<int> cpus) -> std::string {
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  std::ostringstream list;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    size_t last = i;
+    while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) {
+      last += 1;
+    }
+    list << (i > 0 ? "," : "") << cpus[i];
+    if (last > i) {
+      list << "-" << cpus[last];
+    }
+    i = last;
+  }
+  return list.str();
+}
+
+auto ThreadPlacement::currentCpus() -> std::vector<int> {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  /* Thread 0 is the calling thread */
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return cpus;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+auto ThreadPlacement::setCurrentCpus(const std::vector<int>& cpus) -> bool {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+auto ThreadPlacement::preferNode(int node) -> bool {
+  if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long))) {
+    return false;
+  }
+  /* The glibc has no wrapper, and libnuma is not needed for one node */
+  unsigned long nodes = 1UL << node;
+  return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodes, \
+                 8 * sizeof(nodes) + 1) == 0;
+}
+
+ScopedPlacement::ScopedPlacement(const ThreadPlacement& placement, \
+                                 ThreadRole role) {
+  if (!placement.isPinned(role)) {
+    return;
+  }
+  previousCpus = ThreadPlacement::currentCpus();
+  ThreadPlacement::setCurrentCpus(placement.getCpus(role));
+}
+
+ScopedPlacement::~ScopedPlacement() {
+  if (!previousCpus.empty()) {
+    ThreadPlacement::setCurrentCpus(previousCpus);
+  }
+}
@@ -42,6 +42,7 @@
 Transformation :: Transformation() {
   endFrame = cv::Mat::eye(4, 4, CV_32F);
   baseFrame = cv::Mat::eye(4, 4, CV_32F);
+  updateEndToBase();
 }
 
 /**
@@ -53,6 +54,7 @@ Transformation :: Transformation() {
 Transformation :: Transformation(cv::Mat base, cv::Mat end) {
   endFrame = end;
   baseFrame = base;
+  updateEndToBase();
 }
 
 /** 
@@ -165,6 +167,63 @@ auto Transformation :: cameraToImage(cv::Mat intrinsic, \
   }
 }
 
+/**
+ * @brief Function to move an image point through the end to base
+ *        transformation
+ *
+ * @param intrinsic Intrinsic matrix of the camera
+ * @param intrinsicInverse Inverse of the intrinsic matrix
+ * @param point Point in image coordinates
+ *
+ * @return Transformed point in image coordinates
+ */
+auto Transformation :: transformImagePoint(const cv::Matx33f& intrinsic, \
+        const cv::Matx33f& intrinsicInverse, \
+        cv::Point2f point) -> cv::Point2f {
+  /* Normalized point in camera coordinates */
+  float camera[4];
+  for (int row = 0; row < 3; ++row) {
+    camera[row] = intrinsicInverse(row, 0) * point.x + \
+                  intrinsicInverse(row, 1) * point.y + intrinsicInverse(row, 2);
+  }
+  camera[0] /= camera[2];
+  camera[1] /= camera[2];
+  camera[2] = 1;
+  camera[3] = 1;
+  /* Point in base frame */
+  float base[3];
+  for (int row = 0; row < 3; ++row) {
+    base[row] = 0;
+    for (int col = 0; col < 4; ++col) {
+      base[row] += endToBaseFrame(row, col) * camera[col];
+    }
+  }
+  /* Back to normalized image coordinates */
+  float image[3];
+  for (int row = 0; row < 3; ++row) {
+    image[row] = intrinsic(row, 0) * base[0] + intrinsic(row, 1) * base[1] + \
+                 intrinsic(row, 2) * base[2];
+  }
+  return cv::Point2f(image[0] / image[2], image[1] / image[2]);
+}
+
+/**
+ * @brief Computes the end to base transformation from the frames
+ *
+ * @return void
+ */
+auto Transformation :: updateEndToBase() -> void {
+  cv::Mat Rbase = baseFrame(cv::Rect(0, 0, 3, 3));
+  cv::Mat Tbase = baseFrame(cv::Rect(3, 0, 1, 3));
+  cv::Mat RInvbase = Rbase.inv();
+  cv::Mat TInvbase = - RInvbase * Tbase;
+  cv::Mat baseInv = cv::Mat::eye(4, 4, CV_32F);
+  RInvbase.copyTo(baseInv(cv::Rect(0, 0, 3, 3)));
+  TInvbase.copyTo(baseInv(cv::Rect(3, 0, 1, 3)));
+  cv::Mat tf = baseInv * endFrame;
+  endToBaseFrame = tf;
+}
+
 /**
  * @brief Function to return base frame
  *
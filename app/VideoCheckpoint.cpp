@@ -0,0 +1,243 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      VideoCheckpoint.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for VideoCheckpoint class
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "VideoCheckpoint.hpp"
+
+namespace {
+/* First line of the state file, with the version of the format */
+const char kHeader[] = "hodm-checkpoint 1";
+
+/**
+ * @brief Writes a whole buffer to a file descriptor at an offset
+ *
+ * @return false if it can't be written
+ */
+bool writeAll(int descriptor, const char* data, size_t size, off_t offset) {
+  while (size > 0) {
+    ssize_t written = pwrite(descriptor, data, size, offset);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+    offset += written;
+  }
+  return true;
+}
+}  // namespace
+
+VideoCheckpoint::VideoCheckpoint() {
+}
+
+VideoCheckpoint::~VideoCheckpoint() {
+  close();
+}
+
+auto VideoCheckpoint::open(const std::string& path, uint64_t jobKey, \
+        bool resume, CheckpointState& state, \
+        std::vector<Detection>& detections) -> bool {
+  close();
+  statePath = path;
+  detectionsPath = path + ".detections";
+  key = jobKey;
+  resumed = false;
+  state = CheckpointState();
+  detections.clear();
+  if (resume && readState(jobKey, state)) {
+    resumed = readDetections(state.detectionCount, detections);
+    if (!resumed) {
+      state = CheckpointState();
+      detections.clear();
+    }
+  }
+  if (!resumed) {
+    /* A new job, the detections of an earlier one are dropped */
+    detectionsFile = ::open(detectionsPath.c_str(), \
+                            O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    committed = 0;
+    if (detectionsFile == -1) {
+      return false;
+    }
+    return commit(state, detections.data(), detections.size());
+  }
+  return true;
+}
+
+auto VideoCheckpoint::isOpen() const -> bool {
+  return detectionsFile != -1;
+}
+
+auto VideoCheckpoint::isResumed() const -> bool {
+  return resumed;
+}
+
+auto VideoCheckpoint::readState(uint64_t jobKey, \
+                                CheckpointState& state) const -> bool {
+  std::ifstream file(statePath);
+  std::string line;
+  if (!std::getline(file, line) || line != kHeader) {
+    return false;
+  }
+  std::string field;
+  uint64_t fileKey = 0;
+  size_t keyCount = 0;
+  file >> field >> std::hex >> fileKey >> std::dec;
+  if (field != "job" || fileKey != jobKey) {
+    return false;
+  }
+  file >> field >> state.nextFrameID;
+  if (field != "next-frame") {
+    return false;
+  }
+  file >> field >> state.keyFrameID;
+  if (field != "key-frame") {
+    return false;
+  }
+  file >> field >> state.detectionCount;
+  if (field != "detections") {
+    return false;
+  }
+  file >> field >> state.segmentIndex;
+  if (field != "segment") {
+    return false;
+  }
+  file >> field >> keyCount;
+  if (field != "key-detections" || !file) {
+    return false;
+  }
+  state.keyDetections.resize(keyCount);
+  for (auto& detection : state.keyDetections) {
+    file >> detection.frameID >> detection.x1 >> detection.y1 \
+      >> detection.x2 >> detection.y2 >> detection.score \
+      >> detection.classId >> detection.trackID;
+  }
+  return static_cast<bool>(file) && state.nextFrameID >= 0;
+}
+
+auto VideoCheckpoint::readDetections(uint64_t count, \
+        std::vector<Detection>& detections) -> bool {
+  detectionsFile = ::open(detectionsPath.c_str(), O_RDWR);
+  if (detectionsFile == -1) {
+    return false;
+  }
+  detections.resize(count);
+  size_t size = count * sizeof(Detection);
+  char* data = reinterpret_cast<char*>(detections.data());
+  size_t done = 0;
+  while (done < size) {
+    ssize_t bytes = read(detectionsFile, data + done, size - done);
+    if (bytes <= 0) {
+      break;
+    }
+    done += static_cast<size_t>(bytes);
+  }
+  /* Detections appended after the last state are not committed */
+  if (done < size || ftruncate(detectionsFile, size) != 0) {
+    ::close(detectionsFile);
+    detectionsFile = -1;
+    return false;
+  }
+  committed = count;
+  return true;
+}
+
+auto VideoCheckpoint::commit(CheckpointState& state, \
+        const Detection* detections, size_t count) -> bool {
+  if (!isOpen() || count < committed) {
+    return false;
+  }
+  /* The detections reach the disk before the state counting them. They
+  are written after the committed ones, so that a commit failing partway
+  is overwritten by the next one */
+  if (!writeAll(detectionsFile, reinterpret_cast<const char*>(\
+      detections + committed), (count - committed) * sizeof(Detection), \
+      static_cast<off_t>(committed * sizeof(Detection))) || \
+      fsync(detectionsFile) != 0) {
+    return false;
+  }
+  committed = count;
+  state.detectionCount = committed;
+  std::ostringstream text;
+  text << kHeader << "\n" << "job " << std::hex << key << std::dec << "\n" \
+    << "next-frame " << state.nextFrameID << "\n" \
+    << "key-frame " << state.keyFrameID << "\n" \
+    << "detections " << state.detectionCount << "\n" \
+    << "segment " << state.segmentIndex << "\n" \
+    << "key-detections " << state.keyDetections.size() << "\n";
+  text.precision(9);
+  for (const auto& detection : state.keyDetections) {
+    text << detection.frameID << " " << detection.x1 << " " << detection.y1 \
+      << " " << detection.x2 << " " << detection.y2 << " " \
+      << detection.score << " " << detection.classId << " " \
+      << detection.trackID << "\n";
+  }
+  /* Written next to the state and renamed, so that an interrupted commit
+  leaves the previous checkpoint */
+  std::string temporaryPath = statePath + ".tmp";
+  int file = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, \
+                    0644);
+  if (file == -1) {
+    return false;
+  }
+  std::string content = text.str();
+  bool written = writeAll(file, content.data(), content.size(), 0) && \
+                 fsync(file) == 0;
+  ::close(file);
+  if (!written || std::rename(temporaryPath.c_str(), statePath.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+auto VideoCheckpoint::finish() -> void {
+  if (!isOpen()) {
+    return;
+  }
+  close();
+  std::remove(statePath.c_str());
+  std::remove(detectionsPath.c_str());
+}
+
+auto VideoCheckpoint::close() -> void {
+  if (detectionsFile != -1) {
+    ::close(detectionsFile);
+    detectionsFile = -1;
+  }
+}
@@ -30,6 +30,7 @@
  * @brief     Definition for VisionModule class
  */
 
+#include <algorithm>
 #include <iostream>
 
 #include "VisionModule.hpp"
@@ -72,11 +73,31 @@ auto VisionModule::reshape(cv::Mat image, \
   return resizedImage;
 }
 
-std::vector< std::vector<int> > VisionModule::nonMaximalSuppression(\
+auto VisionModule::applyGaussianFilter(const cv::Mat& image, \
+        cv::Size kernelDim, float sigma, cv::Mat& smoothenImage) -> void {
+  cv::GaussianBlur(image, smoothenImage, kernelDim, sigma, sigma);
+}
+
+auto VisionModule::applyFilter(const cv::Mat& image, cv::Size kernelDim, \
+        cv::Mat& smoothenImage) -> void {
+  cv::blur(image, smoothenImage, kernelDim, cv::Point(-1, -1));
+}
+
+auto VisionModule::applyMedianFilter(const cv::Mat& image, int kernelDim, \
+        cv::Mat& smoothenImage) -> void {
+  cv::medianBlur(image, smoothenImage, kernelDim);
+}
+
+auto VisionModule::reshape(const cv::Mat& image, cv::Size size, \
+        cv::Mat& resizedImage) -> void {
+  cv::resize(image, resizedImage, size, 0.0, 0.0);
+}
+
+std::vector<Detection> VisionModule::nonMaximalSuppression(\
         cv::Mat& frame, std::vector<cv::Rect>& predictedBoxes, \
         std::vector<float> confidenceScores, std::vector<int> classIds, \
         int frameID) {
-  std::vector< std::vector<int> > finalDetections;
+  std::vector<Detection> finalDetections;
   std::vector<int> indexes;
   /* Non Maximal Suppression Algorithm that removes the bounding boxes
   with significant overlap */
@@ -88,16 +109,85 @@ std::vector< std::vector<int> > VisionModule::nonMaximalSuppression(\
       /* Calculating bottom right corner coordinates using the width,
       height and top left corner's information */
       int bottomRightX = rectangle_.x + rectangle_.width;
-      if (bottomRightX > 416) bottomRightX = 416;
+      if (bottomRightX > frame.cols) bottomRightX = frame.cols;
       int bottomRightY = rectangle_.y + rectangle_.height;
-      if (bottomRightY > 416) bottomRightY = 416;
-      /* Drawing rectangles on the image */
-      cv::rectangle(frame, cv::Point(rectangle_.x, rectangle_.y), \
-      cv::Point(bottomRightX, bottomRightY), cv::Scalar(0, 170, 50), 3);
-      std::vector<int> temp{frameID, rectangle_.x, rectangle_.y, \
-                  bottomRightX, bottomRightY};
-      finalDetections.push_back(temp);
+      if (bottomRightY > frame.rows) bottomRightY = frame.rows;
+      Detection detection;
+      detection.frameID = frameID;
+      detection.x1 = rectangle_.x;
+      detection.y1 = rectangle_.y;
+      detection.x2 = bottomRightX;
+      detection.y2 = bottomRightY;
+      detection.score = confidenceScores[index];
+      detection.classId = classIds[index];
+      finalDetections.push_back(detection);
     }
   }
   return finalDetections;
 }
+
+auto VisionModule::nonMaximalSuppression(cv::Size frameSize, int frameID, \
+        const std::vector<cv::Rect>& predictedBoxes, \
+        const std::vector<float>& confidenceScores, \
+        const std::vector<int>& classIds, \
+        std::vector<Detection>& detections) -> void {
+  detections.clear();
+  scoreOrder.clear();
+  keptIndices.clear();
+  for (size_t i = 0; i < confidenceScores.size(); ++i) {
+    if (confidenceScores[i] > confidenceThreshold) {
+      scoreOrder.push_back(static_cast<int>(i));
+    }
+  }
+  /* Highest scores first, ties broken by the order of the boxes */
+  std::sort(scoreOrder.begin(), scoreOrder.end(), \
+      [&confidenceScores](int first, int second) {
+        if (confidenceScores[first] != confidenceScores[second]) {
+          return confidenceScores[first] > confidenceScores[second];
+        }
+        return first < second;
+      });
+  for (int index : scoreOrder) {
+    const cv::Rect& box = predictedBoxes[index];
+    bool keep = true;
+    for (int kept : keptIndices) {
+      const cv::Rect& keptBox = predictedBoxes[kept];
+      /* Intersection over union of the two boxes */
+      double intersection = (box & keptBox).area();
+      double unionArea = box.area() + keptBox.area() - intersection;
+      if (unionArea > 0 && intersection / unionArea > nmsThreshold) {
+        keep = false;
+        break;
+      }
+    }
+    if (!keep) {
+      continue;
+    }
+    keptIndices.push_back(index);
+    if (classIds[index] == 0) {
+      Detection detection;
+      detection.frameID = frameID;
+      detection.x1 = box.x;
+      detection.y1 = box.y;
+      detection.x2 = std::min(box.x + box.width, frameSize.width);
+      detection.y2 = std::min(box.y + box.height, frameSize.height);
+      detection.score = confidenceScores[index];
+      detection.classId = classIds[index];
+      detections.push_back(detection);
+    }
+  }
+}
+
+auto VisionModule::drawDetections(cv::Mat& frame, \
+        const std::vector<Detection>& detections) -> void {
+  for (const auto& detection : detections) {
+    /* Drawing rectangles on the image */
+    cv::rectangle(frame, cv::Point(detection.x1, detection.y1), \
+    cv::Point(detection.x2, detection.y2), cv::Scalar(0, 170, 50), 3);
+  }
+}
+
+auto VisionModule::setThresholds(float confidence, float nms) -> void {
+  confidenceThreshold = confidence;
+  nmsThreshold = nms;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      YuvConverter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for YuvConverter class
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "YuvConverter.hpp"
+
+namespace {
+/**
+ * @brief Pixel of a frame converted to RGB
+ */
+struct Rgb {
+  float red;
+  float green;
+  float blue;
+};
+
+/**
+ * @brief Converts one pixel with the BT.601 limited range coefficients of
+ *        cv::cvtColor, saturated to [0, 255] as the 8 bit BGR image would be
+ */
+inline Rgb toRgb(int y, int u, int v) {
+  float luma = 1.164f * static_cast<float>(std::max(0, y - 16));
+  float cb = static_cast<float>(u - 128);
+  float cr = static_cast<float>(v - 128);
+  Rgb pixel;
+  pixel.red = std::min(255.0f, std::max(0.0f, luma + 1.596f * cr));
+  pixel.green = std::min(255.0f, std::max(0.0f, \
+                         luma - 0.813f * cr - 0.391f * cb));
+  pixel.blue = std::min(255.0f, std::max(0.0f, luma + 2.018f * cb));
+  return pixel;
+}
+
+/**
+ * @brief Reads and converts one source pixel, the layout being a template
+ *        parameter so that the loops don't branch on it
+ */
+template<YuvImage::Layout layout>
+inline Rgb sample(const YuvImage& image, int x, int y) {
+  const unsigned char* data = image.data;
+  int width = image.width;
+  int height = image.height;
+  if (layout == YuvImage::kNv12) {
+    const unsigned char* uv = data + width * height + \
+                              (y / 2) * width + (x / 2) * 2;
+    return toRgb(data[y * width + x], uv[0], uv[1]);
+  } else if (layout == YuvImage::kI420) {
+    const unsigned char* u = data + width * height;
+    const unsigned char* v = u + (width / 2) * (height / 2);
+    int chroma = (y / 2) * (width / 2) + x / 2;
+    return toRgb(data[y * width + x], u[chroma], v[chroma]);
+  } else {
+    const unsigned char* pair = data + y * width * 2 + (x / 2) * 4;
+    return toRgb(pair[(x & 1) * 2], pair[1], pair[3]);
+  }
+}
+
+/**
+ * @brief Blends and stores the four source pixels around every output
+ *        pixel
+ */
+template<YuvImage::Layout layout>
+void convertLayout(const YuvImage& image, int width, int height, \
+                   const std::vector<int>& columns, \
+                   const std::vector<float>& columnWeights, \
+                   const std::vector<int>& rows, \
+                   const std::vector<float>& rowWeights, float* planes) {
+  const size_t planeSize = static_cast<size_t>(width) * height;
+  float* red = planes;
+  float* green = red + planeSize;
+  float* blue = green + planeSize;
+  const float scale = 1 / 255.0f;
+  for (int y = 0; y < height; ++y) {
+    int top = rows[y];
+    int bottom = std::min(top + 1, image.height - 1);
+    float down = rowWeights[y];
+    for (int x = 0; x < width; ++x) {
+      int left = columns[x];
+      int right = std::min(left + 1, image.width - 1);
+      float across = columnWeights[x];
+      /* Only the four source pixels around the output pixel are
+      converted */
+      Rgb topLeft = sample<layout>(image, left, top);
+      Rgb topRight = sample<layout>(image, right, top);
+      Rgb bottomLeft = sample<layout>(image, left, bottom);
+      Rgb bottomRight = sample<layout>(image, right, bottom);
+      float wTopLeft = (1 - across) * (1 - down);
+      float wTopRight = across * (1 - down);
+      float wBottomLeft = (1 - across) * down;
+      float wBottomRight = across * down;
+      size_t index = static_cast<size_t>(y) * width + x;
+      red[index] = scale * (wTopLeft * topLeft.red + \
+          wTopRight * topRight.red + wBottomLeft * bottomLeft.red + \
+          wBottomRight * bottomRight.red);
+      green[index] = scale * (wTopLeft * topLeft.green + \
+          wTopRight * topRight.green + wBottomLeft * bottomLeft.green + \
+          wBottomRight * bottomRight.green);
+      blue[index] = scale * (wTopLeft * topLeft.blue + \
+          wTopRight * topRight.blue + wBottomLeft * bottomLeft.blue + \
+          wBottomRight * bottomRight.blue);
+    }
+  }
+}
+
+/**
+ * @brief Source index and weight of every output index, following
+ *        cv::resize with INTER_LINEAR
+ */
+void linearTable(int sourceSize, int size, std::vector<int>& indexes, \
+                 std::vector<float>& weights) {
+  indexes.resize(size);
+  weights.resize(size);
+  double scale = static_cast<double>(sourceSize) / size;
+  for (int i = 0; i < size; ++i) {
+    double position = (i + 0.5) * scale - 0.5;
+    int index = static_cast<int>(std::floor(position));
+    double weight = position - index;
+    if (index < 0) {
+      index = 0;
+      weight = 0;
+    }
+    if (index >= sourceSize - 1) {
+      index = sourceSize - 1;
+      weight = 0;
+    }
+    indexes[i] = index;
+    weights[i] = static_cast<float>(weight);
+  }
+}
+}  // namespace
+
+auto YuvConverter::isValid(const YuvImage& image) -> bool {
+  return image.data != nullptr && image.width > 0 && image.height > 0 && \
+         image.width % 2 == 0 && image.height % 2 == 0;
+}
+
+auto YuvConverter::frameSize(YuvImage::Layout layout, int width, \
+                             int height) -> size_t {
+  size_t pixels = static_cast<size_t>(width) * height;
+  return layout == YuvImage::kYuyv ? 2 * pixels : pixels + pixels / 2;
+}
+
+auto YuvConverter::convertToPlanes(const YuvImage& image, int width, \
+                                   int height, float* planes) -> void {
+  linearTable(image.width, width, columns, columnWeights);
+  linearTable(image.height, height, rows, rowWeights);
+  switch (image.layout) {
+    case YuvImage::kNv12:
+      convertLayout<YuvImage::kNv12>(image, width, height, columns, \
+          columnWeights, rows, rowWeights, planes);
+      break;
+    case YuvImage::kI420:
+      convertLayout<YuvImage::kI420>(image, width, height, columns, \
+          columnWeights, rows, rowWeights, planes);
+      break;
+    default:
+      convertLayout<YuvImage::kYuyv>(image, width, height, columns, \
+          columnWeights, rows, rowWeights, planes);
+      break;
+  }
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      client.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Command line client of the detection server (hodm-client)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/DetectionClient.hpp"
+#include "../include/LatencyHistogram.hpp"
+
+namespace {
+/**
+ * @brief Options of the client
+ */
+struct ClientOptions {
+  std::string socketPath = "/tmp/hodm.sock";
+  /* Size of the raw frames, 0 when the files are encoded images */
+  uint32_t rawWidth = 0;
+  uint32_t rawHeight = 0;
+  /* Number of times every file is sent by every client */
+  int repeat = 1;
+  /* Number of concurrent connections */
+  int clients = 1;
+  std::vector<std::string> files;
+};
+
+void printUsage(const char* application) {
+  std::cout << "Usage: " << application \
+    << " [options] <image files...>\n" \
+    << "  --socket <path>  socket of the server (default /tmp/hodm.sock)\n" \
+    << "  --raw <W>x<H>    files hold raw BGR frames of W x H pixels\n" \
+    << "  --repeat <n>     send every file n times per client\n" \
+    << "  --clients <n>    number of concurrent connections\n" \
+    << "With --repeat or --clients above 1 only the throughput and the " \
+    << "latency of the requests are printed." << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, ClientOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--socket" && hasValue) {
+      options.socketPath = argv[++i];
+    } else if (argument == "--raw" && hasValue) {
+      unsigned width = 0, height = 0;
+      if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || \
+          width == 0 || height == 0) {
+        return false;
+      }
+      options.rawWidth = width;
+      options.rawHeight = height;
+    } else if (argument == "--repeat" && hasValue) {
+      options.repeat = std::atoi(argv[++i]);
+    } else if (argument == "--clients" && hasValue) {
+      options.clients = std::atoi(argv[++i]);
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      options.files.push_back(argument);
+    }
+  }
+  return !options.files.empty() && options.repeat > 0 && options.clients > 0;
+}
+
+bool readFile(const std::string& path, std::vector<char>& content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(file), \
+                 std::istreambuf_iterator<char>());
+  return true;
+}
+
+/**
+ * @brief Sends one file and waits for its detections
+ */
+uint16_t sendFile(DetectionClient& client, const ClientOptions& options, \
+                  const std::vector<char>& content, \
+                  std::vector<Detection>& detections) {
+  if (options.rawWidth > 0) {
+    if (content.size() != \
+        static_cast<size_t>(options.rawWidth) * options.rawHeight * 3) {
+      return protocol::kBadRequest;
+    }
+    return client.detectRaw(content.data(), options.rawWidth, \
+                            options.rawHeight, detections);
+  }
+  return client.detectEncoded(content.data(), content.size(), detections);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  ClientOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  std::vector< std::vector<char> > contents(options.files.size());
+  for (size_t i = 0; i < options.files.size(); ++i) {
+    if (!readFile(options.files[i], contents[i])) {
+      std::cout << "Can't read " << options.files[i] << std::endl;
+      return 1;
+    }
+  }
+  if (options.repeat == 1 && options.clients == 1) {
+    DetectionClient client;
+    if (!client.connect(options.socketPath)) {
+      std::cout << "Can't connect to " << options.socketPath << std::endl;
+      return 1;
+    }
+    std::vector<Detection> detections;
+    for (size_t i = 0; i < contents.size(); ++i) {
+      uint16_t status = sendFile(client, options, contents[i], detections);
+      std::cout << options.files[i] << ": ";
+      if (status != protocol::kOk) {
+        std::cout << "error " << status << std::endl;
+        continue;
+      }
+      std::cout << detections.size() << " detections" << std::endl;
+      for (const auto& detection : detections) {
+        std::cout << "  " << detection.x1 << " " << detection.y1 << " " \
+          << detection.x2 << " " << detection.y2 << " score " \
+          << detection.score << std::endl;
+      }
+    }
+    return 0;
+  }
+
+  /* Throughput test, every client sends all the files repeat times */
+  LatencyHistogram latencies;
+  uint64_t failures = 0;
+  std::mutex mutex;
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  std::vector<std::thread> threads;
+  for (int c = 0; c < options.clients; ++c) {
+    threads.push_back(std::thread([&]() {
+      DetectionClient client;
+      LatencyHistogram clientLatencies;
+      uint64_t clientFailures = 0;
+      std::vector<Detection> detections;
+      if (client.connect(options.socketPath)) {
+        for (int r = 0; r < options.repeat; ++r) {
+          for (const auto& content : contents) {
+            Clock::time_point sent = Clock::now();
+            if (sendFile(client, options, content, detections) != \
+                protocol::kOk) {
+              clientFailures += 1;
+              continue;
+            }
+            clientLatencies.record(std::chrono::duration<double, \
+                std::milli>(Clock::now() - sent).count());
+          }
+        }
+      } else {
+        clientFailures = options.repeat * contents.size();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      latencies.merge(clientLatencies);
+      failures += clientFailures;
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - \
+                                                 start).count();
+  std::cout << std::fixed << std::setprecision(2) << latencies.count() \
+    << " requests (" << failures << " failed) in " << seconds << " s: " \
+    << latencies.count() / seconds << " requests/s, latency mean " \
+    << latencies.mean() << " ms, p50 " << latencies.percentile(0.50) \
+    << " ms, p99 " << latencies.percentile(0.99) << " ms" << std::endl;
+  return failures == 0 ? 0 : 2;
+}
@@ -0,0 +1,334 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      evaluate.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Measures the accuracy and the throughput of configurations
+ *            of the pipeline on labelled images (hodm-eval)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../include/AccuracyEvaluator.hpp"
+#include "../include/DetectionInterpolator.hpp"
+#include "../include/DetectionModule.hpp"
+#include "../include/ImageLoader.hpp"
+
+namespace {
+/**
+ * @brief Darknet model files and the name shown for them
+ */
+struct Model {
+  std::string name;
+  std::string configuration;
+  std::string weights;
+};
+
+/**
+ * @brief Options of the evaluation, every combination of the lists is
+ *        a configuration
+ */
+struct EvaluateOptions {
+  std::string directory;
+  std::vector<int> inputSizes = {416};
+  std::vector<char> filters = {'G'};
+  std::vector<float> confidences = {0.9f};
+  std::vector<float> nmsThresholds = {0.9f};
+  std::vector<int> strides = {1};
+  std::vector<Model> models;
+  float matchIou = 0.5f;
+  int threads = 0;
+  std::string csv;
+};
+
+void printUsage(const char* application) {
+  std::cout << "Usage: " << application << " [options] <directory>\n" \
+    << "  Every image of the directory is labelled by a text file of the " \
+    << "same name,\n  one '<x1> <y1> <x2> <y2> [class]' line per object\n" \
+    << "  --sizes <n,n,...>       input sizes (default 416)\n" \
+    << "  --filters <G,M,B>       noise filters (default G)\n" \
+    << "  --confidence <f,f,...>  confidence thresholds (default 0.9)\n" \
+    << "  --nms <f,f,...>         NMS thresholds (default 0.9)\n" \
+    << "  --strides <n,n,...>     detect one image in n of the sorted " \
+    << "images, as\n                          frames of a video " \
+    << "(default 1)\n" \
+    << "  --model <cfg> <weights> model to evaluate, repeated for " \
+    << "several\n                          (default " \
+    << "../modelFiles/yolov3.*)\n" \
+    << "  --match-iou <f>         overlap of a true positive (default " \
+    << "0.5)\n" \
+    << "  --threads <n>           OpenCV threads (default: OpenCV's)\n" \
+    << "  --csv <file>            also write the results to file" \
+    << std::endl;
+}
+
+/**
+ * @brief Parses a comma separated list
+ */
+template <typename T>
+bool parseList(const std::string& text, std::vector<T>& values) {
+  values.clear();
+  std::istringstream fields(text);
+  std::string field;
+  while (std::getline(fields, field, ',')) {
+    std::istringstream value(field);
+    T parsed;
+    std::string rest;
+    if (!(value >> parsed) || value >> rest) {
+      return false;
+    }
+    values.push_back(parsed);
+  }
+  return !values.empty();
+}
+
+/**
+ * @brief Gives the name of a model, that of its weights without the
+ *        directory and the extension
+ */
+std::string modelName(const std::string& weights) {
+  size_t start = weights.rfind('/');
+  start = start == std::string::npos ? 0 : start + 1;
+  size_t dot = weights.rfind('.');
+  if (dot == std::string::npos || dot < start) {
+    dot = weights.size();
+  }
+  return weights.substr(start, dot - start);
+}
+
+bool parseArguments(int argc, char** argv, EvaluateOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    bool valid = true;
+    if (argument == "--sizes" && hasValue) {
+      valid = parseList(argv[++i], options.inputSizes);
+      for (int size : options.inputSizes) {
+        valid = valid && size >= 32 && size % 32 == 0;
+      }
+    } else if (argument == "--filters" && hasValue) {
+      valid = parseList(argv[++i], options.filters);
+      for (char filter : options.filters) {
+        valid = valid && (filter == 'G' || filter == 'M' || filter == 'B');
+      }
+    } else if (argument == "--confidence" && hasValue) {
+      valid = parseList(argv[++i], options.confidences);
+    } else if (argument == "--nms" && hasValue) {
+      valid = parseList(argv[++i], options.nmsThresholds);
+    } else if (argument == "--strides" && hasValue) {
+      valid = parseList(argv[++i], options.strides);
+      for (int stride : options.strides) {
+        valid = valid && stride >= 1;
+      }
+    } else if (argument == "--model" && i + 2 < argc) {
+      Model model;
+      model.configuration = argv[i + 1];
+      model.weights = argv[i + 2];
+      model.name = modelName(model.weights);
+      options.models.push_back(model);
+      i += 2;
+    } else if (argument == "--match-iou" && hasValue) {
+      options.matchIou = static_cast<float>(std::atof(argv[++i]));
+      valid = options.matchIou > 0 && options.matchIou <= 1;
+    } else if (argument == "--threads" && hasValue) {
+      options.threads = std::atoi(argv[++i]);
+    } else if (argument == "--csv" && hasValue) {
+      options.csv = argv[++i];
+    } else if (!argument.empty() && argument[0] != '-') {
+      options.directory = argument;
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      return false;
+    }
+  }
+  if (options.models.empty()) {
+    options.models.push_back({"yolov3", "", ""});
+  }
+  return !options.directory.empty();
+}
+
+/**
+ * @brief Detects the images with one configuration, the images between
+ *        two detected ones getting the interpolated boxes
+ *
+ * @param module Module set up with the configuration
+ * @param images Images, in the order of the frames of a video
+ * @param inputSize Width and height of the network input
+ * @param stride One image in stride is detected
+ * @param detections Filled with the detections of every image, in pixels
+ *                   of the image
+ *
+ * @return Images detected per second
+ */
+double detectImages(DetectionModule& module, \
+                    const std::vector<cv::Mat>& images, int inputSize, \
+                    int stride, \
+                    std::vector<std::vector<Detection>>& detections) {
+  typedef std::chrono::steady_clock Clock;
+  int count = static_cast<int>(images.size());
+  detections.assign(images.size(), std::vector<Detection>());
+  DetectionInterpolator interpolator;
+  int keyID = -1;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < count; i += stride) {
+    module.detect(images[i], i);
+    /* The boxes are given at the size of the network input */
+    for (Detection detection : module.getFrameDetections()) {
+      detection.x1 = detection.x1 * images[i].cols / inputSize;
+      detection.y1 = detection.y1 * images[i].rows / inputSize;
+      detection.x2 = detection.x2 * images[i].cols / inputSize;
+      detection.y2 = detection.y2 * images[i].rows / inputSize;
+      detections[i].push_back(detection);
+    }
+    if (keyID >= 0 && i - keyID > 1) {
+      interpolator.setKeyFrames(keyID, detections[keyID], i, detections[i]);
+      for (int j = keyID + 1; j < i; ++j) {
+        interpolator.interpolate(j, detections[j]);
+      }
+    }
+    keyID = i;
+  }
+  if (keyID >= 0 && keyID < count - 1) {
+    /* The boxes of the last detected image are held to the end */
+    interpolator.setKeyFrames(keyID, detections[keyID], count - 1, \
+                              detections[keyID]);
+    for (int j = keyID + 1; j < count; ++j) {
+      interpolator.interpolate(j, detections[j]);
+    }
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  return count / elapsed.count();
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  EvaluateOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  if (options.threads > 0) {
+    cv::setNumThreads(options.threads);
+  }
+  /* The images are decoded once and held, so that reading them is not
+  part of the throughput */
+  std::vector<std::string> imagePaths;
+  if (!ImageLoader::listImages(options.directory, imagePaths)) {
+    std::cout << options.directory << " is not a directory" << std::endl;
+    return 1;
+  }
+  std::vector<cv::Mat> images;
+  std::vector<std::vector<Detection>> labels;
+  for (const auto& imagePath : imagePaths) {
+    std::vector<Detection> imageLabels;
+    std::string labelPath = AccuracyEvaluator::labelPath(imagePath);
+    if (!AccuracyEvaluator::loadLabels(labelPath, imageLabels)) {
+      std::cout << "Skipping " << imagePath << ", no valid labels in " \
+        << labelPath << std::endl;
+      continue;
+    }
+    cv::Mat image = cv::imread(imagePath);
+    if (image.empty()) {
+      std::cout << "Skipping " << imagePath << ", can't be read" \
+        << std::endl;
+      continue;
+    }
+    images.push_back(image);
+    labels.push_back(imageLabels);
+  }
+  if (images.empty()) {
+    std::cout << "No labelled image in " << options.directory << std::endl;
+    return 1;
+  }
+  std::cout << "Evaluating on " << images.size() << " labelled images" \
+    << std::endl;
+  std::vector<EvaluationResult> results;
+  std::vector<std::vector<Detection>> detections;
+  for (const auto& model : options.models) {
+    /* One module per model, so that the network is read once */
+    DetectionModule module;
+    for (int inputSize : options.inputSizes) {
+      for (char filter : options.filters) {
+        for (float confidence : options.confidences) {
+          for (float nms : options.nmsThresholds) {
+            for (int stride : options.strides) {
+              RunOptions runOptions;
+              runOptions.headless = true;
+              runOptions.inputSize = inputSize;
+              runOptions.filterType = filter;
+              runOptions.confidenceThreshold = confidence;
+              runOptions.nmsThreshold = nms;
+              runOptions.frameStride = stride;
+              runOptions.modelConfiguration = model.configuration;
+              runOptions.modelWeights = model.weights;
+              module.setOptions(runOptions);
+              module.warmUp();
+              EvaluationResult result;
+              std::ostringstream configuration;
+              configuration << model.name << " size " << inputSize \
+                << " filter " << filter << " conf " << confidence \
+                << " nms " << nms << " stride " << stride;
+              result.configuration = configuration.str();
+              result.framesPerSecond = detectImages(module, images, \
+                  inputSize, stride, detections);
+              AccuracyEvaluator evaluator(options.matchIou);
+              for (size_t i = 0; i < images.size(); ++i) {
+                evaluator.addImage(labels[i], detections[i]);
+              }
+              result.metrics = evaluator.getMetrics();
+              std::cout << result.configuration << ": AP " \
+                << result.metrics.averagePrecision << ", " \
+                << result.framesPerSecond << " images/s" << std::endl;
+              results.push_back(result);
+            }
+          }
+        }
+      }
+    }
+  }
+  AccuracyEvaluator::markParetoFront(results);
+  std::cout << std::endl;
+  AccuracyEvaluator::printTable(results, std::cout);
+  if (!options.csv.empty()) {
+    std::ofstream csv(options.csv);
+    if (!csv) {
+      std::cout << "Can't write " << options.csv << std::endl;
+      return 1;
+    }
+    AccuracyEvaluator::writeCsv(results, csv);
+  }
+  return 0;
+}
@@ -30,15 +30,251 @@
  * @brief     Main application cpp file
  */
 
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <csignal>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include "../include/AsyncDetector.hpp"
 #include "../include/DetectionModule.hpp"
+#include "../include/DetectionServer.hpp"
+#include "../include/MetricsExporter.hpp"
+#include "../include/MetricsRegistry.hpp"
+#include "../include/ThreadPlacement.hpp"
 // #include "../include/VisionModule.hpp"
 #include "../include/IOHandler.hpp"
 
-int main() {
+namespace {
+/* Tuning profile read at startup if it is in the working directory */
+const char kTuningProfile[] = "hodm-tuning.conf";
+
+/* Set by SIGINT and SIGTERM to stop the server */
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+  stopRequested = 1;
+}
+
+/**
+ * @brief Creates the request handler of a connection thread
+ *
+ * The handler decodes the payload on the connection thread and waits for
+ * the detections of the shared AsyncDetector.
+ */
+DetectionServer::RequestHandler makeHandler(AsyncDetector& detector) {
+  return [&detector](const protocol::RequestHeader& header, \
+                     const std::vector<unsigned char>& payload, \
+                     std::vector<Detection>& detections) -> uint16_t {
+    cv::Mat image;
+    if (header.type == protocol::kEncodedImage) {
+      image = cv::imdecode(cv::Mat(1, static_cast<int>(payload.size()), \
+          CV_8UC1, const_cast<unsigned char*>(payload.data())), \
+          cv::IMREAD_COLOR);
+      if (image.empty()) {
+        return protocol::kDecodeError;
+      }
+    } else if (header.type == protocol::kRawBgrFrame) {
+      if (header.width == 0 || header.height == 0 || \
+          static_cast<uint64_t>(header.width) * header.height * 3 != \
+          payload.size()) {
+        return protocol::kBadRequest;
+      }
+      image = cv::Mat(static_cast<int>(header.height), \
+          static_cast<int>(header.width), CV_8UC3, \
+          const_cast<unsigned char*>(payload.data()));
+    } else {
+      return protocol::kBadRequest;
+    }
+    try {
+      detections = detector.submit(image, \
+          static_cast<int>(header.requestID)).get();
+    } catch (const std::exception&) {
+      return protocol::kServerError;
+    }
+    return protocol::kOk;
+  };
+}
+
+/**
+ * @brief Pins the main thread to the inference CPUs and starts the OpenCV
+ *        threads there, when the options pin threads
+ *
+ * OpenCV has a single pool of threads for the process, which inherit the
+ * CPUs of the thread starting them. Unless --threads is given, every
+ * worker uses as many OpenCV threads as it has inference CPUs.
+ */
+bool placeThreads(RunOptions& options, int workers) {
+  if (options.placement.empty()) {
+    return true;
+  }
+  std::vector<int> allowed = ThreadPlacement::currentCpus();
+  for (int role = 0; role < kThreadRoles; ++role) {
+    for (int cpu : options.placement.getCpus(static_cast<ThreadRole>(role))) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) == allowed.end()) {
+        std::cerr << "Error: CPU " << cpu << " can't be used, the process " \
+          << "runs on " << ThreadPlacement::formatCpuList(allowed) \
+          << std::endl;
+        return false;
+      }
+    }
+  }
+  if (!options.placement.pinCurrentThread(kInferenceThreads)) {
+    std::cerr << "Error: Can't pin the threads" << std::endl;
+    return false;
+  }
+  if (options.placement.isPinned(kInferenceThreads)) {
+    if (options.opencvThreads == 0) {
+      options.opencvThreads = \
+          options.placement.threadsPerWorker(kInferenceThreads, workers);
+      cv::setNumThreads(options.opencvThreads);
+    }
+    /* Starts the pool now, from the inference CPUs */
+    cv::parallel_for_(cv::Range(0, std::max(cv::getNumThreads(), 1)), \
+                      [](const cv::Range&) {});
+  }
+  std::cerr << "Threads pinned to " << options.placement.describe() \
+    << std::endl;
+  return true;
+}
+
+/**
+ * @brief Starts exporting the metrics when the options ask for it
+ *
+ * Messages go to the standard error, the standard output may carry the
+ * detections.
+ */
+bool startMetrics(const RunOptions& options, MetricsRegistry& registry, \
+                  MetricsExporter& exporter) {
+  if (options.metricsPort < 0 && options.metricsFile.empty()) {
+    return true;
+  }
+  registry.addProcessMetrics();
+  ScopedPlacement placement(options.placement, kOutputThreads);
+  if (!exporter.start(options.metricsPort, options.metricsFile, \
+                      options.metricsInterval)) {
+    std::cerr << "Error: Can't serve the metrics on port " \
+      << options.metricsPort << std::endl;
+    return false;
+  }
+  if (exporter.getPort() >= 0) {
+    std::cerr << "Metrics on http://127.0.0.1:" << exporter.getPort() \
+      << "/metrics" << std::endl;
+  }
+  return true;
+}
+
+/**
+ * @brief Serves detections on a Unix domain socket until SIGINT or
+ *        SIGTERM
+ */
+int runServer(const RunOptions& options, MetricsRegistry& registry) {
+  /* Every detector worker owns a network; twice as many connections are
+   * served so that decoding overlaps with the detection, and enough of
+   * them to fill the batches of every worker */
+  int connections = options.serverWorkers * std::max(2, options.maxBatch);
+  AsyncDetector detector(options, options.serverWorkers, connections, \
+                         &registry);
+  DetectionServer server([&detector]() { return makeHandler(detector); }, \
+                         connections);
+  bool started = false;
+  {
+    /* The connection threads decode the frames of the requests */
+    ScopedPlacement placement(options.placement, kPreprocessThreads);
+    started = server.start(options.serveSocket);
+  }
+  if (!started) {
+    std::cout << "Error: Can't listen on " << options.serveSocket \
+      << std::endl;
+    return 1;
+  }
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+  std::cout << "Serving detections on " << options.serveSocket << " with " \
+    << options.serverWorkers << " workers" << std::endl;
+  /* Read from the statistics of the server and detector when scraped */
+  registry.sample(MetricsRegistry::kCounter, "hodm_server_requests_total", \
+      "Requests answered, failed or not.", MetricsRegistry::Labels(), \
+      [&server]() { return server.getStats().requests; }, &server);
+  registry.sample(MetricsRegistry::kCounter, \
+      "hodm_server_failed_requests_total", "Requests answered with an " \
+      "error.", MetricsRegistry::Labels(), \
+      [&server]() { return server.getStats().failedRequests; }, &server);
+  registry.sample(MetricsRegistry::kGauge, \
+      "hodm_detector_frames_in_flight", "Frames submitted and not " \
+      "detected yet.", MetricsRegistry::Labels(), \
+      [&detector]() { return detector.inFlight(); }, &detector);
+  while (!stopRequested) {
+    usleep(100000);
+  }
+  registry.removeSamples(&server);
+  registry.removeSamples(&detector);
+  server.stop();
+  ServerStats stats = server.getStats();
+  std::cout << "Served " << stats.requests << " requests (" \
+    << stats.failedRequests << " failed) on " << stats.connections \
+    << " connections" << std::endl;
+  AsyncDetectorStats detectorStats = detector.getStats();
+  if (detectorStats.batches > 0) {
+    std::cout << "Detected " << detectorStats.framesCompleted \
+      << " frames in " << detectorStats.batches << " batches (mean size " \
+      << static_cast<double>(detectorStats.framesCompleted) / \
+         detectorStats.batches << "), queue delay p50 " \
+      << detectorStats.queueDelay.percentile(0.50) << " ms, p99 " \
+      << detectorStats.queueDelay.percentile(0.99) << " ms" << std::endl;
+  }
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    IOHandler io;
+    RunOptions options;
+    /* Options measured on this host by hodm-tune, the command line
+     * overrides them */
+    if (std::ifstream(kTuningProfile).good() && \
+        !io.loadTuningProfile(kTuningProfile, options)) {
+        std::cerr << "Warning: " << kTuningProfile << " is not a valid " \
+          << "tuning profile" << std::endl;
+    }
+    if (!io.parseArguments(argc, argv, options)) {
+        return 1;
+    }
+    if (options.opencvThreads > 0) {
+        cv::setNumThreads(options.opencvThreads);
+    }
+    /* Only the server has several detection workers */
+    if (!placeThreads(options, options.serveSocket.empty() ? 1 : \
+                      options.serverWorkers)) {
+        return 1;
+    }
+    /* Outlive the modules, which report to the registry */
+    MetricsRegistry registry;
+    MetricsExporter exporter(registry);
+    if (!startMetrics(options, registry, exporter)) {
+        return 1;
+    }
+    if (!options.serveSocket.empty()) {
+        return runServer(options, registry);
+    }
+    if (!options.streamInput.empty()) {
+        /* Standard output carries the detections only */
+        DetectionModule module;
+        module.setOptions(options);
+        if (exporter.isRunning()) {
+            module.setMetrics(&registry);
+        }
+        return module.processStream(options.streamInput) ? 0 : 1;
+    }
     std::cout << "Welcome to the Vision Module" << std::endl;
     DetectionModule module;
+    module.setOptions(options);
+    if (exporter.isRunning()) {
+        module.setMetrics(&registry);
+    }
     module.getInput();
     return 0;
 }
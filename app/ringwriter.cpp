@@ -0,0 +1,179 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ringwriter.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Writes the frames of a video or camera into a shared memory
+ *            ring (hodm-ringwriter)
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include "../include/FrameRing.hpp"
+
+namespace {
+/* Set by SIGINT and SIGTERM to stop writing */
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+  stopRequested = 1;
+}
+
+/**
+ * @brief Options of the writer
+ */
+struct WriterOptions {
+  std::string ringName = "/hodm-frames";
+  uint32_t slots = 8;
+  /* Frames per second, 0 to write as fast as frames are read */
+  double fps = 0;
+  /* Size of the frames in the ring, 0 to keep the size of the source */
+  int width = 0;
+  int height = 0;
+  /* Start the video again at its end */
+  bool loop = false;
+  std::string source;
+};
+
+void printUsage(const char* application) {
+  std::cout << "Usage: " << application \
+    << " [options] <video file | camera ID>\n" \
+    << "  --name <name>    name of the ring (default /hodm-frames)\n" \
+    << "  --slots <n>      frames held by the ring (default 8)\n" \
+    << "  --fps <f>        frames written per second (default: as fast " \
+    << "as they are read)\n" \
+    << "  --size <W>x<H>   size of the frames in the ring (default: size " \
+    << "of the source)\n" \
+    << "  --loop           start the video again at its end" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, WriterOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--name" && hasValue) {
+      options.ringName = argv[++i];
+    } else if (argument == "--slots" && hasValue) {
+      options.slots = static_cast<uint32_t>(std::atoi(argv[++i]));
+    } else if (argument == "--fps" && hasValue) {
+      options.fps = std::atof(argv[++i]);
+    } else if (argument == "--size" && hasValue) {
+      if (std::sscanf(argv[++i], "%dx%d", &options.width, \
+                      &options.height) != 2) {
+        return false;
+      }
+    } else if (argument == "--loop") {
+      options.loop = true;
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      options.source = argument;
+    }
+  }
+  return !options.source.empty() && options.slots >= 2 && \
+         options.fps >= 0 && options.width >= 0 && options.height >= 0;
+}
+
+bool openSource(const std::string& source, cv::VideoCapture& capture) {
+  char* end = nullptr;
+  long cameraID = std::strtol(source.c_str(), &end, 10);
+  if (end != source.c_str() && *end == '\0') {
+    return capture.open(static_cast<int>(cameraID));
+  }
+  return capture.open(source);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  WriterOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  cv::VideoCapture capture;
+  if (!openSource(options.source, capture)) {
+    std::cout << "Can't open " << options.source << std::endl;
+    return 1;
+  }
+  cv::Mat frame;
+  if (!capture.read(frame) || frame.empty()) {
+    std::cout << "Can't read a frame from " << options.source << std::endl;
+    return 1;
+  }
+  cv::Size size(options.width > 0 ? options.width : frame.cols, \
+                options.height > 0 ? options.height : frame.rows);
+  FrameRing ring;
+  if (!ring.create(options.ringName, options.slots, size.width, \
+                   size.height)) {
+    std::cout << "Can't create the ring " << options.ringName << std::endl;
+    return 1;
+  }
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+  std::cout << "Writing " << size.width << "x" << size.height \
+    << " frames to " << options.ringName << std::endl;
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point next = Clock::now();
+  int frameID = 0;
+  while (!stopRequested) {
+    if (frame.empty()) {
+      if (!options.loop || !capture.set(cv::CAP_PROP_POS_FRAMES, 0) || \
+          !capture.read(frame) || frame.empty()) {
+        break;
+      }
+    }
+    /* The frame is converted straight into the slot of the ring */
+    cv::Mat slot(size, CV_8UC3, ring.beginWrite());
+    if (frame.size() == size) {
+      frame.copyTo(slot);
+    } else {
+      cv::resize(frame, slot, size);
+    }
+    ring.commitWrite(frameID);
+    frameID += 1;
+    if (options.fps > 0) {
+      next += std::chrono::microseconds(\
+          static_cast<int64_t>(1000000 / options.fps));
+      std::this_thread::sleep_until(next);
+    }
+    capture.read(frame);
+  }
+  ring.close();
+  std::cout << "Wrote " << frameID << " frames" << std::endl;
+  return 0;
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      tune.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Measures the runtime configurations of the host and writes
+ *            the fastest as a tuning profile (hodm-tune)
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../include/AutoTuner.hpp"
+#include "../include/IOHandler.hpp"
+
+namespace {
+/**
+ * @brief Options of the tuner
+ */
+struct TuneOptions {
+  std::string output = "hodm-tuning.conf";
+  /* Largest acceptable p99 latency in milliseconds */
+  double latencyCapMs = 1000;
+  /* Frames timed per configuration */
+  int frames = 16;
+  std::vector<int> inputSizes = {416};
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  std::string image = "../test/testData/testImage.jpg";
+};
+
+void printUsage(const char* application) {
+  std::cout << "Usage: " << application << " [options] [image]\n" \
+    << "  --output <file>       profile to write (default " \
+    << "hodm-tuning.conf)\n" \
+    << "  --latency-cap <ms>    largest p99 latency (default 1000)\n" \
+    << "  --frames <n>          frames timed per configuration " \
+    << "(default 16)\n" \
+    << "  --sizes <n,n,...>     input sizes to try, multiples of 32 " \
+    << "(default 416)\n" \
+    << "  --cores <n>           cores to use (default: all)" << std::endl;
+}
+
+bool parseSizes(const std::string& text, std::vector<int>& sizes) {
+  sizes.clear();
+  std::istringstream fields(text);
+  std::string field;
+  while (std::getline(fields, field, ',')) {
+    int size = std::atoi(field.c_str());
+    if (size < 32 || size % 32 != 0) {
+      return false;
+    }
+    sizes.push_back(size);
+  }
+  return !sizes.empty();
+}
+
+bool parseArguments(int argc, char** argv, TuneOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (argument == "--output" && hasValue) {
+      options.output = argv[++i];
+    } else if (argument == "--latency-cap" && hasValue) {
+      options.latencyCapMs = std::atof(argv[++i]);
+    } else if (argument == "--frames" && hasValue) {
+      options.frames = std::atoi(argv[++i]);
+    } else if (argument == "--sizes" && hasValue) {
+      if (!parseSizes(argv[++i], options.inputSizes)) {
+        return false;
+      }
+    } else if (argument == "--cores" && hasValue) {
+      options.cores = std::atoi(argv[++i]);
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      options.image = argument;
+    }
+  }
+  return options.latencyCapMs > 0 && options.frames > 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  TuneOptions options;
+  if (!parseArguments(argc, argv, options)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  cv::Mat image = cv::imread(options.image);
+  if (image.empty()) {
+    std::cout << "Can't read " << options.image << std::endl;
+    return 1;
+  }
+  std::cout << "Tuning on " << options.cores << " cores with " \
+    << options.frames << " frames per configuration, p99 cap " \
+    << options.latencyCapMs << " ms" << std::endl;
+  AutoTuner tuner(AutoTuner::detectorBenchmark(image, options.frames), \
+                  options.latencyCapMs);
+  bool withinCap = tuner.tune(RunOptions(), options.cores, \
+                              options.inputSizes, std::cout);
+  const RunOptions& best = tuner.getBest();
+  const TuningMeasurement& measurement = tuner.getBestMeasurement();
+  if (!withinCap) {
+    std::cout << "No configuration meets the latency cap, keeping the " \
+      << "lowest p99" << std::endl;
+  }
+  std::ostringstream comment;
+  comment << "Written by hodm-tune on " << options.cores << " cores: " \
+    << measurement.framesPerSecond << " frames/s, p50 " \
+    << measurement.p50Ms << " ms, p99 " << measurement.p99Ms \
+    << " ms (cap " << options.latencyCapMs << " ms)";
+  IOHandler io;
+  if (!io.saveTuningProfile(options.output, best, comment.str())) {
+    std::cout << "Can't write " << options.output << std::endl;
+    return 1;
+  }
+  std::cout << "Best: " << best.opencvThreads << " threads, " \
+    << best.serverWorkers << " workers, batch " << best.maxBatch \
+    << ", input " << best.inputSize << ", filter " << best.filterType \
+    << " -> " << options.output << std::endl;
+  return 0;
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      undelta.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Reconstructs the detections of every frame from a delta
+ *            encoded output (hodm-undelta)
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/DetectionDelta.hpp"
+#include "../include/IOHandler.hpp"
+
+namespace {
+void printUsage(const char* application) {
+  std::cout << "Usage: " << application << " <DetectionsDelta.txt> " \
+    << "[output directory]\n" \
+    << "  Writes DetectionsFile.txt with the detections of every frame to " \
+    << "the output directory (default: the current one)\n" \
+    << "  --frame <n>   print the detections of frame n as JSON instead" \
+    << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string input;
+  std::string outputDirectory = "./";
+  int frameID = -1;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--frame" && i + 1 < argc) {
+      frameID = std::atoi(argv[++i]);
+    } else if (input.empty() && argument[0] != '-') {
+      input = argument;
+    } else if (argument[0] != '-') {
+      outputDirectory = argument;
+      if (outputDirectory.back() != '/') {
+        outputDirectory += '/';
+      }
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (input.empty()) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  DeltaDecoder decoder;
+  if (!decoder.open(input)) {
+    std::cout << "Can't read " << input << " as delta encoded " \
+      << "detections" << std::endl;
+    return 1;
+  }
+  IOHandler io;
+  std::vector<Detection> detections;
+  if (frameID >= 0) {
+    if (!decoder.readFrame(frameID, detections)) {
+      std::cout << "Frame " << frameID << " is not in " << input \
+        << std::endl;
+      return 1;
+    }
+    io.streamDetections(frameID, detections);
+    return 0;
+  }
+  if (!decoder.readAll(detections)) {
+    std::cout << "Invalid record in " << input << std::endl;
+    return 1;
+  }
+  return io.saveOutput(detections, outputDirectory) ? 0 : 1;
+}
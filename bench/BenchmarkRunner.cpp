@@ -0,0 +1,242 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      BenchmarkRunner.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for BenchmarkRunner class
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+
+#include "AllocationCounter.hpp"
+#include "BenchmarkRunner.hpp"
+#include "LatencyHistogram.hpp"
+
+namespace {
+/**
+ * @brief Extracts the value of a key from one line of JSON
+ *
+ * @param line Line holding a flat JSON object
+ * @param key Key to look for
+ * @param value Filled with the value, without quotes for strings
+ *
+ * @return true if the key is found
+ */
+bool jsonValue(const std::string& line, const std::string& key, \
+               std::string& value) {
+  std::string pattern = "\"" + key + "\":";
+  size_t start = line.find(pattern);
+  if (start == std::string::npos) {
+    return false;
+  }
+  start += pattern.size();
+  if (start < line.size() && line[start] == '"') {
+    size_t end = line.find('"', start + 1);
+    if (end == std::string::npos) {
+      return false;
+    }
+    value = line.substr(start + 1, end - start - 1);
+  } else {
+    size_t end = line.find_first_of(",}", start);
+    value = line.substr(start, end - start);
+  }
+  return true;
+}
+}  // namespace
+
+BenchmarkRunner::BenchmarkRunner() {
+}
+
+BenchmarkRunner::~BenchmarkRunner() {
+}
+
+auto BenchmarkRunner::setMinTime(double seconds) -> void {
+  minTime = seconds;
+}
+
+auto BenchmarkRunner::setFilter(const std::string& nameFilter) -> void {
+  filter = nameFilter;
+}
+
+auto BenchmarkRunner::addContext(const std::string& key, \
+                                 const std::string& value) -> void {
+  context.push_back(std::make_pair(key, value));
+}
+
+auto BenchmarkRunner::isSelected(const std::string& name) const -> bool {
+  return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+auto BenchmarkRunner::run(const std::string& name, const std::string& params, \
+                          const std::function<void()>& body) -> bool {
+  if (!isSelected(name)) {
+    return false;
+  }
+  typedef std::chrono::steady_clock Clock;
+  for (uint64_t i = 0; i < warmUpIterations; ++i) {
+    body();
+  }
+  LatencyHistogram histogram;
+  uint64_t allocationsBefore = AllocationCounter::threadAllocations();
+  Clock::time_point begin = Clock::now();
+  double elapsed = 0;
+  while (histogram.count() < minIterations || elapsed < minTime) {
+    Clock::time_point start = Clock::now();
+    body();
+    Clock::time_point end = Clock::now();
+    histogram.record(std::chrono::duration<double, std::milli>(\
+                                                    end - start).count());
+    elapsed = std::chrono::duration<double>(end - begin).count();
+  }
+  BenchmarkResult result;
+  result.name = name;
+  result.params = params;
+  result.iterations = histogram.count();
+  result.meanMs = histogram.mean();
+  result.p50Ms = histogram.percentile(0.50);
+  result.p99Ms = histogram.percentile(0.99);
+  result.minMs = histogram.min();
+  result.maxMs = histogram.max();
+  result.allocsPerIteration = static_cast<double>(\
+      AllocationCounter::threadAllocations() - allocationsBefore) / \
+      static_cast<double>(result.iterations);
+  results.push_back(result);
+  std::cerr << std::left << std::setw(48) << name << std::setw(14) \
+    << params << std::right << std::fixed << std::setprecision(4) \
+    << std::setw(12) << result.meanMs << " ms" << std::endl;
+  return true;
+}
+
+auto BenchmarkRunner::getResults() const \
+                                    -> const std::vector<BenchmarkResult>& {
+  return results;
+}
+
+auto BenchmarkRunner::printTable(std::ostream& output) const -> void {
+  output << std::left << std::setw(48) << "Benchmark" << std::setw(14) \
+    << "Params" << std::right << std::setw(10) << "iters" \
+    << std::setw(12) << "mean ms" << std::setw(12) << "p50 ms" \
+    << std::setw(12) << "p99 ms" << std::setw(12) << "min ms" \
+    << std::setw(12) << "allocs/iter" << "\n";
+  output << std::fixed << std::setprecision(4);
+  for (const auto& result : results) {
+    output << std::left << std::setw(48) << result.name << std::setw(14) \
+      << result.params << std::right << std::setw(10) << result.iterations \
+      << std::setw(12) << result.meanMs << std::setw(12) << result.p50Ms \
+      << std::setw(12) << result.p99Ms << std::setw(12) << result.minMs \
+      << std::setw(12) << std::setprecision(1) << result.allocsPerIteration \
+      << std::setprecision(4) << "\n";
+  }
+}
+
+auto BenchmarkRunner::writeJson(std::ostream& output) const -> void {
+  output << "{\n\"context\": {";
+  for (size_t i = 0; i < context.size(); ++i) {
+    output << (i == 0 ? "" : ", ") << "\"" << context[i].first << "\": \"" \
+      << context[i].second << "\"";
+  }
+  output << "},\n\"benchmarks\": [\n";
+  output << std::setprecision(6) << std::fixed;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    output << "{\"name\":\"" << result.name << "\"," \
+      << "\"params\":\"" << result.params << "\"," \
+      << "\"iterations\":" << result.iterations << "," \
+      << "\"mean_ms\":" << result.meanMs << "," \
+      << "\"p50_ms\":" << result.p50Ms << "," \
+      << "\"p99_ms\":" << result.p99Ms << "," \
+      << "\"min_ms\":" << result.minMs << "," \
+      << "\"max_ms\":" << result.maxMs << "," \
+      << "\"allocs_per_iter\":" << result.allocsPerIteration << "}" \
+      << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  output << "]\n}\n";
+}
+
+auto BenchmarkRunner::readJson(std::istream& input, \
+                        std::vector<BenchmarkResult>& readResults) -> bool {
+  std::string line;
+  while (std::getline(input, line)) {
+    BenchmarkResult result;
+    std::string value;
+    if (!jsonValue(line, "name", result.name) || \
+        !jsonValue(line, "params", result.params)) {
+      continue;
+    }
+    if (jsonValue(line, "iterations", value)) {
+      result.iterations = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    if (jsonValue(line, "mean_ms", value)) {
+      result.meanMs = std::atof(value.c_str());
+    }
+    if (jsonValue(line, "p50_ms", value)) {
+      result.p50Ms = std::atof(value.c_str());
+    }
+    if (jsonValue(line, "p99_ms", value)) {
+      result.p99Ms = std::atof(value.c_str());
+    }
+    if (jsonValue(line, "min_ms", value)) {
+      result.minMs = std::atof(value.c_str());
+    }
+    if (jsonValue(line, "max_ms", value)) {
+      result.maxMs = std::atof(value.c_str());
+    }
+    if (jsonValue(line, "allocs_per_iter", value)) {
+      result.allocsPerIteration = std::atof(value.c_str());
+    }
+    readResults.push_back(result);
+  }
+  return !readResults.empty();
+}
+
+auto BenchmarkRunner::printComparison(\
+        const std::vector<BenchmarkResult>& baseline, \
+        std::ostream& output) const -> void {
+  std::map<std::string, const BenchmarkResult*> baselineResults;
+  for (const auto& result : baseline) {
+    baselineResults[result.name + " " + result.params] = &result;
+  }
+  output << std::left << std::setw(48) << "Benchmark" << std::setw(14) \
+    << "Params" << std::right << std::setw(14) << "baseline ms" \
+    << std::setw(12) << "now ms" << std::setw(10) << "change" << "\n";
+  for (const auto& result : results) {
+    auto found = baselineResults.find(result.name + " " + result.params);
+    if (found == baselineResults.end()) {
+      continue;
+    }
+    double before = found->second->meanMs;
+    double change = before > 0 ? (result.meanMs - before) / before * 100 : 0;
+    output << std::left << std::setw(48) << result.name << std::setw(14) \
+      << result.params << std::right << std::fixed << std::setprecision(4) \
+      << std::setw(14) << before << std::setw(12) << result.meanMs \
+      << std::setprecision(1) << std::setw(9) << std::showpos << change \
+      << std::noshowpos << "%\n";
+  }
+}
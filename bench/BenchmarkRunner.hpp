@@ -0,0 +1,205 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      BenchmarkRunner.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares BenchmarkRunner class used by the hodm-bench target
+ */
+
+#ifndef BENCH_BENCHMARKRUNNER_HPP_
+#define BENCH_BENCHMARKRUNNER_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Timing results of one benchmark
+ */
+struct BenchmarkResult {
+  /* Name of the benchmark, e.g. VisionModule/reshape */
+  std::string name;
+  /* Parameters of the benchmark, e.g. the frame resolution */
+  std::string params;
+  /* Number of timed iterations */
+  uint64_t iterations = 0;
+  /* Statistics of the iteration time in milliseconds */
+  double meanMs = 0;
+  double p50Ms = 0;
+  double p99Ms = 0;
+  double minMs = 0;
+  double maxMs = 0;
+  /* Heap allocations made by one iteration, on average */
+  double allocsPerIteration = 0;
+};
+
+/**
+ * @brief Prevents the compiler from optimizing away a computed value
+ *
+ * @param value Value that must be computed
+ *
+ * @return void
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief Class to time small pieces of code and report the results
+ */
+class BenchmarkRunner {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  BenchmarkRunner();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~BenchmarkRunner();
+
+  /**
+   * @brief Sets the minimum time spent timing each benchmark
+   *
+   * @param seconds Minimum time in seconds
+   *
+   * @return void
+   */
+  void setMinTime(double seconds);
+
+  /**
+   * @brief Runs only the benchmarks whose name contains the filter
+   *
+   * @param nameFilter Part of the benchmark names to run, empty for all
+   *
+   * @return void
+   */
+  void setFilter(const std::string& nameFilter);
+
+  /**
+   * @brief Tells whether a benchmark is selected by the filter
+   *
+   * @param name Name of the benchmark
+   *
+   * @return true if the benchmark has to run
+   */
+  bool isSelected(const std::string& name) const;
+
+  /**
+   * @brief Adds information about the machine or build to the results
+   *
+   * @param key Name of the information, e.g. opencv
+   * @param value Value of the information
+   *
+   * @return void
+   */
+  void addContext(const std::string& key, const std::string& value);
+
+  /**
+   * @brief Times the given code
+   *
+   * The code is run a few times to warm up caches, then repeatedly until
+   * both the minimum time and the minimum number of iterations are reached.
+   *
+   * @param name Name of the benchmark
+   * @param params Parameters of the benchmark
+   * @param body Code to time, one call is one iteration
+   *
+   * @return true if the benchmark ran, false if it is filtered out
+   */
+  bool run(const std::string& name, const std::string& params, \
+           const std::function<void()>& body);
+
+  /**
+   * @brief Gives the results of all the benchmarks run so far
+   *
+   * @return Results in order of execution
+   */
+  const std::vector<BenchmarkResult>& getResults() const;
+
+  /**
+   * @brief Prints the results as a table
+   *
+   * @param output Stream to print on
+   *
+   * @return void
+   */
+  void printTable(std::ostream& output) const;
+
+  /**
+   * @brief Writes the results as JSON, one benchmark per line
+   *
+   * @param output Stream to write on
+   *
+   * @return void
+   */
+  void writeJson(std::ostream& output) const;
+
+  /**
+   * @brief Reads results written by writeJson
+   *
+   * @param input Stream to read from
+   * @param results Filled with the results that are read
+   *
+   * @return true if at least one result is read
+   */
+  static bool readJson(std::istream& input, \
+                       std::vector<BenchmarkResult>& results);
+
+  /**
+   * @brief Prints the change of the mean time of every benchmark against
+   *        the same benchmark in a baseline
+   *
+   * @param baseline Results of a previous run
+   * @param output Stream to print on
+   *
+   * @return void
+   */
+  void printComparison(const std::vector<BenchmarkResult>& baseline, \
+                       std::ostream& output) const;
+
+ private:
+  /* Minimum time spent timing each benchmark in seconds */
+  double minTime = 0.5;
+  /* Minimum number of timed iterations of each benchmark */
+  uint64_t minIterations = 10;
+  /* Number of untimed warm up iterations */
+  uint64_t warmUpIterations = 3;
+  /* Only benchmarks containing this string are run */
+  std::string filter;
+  /* Information about the machine and build */
+  std::vector< std::pair<std::string, std::string> > context;
+  /* Results of the benchmarks run so far */
+  std::vector<BenchmarkResult> results;
+};
+
+#endif    // BENCH_BENCHMARKRUNNER_HPP_
@@ -0,0 +1,270 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      LoadGenerator.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Definition for LoadGenerator class
+ */
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include "LoadGenerator.hpp"
+#include "LatencyHistogram.hpp"
+#include "ThreadPlacement.hpp"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Frame waiting in the queue for a worker
+ */
+struct PendingFrame {
+  /* Stream the frame belongs to */
+  int stream;
+  /* Index of the frame in the stream */
+  int index;
+  /* Time at which the frame arrived */
+  Clock::time_point arrival;
+};
+
+/**
+ * @brief Gives the user and system CPU time used by the process so far
+ *
+ * @return CPU time in seconds
+ */
+double processCpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + \
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+}  // namespace
+
+LoadGenerator::LoadGenerator(const std::vector<cv::Mat>& replayFrames, \
+                             const ProcessorFactory& factory) :
+    frames(replayFrames), processorFactory(factory) {
+}
+
+LoadGenerator::~LoadGenerator() {
+}
+
+auto LoadGenerator::run(const LoadConfiguration& configuration) \
+                                                            -> LoadResult {
+  cv::setNumThreads(configuration.cvThreads);
+  const bool closedLoop = configuration.streamFps <= 0;
+  const uint64_t totalFrames = static_cast<uint64_t>(\
+            configuration.streams) * configuration.framesPerStream;
+
+  std::mutex mutex;
+  std::condition_variable queueChanged, workerReady;
+  std::deque<PendingFrame> queue;
+  int readyWorkers = 0;
+  uint64_t completedFrames = 0;
+  bool finished = totalFrames == 0;
+  LatencyHistogram latency;
+  /* The workers share the CPUs the run may use */
+  ThreadPlacement placement;
+  if (configuration.pinned) {
+    placement.setCpus(kInferenceThreads, ThreadPlacement::formatCpuList(\
+                                         ThreadPlacement::currentCpus()));
+  }
+
+  std::vector<std::thread> workers;
+  for (int w = 0; w < configuration.workers; ++w) {
+    workers.emplace_back([&, w]() {
+      placement.pinCurrentThread(kInferenceThreads, w, \
+                                 configuration.workers);
+      /* The pipeline is created and warmed up inside its own thread */
+      FrameProcessor process = processorFactory();
+      process(frames[0], 0);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        readyWorkers += 1;
+      }
+      workerReady.notify_one();
+      while (true) {
+        PendingFrame pending;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          queueChanged.wait(lock, [&]() {
+            return !queue.empty() || finished;
+          });
+          if (queue.empty()) {
+            return;
+          }
+          pending = queue.front();
+          queue.pop_front();
+        }
+        process(frames[pending.index % frames.size()], \
+                pending.stream * configuration.framesPerStream + \
+                pending.index);
+        Clock::time_point done = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        latency.record(std::chrono::duration<double, std::milli>(\
+                                          done - pending.arrival).count());
+        completedFrames += 1;
+        /* In closed loop the stream sends its next frame right away */
+        if (closedLoop && pending.index + 1 < \
+                                        configuration.framesPerStream) {
+          queue.push_back({pending.stream, pending.index + 1, done});
+          queueChanged.notify_one();
+        }
+        if (completedFrames == totalFrames) {
+          finished = true;
+          queueChanged.notify_all();
+        }
+      }
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    workerReady.wait(lock, [&]() {
+      return readyWorkers == configuration.workers;
+    });
+  }
+
+  Clock::time_point start = Clock::now();
+  double cpuStart = processCpuSeconds();
+  if (closedLoop) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int s = 0; s < configuration.streams && \
+                    configuration.framesPerStream > 0; ++s) {
+      queue.push_back({s, 0, start});
+    }
+    queueChanged.notify_all();
+  } else {
+    /* Streams are staggered evenly within one frame interval */
+    double interval = 1.0 / configuration.streamFps;
+    for (int k = 0; k < configuration.framesPerStream; ++k) {
+      for (int s = 0; s < configuration.streams; ++s) {
+        Clock::time_point arrival = start + \
+            std::chrono::duration_cast<Clock::duration>(\
+            std::chrono::duration<double>(interval * \
+            (k + static_cast<double>(s) / configuration.streams)));
+        std::this_thread::sleep_until(arrival);
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({s, k, arrival});
+        queueChanged.notify_one();
+      }
+    }
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double seconds = std::chrono::duration<double>(\
+                                        Clock::now() - start).count();
+  double cpuSeconds = processCpuSeconds() - cpuStart;
+
+  LoadResult result;
+  result.configuration = configuration;
+  result.frames = completedFrames;
+  result.seconds = seconds;
+  result.framesPerSecond = seconds > 0 ? completedFrames / seconds : 0;
+  result.meanMs = latency.mean();
+  result.p50Ms = latency.percentile(0.50);
+  result.p99Ms = latency.percentile(0.99);
+  result.maxMs = latency.max();
+  result.jitterMs = result.p99Ms - result.p50Ms;
+  result.coresBusy = seconds > 0 ? cpuSeconds / seconds : 0;
+  unsigned cpus = std::thread::hardware_concurrency();
+  result.cpuUtilisation = cpus > 0 ? result.coresBusy / cpus : 0;
+  return result;
+}
+
+auto LoadGenerator::readVideo(const std::string& filePath, int maxFrames, \
+                              std::vector<cv::Mat>& frames) -> bool {
+  cv::VideoCapture video(filePath);
+  cv::Mat frame;
+  while (static_cast<int>(frames.size()) < maxFrames && video.read(frame)) {
+    /* The capture may reuse the buffer of the previous frame */
+    frames.push_back(frame.clone());
+  }
+  return !frames.empty();
+}
+
+auto LoadGenerator::syntheticFrames(cv::Size size, int count) \
+                                                    -> std::vector<cv::Mat> {
+  std::vector<cv::Mat> frames;
+  cv::RNG rng(42);
+  for (int i = 0; i < count; ++i) {
+    cv::Mat frame(size, CV_8UC3);
+    rng.fill(frame, cv::RNG::UNIFORM, cv::Scalar::all(0), \
+             cv::Scalar::all(256));
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+auto LoadGenerator::printTable(const std::vector<LoadResult>& results, \
+                               std::ostream& output) -> void {
+  output << std::right << std::setw(8) << "streams" << std::setw(9) \
+    << "workers" << std::setw(9) << "threads" << std::setw(5) << "pin" \
+    << std::setw(8) << "fps_in" \
+    << std::setw(8) << "frames" << std::setw(10) << "fps" \
+    << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms" \
+    << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" \
+    << std::setw(10) << "jitter" << std::setw(8) << "cores" \
+    << std::setw(7) << "cpu%" << "\n";
+  output << std::fixed;
+  for (const auto& result : results) {
+    const LoadConfiguration& c = result.configuration;
+    output << std::setprecision(0) << std::setw(8) << c.streams \
+      << std::setw(9) << c.workers << std::setw(9) << c.cvThreads \
+      << std::setw(5) << (c.pinned ? "on" : "off") \
+      << std::setw(8) << c.streamFps << std::setw(8) << result.frames \
+      << std::setprecision(2) << std::setw(10) << result.framesPerSecond \
+      << std::setw(10) << result.meanMs << std::setw(10) << result.p50Ms \
+      << std::setw(10) << result.p99Ms << std::setw(10) << result.maxMs \
+      << std::setw(10) << result.jitterMs << std::setw(8) << result.coresBusy \
+      << std::setprecision(1) << std::setw(7) \
+      << result.cpuUtilisation * 100 << "\n";
+  }
+}
+
+auto LoadGenerator::writeCsv(const std::vector<LoadResult>& results, \
+                             std::ostream& output) -> void {
+  output << "streams,workers,cv_threads,stream_fps,frames,seconds,fps," \
+    << "mean_ms,p50_ms,p99_ms,cores_busy,cpu_utilisation,pinned,max_ms," \
+    << "jitter_ms\n";
+  for (const auto& result : results) {
+    const LoadConfiguration& c = result.configuration;
+    output << c.streams << "," << c.workers << "," << c.cvThreads << "," \
+      << c.streamFps << "," << result.frames << "," << result.seconds << "," \
+      << result.framesPerSecond << "," << result.meanMs << "," \
+      << result.p50Ms << "," << result.p99Ms << "," << result.coresBusy \
+      << "," << result.cpuUtilisation << "," << c.pinned << "," \
+      << result.maxMs << "," << result.jitterMs << "\n";
+  }
+}
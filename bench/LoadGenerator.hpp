@@ -0,0 +1,183 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      LoadGenerator.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares LoadGenerator class used by the hodm-loadtest target
+ */
+
+#ifndef BENCH_LOADGENERATOR_HPP_
+#define BENCH_LOADGENERATOR_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief One configuration of a load test run
+ */
+struct LoadConfiguration {
+  /* Number of concurrent streams replaying the frames */
+  int streams = 1;
+  /* Number of worker threads running the pipeline */
+  int workers = 1;
+  /* Number of OpenCV threads (cv::setNumThreads) */
+  int cvThreads = 1;
+  /* Frame rate of every stream, 0 to send frames as fast as possible */
+  double streamFps = 0;
+  /* Number of frames sent by every stream */
+  int framesPerStream = 100;
+  /* Pin every worker to its own part of the CPUs, on a single NUMA node
+  when possible */
+  bool pinned = false;
+};
+
+/**
+ * @brief Measurements of one load test run
+ */
+struct LoadResult {
+  /* Configuration that was run */
+  LoadConfiguration configuration;
+  /* Total number of frames processed */
+  uint64_t frames = 0;
+  /* Wall clock duration of the run in seconds */
+  double seconds = 0;
+  /* Frames processed per second over all the streams */
+  double framesPerSecond = 0;
+  /* Frame latency from arrival to completion in milliseconds */
+  double meanMs = 0;
+  double p50Ms = 0;
+  double p99Ms = 0;
+  double maxMs = 0;
+  /* Spread of the latency, p99Ms - p50Ms */
+  double jitterMs = 0;
+  /* Process CPU time divided by wall clock time */
+  double coresBusy = 0;
+  /* coresBusy divided by the number of CPUs of the machine */
+  double cpuUtilisation = 0;
+};
+
+/**
+ * @brief Class replaying frames as concurrent streams into the detection
+ *        pipeline and measuring throughput, latency and CPU usage
+ *
+ * Every worker thread owns its own pipeline, created by the given factory,
+ * and takes frames from a queue shared by all the streams. With a stream
+ * frame rate of 0 every stream keeps exactly one frame in flight (closed
+ * loop), otherwise frames arrive on schedule whether or not the workers
+ * keep up (open loop), so that queueing shows up in the latency.
+ *
+ * Pinned workers are pinned before creating their pipeline, so that its
+ * memory is allocated on their node.
+ */
+class LoadGenerator {
+ public:
+  /* Function processing one frame with its ID */
+  typedef std::function<void(const cv::Mat&, int)> FrameProcessor;
+  /* Function creating the frame processor of one worker */
+  typedef std::function<FrameProcessor()> ProcessorFactory;
+
+  /**
+   * @brief Constructor for class
+   *
+   * @param replayFrames Frames replayed by every stream, in a loop
+   * @param factory Creates the pipeline of every worker
+   */
+  LoadGenerator(const std::vector<cv::Mat>& replayFrames, \
+                const ProcessorFactory& factory);
+
+  /**
+   * @brief Destructor for class
+   */
+  ~LoadGenerator();
+
+  /**
+   * @brief Runs the load test for one configuration
+   *
+   * Workers process one untimed frame to warm up before the run starts.
+   *
+   * @param configuration Configuration to run
+   *
+   * @return Measurements of the run
+   */
+  LoadResult run(const LoadConfiguration& configuration);
+
+  /**
+   * @brief Reads the frames of a video into memory
+   *
+   * @param filePath Path of the video
+   * @param maxFrames Maximum number of frames to read
+   * @param frames Filled with the frames
+   *
+   * @return true if at least one frame is read
+   */
+  static bool readVideo(const std::string& filePath, int maxFrames, \
+                        std::vector<cv::Mat>& frames);
+
+  /**
+   * @brief Creates frames filled with noise
+   *
+   * @param size Size of the frames
+   * @param count Number of frames
+   *
+   * @return Synthetic frames
+   */
+  static std::vector<cv::Mat> syntheticFrames(cv::Size size, int count);
+
+  /**
+   * @brief Prints the results as a table
+   *
+   * @param results Results of the runs
+   * @param output Stream to print on
+   *
+   * @return void
+   */
+  static void printTable(const std::vector<LoadResult>& results, \
+                         std::ostream& output);
+
+  /**
+   * @brief Writes the results as CSV with a header line
+   *
+   * @param results Results of the runs
+   * @param output Stream to write on
+   *
+   * @return void
+   */
+  static void writeCsv(const std::vector<LoadResult>& results, \
+                       std::ostream& output);
+
+ private:
+  /* Frames replayed by every stream */
+  std::vector<cv::Mat> frames;
+  /* Creates the pipeline of every worker */
+  ProcessorFactory processorFactory;
+};
+
+#endif    // BENCH_LOADGENERATOR_HPP_
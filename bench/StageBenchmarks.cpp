@@ -0,0 +1,313 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      StageBenchmarks.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Microbenchmarks of the pipeline stages
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "StageBenchmarks.hpp"
+#include "DetectionModule.hpp"
+#include "IOHandler.hpp"
+#include "Network.hpp"
+#include "Transformation.hpp"
+#include "VisionModule.hpp"
+
+namespace {
+/* Resolutions of the synthetic source frames */
+const std::vector<cv::Size> kResolutions{cv::Size(640, 480), \
+                              cv::Size(1280, 720), cv::Size(1920, 1080)};
+/* Size of the network input */
+const cv::Size kNetworkSize(416, 416);
+/* Number of classes predicted by the YOLO network */
+const int kClasses = 80;
+
+/**
+ * @brief Gives the resolution as a WxH string
+ */
+std::string resolutionName(cv::Size size) {
+  return std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+/**
+ * @brief Creates a frame filled with uniform noise
+ *
+ * @param size Size of the frame
+ * @param seed Seed of the random generator
+ *
+ * @return 8 bit BGR frame
+ */
+cv::Mat syntheticFrame(cv::Size size, uint64_t seed) {
+  cv::Mat frame(size, CV_8UC3);
+  cv::RNG rng(seed);
+  rng.fill(frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+  return frame;
+}
+
+/**
+ * @brief Creates raw YOLOv3 output for a 416x416 input
+ *
+ * Three output layers with 13x13, 26x26 and 52x52 cells and three anchors
+ * per cell. About one box in a thousand has a class score above threshold.
+ *
+ * @return Output matrices of the YOLO layers
+ */
+std::vector<cv::Mat> syntheticNetworkOutput() {
+  std::vector<cv::Mat> outputs;
+  cv::RNG rng(7);
+  for (int grid : {13, 26, 52}) {
+    cv::Mat output(grid * grid * 3, 5 + kClasses, CV_32F);
+    rng.fill(output, cv::RNG::UNIFORM, cv::Scalar::all(0), \
+             cv::Scalar::all(0.5));
+    for (int i = 0; i < output.rows; ++i) {
+      if (rng.uniform(0, 1000) == 0) {
+        output.at<float>(i, 5 + rng.uniform(0, kClasses)) = 0.95f;
+      }
+    }
+    outputs.push_back(output);
+  }
+  return outputs;
+}
+
+/**
+ * @brief Creates clusters of overlapping boxes inside a 416x416 frame
+ *
+ * @param count Number of boxes
+ * @param boxes Filled with the boxes
+ * @param scores Filled with a score for every box
+ * @param classIds Filled with class 0 (person) for every box
+ *
+ * @return void
+ */
+void syntheticBoxes(int count, std::vector<cv::Rect>& boxes, \
+                    std::vector<float>& scores, std::vector<int>& classIds) {
+  cv::RNG rng(11);
+  for (int i = 0; i < count; ++i) {
+    /* Boxes jitter around eight cluster centres */
+    int cluster = i % 8;
+    int x = 20 + cluster * 45 + rng.uniform(-10, 10);
+    int y = 40 + cluster * 30 + rng.uniform(-10, 10);
+    boxes.push_back(cv::Rect(x, y, 60 + rng.uniform(0, 20), \
+                             120 + rng.uniform(0, 40)));
+    scores.push_back(rng.uniform(0.9f, 1.0f));
+    classIds.push_back(0);
+  }
+}
+
+/**
+ * @brief Benchmarks of the VisionModule filters and reshape
+ */
+void runVisionModuleBenchmarks(BenchmarkRunner& runner) {
+  VisionModule vm;
+  std::vector<cv::Size> filterSizes{kNetworkSize};
+  filterSizes.insert(filterSizes.end(), kResolutions.begin(), \
+                     kResolutions.end());
+  for (cv::Size size : kResolutions) {
+    cv::Mat frame = syntheticFrame(size, 1);
+    runner.run("VisionModule/reshape", resolutionName(size), [&]() {
+      doNotOptimize(vm.reshape(frame, kNetworkSize));
+    });
+  }
+  for (cv::Size size : filterSizes) {
+    cv::Mat frame = syntheticFrame(size, 2);
+    runner.run("VisionModule/applyGaussianFilter", resolutionName(size), \
+               [&]() {
+      doNotOptimize(vm.applyGaussianFilter(frame, cv::Size(3, 3), 0));
+    });
+    runner.run("VisionModule/applyMedianFilter", resolutionName(size), \
+               [&]() {
+      doNotOptimize(vm.applyMedianFilter(frame, 3));
+    });
+    runner.run("VisionModule/applyFilter", resolutionName(size), [&]() {
+      doNotOptimize(vm.applyFilter(frame, cv::Size(3, 3)));
+    });
+    /* OpenCV and the specialized kernels into the same reused buffer */
+    cv::Mat smoothed;
+    runner.run("VisionModule/applyGaussianFilterInto", \
+               resolutionName(size), [&]() {
+      vm.applyGaussianFilter(frame, cv::Size(3, 3), 0, smoothed);
+      doNotOptimize(smoothed);
+    });
+    runner.run("VisionModule/smooth<GaussianKernel<3>>", \
+               resolutionName(size), [&]() {
+      VisionModule::smooth<GaussianKernel<3, uint8_t>>(frame, smoothed);
+      doNotOptimize(smoothed);
+    });
+    runner.run("VisionModule/applyMedianFilterInto", resolutionName(size), \
+               [&]() {
+      vm.applyMedianFilter(frame, 3, smoothed);
+      doNotOptimize(smoothed);
+    });
+    runner.run("VisionModule/smooth<MedianKernel<3>>", \
+               resolutionName(size), [&]() {
+      VisionModule::smooth<MedianKernel<3, uint8_t>>(frame, smoothed);
+      doNotOptimize(smoothed);
+    });
+    runner.run("VisionModule/applyFilterInto", resolutionName(size), \
+               [&]() {
+      vm.applyFilter(frame, cv::Size(3, 3), smoothed);
+      doNotOptimize(smoothed);
+    });
+    runner.run("VisionModule/smooth<BoxKernel<3>>", resolutionName(size), \
+               [&]() {
+      VisionModule::smooth<BoxKernel<3, uint8_t>>(frame, smoothed);
+      doNotOptimize(smoothed);
+    });
+  }
+  for (int count : {10, 100, 1000}) {
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<int> classIds;
+    syntheticBoxes(count, boxes, scores, classIds);
+    cv::Mat frame = syntheticFrame(kNetworkSize, 3);
+    runner.run("VisionModule/nonMaximalSuppression", \
+               "boxes=" + std::to_string(count), [&]() {
+      doNotOptimize(vm.nonMaximalSuppression(frame, boxes, scores, \
+                                             classIds, 0));
+    });
+    std::vector<Detection> detections;
+    runner.run("VisionModule/nonMaximalSuppressionInPlace", \
+               "boxes=" + std::to_string(count), [&]() {
+      vm.nonMaximalSuppression(frame.size(), 0, boxes, scores, classIds, \
+                               detections);
+      doNotOptimize(detections);
+    });
+  }
+}
+
+/**
+ * @brief Benchmarks of the DetectionModule pre and post processing
+ */
+void runDetectionModuleBenchmarks(BenchmarkRunner& runner) {
+  DetectionModule dm;
+  for (cv::Size size : kResolutions) {
+    cv::Mat frame = syntheticFrame(size, 4);
+    for (char filterType : {'G', 'M', 'B'}) {
+      runner.run(std::string("DetectionModule/preProcessImage/") + \
+                 filterType, resolutionName(size), [&]() {
+        doNotOptimize(dm.preProcessImage(frame, filterType));
+      });
+    }
+  }
+  std::vector<cv::Mat> outputs = syntheticNetworkOutput();
+  std::vector<cv::Rect> boxes;
+  std::vector<float> scores;
+  std::vector<int> classIds;
+  runner.run("DetectionModule/decodeNetworkOutput", \
+             resolutionName(kNetworkSize), [&]() {
+    dm.decodeNetworkOutput(outputs, kNetworkSize, boxes, scores, classIds);
+    doNotOptimize(boxes);
+  });
+  for (int count : {1, 10, 100}) {
+    std::vector<Detection> detections(count);
+    for (int i = 0; i < count; ++i) {
+      detections[i].x1 = i;
+      detections[i].y1 = i;
+      detections[i].x2 = i + 50;
+      detections[i].y2 = i + 100;
+    }
+    /* Frames are identities, so the detections are unchanged by each
+    iteration */
+    runner.run("DetectionModule/transformDetections", \
+               "detections=" + std::to_string(count), [&]() {
+      dm.transformDetections(detections);
+      doNotOptimize(detections);
+    });
+  }
+}
+
+/**
+ * @brief Benchmarks of the Network input creation
+ */
+void runNetworkBenchmarks(BenchmarkRunner& runner) {
+  Network network;
+  cv::Mat frame = syntheticFrame(kNetworkSize, 5);
+  runner.run("Network/createNetworkInput", resolutionName(kNetworkSize), \
+             [&]() {
+    doNotOptimize(network.createNetworkInput(frame));
+  });
+}
+
+/**
+ * @brief Benchmarks of the Transformation conversions of one point
+ */
+void runTransformationBenchmarks(BenchmarkRunner& runner) {
+  Transformation tf;
+  cv::Mat intrinsic = cv::Mat::eye(3, 3, CV_32F);
+  cv::Mat point2d = cv::Mat::ones(2, 1, CV_32F);
+  cv::Mat point4d = cv::Mat::ones(4, 1, CV_32F);
+  runner.run("Transformation/imageToCamera", "point", [&]() {
+    doNotOptimize(tf.imageToCamera(intrinsic, point2d));
+  });
+  runner.run("Transformation/endToBase", "point", [&]() {
+    doNotOptimize(tf.endToBase(point4d));
+  });
+  runner.run("Transformation/baseToEnd", "point", [&]() {
+    doNotOptimize(tf.baseToEnd(point4d));
+  });
+  runner.run("Transformation/cameraToImage", "point", [&]() {
+    doNotOptimize(tf.cameraToImage(intrinsic, point4d));
+  });
+}
+
+/**
+ * @brief Benchmarks of writing the detections file
+ */
+void runIOHandlerBenchmarks(BenchmarkRunner& runner, \
+                            const std::string& outputDirectory) {
+  std::ostringstream discardedOutput;
+  IOHandler io(std::cin, discardedOutput);
+  for (int count : {100, 10000}) {
+    std::vector<Detection> detections(count);
+    for (int i = 0; i < count; ++i) {
+      detections[i].frameID = i / 4;
+      detections[i].x1 = i % 400;
+      detections[i].y1 = i % 300;
+      detections[i].x2 = i % 400 + 16;
+      detections[i].y2 = i % 300 + 16;
+      detections[i].score = 0.95f;
+    }
+    runner.run("IOHandler/saveOutput", \
+               "detections=" + std::to_string(count), [&]() {
+      io.saveOutput(detections, outputDirectory);
+    });
+  }
+}
+}  // namespace
+
+auto runStageBenchmarks(BenchmarkRunner& runner, \
+                        const std::string& outputDirectory) -> void {
+  runVisionModuleBenchmarks(runner);
+  runDetectionModuleBenchmarks(runner);
+  runNetworkBenchmarks(runner);
+  runTransformationBenchmarks(runner);
+  runIOHandlerBenchmarks(runner, outputDirectory);
+}
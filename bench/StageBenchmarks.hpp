@@ -0,0 +1,52 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      StageBenchmarks.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares the microbenchmarks of the pipeline stages
+ */
+
+#ifndef BENCH_STAGEBENCHMARKS_HPP_
+#define BENCH_STAGEBENCHMARKS_HPP_
+
+#include <string>
+
+#include "BenchmarkRunner.hpp"
+
+/**
+ * @brief Runs the microbenchmarks of all the pipeline stages on synthetic
+ *        frames and detections
+ *
+ * @param runner Runner that times the benchmarks and keeps the results
+ * @param outputDirectory Directory where the output benchmarks write files
+ *
+ * @return void
+ */
+void runStageBenchmarks(BenchmarkRunner& runner, \
+                        const std::string& outputDirectory);
+
+#endif    // BENCH_STAGEBENCHMARKS_HPP_
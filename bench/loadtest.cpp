@@ -0,0 +1,206 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      loadtest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Entry point of the hodm-loadtest end-to-end load generator
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DetectionModule.hpp"
+#include "LoadGenerator.hpp"
+
+/**
+ * @brief Prints the command line options of the load generator
+ */
+void printUsage(const std::string& applicationName) {
+  std::cerr << "Usage: " << applicationName << " [options]\n" \
+    << "  --video <path>       replay the frames of a video\n" \
+    << "  --synthetic <WxH>    replay synthetic frames (default 1280x720)\n" \
+    << "  --max-frames <n>     frames kept in memory for replay (100)\n" \
+    << "  --frames <n>         frames sent by every stream (100)\n" \
+    << "  --fps <f>            frame rate of every stream, 0 for as fast " \
+    << "as possible (0)\n" \
+    << "  --streams <list>     comma separated stream counts (1)\n" \
+    << "  --workers <list>     comma separated worker counts (1)\n" \
+    << "  --threads <list>     comma separated OpenCV thread counts (1)\n" \
+    << "  --pin <list>         off to let the workers run on any CPU, on " \
+    << "to pin each to its own CPUs (off)\n" \
+    << "  --csv <path>         also write the results as CSV" << std::endl;
+}
+
+/**
+ * @brief Parses a comma separated list of positive integers
+ *
+ * @param text List to parse
+ * @param values Filled with the values
+ *
+ * @return true if all the values are positive integers
+ */
+bool parseList(const std::string& text, std::vector<int>& values) {
+  values.clear();
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    int value = std::atoi(item.c_str());
+    if (value <= 0) {
+      return false;
+    }
+    values.push_back(value);
+  }
+  return !values.empty();
+}
+
+/**
+ * @brief Parses a comma separated list of off and on
+ *
+ * @param text List to parse
+ * @param values Filled with false for off and true for on
+ *
+ * @return true if every item is off or on
+ */
+bool parseSwitches(const std::string& text, std::vector<bool>& values) {
+  values.clear();
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item != "off" && item != "on") {
+      return false;
+    }
+    values.push_back(item == "on");
+  }
+  return !values.empty();
+}
+
+int main(int argc, char** argv) {
+  std::string videoPath, csvPath;
+  cv::Size syntheticSize(1280, 720);
+  int maxFrames = 100;
+  LoadConfiguration base;
+  std::vector<int> streamCounts{1}, workerCounts{1}, threadCounts{1};
+  std::vector<bool> pinnings{false};
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (i + 1 >= argc) {
+      printUsage(argv[0]);
+      return 1;
+    }
+    std::string value = argv[++i];
+    bool valid = true;
+    if (argument == "--video") {
+      videoPath = value;
+    } else if (argument == "--synthetic") {
+      valid = std::sscanf(value.c_str(), "%dx%d", &syntheticSize.width, \
+                          &syntheticSize.height) == 2;
+    } else if (argument == "--max-frames") {
+      maxFrames = std::atoi(value.c_str());
+      valid = maxFrames > 0;
+    } else if (argument == "--frames") {
+      base.framesPerStream = std::atoi(value.c_str());
+      valid = base.framesPerStream > 0;
+    } else if (argument == "--fps") {
+      base.streamFps = std::atof(value.c_str());
+    } else if (argument == "--streams") {
+      valid = parseList(value, streamCounts);
+    } else if (argument == "--workers") {
+      valid = parseList(value, workerCounts);
+    } else if (argument == "--threads") {
+      valid = parseList(value, threadCounts);
+    } else if (argument == "--pin") {
+      valid = parseSwitches(value, pinnings);
+    } else if (argument == "--csv") {
+      csvPath = value;
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      std::cerr << "Invalid argument: " << argument << " " << value << "\n";
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<cv::Mat> frames;
+  if (!videoPath.empty()) {
+    if (!LoadGenerator::readVideo(videoPath, maxFrames, frames)) {
+      std::cerr << "Error: Invalid video file" << std::endl;
+      return 1;
+    }
+  } else {
+    frames = LoadGenerator::syntheticFrames(syntheticSize, maxFrames);
+  }
+
+  /* Every worker owns a full pipeline, so the network is loaded once per
+     worker before the timed part of the run */
+  LoadGenerator generator(frames, []() {
+    std::shared_ptr<DetectionModule> module = \
+                                      std::make_shared<DetectionModule>();
+    return LoadGenerator::FrameProcessor([module](const cv::Mat& frame, \
+                                                  int frameID) {
+      module->processFrame(frame, frameID);
+      module->takeDetections();
+    });
+  });
+
+  std::vector<LoadResult> results;
+  for (int streams : streamCounts) {
+    for (int workers : workerCounts) {
+      for (int threads : threadCounts) {
+        for (bool pinned : pinnings) {
+          LoadConfiguration configuration = base;
+          configuration.streams = streams;
+          configuration.workers = workers;
+          configuration.cvThreads = threads;
+          configuration.pinned = pinned;
+          std::cerr << "Running " << streams << " streams, " << workers \
+            << (pinned ? " pinned" : "") << " workers, " << threads \
+            << " OpenCV threads" << std::endl;
+          results.push_back(generator.run(configuration));
+        }
+      }
+    }
+  }
+
+  LoadGenerator::printTable(results, std::cout);
+  if (!csvPath.empty()) {
+    std::ofstream csvFile(csvPath);
+    if (!csvFile) {
+      std::cerr << "Can't write " << csvPath << std::endl;
+      return 1;
+    }
+    LoadGenerator::writeCsv(results, csvFile);
+  }
+  return 0;
+}
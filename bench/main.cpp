@@ -0,0 +1,119 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      main.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Entry point of the hodm-bench microbenchmark target
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "BenchmarkRunner.hpp"
+#include "StageBenchmarks.hpp"
+
+/**
+ * @brief Prints the command line options of the benchmark
+ */
+void printUsage(const std::string& applicationName) {
+  std::cerr << "Usage: " << applicationName << " [options]\n" \
+    << "  --filter <text>      run only benchmarks whose name contains text\n" \
+    << "  --min-time <sec>     minimum time spent in each benchmark\n" \
+    << "  --threads <n>        number of OpenCV threads\n" \
+    << "  --json <path>        write the results as JSON to path\n" \
+    << "  --compare <path>     compare against JSON results of a previous run\n" \
+    << "  --output-dir <dir>   directory for the files written by the " \
+    << "benchmarks (default ./)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  BenchmarkRunner runner;
+  std::string jsonPath, comparePath, outputDirectory = "./";
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (i + 1 >= argc) {
+      printUsage(argv[0]);
+      return 1;
+    }
+    std::string value = argv[++i];
+    if (argument == "--filter") {
+      runner.setFilter(value);
+    } else if (argument == "--min-time") {
+      runner.setMinTime(std::atof(value.c_str()));
+    } else if (argument == "--threads") {
+      cv::setNumThreads(std::atoi(value.c_str()));
+    } else if (argument == "--json") {
+      jsonPath = value;
+    } else if (argument == "--compare") {
+      comparePath = value;
+    } else if (argument == "--output-dir") {
+      outputDirectory = value;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+#ifndef __OPTIMIZE__
+  std::cerr << "WARNING: hodm-bench is built without optimization, " \
+    << "configure with -DCMAKE_BUILD_TYPE=Release" << std::endl;
+#endif
+  runner.addContext("opencv", CV_VERSION);
+  runner.addContext("threads", std::to_string(cv::getNumThreads()));
+  runner.addContext("compiler", __VERSION__);
+#ifdef __OPTIMIZE__
+  runner.addContext("optimized", "true");
+#else
+  runner.addContext("optimized", "false");
+#endif
+
+  runStageBenchmarks(runner, outputDirectory);
+
+  runner.printTable(std::cout);
+  if (!jsonPath.empty()) {
+    std::ofstream jsonFile(jsonPath);
+    if (!jsonFile) {
+      std::cerr << "Can't write " << jsonPath << std::endl;
+      return 1;
+    }
+    runner.writeJson(jsonFile);
+  }
+  if (!comparePath.empty()) {
+    std::ifstream baselineFile(comparePath);
+    std::vector<BenchmarkResult> baseline;
+    if (!BenchmarkRunner::readJson(baselineFile, baseline)) {
+      std::cerr << "Can't read results from " << comparePath << std::endl;
+      return 1;
+    }
+    std::cout << std::endl;
+    runner.printComparison(baseline, std::cout);
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      AccuracyEvaluator.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares AccuracyEvaluator class
+ */
+
+#ifndef INCLUDE_ACCURACYEVALUATOR_HPP_
+#define INCLUDE_ACCURACYEVALUATOR_HPP_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Accuracy of the detections of a set of labelled images
+ */
+struct EvaluationMetrics {
+  /* Labelled objects of the class */
+  uint64_t labels = 0;
+  /* Detections of the class, and those matching a label */
+  uint64_t detections = 0;
+  uint64_t truePositives = 0;
+  /* Share of the detections matching a label, and of the labels matched */
+  double precision = 0;
+  double recall = 0;
+  /* Area under the precision recall curve of the detections by score */
+  double averagePrecision = 0;
+};
+
+/**
+ * @brief Accuracy and throughput of one configuration of the pipeline
+ */
+struct EvaluationResult {
+  /* Settings of the configuration, as printed in the table */
+  std::string configuration;
+  EvaluationMetrics metrics;
+  /* Images detected per second */
+  double framesPerSecond = 0;
+  /* Whether no other configuration is at least as accurate and as fast */
+  bool paretoOptimal = false;
+};
+
+/**
+ * @brief Class measuring the accuracy of the detections of one class
+ *        against labelled images
+ *
+ * The detections of an image are matched by decreasing score to the
+ * label they overlap most, among the labels not matched yet, if the
+ * intersection over union reaches the match threshold. The average
+ * precision is the area under the precision recall curve of all the
+ * detections ranked by score, with the precision made monotonic (all
+ * point interpolation, as for Pascal VOC), so it only covers the
+ * detections above the confidence threshold of the configuration.
+ *
+ * Labels are text files next to the images, with the name of the image
+ * and the extension .txt, one object per line in pixels of the image:
+ *   <x1> <y1> <x2> <y2> [class]
+ * the class being 0 for a person when it is left out. Empty lines and
+ * lines starting with # are skipped.
+ */
+class AccuracyEvaluator {
+ public:
+  /**
+   * @brief Constructor for class
+   *
+   * @param matchIou Smallest intersection over union of a detection and
+   *                 the label it matches
+   * @param classId Class evaluated, the others are ignored
+   */
+  explicit AccuracyEvaluator(float matchIou = 0.5f, int32_t classId = 0);
+
+  /**
+   * @brief Matches the detections of an image to its labels
+   *
+   * @param labels Labelled objects of the image
+   * @param detections Detections of the image, in the same coordinates
+   *
+   * @return void
+   */
+  void addImage(const std::vector<Detection>& labels, \
+                const std::vector<Detection>& detections);
+
+  /**
+   * @brief Gives the accuracy of the images added so far
+   *
+   * @return Metrics of the class evaluated
+   */
+  EvaluationMetrics getMetrics() const;
+
+  /**
+   * @brief Forgets the images added
+   *
+   * @return void
+   */
+  void reset();
+
+  /**
+   * @brief Reads the labels of an image
+   *
+   * @param path Path of the label file
+   * @param labels Filled with the labelled objects
+   *
+   * @return false if the file can't be read or a line is not valid
+   */
+  static bool loadLabels(const std::string& path, \
+                         std::vector<Detection>& labels);
+
+  /**
+   * @brief Gives the path of the label file of an image
+   *
+   * @param imagePath Path of the image
+   *
+   * @return Path of the image with the extension .txt
+   */
+  static std::string labelPath(const std::string& imagePath);
+
+  /**
+   * @brief Marks the results that no other result beats on both average
+   *        precision and throughput
+   *
+   * @param results Results of all the configurations
+   *
+   * @return void
+   */
+  static void markParetoFront(std::vector<EvaluationResult>& results);
+
+  /**
+   * @brief Prints the results as a table, by decreasing throughput, the
+   *        Pareto optimal ones marked with *
+   *
+   * @param results Results of all the configurations
+   * @param output Stream the table is printed on
+   *
+   * @return void
+   */
+  static void printTable(const std::vector<EvaluationResult>& results, \
+                         std::ostream& output);
+
+  /**
+   * @brief Writes the results as comma separated values, with a header
+   *
+   * @param results Results of all the configurations
+   * @param output Stream the values are written to
+   *
+   * @return void
+   */
+  static void writeCsv(const std::vector<EvaluationResult>& results, \
+                       std::ostream& output);
+
+ private:
+  /* Score of a detection and whether it matches a label */
+  struct Ranked {
+    float score;
+    bool truePositive;
+  };
+
+  float matchIou;
+  int32_t classId;
+  uint64_t labelCount = 0;
+  std::vector<Ranked> ranked;
+  /* Scratch storage of the matching, reused between images */
+  std::vector<int> order;
+  std::vector<bool> matched;
+};
+
+#endif    // INCLUDE_ACCURACYEVALUATOR_HPP_
@@ -0,0 +1,91 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AllocationCounter.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares AllocationCounter class
+ */
+
+#ifndef INCLUDE_ALLOCATIONCOUNTER_HPP_
+#define INCLUDE_ALLOCATIONCOUNTER_HPP_
+
+#include <cstdint>
+
+/**
+ * @brief Class giving the number of heap allocations done with operator new
+ *        and the number of OpenCV image buffers allocated
+ *
+ * The counts are maintained by replacements of the global operator new
+ * and by a counting cv::MatAllocator made the default allocator of the
+ * images, both defined in AllocationCounter.cpp. That file is only linked
+ * into the test and benchmark targets, so that the application itself
+ * keeps the default allocators. Image buffers are allocated with
+ * cv::fastMalloc, they are counted apart from the operator new
+ * allocations.
+ */
+class AllocationCounter {
+ public:
+  /**
+   * @brief Number of allocations done by all the threads so far
+   *
+   * @return Count of allocations
+   */
+  static uint64_t allocations();
+
+  /**
+   * @brief Number of bytes allocated by all the threads so far
+   *
+   * @return Count of bytes
+   */
+  static uint64_t allocatedBytes();
+
+  /**
+   * @brief Number of allocations done by the calling thread so far
+   *
+   * Unlike allocations(), this count is not affected by work done at the
+   * same time on other threads, e.g. by the OpenCV thread pool.
+   *
+   * @return Count of allocations of the calling thread
+   */
+  static uint64_t threadAllocations();
+
+  /**
+   * @brief Number of image buffers allocated by all the threads so far
+   *
+   * @return Count of cv::Mat buffers
+   */
+  static uint64_t matAllocations();
+
+  /**
+   * @brief Number of image buffers allocated by the calling thread so far
+   *
+   * @return Count of cv::Mat buffers of the calling thread
+   */
+  static uint64_t threadMatAllocations();
+};
+
+#endif    // INCLUDE_ALLOCATIONCOUNTER_HPP_
@@ -0,0 +1,291 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AsyncDetector.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares AsyncDetector class
+ */
+
+#ifndef INCLUDE_ASYNCDETECTOR_HPP_
+#define INCLUDE_ASYNCDETECTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "Detection.hpp"
+#include "IOHandler.hpp"
+#include "LatencyHistogram.hpp"
+#include "MetricsRegistry.hpp"
+
+/**
+ * @brief Statistics of an AsyncDetector
+ */
+struct AsyncDetectorStats {
+  /* Frames given to submit() */
+  uint64_t framesSubmitted = 0;
+  /* Frames whose detections were delivered */
+  uint64_t framesCompleted = 0;
+  /* Frames whose detection failed */
+  uint64_t framesFailed = 0;
+  /* Calls to submit() that had to wait for a free slot */
+  uint64_t blockedSubmits = 0;
+  /* Largest number of frames in flight at once */
+  uint64_t maxInFlight = 0;
+  /* Forward passes run, each on a batch of one or more frames */
+  uint64_t batches = 0;
+  /* Number of batches of every size, indexed by the size */
+  std::vector<uint64_t> batchSizes;
+  /* Time from submission to the start of the batch, in milliseconds */
+  LatencyHistogram queueDelay;
+};
+
+/**
+ * @brief In process detection API with several frames in flight
+ *
+ * submit() copies the frame into one of maxInFlight slots and returns at
+ * once; worker threads run the detection and deliver the detections
+ * through a std::future or a callback. Every worker owns its own detector
+ * (and so its own network), created on the worker thread. When all the
+ * slots are in use submit() blocks until a frame completes, so memory
+ * stays bounded when frames arrive faster than they are detected.
+ *
+ * Frames submitted by several streams can be detected together: a worker
+ * waits until maxBatchSize frames are queued or the oldest one has waited
+ * maxWaitMs, whichever comes first, and detects them with a single forward
+ * pass. Each result goes back to the future or callback of its own frame.
+ *
+ * With more than one worker, frames may complete out of submission order.
+ */
+class AsyncDetector {
+ public:
+  /**
+   * @brief Function detecting the persons of one frame
+   */
+  typedef std::function<std::vector<Detection>(const cv::Mat&, int)> \
+        DetectFunction;
+
+  /**
+   * @brief Function creating the detector of a worker, called on the
+   *        worker thread
+   */
+  typedef std::function<DetectFunction()> DetectorFactory;
+
+  /**
+   * @brief Function detecting the persons of a batch of frames, filling
+   *        the detections of every frame in the order of the frames
+   */
+  typedef std::function<void(const std::vector<cv::Mat>&, \
+        const std::vector<int>&, std::vector<std::vector<Detection>>&)> \
+        BatchDetectFunction;
+
+  /**
+   * @brief Function creating the batch detector of a worker, called on the
+   *        worker thread
+   */
+  typedef std::function<BatchDetectFunction()> BatchDetectorFactory;
+
+  /**
+   * @brief Function receiving the result of a frame, called on a worker
+   *        thread
+   *
+   * Gets the frame ID, the detections and false if the detection failed.
+   */
+  typedef std::function<void(int, const std::vector<Detection>&, bool)> \
+        Callback;
+
+  /**
+   * @brief Constructor for class, starts the workers
+   *
+   * @param factory Creates the detector of every worker
+   * @param workers Number of worker threads
+   * @param maxInFlight Number of frames submitted but not completed
+   */
+  AsyncDetector(DetectorFactory factory, int workers, size_t maxInFlight);
+
+  /**
+   * @brief Constructor for class detecting batches of frames, starts the
+   *        workers
+   *
+   * @param factory Creates the batch detector of every worker
+   * @param workers Number of worker threads
+   * @param maxInFlight Number of frames submitted but not completed, at
+   *                    least maxBatchSize
+   * @param maxBatchSize Largest number of frames of a batch
+   * @param maxWaitMs Longest time a frame waits for the batch to fill
+   */
+  AsyncDetector(BatchDetectorFactory factory, int workers, \
+                size_t maxInFlight, size_t maxBatchSize, int maxWaitMs);
+
+  /**
+   * @brief Constructor for class using one DetectionModule per worker,
+   *        batching as set by the options
+   *
+   * @param options Options given to the DetectionModules
+   * @param workers Number of worker threads
+   * @param maxInFlight Number of frames submitted but not completed
+   * @param registry Registry the DetectionModules report to, none if null
+   */
+  AsyncDetector(const RunOptions& options, int workers, \
+                size_t maxInFlight, MetricsRegistry* registry = nullptr);
+
+  /**
+   * @brief Destructor for class, completes the submitted frames and
+   *        stops the workers
+   */
+  ~AsyncDetector();
+
+  /**
+   * @brief Creates DetectionModules configured by the options, loaded
+   *        and warmed up on the worker thread
+   *
+   * Every worker is first pinned to its part of the inference CPUs of the
+   * options.
+   *
+   * @param options Options given to the DetectionModules
+   * @param workers Number of workers sharing the inference CPUs
+   * @param registry Registry the DetectionModules report to once warmed
+   *        up, none if null. It must outlive the DetectionModules
+   *
+   * @return Factory of detectors
+   */
+  static BatchDetectorFactory moduleFactory(const RunOptions& options, \
+      int workers = 1, MetricsRegistry* registry = nullptr);
+
+  /**
+   * @brief Submits a frame, blocks while maxInFlight frames are in flight
+   *
+   * @param frame Frame in BGR of any size, copied before returning
+   * @param frameID ID given to the detections
+   *
+   * @return Future of the detections, holding the exception if the
+   *         detection failed
+   */
+  std::future<std::vector<Detection>> submit(const cv::Mat& frame, \
+                                             int frameID);
+
+  /**
+   * @brief Submits a frame, blocks while maxInFlight frames are in flight
+   *
+   * @param frame Frame in BGR of any size, copied before returning
+   * @param frameID ID given to the detections
+   * @param callback Receives the detections on a worker thread
+   *
+   * @return void
+   */
+  void submit(const cv::Mat& frame, int frameID, Callback callback);
+
+  /**
+   * @brief Waits until every submitted frame is completed
+   *
+   * @return void
+   */
+  void waitIdle();
+
+  /**
+   * @brief Gives the number of frames submitted but not completed
+   *
+   * @return Frames in flight
+   */
+  size_t inFlight();
+
+  /**
+   * @brief Gives the statistics of the detector
+   *
+   * @return Statistics since the construction
+   */
+  AsyncDetectorStats getStats();
+
+ private:
+  /**
+   * @brief Frame waiting for or going through detection
+   */
+  struct Job {
+    /* Slot holding the copy of the frame */
+    size_t slot = 0;
+    int frameID = 0;
+    /* Either the promise or the callback receives the result */
+    std::shared_ptr<std::promise<std::vector<Detection>>> promise;
+    Callback callback;
+    /* Time of the submission */
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  /**
+   * @brief Copies a frame into a free slot and queues its job
+   *
+   * @param frame Frame to copy
+   * @param job Job of the frame, the slot is filled in
+   *
+   * @return void
+   */
+  void enqueue(const cv::Mat& frame, Job job);
+
+  /**
+   * @brief Loop of the worker threads
+   *
+   * @return void
+   */
+  void runWorker();
+
+  /* Creates the detectors of the workers */
+  BatchDetectorFactory detectorFactory;
+  /* Largest number of frames of a batch */
+  size_t maxBatchSize = 1;
+  /* Longest time a frame waits for the batch to fill */
+  std::chrono::milliseconds maxWait;
+  /* Copies of the frames in flight, reused from frame to frame */
+  std::vector<cv::Mat> slots;
+  /* Indexes of the slots not in use */
+  std::vector<size_t> freeSlots;
+  /* Jobs waiting for a worker */
+  std::deque<Job> jobs;
+  /* Frames submitted but not completed */
+  size_t pending = 0;
+  /* Set when the workers must stop */
+  bool stopping = false;
+  /* Protects the members above and the statistics */
+  std::mutex mutex;
+  /* Signaled when a job is queued or the detector stops */
+  std::condition_variable jobQueued;
+  /* Signaled when a frame completes */
+  std::condition_variable jobCompleted;
+  /* Worker threads */
+  std::vector<std::thread> workers;
+  /* Statistics of the detector */
+  AsyncDetectorStats stats;
+};
+
+#endif    // INCLUDE_ASYNCDETECTOR_HPP_
@@ -0,0 +1,231 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AsyncVideoWriter.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares AsyncVideoWriter class
+ */
+
+#ifndef INCLUDE_ASYNCVIDEOWRITER_HPP_
+#define INCLUDE_ASYNCVIDEOWRITER_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "MjpegAviWriter.hpp"
+
+/**
+ * @brief Statistics of an AsyncVideoWriter
+ */
+struct VideoWriterStats {
+  /* Frames given to write() */
+  uint64_t framesSubmitted = 0;
+  /* Frames written to the file */
+  uint64_t framesWritten = 0;
+  /* Frames that could not be written */
+  uint64_t framesFailed = 0;
+  /* Files the video was written to, more than one when a file reached
+  its maximum size */
+  uint64_t files = 0;
+  /* Calls to write() that had to wait for room in the queue */
+  uint64_t blockedWrites = 0;
+  /* Total time spent waiting for room in the queue, in milliseconds */
+  double blockedMs = 0;
+  /* Largest number of frames queued at once */
+  uint64_t maxQueueDepth = 0;
+  /* Total time spent encoding the frames, in milliseconds */
+  double encodeMs = 0;
+};
+
+/**
+ * @brief Class writing the annotated frames of a video on other threads
+ *
+ * write() copies the frame into a slot of a bounded queue and returns, the
+ * encoding happens on background threads. When the queue is full write()
+ * blocks until a frame has been written (backpressure), so memory stays
+ * bounded when encoding is slower than detection.
+ *
+ * Without encoder threads a single thread writes the frames with
+ * cv::VideoWriter (MJPG). With encoder threads the frames are encoded to
+ * JPEG in parallel and muxed by MjpegAviWriter, which continues in
+ * <name>_part<n>.avi files when a file reaches its maximum size. In both
+ * cases the frames
+ * are written in the order of their frame IDs, write() refuses a frame ID
+ * that is not larger than the previous one.
+ */
+class AsyncVideoWriter {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  AsyncVideoWriter();
+
+  /**
+   * @brief Destructor for class, writes the queued frames and closes the
+   *        file
+   */
+  ~AsyncVideoWriter();
+
+  /**
+   * @brief Creates the video file and starts the background threads
+   *
+   * @param filePath Path of the video file
+   * @param fps Frame rate of the video
+   * @param frameSize Size of the frames
+   * @param queueCapacity Number of frames that can be queued
+   * @param encoderThreads Number of JPEG encoder threads, 0 to encode with
+   *                       cv::VideoWriter on a single thread
+   *
+   * @return true if the file is created
+   */
+  bool open(const std::string& filePath, double fps, cv::Size frameSize, \
+            size_t queueCapacity, int encoderThreads);
+
+  /**
+   * @brief Checks if a file is open
+   *
+   * @return true between open and close
+   */
+  bool isOpened() const;
+
+  /**
+   * @brief Queues a frame to be written
+   *
+   * The frame is copied, so the caller can reuse it right away. Blocks
+   * while the queue is full.
+   *
+   * @param frameID ID of the frame, larger than the previous one
+   * @param frame Image to write, of the size given to open
+   *
+   * @return true if the frame is queued
+   */
+  bool write(int frameID, const cv::Mat& frame);
+
+  /**
+   * @brief Sets the largest size of the files of the encoder threads, see
+   *        MjpegAviWriter::setMaxFileSize, before opening the video
+   *
+   * @param bytes Size in bytes
+   *
+   * @return void
+   */
+  void setMaxFileSize(uint64_t bytes);
+
+  /**
+   * @brief Writes the queued frames, stops the threads and closes the file
+   *
+   * @return void
+   */
+  void close();
+
+  /**
+   * @brief Gives the statistics of the writer
+   *
+   * @return Statistics since the file was opened
+   */
+  VideoWriterStats getStats();
+
+ private:
+  /* States of a queue slot */
+  enum SlotState {
+    kFree,
+    kQueued,
+    kEncoding,
+    kEncoded
+  };
+
+  /* Frame held by the queue */
+  struct Slot {
+    SlotState state = kFree;
+    int frameID = 0;
+    cv::Mat image;
+    std::vector<uchar> jpeg;
+  };
+
+  /**
+   * @brief Loop of the encoder threads
+   *
+   * @return void
+   */
+  void encodeFrames();
+
+  /**
+   * @brief Loop of the thread writing the frames in order
+   *
+   * @return void
+   */
+  void writeFrames();
+
+  /**
+   * @brief Writes an encoded frame, continuing in the next part of the
+   *        video when the file is full
+   *
+   * @param jpeg Encoded frame
+   *
+   * @return true if the frame is written
+   */
+  bool writeEncoded(const std::vector<uchar>& jpeg);
+
+  /* Slots of the queue, frame number n uses slot n % size */
+  std::vector<Slot> slots;
+  /* Number of frames submitted, encoded (taken by an encoder) and
+  written */
+  uint64_t submitted = 0;
+  uint64_t encodeNext = 0;
+  uint64_t written = 0;
+  /* Frame ID of the last frame submitted */
+  int lastFrameID = 0;
+  /* Set when the file is being closed */
+  bool closing = false;
+  /* Protects the slots, the counters and the statistics */
+  std::mutex mutex;
+  /* Signaled when a slot changes state */
+  std::condition_variable slotChanged;
+  /* Threads encoding and writing the frames */
+  std::vector<std::thread> encoders;
+  std::thread writer;
+  /* Writer of the frames when there are no encoder threads */
+  cv::VideoWriter videoWriter;
+  /* Writer of the JPEG frames when there are encoder threads */
+  MjpegAviWriter aviWriter;
+  /* Size of the frames of the file */
+  cv::Size size;
+  /* Path and frame rate of the video, and number of its files */
+  std::string path;
+  double frameRate = 0;
+  int parts = 0;
+  /* Statistics of the writer */
+  VideoWriterStats stats;
+};
+
+#endif    // INCLUDE_ASYNCVIDEOWRITER_HPP_
@@ -0,0 +1,176 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AutoTuner.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares AutoTuner class
+ */
+
+#ifndef INCLUDE_AUTOTUNER_HPP_
+#define INCLUDE_AUTOTUNER_HPP_
+
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "IOHandler.hpp"
+
+/**
+ * @brief Throughput and latency measured for one configuration
+ */
+struct TuningMeasurement {
+  /* Frames detected per second with all the workers busy */
+  double framesPerSecond = 0;
+  /* Median and 99th percentile of the time from submission to result,
+  in milliseconds */
+  double p50Ms = 0;
+  double p99Ms = 0;
+};
+
+/**
+ * @brief Class searching the fastest runtime configuration of the host
+ *
+ * Every combination of OpenCV threads, workers, batch size and input size
+ * that fits the cores is measured, then the noise filters are compared on
+ * the best of them. The chosen configuration has the highest throughput
+ * among those whose p99 latency stays under the cap, or the lowest p99 if
+ * none does.
+ */
+class AutoTuner {
+ public:
+  /**
+   * @brief Function measuring one configuration
+   */
+  typedef std::function<TuningMeasurement(const RunOptions&)> \
+        MeasureFunction;
+
+  /**
+   * @brief Constructor for class
+   *
+   * @param measure Measures a configuration
+   * @param latencyCapMs Largest acceptable p99 latency in milliseconds
+   */
+  AutoTuner(MeasureFunction measure, double latencyCapMs);
+
+  /**
+   * @brief Destructor for class
+   */
+  ~AutoTuner();
+
+  /**
+   * @brief Lists the configurations of threads, workers, batch size and
+   *        input size to measure
+   *
+   * Threads and workers go by powers of two, their product staying within
+   * the cores. Batches are 1, 2 and 4 frames.
+   *
+   * @param base Options the configurations start from
+   * @param cores Number of cores of the host
+   * @param inputSizes Input sizes to try
+   * @param candidates Filled with the configurations
+   *
+   * @return void
+   */
+  static void listCandidates(const RunOptions& base, int cores, \
+                             const std::vector<int>& inputSizes, \
+                             std::vector<RunOptions>& candidates);
+
+  /**
+   * @brief Measures the candidates and then the filters, printing every
+   *        measurement
+   *
+   * @param base Options the configurations start from
+   * @param cores Number of cores of the host
+   * @param inputSizes Input sizes to try
+   * @param log Stream the measurements are printed to
+   *
+   * @return true if a configuration meets the latency cap
+   */
+  bool tune(const RunOptions& base, int cores, \
+            const std::vector<int>& inputSizes, std::ostream& log);
+
+  /**
+   * @brief Gives the chosen configuration
+   *
+   * @return Options of the best configuration measured by tune
+   */
+  const RunOptions& getBest() const;
+
+  /**
+   * @brief Gives the measurement of the chosen configuration
+   *
+   * @return Measurement of the best configuration
+   */
+  const TuningMeasurement& getBestMeasurement() const;
+
+  /**
+   * @brief Creates the measurement running an AsyncDetector on a frame
+   *
+   * The OpenCV threads are set, the workers warmed up, and the frame is
+   * submitted with workers x batch frames in flight.
+   *
+   * @param frame Frame detected over and over, in BGR
+   * @param frames Number of frames timed per configuration
+   *
+   * @return Function measuring a configuration
+   */
+  static MeasureFunction detectorBenchmark(const cv::Mat& frame, \
+                                           int frames);
+
+ private:
+  /* Measures a configuration */
+  MeasureFunction measure;
+  /* Largest acceptable p99 latency */
+  double latencyCapMs;
+  /* Best configuration so far and its measurement */
+  RunOptions best;
+  TuningMeasurement bestMeasurement;
+  /* Whether a configuration has been measured yet */
+  bool measured = false;
+
+  /**
+   * @brief Measures a configuration and keeps it if it is the best so far
+   *
+   * @param options Configuration to measure
+   * @param log Stream the measurement is printed to
+   *
+   * @return void
+   */
+  void evaluate(const RunOptions& options, std::ostream& log);
+
+  /**
+   * @brief Checks if a measurement beats the best one
+   *
+   * @param measurement Measurement of a configuration
+   *
+   * @return true if it is better
+   */
+  bool isBetter(const TuningMeasurement& measurement) const;
+};
+
+#endif    // INCLUDE_AUTOTUNER_HPP_
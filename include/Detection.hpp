@@ -0,0 +1,69 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      Detection.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares Detection structure
+ */
+
+#ifndef INCLUDE_DETECTION_HPP_
+#define INCLUDE_DETECTION_HPP_
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief One detected object of a frame
+ *
+ * Plain record stored contiguously, so that the detections of a frame are
+ * passed between the stages without an allocation per detection.
+ */
+struct Detection {
+  /* Track ID of the objects that are not tracked */
+  static const int32_t kNoTrack = -1;
+
+  /* ID of the frame the object is detected in */
+  int32_t frameID = 0;
+  /* Upper left and bottom right corners of the bounding box */
+  int32_t x1 = 0;
+  int32_t y1 = 0;
+  int32_t x2 = 0;
+  int32_t y2 = 0;
+  /* Confidence score given by the network */
+  float score = 0;
+  /* Class of the object, 0 being a person */
+  int32_t classId = 0;
+  /* ID of the object across frames, kNoTrack if it is not tracked */
+  int32_t trackID = kNoTrack;
+};
+
+static_assert(std::is_trivially_copyable<Detection>::value, \
+              "Detection must stay a plain record");
+static_assert(sizeof(Detection) == 8 * sizeof(int32_t), \
+              "Detection must stay packed");
+
+#endif    // INCLUDE_DETECTION_HPP_
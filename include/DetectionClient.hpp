@@ -0,0 +1,121 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionClient.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares DetectionClient class
+ */
+
+#ifndef INCLUDE_DETECTIONCLIENT_HPP_
+#define INCLUDE_DETECTIONCLIENT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DetectionProtocol.hpp"
+
+/**
+ * @brief Class sending images to a DetectionServer
+ *
+ * Keeps one connection open for all its requests. Not thread safe, use one
+ * client per thread.
+ */
+class DetectionClient {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  DetectionClient();
+
+  /**
+   * @brief Destructor for class, closes the connection
+   */
+  ~DetectionClient();
+
+  /**
+   * @brief Connects to a server
+   *
+   * @param socketPath Path of the Unix domain socket of the server
+   *
+   * @return true if connected
+   */
+  bool connect(const std::string& socketPath);
+
+  /**
+   * @brief Closes the connection
+   *
+   * @return void
+   */
+  void disconnect();
+
+  /**
+   * @brief Sends an encoded image (JPEG, PNG, ...) and waits for the
+   *        detections
+   *
+   * @param data Content of the image file
+   * @param size Size of the content in bytes
+   * @param detections Filled with the detections
+   *
+   * @return Status of the response, kServerError if the connection fails
+   */
+  uint16_t detectEncoded(const void* data, size_t size, \
+                         std::vector<Detection>& detections);
+
+  /**
+   * @brief Sends a raw BGR frame and waits for the detections
+   *
+   * @param pixels Pixels of the frame, rows without padding
+   * @param width Width of the frame
+   * @param height Height of the frame
+   * @param detections Filled with the detections
+   *
+   * @return Status of the response, kServerError if the connection fails
+   */
+  uint16_t detectRaw(const void* pixels, uint32_t width, uint32_t height, \
+                     std::vector<Detection>& detections);
+
+ private:
+  /**
+   * @brief Sends a request and waits for its response
+   *
+   * @param header Header of the request
+   * @param payload Payload of the request
+   * @param detections Filled with the detections
+   *
+   * @return Status of the response
+   */
+  uint16_t request(protocol::RequestHeader& header, const void* payload, \
+                   std::vector<Detection>& detections);
+
+  /* Socket of the connection */
+  int fd = -1;
+  /* ID of the next request */
+  uint32_t nextRequestID = 0;
+};
+
+#endif    // INCLUDE_DETECTIONCLIENT_HPP_
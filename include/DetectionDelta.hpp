@@ -0,0 +1,249 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      DetectionDelta.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares DeltaEncoder and DeltaDecoder classes
+ */
+
+#ifndef INCLUDE_DETECTIONDELTA_HPP_
+#define INCLUDE_DETECTIONDELTA_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Statistics of a DeltaEncoder
+ */
+struct DeltaStats {
+  /* Frames encoded, with or without detections */
+  uint64_t frames = 0;
+  /* Frames written in full */
+  uint64_t keyframes = 0;
+  /* Boxes of all the frames */
+  uint64_t boxes = 0;
+  /* Boxes written, in full frames or as changes */
+  uint64_t boxesWritten = 0;
+};
+
+/**
+ * @brief Class writing the detections of consecutive frames as the changes
+ *        from one frame to the next
+ *
+ * Every frame is compared with the boxes the decoder holds. A box of the
+ * same class and track within tolerance pixels on every side and within
+ * the score tolerance is unchanged and not written, so the decoded box
+ * may differ from the detected one by up to the tolerance, without
+ * drifting further. Otherwise the box is written as moved when it still
+ * overlaps a held box, as new when it doesn't, and the held boxes left
+ * are removed. Frames without a change are not written at all. One frame
+ * every keyframe interval is written in full so that a decoder can start
+ * there.
+ *
+ * Text layout, one record per line:
+ *   hodm-delta 1 <keyframe interval> <tolerance> <score tolerance>
+ *   K <frame> <n>             full frame, followed by n boxes
+ *     <x1> <y1> <x2> <y2> <score> <class> <track>
+ *   F <frame> <moved> <removed> <new>    changes, followed by
+ *     ~ <index> <x1> <y1> <x2> <y2> <score>   for every moved box
+ *     - <index>                               for every removed box
+ *     + <x1> <y1> <x2> <y2> <score> <class> <track>   for every new box
+ *   E <frame>                 last frame
+ * Indexes are those of the held boxes before the frame. Moved boxes keep
+ * their place, removed ones are erased and new ones appended after them.
+ */
+class DeltaEncoder {
+ public:
+  /**
+   * @brief Constructor for class
+   *
+   * @param output Stream the records are written to
+   * @param keyframeInterval Largest number of frames between two full
+   *                         frames
+   * @param tolerance Largest move in pixels of a side of an unchanged box
+   * @param scoreTolerance Largest change of the score of an unchanged box
+   */
+  explicit DeltaEncoder(std::ostream& output, int keyframeInterval = 300, \
+                        int tolerance = 2, float scoreTolerance = 0.05f);
+
+  /**
+   * @brief Writes the changes of one frame
+   *
+   * Frames are given in increasing ID order. The frames skipped between
+   * two calls are encoded as frames without detections.
+   *
+   * @param frameID ID of the frame
+   * @param detections Detections of the frame
+   * @param count Number of detections
+   *
+   * @return false if the frame comes before the last one encoded
+   */
+  bool encode(int frameID, const Detection* detections, size_t count);
+
+  /**
+   * @brief Encodes a run of detections, grouped by frame
+   *
+   * @param detections Detections of all the frames, in frame order
+   *
+   * @return false if the frames are not in order
+   */
+  bool encodeAll(const std::vector<Detection>& detections);
+
+  /**
+   * @brief Writes the end of the records
+   *
+   * @param lastFrameID ID of the last frame of the run, the frames after
+   *                    the last one encoded being without detections
+   *
+   * @return void
+   */
+  void finish(int lastFrameID);
+
+  /**
+   * @brief Gives the statistics of the frames encoded
+   *
+   * @return Statistics
+   */
+  const DeltaStats& getStats() const;
+
+  /**
+   * @brief Prints the share of the boxes written
+   *
+   * @param output Stream the report is printed on
+   *
+   * @return void
+   */
+  void printReport(std::ostream& output) const;
+
+ private:
+  /**
+   * @brief Writes one frame, in full or as changes
+   */
+  void encodeFrame(int frameID, const Detection* detections, size_t count);
+
+  /**
+   * @brief Writes the first line of the records, once
+   */
+  void writeHeader();
+
+  /**
+   * @brief Writes a box with its class and track
+   */
+  void writeBox(const Detection& detection);
+
+  std::ostream& output;
+  int keyframeInterval;
+  int tolerance;
+  float scoreTolerance;
+  bool started = false;
+  int nextFrameID = 0;
+  int keyframeID = 0;
+  /* Boxes held by the decoder */
+  std::vector<Detection> held;
+  /* Scratch storage of the comparison, reused between frames: the box
+  of the frame matched by every held box or -1, whether it is unchanged,
+  whether every box of the frame is matched, and the next held boxes */
+  std::vector<int> match;
+  std::vector<bool> unchanged;
+  std::vector<bool> matched;
+  std::vector<Detection> next;
+  DeltaStats stats;
+};
+
+/**
+ * @brief Class reading the detections of the frames written by a
+ *        DeltaEncoder
+ *
+ * The positions of the full frames are indexed when the file is opened,
+ * so reading a frame only decodes from the full frame before it, and
+ * reading the frames in order decodes each record once.
+ */
+class DeltaDecoder {
+ public:
+  /**
+   * @brief Opens a file written by a DeltaEncoder and indexes its full
+   *        frames
+   *
+   * @param path Path of the file
+   *
+   * @return false if the file can't be read or is not delta encoded
+   */
+  bool open(const std::string& path);
+
+  /**
+   * @brief Gives the ID of the last frame of the file
+   *
+   * @return ID of the last frame, -1 if there is none
+   */
+  int getLastFrameID() const;
+
+  /**
+   * @brief Reads the detections of one frame
+   *
+   * @param frameID ID of the frame
+   * @param detections Replaced with the detections of the frame
+   *
+   * @return false if the frame is not in the file or a record is invalid
+   */
+  bool readFrame(int frameID, std::vector<Detection>& detections);
+
+  /**
+   * @brief Reads the detections of all the frames
+   *
+   * @param detections Replaced with the detections, in frame order
+   *
+   * @return false if a record is invalid
+   */
+  bool readAll(std::vector<Detection>& detections);
+
+ private:
+  /**
+   * @brief Applies the records up to a frame to the held boxes
+   */
+  bool advance(int frameID);
+
+  /**
+   * @brief Applies the record starting with a line
+   */
+  bool applyRecord(const std::string& line);
+
+  std::ifstream input;
+  /* Offset of the full frames by frame ID */
+  std::map<int, std::streamoff> keyframes;
+  int lastFrameID = -1;
+  /* Frame the held boxes are those of, -1 before the first record */
+  int decodedFrameID = -1;
+  std::vector<Detection> held;
+  std::vector<bool> removed;
+};
+
+#endif    // INCLUDE_DETECTIONDELTA_HPP_
@@ -0,0 +1,127 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionInterpolator.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares DetectionInterpolator class
+ */
+
+#ifndef INCLUDE_DETECTIONINTERPOLATOR_HPP_
+#define INCLUDE_DETECTIONINTERPOLATOR_HPP_
+
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Class giving the detections of the frames skipped between two
+ *        detected key frames
+ *
+ * The boxes of the two key frames are paired greedily by decreasing
+ * intersection over union, among boxes of the same class overlapping by
+ * at least the match threshold. A paired box moves linearly from one key
+ * frame to the other, its score too. A box without a pair is kept as it
+ * is for the frames closer to its own key frame, so objects appear and
+ * disappear half way.
+ */
+class DetectionInterpolator {
+ public:
+  /**
+   * @brief Constructor for class
+   *
+   * @param matchIou Smallest intersection over union of two boxes paired
+   *                 across the key frames
+   */
+  explicit DetectionInterpolator(float matchIou = 0.3f);
+
+  /**
+   * @brief Sets the key frames to interpolate between, pairing their boxes
+   *
+   * Giving the same detections for both holds them over the frames in
+   * between, e.g. after the last key frame of a video.
+   *
+   * @param firstID ID of the first key frame
+   * @param first Detections of the first key frame
+   * @param lastID ID of the last key frame, not smaller than firstID
+   * @param last Detections of the last key frame
+   *
+   * @return void
+   */
+  void setKeyFrames(int firstID, const std::vector<Detection>& first, \
+                    int lastID, const std::vector<Detection>& last);
+
+  /**
+   * @brief Appends the detections of one frame between the key frames
+   *
+   * @param frameID ID of the frame, between the IDs of the key frames
+   * @param detections Detections of the frame are appended to it
+   *
+   * @return void
+   */
+  void interpolate(int frameID, std::vector<Detection>& detections) const;
+
+  /**
+   * @brief Gives the intersection over union of two boxes
+   *
+   * @param first First box
+   * @param second Second box
+   *
+   * @return Area of the intersection over the area of the union, 0 if
+   *         they don't overlap
+   */
+  static float iou(const Detection& first, const Detection& second);
+
+ private:
+  /* Pair of boxes of the key frames, -1 for a box without a pair */
+  struct Pair {
+    int first;
+    int last;
+  };
+
+  /* Candidate pair with its overlap */
+  struct Candidate {
+    float iou;
+    int first;
+    int last;
+  };
+
+  /* Smallest overlap of a pair */
+  float matchIou;
+  /* IDs and detections of the key frames */
+  int firstID = 0;
+  int lastID = 0;
+  std::vector<Detection> first;
+  std::vector<Detection> last;
+  /* Pairs of the boxes, then the boxes left alone */
+  std::vector<Pair> pairs;
+  /* Scratch storage of the pairing, reused between key frames */
+  std::vector<Candidate> candidates;
+  std::vector<bool> firstPaired;
+  std::vector<bool> lastPaired;
+};
+
+#endif    // INCLUDE_DETECTIONINTERPOLATOR_HPP_
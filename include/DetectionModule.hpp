@@ -42,9 +42,20 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include "VisionModule.hpp"
+#include "AsyncVideoWriter.hpp"
+#include "DetectionInterpolator.hpp"
+#include "FrameArena.hpp"
+#include "FrameRenderer.hpp"
+#include "FrameRing.hpp"
+#include "FrameStreamReader.hpp"
+#include "ImageLoader.hpp"
 #include "IOHandler.hpp"
+#include "MetricsRegistry.hpp"
 #include "Network.hpp"
+#include "Profiler.hpp"
+#include "ResultCache.hpp"
 #include "Transformation.hpp"
+#include "VideoCheckpoint.hpp"
 
 /**
  * @brief Class for Implementing Human Obstacle Detection Algorithms
@@ -63,16 +74,315 @@ class DetectionModule : public VisionModule {
   std::vector<cv::Mat> detectedObjects;
   /* Choice of input - Image, Video or Live Cam Feed */
   int inputChoice;
+  /* Object to read the still images, at reduced resolution if possible */
+  ImageLoader imageLoader;
   /* Object to parse the video frames */
   cv::VideoCapture videoFrames;
-  /* Object to write the video frames*/
-  cv::VideoWriter videoWriter;
+  /* Object to write the video frames, on background threads */
+  AsyncVideoWriter videoWriter;
   /* Confidence Threshold for the predictions */
   float confidenceThreshold = 0.9;
   /* Non-Maximum Threshold Value */
   float nmsThreshold = 0.9;
-  /* Vector to store the vector of detection information */
-  std::vector< std::vector <int> > finalDetections;
+  /* Detections of all the frames processed so far */
+  std::vector<Detection> finalDetections;
+  /* Options given on the command line */
+  RunOptions options;
+  /* Records the latency of every stage when profiling is enabled */
+  Profiler profiler;
+  /* Buffers reused by the stages for every frame */
+  FrameArena arena;
+  /* Pre processed images of the batch being detected */
+  std::vector<cv::Mat> batchImages;
+  /* Planes of the input blob of a YUV frame, filtered in place */
+  std::vector<cv::Mat> inputPlanes;
+  /* Regions of the zones detected in for the current frame, the size of
+  the frame and its image for the output */
+  std::vector<cv::Rect> zoneRegions;
+  cv::Size zoneFrameSize;
+  cv::Mat zoneImage;
+  /* Output of the network and decoded boxes of one region */
+  std::vector<cv::Mat> zoneOutput;
+  std::vector<cv::Rect> zoneBoxes;
+  std::vector<float> zoneScores;
+  std::vector<int> zoneClassIds;
+  /* Zones scaled to the output image */
+  std::vector<std::vector<cv::Point>> zoneOutlines;
+  /* Whether the detections are drawn on the processed image, only when the
+  image is written */
+  bool drawing = true;
+  /* Detections of the last processed frame before their transformation,
+  drawn by the renderer */
+  std::vector<Detection> frameDetections;
+  /* Gives the boxes of the video frames skipped by the frame stride */
+  DetectionInterpolator interpolator;
+  /* Detections of the last key frame before their transformation, and
+  those interpolated for the frames after it */
+  std::vector<Detection> keyDetections;
+  std::vector<Detection> interpolatedDetections;
+  /* Detections of the images seen in earlier runs */
+  ResultCache resultCache;
+  /* Hash of the model and the settings the cache keys start from */
+  uint64_t cacheFingerprint = 0;
+  /* Detections of an image found in the cache */
+  std::vector<Detection> cachedDetections;
+  /* Registry the module reports to, nullptr if it does not */
+  MetricsRegistry* metrics = nullptr;
+  /* Metrics updated for every frame, nullptr without registry */
+  MetricCounter* framesMetric = nullptr;
+  MetricCounter* detectionsMetric = nullptr;
+  MetricGauge* frameDetectionsMetric = nullptr;
+  /* Frames not shown by the display, skipped by the shared ring while the
+  detection was busy, and overwritten while they were read */
+  MetricCounter* displayDropsMetric = nullptr;
+  MetricCounter* busyDropsMetric = nullptr;
+  MetricCounter* tornDropsMetric = nullptr;
+  /* Intrinsic matrix of the camera and its inverse */
+  cv::Matx33f intrinsic;
+  cv::Matx33f intrinsicInverse;
+
+  /**
+   * @brief Reads the next frame of the video or camera feed
+   *
+   * @param image Filled with the frame that is read
+   * @param frameID ID given to the frame
+   *
+   * @return true if a frame is read, false at the end of the input
+   */
+  bool readFrame(cv::Mat& image, int frameID);
+
+  /**
+   * @brief Detects the frames of a video, committing its progress to the
+   *        checkpoint of the options and resuming from it if asked
+   *
+   * The detections are written before the checkpoint is removed, so that
+   * a job failing to write them can still be resumed.
+   *
+   * @param filePath Path of the video
+   * @param outputDirectory Directory of the annotated video and the
+   *                        detections
+   *
+   * @return false if the video can't be opened or resumed, or its
+   *         detections can't be written
+   */
+  bool processVideo(const std::string& filePath, \
+                    const std::string& outputDirectory);
+
+  /**
+   * @brief Moves the video to a frame, seeking if the container allows it
+   *        and grabbing the frames before it otherwise
+   *
+   * @param filePath Path of the video, reopened to grab the frames
+   * @param frameID ID of the next frame read
+   *
+   * @return false if the video has fewer frames
+   */
+  bool seekFrame(const std::string& filePath, int frameID);
+
+  /**
+   * @brief Gives the path of a segment of the annotated video of a
+   *        checkpointed job
+   *
+   * @param outputDirectory Directory of the annotated video
+   * @param segmentIndex Index of the segment
+   *
+   * @return Path of the segment
+   */
+  static std::string videoSegmentPath(const std::string& outputDirectory, \
+                                      int segmentIndex);
+
+  /**
+   * @brief Identifies a video job by the settings that change the
+   *        detections and by the video file
+   *
+   * @param filePath Path of the video
+   *
+   * @return Key of the job in its checkpoint
+   */
+  uint64_t videoJobKey(const std::string& filePath);
+
+  /**
+   * @brief Moves past the next frame of the video without decoding it to
+   *        an image
+   *
+   * @param frameID ID of the skipped frame
+   *
+   * @return true if a frame is skipped, false at the end of the input
+   */
+  bool skipFrame(int frameID);
+
+  /**
+   * @brief Adds the interpolated detections of the frames between two key
+   *        frames to the detections of the run
+   *
+   * @param firstID ID of the first key frame
+   * @param first Detections of the first key frame, not transformed
+   * @param lastID ID of the last key frame
+   * @param last Detections of the last key frame, not transformed
+   * @param position Index of the detections of the run they are inserted
+   *                 at, where the detections of the last key frame start
+   *
+   * @return void
+   */
+  void interpolateFrames(int firstID, const std::vector<Detection>& first, \
+                         int lastID, const std::vector<Detection>& last, \
+                         size_t position);
+
+  /**
+   * @brief Reads, processes and writes one still image
+   *
+   * @param filePath Path of the image
+   * @param outputPath Path of the annotated image
+   * @param frameID ID given to the image
+   *
+   * @return false if the image can't be read
+   */
+  bool processImageFile(const std::string& filePath, \
+                        const std::string& outputPath, int frameID);
+
+  /**
+   * @brief Describes the model and the settings that change the detections
+   *
+   * @return Description of the settings
+   */
+  std::string describeSettings();
+
+  /**
+   * @brief Opens the result cache of the options, keyed by the model and
+   *        the settings that change the detections
+   *
+   * @return false if the file is not a result cache
+   */
+  bool openCache();
+
+  /**
+   * @brief Processes one still image of a directory, unless the cache has
+   *        its detections and its annotated image exists
+   *
+   * @param filePath Path of the image
+   * @param outputPath Path of the annotated image
+   * @param frameID ID given to the image
+   *
+   * @return false if the image can't be read
+   */
+  bool processCachedImage(const std::string& filePath, \
+                          const std::string& outputPath, int frameID);
+
+  /**
+   * @brief Processes the frames of a shared memory ring, read in place,
+   *        until the writer closes the ring or exits
+   *
+   * @param ringName Name of the FrameRing
+   *
+   * @return false if the ring can't be opened
+   */
+  bool processSharedFrames(const std::string& ringName);
+
+  /**
+   * @brief Converts a frame of a stream to a BGR image
+   *
+   * @param pixels Pixels of the frame
+   * @param reader Reader giving the format and size of the frame
+   * @param image Filled with the frame in BGR, reused from frame to frame;
+   *              a BGR frame is used in place
+   *
+   * @return false if the frame can't be converted
+   */
+  bool convertStreamFrame(std::vector<unsigned char>& pixels, \
+                          const FrameStreamReader& reader, cv::Mat& image);
+
+  /**
+   * @brief Runs the forward pass on the input blob of the network
+   *
+   * @return 0 if the network gives no output, 1 if not
+   */
+  int runNetwork();
+
+  /**
+   * @brief Decodes the output of the last forward pass and applies NMS
+   *
+   * @param frameSize Size of the image the boxes are scaled to
+   * @param frameID ID of the frame
+   *
+   * @return Detections of the frame, in a buffer of the arena
+   */
+  std::vector<Detection>& suppressDetections(cv::Size frameSize, \
+                                             int frameID);
+
+  /**
+   * @brief Transforms the detections of a frame to the robot's frame and
+   *        adds them to the detections of the run
+   *
+   * @param detections Detections of the frame, transformed in place
+   *
+   * @return void
+   */
+  void storeDetections(std::vector<Detection>& detections);
+
+  /**
+   * @brief Pre processes the regions of the zones of a frame as one batch,
+   *        and keeps the whole frame at the network size for the output
+   *
+   * @param image Frame (image) as read from the input
+   * @param filterType Type of filter to be used for removing noise
+   *
+   * @return void
+   */
+  void prepareZones(const cv::Mat& image, char filterType);
+
+  /**
+   * @brief Detects in the regions prepared by prepareZones with a single
+   *        forward pass
+   *
+   * Boxes are mapped back to the full frame and the ones outside every
+   * zone are discarded before NMS. The kept detections are then scaled to
+   * the network size, as the detections of the whole frame are.
+   *
+   * @param frameID ID of the frame
+   *
+   * @return Frame at the network size with the zones and the detections
+   *         drawn on it
+   */
+  cv::Mat detectZones(int frameID);
+
+  /**
+   * @brief Prints the stage summary and exports the trace of the run if
+   *        profiling is enabled
+   *
+   * @param outputDirectory path where the trace file is stored
+   *
+   * @return void
+   */
+  void reportProfile(std::string outputDirectory);
+
+  /**
+   * @brief Writes the detections of the run, in full or as the changes
+   *        between frames as the options ask
+   *
+   * @param outputDirectory Directory of the detections file
+   *
+   * @return true if the file is written
+   */
+  bool saveDetections(const std::string& outputDirectory);
+
+  /**
+   * @brief Prints the frames the video writer could not write and the
+   *        files the video is split in, and how much the writer held back
+   *        the detection if profiling is enabled
+   *
+   * @return void
+   */
+  void reportVideoWriter();
+
+  /**
+   * @brief Prints how many frames the renderer showed and skipped, if
+   *        profiling is enabled
+   *
+   * @param stats Statistics of the renderer of the camera feed
+   *
+   * @return void
+   */
+  void reportRenderer(const RendererStats& stats);
 
  public :
   /**
@@ -106,7 +416,8 @@ class DetectionModule : public VisionModule {
    * @param image Current frame (image) on which detection is to be done
    * @param filterType Type of filter to be used for removing noise
    *
-   * @return Image after Processing
+   * @return Image after Processing. It shares the buffer of the module that
+   *         is overwritten by the next call.
    */
   cv::Mat preProcessImage(cv::Mat image, char filterType);
 
@@ -125,6 +436,179 @@ class DetectionModule : public VisionModule {
    */
   cv::Mat postProcessImage(cv::Mat frame, int frameID);
 
+  /**
+   * @brief Decodes the raw output of the YOLO network into bounding boxes
+   *
+   * Keeps only the boxes whose best class score is above the confidence
+   * threshold.
+   *
+   * @param networkOutput Output matrices of the YOLO layers, one row per
+   *                      predicted box
+   * @param frameSize Size of the image the boxes are scaled to
+   * @param predictedBoxes Filled with the boxes above threshold
+   * @param confidenceScores Filled with the score of each box
+   * @param classIds Filled with the class of each box
+   *
+   * @return void
+   */
+  void decodeNetworkOutput(const std::vector<cv::Mat>& networkOutput, \
+        cv::Size frameSize, std::vector<cv::Rect>& predictedBoxes, \
+        std::vector<float>& confidenceScores, std::vector<int>& classIds);
+
+  /**
+   * @brief Transforms the detections from the image frame to the robot's
+   *        perspective frame
+   *
+   * The detections are transformed in place, their other fields are kept.
+   *
+   * @param detections Detections as returned by nonMaximalSuppression
+   *
+   * @return void
+   */
+  void transformDetections(std::vector<Detection>& detections);
+
+  /**
+   * @brief Runs pre processing, detection and post processing on a frame
+   *
+   * @param image Frame (image) as read from the input
+   * @param frameID ID of the frame
+   *
+   * @return Processed image with the detections drawn on it
+   */
+  cv::Mat processFrame(cv::Mat image, int frameID);
+
+  /**
+   * @brief Detects the persons in one image, without writing any file
+   *
+   * @param image Image in BGR, of any size
+   * @param frameID ID given to the detections
+   *
+   * @return Detections of the image
+   */
+  std::vector<Detection> detect(const cv::Mat& image, int frameID);
+
+  /**
+   * @brief Detects the persons in one YUV frame, converted straight into
+   *        the input of the network without making a BGR image of it
+   *
+   * The boxes are in the coordinates of the network input, as for detect.
+   * The filter of the options is applied to the planes of the input.
+   * Nothing is drawn.
+   *
+   * @param image Frame in NV12, I420 or YUYV, of even dimensions
+   * @param frameID ID given to the detections
+   *
+   * @return Detections of the frame, none if it is not valid
+   */
+  std::vector<Detection> detectYuv(const YuvImage& image, int frameID);
+
+  /**
+   * @brief Detects the persons in the frames of a Y4M or raw stream as they
+   *        arrive, and writes the detections of every frame as a line of
+   *        JSON on the output stream. Messages go to the error stream.
+   *
+   * @param path Path of the FIFO or file, "-" for the standard input
+   *
+   * @return false if the stream can't be read
+   */
+  bool processStream(const std::string& path);
+
+  /**
+   * @brief Detects the persons in several images with a single forward
+   *        pass of the network
+   *
+   * @param images Images in BGR, of any size
+   * @param frameIDs ID given to the detections of every image
+   * @param detections Filled with the detections of every image, in the
+   *                   order of the images
+   *
+   * @return void
+   */
+  void detectBatch(const std::vector<cv::Mat>& images, \
+                   const std::vector<int>& frameIDs, \
+                   std::vector<std::vector<Detection>>& detections);
+
+  /**
+   * @brief Loads the network and sizes the buffers by processing a blank
+   *        frame, so that the first real frame is not slower than the
+   *        others
+   *
+   * @return void
+   */
+  void warmUp();
+
+  /**
+   * @brief Reserves room for the detections accumulated over a run, so
+   *        that keeping them does not reallocate
+   *
+   * @param count Number of detections
+   *
+   * @return void
+   */
+  void reserveDetections(size_t count);
+
+  /**
+   * @brief Hands over the detections accumulated so far
+   *
+   * The detections are removed from the module, so that long running
+   * callers processing frames one by one do not accumulate them.
+   *
+   * @return Detections of all the frames processed since the last call
+   */
+  std::vector<Detection> takeDetections();
+
+  /**
+   * @brief Gives the detections of the last frame before they are
+   *        transformed, in the coordinates of the network input
+   *
+   * @return Detections of the last frame processed
+   */
+  const std::vector<Detection>& getFrameDetections() const;
+
+  /**
+   * @brief Sets the options given on the command line
+   *
+   * @param runOptions Options of the run
+   *
+   * @return void
+   */
+  void setOptions(const RunOptions& runOptions);
+
+  /**
+   * @brief Gives access to the stage timings of the module
+   *
+   * @return Profiler of the module
+   */
+  Profiler& getProfiler();
+
+  /**
+   * @brief Gives access to the buffers reused between frames
+   *
+   * @return Arena of the module
+   */
+  FrameArena& getArena();
+
+  /**
+   * @brief Gives access to the detection network
+   *
+   * @return Network of the module
+   */
+  Network& getNetwork();
+
+  /**
+   * @brief Sets the registry the module reports to while it runs
+   *
+   * Counts the frames processed, the persons detected and the frames
+   * dropped, observes the durations of the stages and samples the depth of
+   * the queue of the video writer.
+   *
+   * @param registry Registry outliving the module, nullptr to stop
+   *                 reporting
+   *
+   * @return void
+   */
+  void setMetrics(MetricsRegistry* registry);
+
   /**
    * @brief Function to get input from user. Uses IOHandler functionality
    *
@@ -144,7 +628,8 @@ class DetectionModule : public VisionModule {
    * @param cameraID contains the cameraID if user choses camera to be the mode
    *                 of input.
    * @param outputDirectory path where the results need to be stored  
-   * @param choice Choice of input format(image/video/camera) given by user
+   * @param choice Choice of input format(image/video/camera) given by user,
+   *               4 reads the shared memory ring named by filePath
    * 
    * @return 0 if the data is invalid or the cameraID is invalid and return 1
    *        if the module runs successfully.
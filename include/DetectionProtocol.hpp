@@ -0,0 +1,186 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionProtocol.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares the binary protocol of the detection server
+ */
+
+#ifndef INCLUDE_DETECTIONPROTOCOL_HPP_
+#define INCLUDE_DETECTIONPROTOCOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Binary protocol spoken over the Unix domain socket of the server
+ *
+ * Every request is a fixed header followed by the image bytes, every
+ * response a fixed header followed by the detections. All the values are
+ * little endian. A connection carries any number of request/response
+ * pairs, one at a time.
+ *
+ * Request header (24 bytes): magic "HODM", version (16 bits), type
+ * (16 bits), request ID, width, height and payload size (32 bits each).
+ * Width and height are only used for raw frames.
+ *
+ * Response header (16 bytes): magic "HODM", version (16 bits), status
+ * (16 bits), request ID and detection count (32 bits each), followed by
+ * count detections of 8 values of 32 bits (frame ID, x1, y1, x2, y2,
+ * score as IEEE float, class ID, track ID).
+ */
+namespace protocol {
+
+/* "HODM" read as a little endian value */
+const uint32_t kMagic = 0x4D444F48;
+const uint16_t kVersion = 1;
+const size_t kRequestHeaderSize = 24;
+const size_t kResponseHeaderSize = 16;
+const size_t kDetectionSize = 32;
+/* Largest payload accepted, so a bad header can't exhaust memory */
+const uint32_t kMaxPayloadSize = 64 * 1024 * 1024;
+
+/**
+ * @brief Types of request
+ */
+enum RequestType : uint16_t {
+  /* Image file content (JPEG, PNG, ...) */
+  kEncodedImage = 1,
+  /* Raw 8 bit BGR pixels, width x height x 3 bytes */
+  kRawBgrFrame = 2
+};
+
+/**
+ * @brief Status of a response
+ */
+enum Status : uint16_t {
+  kOk = 0,
+  /* Header or payload is not valid */
+  kBadRequest = 1,
+  /* Payload can't be decoded as an image */
+  kDecodeError = 2,
+  /* Detection failed */
+  kServerError = 3
+};
+
+/**
+ * @brief Header of a request
+ */
+struct RequestHeader {
+  uint16_t type = kEncodedImage;
+  uint32_t requestID = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t payloadSize = 0;
+};
+
+/**
+ * @brief Header of a response
+ */
+struct ResponseHeader {
+  uint16_t status = kOk;
+  uint32_t requestID = 0;
+  uint32_t count = 0;
+};
+
+/**
+ * @brief Reads exactly size bytes from a file descriptor
+ *
+ * @param fd File descriptor, e.g. a socket
+ * @param data Buffer filled with the bytes
+ * @param size Number of bytes to read
+ *
+ * @return false on end of file or error
+ */
+bool readExact(int fd, void* data, size_t size);
+
+/**
+ * @brief Writes exactly size bytes to a file descriptor
+ *
+ * @param fd File descriptor, e.g. a socket
+ * @param data Bytes to write
+ * @param size Number of bytes to write
+ *
+ * @return false on error
+ */
+bool writeExact(int fd, const void* data, size_t size);
+
+/**
+ * @brief Sends a request
+ *
+ * @param fd Socket
+ * @param header Header of the request, payloadSize gives the payload size
+ * @param payload Image bytes
+ *
+ * @return false on error
+ */
+bool writeRequest(int fd, const RequestHeader& header, const void* payload);
+
+/**
+ * @brief Receives a request
+ *
+ * @param fd Socket
+ * @param header Filled with the header of the request
+ * @param payload Filled with the image bytes, reusing its capacity
+ * @param valid Set to false if the header is not valid, the connection
+ *              can't be used further in that case
+ *
+ * @return false on end of connection, error or invalid header
+ */
+bool readRequest(int fd, RequestHeader& header, \
+                 std::vector<unsigned char>& payload, bool& valid);
+
+/**
+ * @brief Sends a response
+ *
+ * @param fd Socket
+ * @param header Header of the response, its count is ignored
+ * @param detections Detections of the image
+ *
+ * @return false on error
+ */
+bool writeResponse(int fd, const ResponseHeader& header, \
+                   const std::vector<Detection>& detections);
+
+/**
+ * @brief Receives a response
+ *
+ * @param fd Socket
+ * @param header Filled with the header of the response
+ * @param detections Filled with the detections
+ *
+ * @return false on end of connection, error or invalid header
+ */
+bool readResponse(int fd, ResponseHeader& header, \
+                  std::vector<Detection>& detections);
+
+}  // namespace protocol
+
+#endif    // INCLUDE_DETECTIONPROTOCOL_HPP_
@@ -0,0 +1,182 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionServer.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares DetectionServer class
+ */
+
+#ifndef INCLUDE_DETECTIONSERVER_HPP_
+#define INCLUDE_DETECTIONSERVER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DetectionProtocol.hpp"
+
+/**
+ * @brief Statistics of a DetectionServer
+ */
+struct ServerStats {
+  /* Connections accepted */
+  uint64_t connections = 0;
+  /* Requests answered, whatever their status */
+  uint64_t requests = 0;
+  /* Requests answered with an error status */
+  uint64_t failedRequests = 0;
+};
+
+/**
+ * @brief Class serving detections over a Unix domain socket
+ *
+ * A thread accepts the connections and queues them, a pool of workers
+ * serves them, one connection per worker at a time, for as long as the
+ * client keeps it open. Every worker gets its own request handler from
+ * the factory, so a handler (and the network it owns) is only used by one
+ * thread and is created, i.e. loaded, once for the life of the server.
+ */
+class DetectionServer {
+ public:
+  /**
+   * @brief Function answering one request
+   *
+   * Gets the header and the payload of the request, fills the detections
+   * and returns the status of the response.
+   */
+  typedef std::function<uint16_t(const protocol::RequestHeader&, \
+        const std::vector<unsigned char>&, std::vector<Detection>&)> \
+        RequestHandler;
+
+  /**
+   * @brief Function creating the handler of a worker, called on the
+   *        worker thread
+   */
+  typedef std::function<RequestHandler()> HandlerFactory;
+
+  /**
+   * @brief Constructor for class
+   *
+   * @param factory Creates the handler of every worker
+   * @param workers Number of worker threads
+   */
+  DetectionServer(HandlerFactory factory, int workers);
+
+  /**
+   * @brief Destructor for class, stops the server
+   */
+  ~DetectionServer();
+
+  /**
+   * @brief Listens on a socket and starts the threads
+   *
+   * An existing socket file at the path is replaced.
+   *
+   * @param socketPath Path of the Unix domain socket
+   *
+   * @return true if the server listens
+   */
+  bool start(const std::string& socketPath);
+
+  /**
+   * @brief Stops accepting connections, closes the open ones, waits for
+   *        the threads and removes the socket file
+   *
+   * @return void
+   */
+  void stop();
+
+  /**
+   * @brief Checks if the server is running
+   *
+   * @return true between start and stop
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Gives the statistics of the server
+   *
+   * @return Statistics since the start
+   */
+  ServerStats getStats();
+
+ private:
+  /**
+   * @brief Loop of the thread accepting the connections
+   *
+   * @return void
+   */
+  void acceptConnections();
+
+  /**
+   * @brief Loop of the worker threads
+   *
+   * @return void
+   */
+  void serveConnections();
+
+  /**
+   * @brief Answers the requests of one connection until it is closed
+   *
+   * @param fd Socket of the connection
+   * @param handler Handler of the worker
+   *
+   * @return void
+   */
+  void serveConnection(int fd, const RequestHandler& handler);
+
+  /* Creates the handlers of the workers */
+  HandlerFactory handlerFactory;
+  /* Number of worker threads */
+  int workerCount;
+  /* Path and descriptor of the listening socket */
+  std::string path;
+  int listenFd = -1;
+  /* Set while the server runs */
+  std::atomic<bool> running;
+  /* Accepted connections waiting for a worker */
+  std::deque<int> pendingConnections;
+  /* Connections being served, closed when the server stops */
+  std::vector<int> activeConnections;
+  /* Protects the connections and the statistics */
+  std::mutex mutex;
+  /* Signaled when a connection is queued or the server stops */
+  std::condition_variable connectionQueued;
+  /* Threads of the server */
+  std::thread acceptor;
+  std::vector<std::thread> workers;
+  /* Statistics of the server */
+  ServerStats stats;
+};
+
+#endif    // INCLUDE_DETECTIONSERVER_HPP_
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameArena.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares FrameArena class
+ */
+
+#ifndef INCLUDE_FRAMEARENA_HPP_
+#define INCLUDE_FRAMEARENA_HPP_
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Class owning the buffers reused by the pipeline for every frame
+ *
+ * Images are kept in fixed slots and only reallocated when the requested
+ * size or type changes, and the vectors are cleared between frames without
+ * releasing their capacity. Once the first frames have been processed
+ * (warm up), the pipeline stages run without heap allocations of their own.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Slots of the images held by the arena
+   */
+  enum MatSlot {
+    /* Frame resized to the network input size */
+    kResizedImage = 0,
+    /* Resized frame after noise removal */
+    kFilteredImage,
+    /* Whole frame resized for the output when only its zones are
+    detected in */
+    kOverviewImage,
+    /* Number of slots */
+    kMatSlotCount
+  };
+
+  /**
+   * @brief Constructor for class
+   */
+  FrameArena();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~FrameArena();
+
+  /**
+   * @brief Gives the image of a slot with the requested size and type
+   *
+   * @param slot Slot of the image
+   * @param size Size the image must have
+   * @param type OpenCV type the image must have, e.g. CV_8UC3
+   *
+   * @return Image of the slot, its content is undefined
+   */
+  cv::Mat& mat(MatSlot slot, cv::Size size, int type);
+
+  /**
+   * @brief Boxes decoded from the network output
+   *
+   * @return Vector reused for every frame
+   */
+  std::vector<cv::Rect>& predictedBoxes();
+
+  /**
+   * @brief Confidence scores of the decoded boxes
+   *
+   * @return Vector reused for every frame
+   */
+  std::vector<float>& confidenceScores();
+
+  /**
+   * @brief Classes of the decoded boxes
+   *
+   * @return Vector reused for every frame
+   */
+  std::vector<int>& classIds();
+
+  /**
+   * @brief Detections kept by non maximal suppression
+   *
+   * @return Vector reused for every frame
+   */
+  std::vector<Detection>& detections();
+
+  /**
+   * @brief Clears all the vectors, keeping their capacity
+   *
+   * @return void
+   */
+  void clear();
+
+  /**
+   * @brief Reserves room in the vectors for the given number of boxes
+   *
+   * @param boxes Number of boxes per frame to make room for
+   *
+   * @return void
+   */
+  void reserve(size_t boxes);
+
+  /**
+   * @brief Number of times an image slot had to be (re)allocated
+   *
+   * @return Count of image allocations
+   */
+  uint64_t matAllocations() const;
+
+ private:
+  /* Images of the slots */
+  std::vector<cv::Mat> mats;
+  /* Scratch vectors of the decode and NMS stages */
+  std::vector<cv::Rect> boxes;
+  std::vector<float> scores;
+  std::vector<int> classes;
+  std::vector<Detection> frameDetections;
+  /* Number of image (re)allocations */
+  uint64_t allocationCount = 0;
+};
+
+#endif    // INCLUDE_FRAMEARENA_HPP_
@@ -0,0 +1,185 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRenderer.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares FrameRenderer class
+ */
+
+#ifndef INCLUDE_FRAMERENDERER_HPP_
+#define INCLUDE_FRAMERENDERER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "Detection.hpp"
+#include "VisionModule.hpp"
+
+/**
+ * @brief Statistics of a FrameRenderer
+ */
+struct RendererStats {
+  /* Frames given to submit() */
+  uint64_t framesSubmitted = 0;
+  /* Frames drawn and shown */
+  uint64_t framesShown = 0;
+  /* Frames replaced by a newer one before they could be shown */
+  uint64_t framesSkipped = 0;
+};
+
+/**
+ * @brief Class drawing and showing the detected frames on its own thread
+ *
+ * submit() copies the frame and its detections into a mailbox holding only
+ * the latest frame and returns at once, so the display never throttles the
+ * detection. The render thread draws the zones and the boxes on the frame
+ * and shows it at most at the given rate; frames submitted faster than
+ * that replace each other unseen. Only the render thread uses the window.
+ */
+class FrameRenderer {
+ public:
+  /**
+   * @brief Shows an image and handles the window events
+   *
+   * Called with an empty image to handle the events only. Returns the code
+   * of the key pressed within waitMs milliseconds, -1 if none.
+   */
+  typedef std::function<int(const cv::Mat& image, int waitMs)> ShowFunction;
+
+  /**
+   * @brief Constructor for class, shows the frames with cv::imshow
+   */
+  FrameRenderer();
+
+  /**
+   * @brief Constructor for class
+   *
+   * @param show Function showing the frames on the render thread
+   */
+  explicit FrameRenderer(ShowFunction show);
+
+  /**
+   * @brief Destructor for class, stops the render thread
+   */
+  ~FrameRenderer();
+
+  /**
+   * @brief Starts the render thread
+   *
+   * @param maxFps Largest number of frames shown per second
+   *
+   * @return void
+   */
+  void start(double maxFps);
+
+  /**
+   * @brief Stops the render thread, a frame not shown yet is dropped
+   *
+   * @return void
+   */
+  void stop();
+
+  /**
+   * @brief Checks if the render thread runs
+   *
+   * @return true between start and stop
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Gives the next frame to show, replacing one not shown yet
+   *
+   * Everything is copied, so the caller can reuse the buffers right away.
+   * Does nothing unless the render thread runs.
+   *
+   * @param image Frame without the detections drawn on it
+   * @param detections Detections in the coordinates of the frame
+   * @param outlines Zones to outline on the frame, may be empty
+   *
+   * @return void
+   */
+  void submit(const cv::Mat& image, const std::vector<Detection>& detections, \
+              const std::vector<std::vector<cv::Point>>& outlines);
+
+  /**
+   * @brief Tells whether escape was pressed in the window
+   *
+   * @return true once escape has been pressed
+   */
+  bool closeRequested() const;
+
+  /**
+   * @brief Gives the statistics of the renderer
+   *
+   * @return Statistics since the renderer was started
+   */
+  RendererStats getStats();
+
+ private:
+  /**
+   * @brief Loop of the render thread
+   *
+   * @param waitMs Time between two frames shown, in milliseconds
+   *
+   * @return void
+   */
+  void renderFrames(int waitMs);
+
+  /* Shows the frames on the render thread */
+  ShowFunction show;
+  /* Draws the boxes of the detections */
+  VisionModule painter;
+  /* Latest frame submitted and not shown yet, with its overlay */
+  cv::Mat pendingImage;
+  std::vector<Detection> pendingDetections;
+  std::vector<std::vector<cv::Point>> pendingOutlines;
+  bool hasPending = false;
+  /* Frame being drawn and shown, swapped with the pending one */
+  cv::Mat image;
+  std::vector<Detection> detections;
+  std::vector<std::vector<cv::Point>> outlines;
+  /* Set between start and stop */
+  bool running = false;
+  /* Set when escape is pressed in the window */
+  std::atomic<bool> escapePressed;
+  /* Protects the pending frame, the running flag and the statistics */
+  mutable std::mutex mutex;
+  /* Signaled when a frame is submitted or the renderer stops */
+  std::condition_variable frameReady;
+  /* Thread drawing and showing the frames */
+  std::thread renderer;
+  /* Statistics of the renderer */
+  RendererStats stats;
+};
+
+#endif    // INCLUDE_FRAMERENDERER_HPP_
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRing.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares FrameRing class
+ */
+
+#ifndef INCLUDE_FRAMERING_HPP_
+#define INCLUDE_FRAMERING_HPP_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Frame of a FrameRing, read in place
+ */
+struct RingFrame {
+  /* First pixel of the frame in the shared memory, BGR 8 bit */
+  const unsigned char* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  /* Bytes from one row to the next */
+  size_t step = 0;
+  /* Frame ID given by the writer */
+  int frameID = 0;
+  /* Time of the write, microseconds of CLOCK_MONOTONIC */
+  int64_t timestampUs = 0;
+  /* Position of the frame in the stream of the writer */
+  uint64_t sequence = 0;
+};
+
+/**
+ * @brief Ring buffer of fixed size frames in POSIX shared memory
+ *
+ * One process creates the ring and writes frames, others open it and read
+ * the frames where they lie, without copying them. Every slot holds a
+ * sequence number that is odd while the writer fills the slot and even
+ * once the frame is complete (a seqlock), so the writer never waits for
+ * the readers. A reader that falls a full ring behind jumps to the newest
+ * frame and counts the frames it skipped; release() tells if the writer
+ * overwrote the frame while it was being read.
+ */
+class FrameRing {
+ public:
+  /**
+   * @brief Result of acquire
+   */
+  enum ReadStatus {
+    /* A frame is returned */
+    kFrame,
+    /* No frame arrived in time */
+    kTimeout,
+    /* The writer closed the ring and every frame was read */
+    kClosed
+  };
+
+  /**
+   * @brief Constructor for class
+   */
+  FrameRing();
+
+  /**
+   * @brief Destructor for class, unmaps the ring
+   */
+  ~FrameRing();
+
+  /**
+   * @brief Creates a ring to write frames to, replacing an existing ring
+   *        of the same name
+   *
+   * @param name Name of the shared memory object, "/" is prepended if
+   *             missing
+   * @param slotCount Number of frames the ring holds
+   * @param width Width of the frames
+   * @param height Height of the frames
+   *
+   * @return true if the ring is created
+   */
+  bool create(const std::string& name, uint32_t slotCount, int width, \
+              int height);
+
+  /**
+   * @brief Opens an existing ring to read frames from
+   *
+   * @param name Name of the shared memory object
+   *
+   * @return true if the ring is opened
+   */
+  bool open(const std::string& name);
+
+  /**
+   * @brief Unmaps the ring; the writer marks it closed and removes the
+   *        shared memory object, readers that have it mapped keep it
+   *
+   * @return void
+   */
+  void close();
+
+  /**
+   * @brief Gives the slot the next frame is written into and marks it as
+   *        being written; the producer can fill it in place
+   *
+   * @return Pixels of the slot, nullptr if the ring isn't created
+   */
+  unsigned char* beginWrite();
+
+  /**
+   * @brief Publishes the frame filled since beginWrite
+   *
+   * @param frameID ID of the frame
+   *
+   * @return void
+   */
+  void commitWrite(int frameID);
+
+  /**
+   * @brief Copies a frame into the ring and publishes it
+   *
+   * @param pixels BGR pixels of the frame
+   * @param step Bytes from one row to the next
+   * @param frameID ID of the frame
+   *
+   * @return true if the frame is written
+   */
+  bool write(const unsigned char* pixels, size_t step, int frameID);
+
+  /**
+   * @brief Waits for the next frame
+   *
+   * @param frame Filled with the frame, valid until it is released
+   * @param timeoutMs Longest time to wait in milliseconds
+   *
+   * @return Whether a frame is returned
+   */
+  ReadStatus acquire(RingFrame& frame, int timeoutMs);
+
+  /**
+   * @brief Ends the use of a frame
+   *
+   * @param frame Frame given by acquire
+   *
+   * @return true if the frame stayed intact while it was used, false if
+   *         the writer overwrote it
+   */
+  bool release(const RingFrame& frame);
+
+  /**
+   * @brief Checks if the process that created the ring is alive
+   *
+   * @return true if the writer is running
+   */
+  bool writerAlive() const;
+
+  /**
+   * @brief Gives the number of frames a reader skipped by falling behind
+   *
+   * @return Frames skipped
+   */
+  uint64_t droppedFrames() const;
+
+  /**
+   * @brief Gives the size of the frames and the number of slots
+   *
+   * @return Width, height or number of slots of the ring
+   */
+  int width() const;
+  int height() const;
+  uint32_t slotCount() const;
+
+  /**
+   * @brief Gives the size of the frames in bytes
+   *
+   * @return Bytes of one frame
+   */
+  size_t frameSize() const;
+
+ private:
+  /**
+   * @brief Gives the slot of a sequence number
+   *
+   * @param sequence Position of a frame in the stream
+   *
+   * @return Start of the slot
+   */
+  unsigned char* slot(uint64_t sequence) const;
+
+  /* Name of the shared memory object */
+  std::string ringName;
+  /* Mapping of the ring */
+  unsigned char* mapping = nullptr;
+  size_t mappingSize = 0;
+  /* Set for the process that created the ring */
+  bool writer = false;
+  /* Sequence number of the next frame to read */
+  uint64_t nextSequence = 0;
+  /* Frames skipped by this reader */
+  uint64_t dropped = 0;
+};
+
+#endif    // INCLUDE_FRAMERING_HPP_
@@ -0,0 +1,217 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameStreamReader.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares FrameStreamReader class
+ */
+
+#ifndef INCLUDE_FRAMESTREAMREADER_HPP_
+#define INCLUDE_FRAMESTREAMREADER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class reading uncompressed frames from a pipe, a FIFO or a file
+ *
+ * A stream starting with "YUV4MPEG2" is read as Y4M, which carries the
+ * size and the pixel format of the frames (8 bit 4:2:0 or mono). Any other
+ * stream is a sequence of raw frames whose format and size must be given.
+ * Frames are read as they arrive, so the stream can be the output of a
+ * running ffmpeg:
+ *
+ *   ffmpeg -i input.mp4 -f yuv4mpegpipe - | hodm-app --stream -
+ */
+class FrameStreamReader {
+ public:
+  /**
+   * @brief Layout of the pixels of a frame
+   */
+  enum PixelFormat {
+    kUnknown = 0,
+    /* Interleaved 8 bit BGR */
+    kBgr24,
+    /* Planar Y, U and V with the chroma halved in both directions */
+    kYuv420p,
+    /* 8 bit luma only */
+    kGray,
+    /* Y plane then interleaved U and V, halved in both directions */
+    kNv12,
+    /* Packed Y0 U Y1 V, chroma halved horizontally */
+    kYuyv
+  };
+
+  /**
+   * @brief Constructor for class
+   */
+  FrameStreamReader();
+
+  /**
+   * @brief Destructor for class, closes the stream if it was opened by
+   *        the reader
+   */
+  ~FrameStreamReader();
+
+  /**
+   * @brief Opens a stream
+   *
+   * @param path Path of the FIFO or file, "-" for the standard input
+   * @param rawFormat Format of raw frames, kUnknown for a Y4M stream
+   * @param width Width of raw frames
+   * @param height Height of raw frames
+   *
+   * @return true if the stream is opened and its header is valid
+   */
+  bool open(const std::string& path, PixelFormat rawFormat, int width, \
+            int height);
+
+  /**
+   * @brief Starts reading an open descriptor, which is not closed by the
+   *        reader
+   *
+   * @param fd Descriptor of the stream
+   * @param rawFormat Format of raw frames, kUnknown for a Y4M stream
+   * @param width Width of raw frames
+   * @param height Height of raw frames
+   *
+   * @return true if the header of the stream is valid
+   */
+  bool openDescriptor(int fd, PixelFormat rawFormat, int width, int height);
+
+  /**
+   * @brief Closes the stream
+   *
+   * @return void
+   */
+  void close();
+
+  /**
+   * @brief Reads the next frame, waiting for it to arrive
+   *
+   * @param frame Filled with the pixels of the frame, reused from frame
+   *              to frame
+   *
+   * @return true if a whole frame is read, false at the end of the stream
+   *         or on an error
+   */
+  bool readFrame(std::vector<unsigned char>& frame);
+
+  /**
+   * @brief Parses the name of a raw pixel format, as used by ffmpeg
+   *
+   * @param name bgr24, yuv420p (or i420), gray, nv12 or yuyv422 (or
+   *             yuyv)
+   *
+   * @return Format, kUnknown if the name isn't known
+   */
+  static PixelFormat parseFormat(const std::string& name);
+
+  /**
+   * @brief Gives the size in bytes of a frame
+   *
+   * @param format Pixel format
+   * @param width Width of the frame
+   * @param height Height of the frame
+   *
+   * @return Bytes of one frame, 0 for an unknown format
+   */
+  static size_t frameSize(PixelFormat format, int width, int height);
+
+  /**
+   * @brief Gives the format and the size of the frames of the stream
+   *
+   * @return Pixel format, width or height
+   */
+  PixelFormat getFormat() const;
+  int getWidth() const;
+  int getHeight() const;
+
+  /**
+   * @brief Gives the frame rate given by a Y4M header
+   *
+   * @return Frames per second, 0 if unknown
+   */
+  double getFps() const;
+
+  /**
+   * @brief Checks if the stream was cut in the middle of a frame
+   *
+   * @return true if the last frame is incomplete
+   */
+  bool isTruncated() const;
+
+  /**
+   * @brief Tells why the header of the stream is not supported
+   *
+   * @return Reason, empty if none is known
+   */
+  const std::string& getError() const;
+
+ private:
+  /**
+   * @brief Reads exactly size bytes, from the buffer first
+   *
+   * @return false at the end of the stream or on an error
+   */
+  bool readExact(unsigned char* data, size_t size);
+
+  /**
+   * @brief Reads a line ending with a new line character, without it
+   *
+   * @return false at the end of the stream or if the line is too long
+   */
+  bool readLine(std::string& line);
+
+  /**
+   * @brief Parses the header line of a Y4M stream
+   *
+   * @return false if the header isn't supported
+   */
+  bool parseY4mHeader(const std::string& header);
+
+  /* Descriptor of the stream and whether the reader owns it */
+  int fd = -1;
+  bool ownsDescriptor = false;
+  /* Bytes read ahead of the parser */
+  std::vector<unsigned char> buffer;
+  size_t bufferStart = 0;
+  size_t bufferEnd = 0;
+  /* Frames are preceded by a FRAME line */
+  bool y4m = false;
+  PixelFormat format = kUnknown;
+  int width = 0;
+  int height = 0;
+  double fps = 0;
+  bool truncated = false;
+  /* Why the header is not supported */
+  std::string error;
+};
+
+#endif    // INCLUDE_FRAMESTREAMREADER_HPP_
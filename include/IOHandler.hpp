@@ -40,6 +40,101 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/opencv.hpp>
 #include <opencv2/highgui/highgui.hpp>
+
+#include "Detection.hpp"
+#include "RegionOfInterest.hpp"
+#include "ThreadPlacement.hpp"
+/**
+ * @brief Options given to the application on the command line
+ */
+struct RunOptions {
+  /* Record stage timings, print a summary and export a trace of the run */
+  bool profile = false;
+  /* Also count the hardware counters of the stages when profiling */
+  bool perfCounters = false;
+  /* Number of JPEG encoder threads of the video writer, 0 to encode on
+  the writer thread */
+  int encoderThreads = 0;
+  /* Number of annotated frames that can wait to be written */
+  int writeQueue = 8;
+  /* Decode still JPEG images at a reduced resolution when possible */
+  bool reducedDecode = true;
+  /* One reduced image every decodeCalibration is also decoded at full
+  resolution to estimate the time saved, 0 to never */
+  int decodeCalibration = 16;
+  /* Unix domain socket to serve detections on, empty to run interactively */
+  std::string serveSocket;
+  /* Number of worker threads of the server, each with its own network */
+  int serverWorkers = 1;
+  /* Largest number of frames of different requests detected together */
+  int maxBatch = 1;
+  /* Longest time in milliseconds a frame waits for its batch to fill */
+  int batchWaitMs = 5;
+  /* FrameRing to read the frames from instead of asking for an input */
+  std::string sharedMemoryRing;
+  /* Y4M or raw frame stream to read, "-" for the standard input */
+  std::string streamInput;
+  /* Format and size of the frames of a raw stream, empty for Y4M */
+  std::string rawFormat;
+  int rawWidth = 0;
+  int rawHeight = 0;
+  /* Zones of the frames of the stream to detect in, the whole frame if
+  there is none */
+  RegionOfInterest zones;
+  /* File keeping the detections of the still images between runs, empty
+  to not cache them */
+  std::string cacheFile;
+  /* Largest number of images in the cache */
+  int cacheEntries = 10000;
+  /* Threads of the OpenCV functions and layers, 0 for the OpenCV
+  default */
+  int opencvThreads = 0;
+  /* Noise filter of the pre processing, 'G'aussian, 'M'edian or 'B'ox */
+  char filterType = 'G';
+  /* Width and height of the network input, a multiple of 32 */
+  int inputSize = 416;
+  /* Neither draw nor show the detections, nor write annotated images and
+  videos, only the detections */
+  bool headless = false;
+  /* Largest number of camera frames shown per second */
+  int displayFps = 25;
+  /* Detect one video frame in frameStride and interpolate the boxes of
+  the others */
+  int frameStride = 1;
+  /* File the progress of a video is committed to, empty to not
+  checkpoint it */
+  std::string checkpointFile;
+  /* Smallest number of frames between two commits of the checkpoint */
+  int checkpointInterval = 1000;
+  /* Continue the video from its checkpoint instead of the first frame */
+  bool resume = false;
+  /* Write the detections as the changes between frames instead of every
+  box of every frame */
+  bool deltaOutput = false;
+  /* Largest number of frames between two frames written in full */
+  int deltaKeyframes = 300;
+  /* Largest move in pixels of a box that is not written again */
+  int deltaTolerance = 2;
+  /* Smallest confidence of a box kept, and largest overlap of a box with
+  a box already kept by the non maximum suppression */
+  float confidenceThreshold = 0.9f;
+  float nmsThreshold = 0.9f;
+  /* Darknet configuration and weights of the model, empty for those of
+  modelFiles */
+  std::string modelConfiguration;
+  std::string modelWeights;
+  /* Loopback TCP port the metrics are served on in the Prometheus text
+  format, -1 to not serve them */
+  int metricsPort = -1;
+  /* File the metrics are written to every metricsInterval seconds, empty
+  to not write them */
+  std::string metricsFile;
+  int metricsInterval = 15;
+  /* CPUs the capture, pre processing, inference and output threads are
+  pinned to, none being pinned by default */
+  ThreadPlacement placement;
+};
+
 /**
  * @brief Class to manage the input output functionality of the module
  */
@@ -62,6 +157,15 @@ class IOHandler {
   /* Manages the output data */
   std::ostream& outputStream;
 
+  /**
+   * @brief Prints the command line options of the application
+   *
+   * @param applicationName Name the application is invoked with
+   *
+   * @return void
+   */
+  void printUsage(const std::string& applicationName);
+
  public:
   /**
    * @brief Default constructor
@@ -110,13 +214,79 @@ class IOHandler {
   /**
    * @brief Saves the text file in the output directory
    * 
-   * @param finalDetections Vector of vectors to store the final detections
-   *                    after the complete preprocessing
+   * @param finalDetections Final detections of all the frames after the
+   *                    complete preprocessing
    * @param outputDirectory the path of the directory to store the results
    * 
+   * @return true if the file is written
+   */
+  bool saveOutput(const std::vector<Detection>& finalDetections, \
+  const std::string& outputDirectory);
+  /**
+   * @brief Saves the detections in the output directory as the changes
+   *        between frames, see DeltaEncoder
+   *
+   * @param finalDetections Final detections of all the frames, in frame
+   *                        order
+   * @param outputDirectory the path of the directory to store the results
+   * @param keyframeInterval Largest number of frames between two frames
+   *                         written in full
+   * @param tolerance Largest move in pixels of a box not written again
+   *
+   * @return true if the file is written
+   */
+  bool saveDeltaOutput(const std::vector<Detection>& finalDetections, \
+                       const std::string& outputDirectory, \
+                       int keyframeInterval, int tolerance);
+  /**
+   * @brief Writes the detections of one frame as a line of JSON on the
+   *        output stream and flushes it, so that a reader of the stream
+   *        gets every frame as soon as it is processed
+   *
+   * @param frameID ID of the frame
+   * @param detections Detections of the frame
+   *
    * @return void
    */
-  void saveOutput(std::vector< std::vector<int> > finalDetections, \
-  std::string outputDirectory);
+  void streamDetections(int frameID, \
+                        const std::vector<Detection>& detections);
+  /**
+   * @brief Parses the command line arguments of the application
+   *
+   * Prints the usage on the output stream if an argument is not
+   * recognized.
+   *
+   * @param argc Number of arguments
+   * @param argv Arguments, argv[0] being the name of the application
+   * @param options Filled with the parsed options
+   *
+   * @return true if all the arguments are valid, false otherwise
+   */
+  bool parseArguments(int argc, char** argv, RunOptions& options);
+  /**
+   * @brief Reads a tuning profile into the options
+   *
+   * The profile has one "<option>=<value>" line per tuned option, the
+   * options being threads, workers, batch, filter and input-size as on
+   * the command line. Lines starting with # are comments.
+   *
+   * @param path Path of the profile
+   * @param options Options updated with the values of the profile
+   *
+   * @return false if the file can't be read or a line is not valid
+   */
+  bool loadTuningProfile(const std::string& path, RunOptions& options);
+  /**
+   * @brief Writes the tuned options as a tuning profile
+   *
+   * @param path Path of the profile
+   * @param options Options to write
+   * @param comment Written as a comment at the top of the profile, one
+   *                line per line of the text
+   *
+   * @return false if the file can't be written
+   */
+  bool saveTuningProfile(const std::string& path, const RunOptions& options, \
+                         const std::string& comment);
 };
 #endif    // INCLUDE_IOHANDLER_HPP_
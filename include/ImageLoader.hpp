@@ -0,0 +1,205 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ImageLoader.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares ImageLoader class
+ */
+
+#ifndef INCLUDE_IMAGELOADER_HPP_
+#define INCLUDE_IMAGELOADER_HPP_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Decoding statistics of an ImageLoader
+ */
+struct DecodeStats {
+  /* Images decoded */
+  uint64_t images = 0;
+  /* Images decoded at a reduced resolution */
+  uint64_t reducedImages = 0;
+  /* Time spent decoding all the images, in milliseconds */
+  double decodeMs = 0;
+  /* Time spent decoding the images at a reduced resolution */
+  double reducedDecodeMs = 0;
+  /* Reduced images also decoded at full resolution to calibrate the
+  estimate of the time saved */
+  uint64_t calibratedImages = 0;
+  /* Reduced and full resolution decode times of the calibrated images */
+  double calibratedReducedMs = 0;
+  double calibratedFullMs = 0;
+};
+
+/**
+ * @brief Class reading still images at the resolution they are needed at
+ *
+ * The frames are resized to the network input right after being read, so
+ * decoding a 12 MP photo at full resolution mostly produces pixels that
+ * are thrown away. JPEG can be decoded at 1/2, 1/4 or 1/8 of its size
+ * directly in the DCT domain, which is several times faster. The loader
+ * reads the size from the file header and picks the largest reduction
+ * that still gives at least the target size.
+ */
+class ImageLoader {
+ public:
+  /**
+   * @brief Formats recognized from the file header
+   */
+  enum Format {
+    kUnknown = 0,
+    kJpeg,
+    kPng
+  };
+
+  /**
+   * @brief Constructor for class
+   */
+  ImageLoader();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~ImageLoader();
+
+  /**
+   * @brief Reads the format and size of an image from its header
+   *
+   * @param filePath Path of the image
+   * @param size Filled with the size of the image
+   * @param format Filled with the format of the image
+   *
+   * @return true if the header is recognized
+   */
+  static bool readHeader(const std::string& filePath, cv::Size& size, \
+                         Format& format);
+
+  /**
+   * @brief Gives the largest reduction of the source keeping the target
+   *        size
+   *
+   * @param source Size of the encoded image
+   * @param target Size the image is resized to after decoding
+   *
+   * @return 8, 4, 2 or 1 (full resolution)
+   */
+  static int reducedFactor(cv::Size source, cv::Size target);
+
+  /**
+   * @brief Lists the images of a directory
+   *
+   * @param directory Path of the directory
+   * @param imagePaths Filled with the paths of the JPEG, PNG and BMP files
+   *                   of the directory, sorted by name
+   *
+   * @return false if the path is not a directory
+   */
+  static bool listImages(const std::string& directory, \
+                         std::vector<std::string>& imagePaths);
+
+  /**
+   * @brief Sets the size the images are resized to after decoding
+   *
+   * @param size Target size, 416x416 by default
+   *
+   * @return void
+   */
+  void setTargetSize(cv::Size size);
+
+  /**
+   * @brief Enables or disables reduced decoding
+   *
+   * @param enabled false to always decode at full resolution
+   *
+   * @return void
+   */
+  void setReducedDecode(bool enabled);
+
+  /**
+   * @brief Sets how often a reduced image is also decoded at full
+   *        resolution to estimate the time saved
+   *
+   * @param interval One image every interval reduced images, 0 to never
+   *
+   * @return void
+   */
+  void setCalibrationInterval(int interval);
+
+  /**
+   * @brief Reads an image
+   *
+   * @param filePath Path of the image
+   * @param factor Filled with the reduction applied while decoding, the
+   *               size of the image is the encoded size divided by it
+   *
+   * @return Image in BGR, empty if it can't be read
+   */
+  cv::Mat load(const std::string& filePath, int& factor);
+
+  /**
+   * @brief Gives the decoding statistics
+   *
+   * @return Statistics since the creation of the loader
+   */
+  const DecodeStats& getStats() const;
+
+  /**
+   * @brief Estimates the decoding time saved by the reduced decoding
+   *
+   * The full resolution time of the reduced images is extrapolated from
+   * the ratio measured on the calibrated images.
+   *
+   * @return Time saved in milliseconds, 0 without calibrated images
+   */
+  double estimatedSavedMs() const;
+
+  /**
+   * @brief Prints the decoding statistics and the time saved
+   *
+   * @param output Stream the report is printed to
+   *
+   * @return void
+   */
+  void printReport(std::ostream& output) const;
+
+ private:
+  /* Size the images are resized to after decoding */
+  cv::Size targetSize;
+  /* Whether reduced decoding is used */
+  bool reducedDecode = true;
+  /* One reduced image every calibrationInterval is also decoded at full
+  resolution */
+  int calibrationInterval = 16;
+  /* Statistics of the decoded images */
+  DecodeStats stats;
+};
+
+#endif    // INCLUDE_IMAGELOADER_HPP_
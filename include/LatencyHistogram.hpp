@@ -0,0 +1,157 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      LatencyHistogram.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares LatencyHistogram class
+ */
+
+#ifndef INCLUDE_LATENCYHISTOGRAM_HPP_
+#define INCLUDE_LATENCYHISTOGRAM_HPP_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Fixed size log-bucketed histogram of latencies in milliseconds
+ *
+ * Bucket boundaries grow geometrically, so percentiles are reported with a
+ * bounded relative error while memory use stays constant no matter how many
+ * samples are recorded.
+ */
+class LatencyHistogram {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  LatencyHistogram();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~LatencyHistogram();
+
+  /**
+   * @brief Adds one latency sample to the histogram
+   *
+   * @param milliseconds Latency of the sample in milliseconds
+   *
+   * @return void
+   */
+  void record(double milliseconds);
+
+  /**
+   * @brief Adds all the samples of another histogram to this one
+   *
+   * @param other Histogram to be merged
+   *
+   * @return void
+   */
+  void merge(const LatencyHistogram& other);
+
+  /**
+   * @brief Removes all the recorded samples
+   *
+   * @return void
+   */
+  void reset();
+
+  /**
+   * @brief Gives the latency below which the given fraction of samples lie
+   *
+   * @param fraction Fraction of samples in the range [0, 1], e.g. 0.99
+   *
+   * @return Latency in milliseconds, 0 if no sample is recorded
+   */
+  double percentile(double fraction) const;
+
+  /**
+   * @brief Number of recorded samples
+   *
+   * @return Sample count
+   */
+  uint64_t count() const;
+
+  /**
+   * @brief Mean of recorded samples
+   *
+   * @return Mean latency in milliseconds
+   */
+  double mean() const;
+
+  /**
+   * @brief Smallest recorded sample
+   *
+   * @return Minimum latency in milliseconds
+   */
+  double min() const;
+
+  /**
+   * @brief Largest recorded sample
+   *
+   * @return Maximum latency in milliseconds
+   */
+  double max() const;
+
+  /**
+   * @brief Sum of recorded samples
+   *
+   * @return Total latency in milliseconds
+   */
+  double sum() const;
+
+ private:
+  /**
+   * @brief Gives the index of the bucket holding the given latency
+   *
+   * @param milliseconds Latency in milliseconds
+   *
+   * @return Index of the bucket
+   */
+  static int bucketIndex(double milliseconds);
+
+  /**
+   * @brief Gives the upper boundary of the given bucket
+   *
+   * @param index Index of the bucket
+   *
+   * @return Latency in milliseconds
+   */
+  static double bucketUpperBound(int index);
+
+  /* Number of samples in each bucket */
+  std::vector<uint64_t> buckets;
+  /* Total number of samples */
+  uint64_t sampleCount = 0;
+  /* Sum of all samples in milliseconds */
+  double sampleSum = 0;
+  /* Smallest and largest sample in milliseconds */
+  double sampleMin = 0;
+  double sampleMax = 0;
+};
+
+#endif    // INCLUDE_LATENCYHISTOGRAM_HPP_
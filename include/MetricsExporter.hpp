@@ -0,0 +1,159 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MetricsExporter.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares MetricsExporter class
+ */
+
+#ifndef INCLUDE_METRICSEXPORTER_HPP_
+#define INCLUDE_METRICSEXPORTER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "MetricsRegistry.hpp"
+
+/**
+ * @brief Class exporting a MetricsRegistry over HTTP and to a file
+ *
+ * One thread answers GET /metrics on a loopback TCP port with the
+ * registry in the Prometheus text format, one request per connection,
+ * and rewrites the dump file at every interval. The registry is only read
+ * when it is scraped or dumped, so the exporter costs the detection
+ * nothing in between.
+ */
+class MetricsExporter {
+ public:
+  /**
+   * @brief Constructor for class
+   *
+   * @param registry Metrics to export, must outlive the exporter
+   */
+  explicit MetricsExporter(MetricsRegistry& registry);
+
+  /**
+   * @brief Destructor for class, stops the exporter
+   */
+  ~MetricsExporter();
+
+  /**
+   * @brief Starts the thread of the exporter
+   *
+   * @param port TCP port listened on 127.0.0.1, 0 for any free port, -1
+   *             not to listen
+   * @param dumpPath File the metrics are written to, empty for none
+   * @param dumpSeconds Interval between two writes of the file
+   *
+   * @return true if the exporter runs, false if the port can't be
+   *         listened on or there is nothing to export to
+   */
+  bool start(int port, const std::string& dumpPath = "", \
+             double dumpSeconds = 15);
+
+  /**
+   * @brief Stops the thread and writes the dump file a last time
+   *
+   * @return void
+   */
+  void stop();
+
+  /**
+   * @brief Checks if the exporter is running
+   *
+   * @return true between start and stop
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Gives the port listened on
+   *
+   * @return Port, -1 if the exporter does not listen
+   */
+  int getPort() const;
+
+  /**
+   * @brief Gives the number of requests answered
+   *
+   * @return Count of requests, whatever their status
+   */
+  uint64_t getRequests() const;
+
+  /**
+   * @brief Writes the metrics to the dump file, through a temporary file
+   *        renamed over it so that readers never see half of it
+   *
+   * @return true if the file is written
+   */
+  bool dump();
+
+ private:
+  /**
+   * @brief Loop of the thread of the exporter
+   *
+   * @return void
+   */
+  void run();
+
+  /**
+   * @brief Answers the request of one connection
+   *
+   * @param fd Socket of the connection
+   *
+   * @return void
+   */
+  void serveConnection(int fd);
+
+  /**
+   * @brief Writes all the bytes of a buffer to a socket
+   *
+   * @param fd Socket to write to
+   * @param data Bytes to write
+   *
+   * @return true if all the bytes are written
+   */
+  static bool sendAll(int fd, const std::string& data);
+
+  /* Metrics exported */
+  MetricsRegistry& metrics;
+  /* Descriptor and port of the listening socket */
+  int listenFd = -1;
+  int listenPort = -1;
+  /* File the metrics are dumped to and interval between two dumps */
+  std::string dumpFile;
+  double dumpInterval = 15;
+  /* Set while the exporter runs */
+  std::atomic<bool> running;
+  /* Number of requests answered */
+  std::atomic<uint64_t> requests;
+  /* Thread of the exporter */
+  std::thread worker;
+};
+
+#endif    // INCLUDE_METRICSEXPORTER_HPP_
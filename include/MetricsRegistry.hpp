@@ -0,0 +1,467 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MetricsRegistry.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares MetricsRegistry class and its metrics
+ */
+
+#ifndef INCLUDE_METRICSREGISTRY_HPP_
+#define INCLUDE_METRICSREGISTRY_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One time series of a MetricsRegistry
+ *
+ * The metrics are updated with relaxed atomic operations and no lock, so
+ * that the detection loop can update them for every frame. They are only
+ * read, through write(), when the registry is exported.
+ */
+class Metric {
+ public:
+  /**
+   * @brief Destructor for class
+   */
+  virtual ~Metric();
+
+  /**
+   * @brief Writes the samples of the series in the Prometheus text format
+   *
+   * @param output Stream to write the samples to
+   * @param name Name of the metric
+   * @param labels Labels of the series as name="value" pairs separated by
+   *               commas, empty if it has none
+   *
+   * @return void
+   */
+  virtual void write(std::ostream& output, const std::string& name, \
+                     const std::string& labels) const = 0;
+
+  /**
+   * @brief Formats a sample value as Prometheus does, +Inf, -Inf and NaN
+   *        included
+   *
+   * @param value Value of the sample
+   *
+   * @return Text of the value
+   */
+  static std::string formatValue(double value);
+
+ protected:
+  /**
+   * @brief Writes one line of sample
+   *
+   * @param output Stream to write the sample to
+   * @param name Name of the sample
+   * @param labels Labels of the sample, empty if it has none
+   * @param value Text of the value
+   *
+   * @return void
+   */
+  static void writeSample(std::ostream& output, const std::string& name, \
+                          const std::string& labels, \
+                          const std::string& value);
+};
+
+/**
+ * @brief Metric counting events, it only goes up
+ */
+class MetricCounter : public Metric {
+ public:
+  /**
+   * @brief Adds to the count
+   *
+   * @param amount Number of events
+   *
+   * @return void
+   */
+  void add(uint64_t amount = 1) {
+    value.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gives the count
+   *
+   * @return Number of events counted
+   */
+  uint64_t get() const;
+
+  void write(std::ostream& output, const std::string& name, \
+             const std::string& labels) const override;
+
+ private:
+  /* Number of events counted */
+  std::atomic<uint64_t> value{0};
+};
+
+/**
+ * @brief Metric holding a value that goes up and down
+ */
+class MetricGauge : public Metric {
+ public:
+  /**
+   * @brief Sets the value
+   *
+   * @param newValue Value of the gauge
+   *
+   * @return void
+   */
+  void set(double newValue) {
+    value.store(newValue, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Adds to the value, a negative amount takes away from it
+   *
+   * @param amount Amount added
+   *
+   * @return void
+   */
+  void add(double amount);
+
+  /**
+   * @brief Gives the value
+   *
+   * @return Value of the gauge
+   */
+  double get() const;
+
+  void write(std::ostream& output, const std::string& name, \
+             const std::string& labels) const override;
+
+ private:
+  /* Value of the gauge */
+  std::atomic<double> value{0};
+};
+
+/**
+ * @brief Metric counting observations in buckets of fixed upper bounds,
+ *        e.g. latencies
+ */
+class MetricHistogram : public Metric {
+ public:
+  /**
+   * @brief Constructor for class
+   *
+   * @param upperBounds Increasing upper bounds of the buckets, a last
+   *                    bucket without bound is added
+   */
+  explicit MetricHistogram(const std::vector<double>& upperBounds);
+
+  /**
+   * @brief Counts one observation in the bucket of its value
+   *
+   * @param value Observed value, in seconds for durations
+   *
+   * @return void
+   */
+  void observe(double value) {
+    size_t index = std::lower_bound(bounds.begin(), bounds.end(), value) - \
+                   bounds.begin();
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    addToSum(value);
+  }
+
+  /**
+   * @brief Gives the number of observations
+   *
+   * @return Count of observations
+   */
+  uint64_t count() const;
+
+  /**
+   * @brief Gives the sum of the observed values
+   *
+   * @return Sum of the observations
+   */
+  double sum() const;
+
+  void write(std::ostream& output, const std::string& name, \
+             const std::string& labels) const override;
+
+ private:
+  /**
+   * @brief Adds an observed value to the sum
+   *
+   * @param value Observed value
+   *
+   * @return void
+   */
+  void addToSum(double value);
+
+  /* Upper bounds of the buckets */
+  std::vector<double> bounds;
+  /* Number of observations of every bucket, one more than the bounds */
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+  /* Sum of the observed values */
+  std::atomic<double> total{0};
+};
+
+/**
+ * @brief Class holding the metrics of the process, exported in the
+ *        Prometheus text format
+ *
+ * Metrics are registered by name and labels, registering them again gives
+ * the same metric, so the hot path keeps a reference taken once. Values
+ * owned by other objects, like the depth of a queue, are registered as
+ * samplers called when the registry is written. A name is registered with
+ * one type; registering it with another type, or an invalid name, gives a
+ * metric that is not exported.
+ */
+class MetricsRegistry {
+ public:
+  /**
+   * @brief Types of metrics
+   */
+  enum MetricType {
+    kCounter,
+    kGauge,
+    kHistogram
+  };
+
+  /* Labels of a series as name and value pairs */
+  typedef std::vector<std::pair<std::string, std::string>> Labels;
+
+  /* Gives the value of a sampled series, called with the registry locked */
+  typedef std::function<double()> Sampler;
+
+  /**
+   * @brief Constructor for class
+   */
+  MetricsRegistry();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~MetricsRegistry();
+
+  /**
+   * @brief Gives a counter, registering it if it is new
+   *
+   * @param name Name of the metric, ending in _total
+   * @param help Description of the metric
+   * @param labels Labels of the series
+   *
+   * @return Counter, valid as long as the registry
+   */
+  MetricCounter& counter(const std::string& name, const std::string& help, \
+                         const Labels& labels = Labels());
+
+  /**
+   * @brief Gives a gauge, registering it if it is new
+   *
+   * @param name Name of the metric
+   * @param help Description of the metric
+   * @param labels Labels of the series
+   *
+   * @return Gauge, valid as long as the registry
+   */
+  MetricGauge& gauge(const std::string& name, const std::string& help, \
+                     const Labels& labels = Labels());
+
+  /**
+   * @brief Gives a histogram, registering it if it is new
+   *
+   * @param name Name of the metric
+   * @param help Description of the metric
+   * @param upperBounds Upper bounds of the buckets, not used if the
+   *                    histogram is already registered
+   * @param labels Labels of the series
+   *
+   * @return Histogram, valid as long as the registry
+   */
+  MetricHistogram& histogram(const std::string& name, \
+                             const std::string& help, \
+                             const std::vector<double>& upperBounds, \
+                             const Labels& labels = Labels());
+
+  /**
+   * @brief Registers a counter or gauge read by a function when the
+   *        registry is written, replacing the sampler of the same series
+   *
+   * @param type kCounter or kGauge
+   * @param name Name of the metric
+   * @param help Description of the metric
+   * @param labels Labels of the series
+   * @param sampler Gives the value, must not use the registry
+   * @param owner Object the sampler reads, to remove its samplers when it
+   *              goes away
+   *
+   * @return true if the series is registered
+   */
+  bool sample(MetricType type, const std::string& name, \
+              const std::string& help, const Labels& labels, \
+              Sampler sampler, const void* owner = nullptr);
+
+  /**
+   * @brief Removes the sampled series of an object
+   *
+   * @param owner Object given to sample()
+   *
+   * @return void
+   */
+  void removeSamples(const void* owner);
+
+  /**
+   * @brief Registers the resident memory of the process as
+   *        process_resident_memory_bytes
+   *
+   * @return void
+   */
+  void addProcessMetrics();
+
+  /**
+   * @brief Writes all the metrics in the Prometheus text format
+   *
+   * @param output Stream to write the metrics to
+   *
+   * @return void
+   */
+  void write(std::ostream& output) const;
+
+  /**
+   * @brief Gives all the metrics in the Prometheus text format
+   *
+   * @return Text of the metrics
+   */
+  std::string render() const;
+
+  /**
+   * @brief Gives the upper bounds of the buckets used for durations, from
+   *        half a millisecond to 10 seconds
+   *
+   * @return Upper bounds in seconds
+   */
+  static std::vector<double> latencyBounds();
+
+  /**
+   * @brief Checks that a metric or label name is valid for Prometheus
+   *
+   * @param name Name to check
+   * @param metric true for a metric name, which may contain colons
+   *
+   * @return true if the name is valid
+   */
+  static bool isValidName(const std::string& name, bool metric);
+
+  /**
+   * @brief Gives the resident memory of the process
+   *
+   * @return Resident memory in bytes, 0 if it can't be read
+   */
+  static double residentMemoryBytes();
+
+ private:
+  /**
+   * @brief One series of a metric
+   */
+  struct Series {
+    /* Labels of the series, rendered */
+    std::string labels;
+    /* Whether the value is read by a sampler */
+    bool sampled;
+    /* Object the sampler reads */
+    const void* owner;
+    /* Metric of the series */
+    std::unique_ptr<Metric> metric;
+  };
+
+  /**
+   * @brief All the series of a metric name
+   */
+  struct Family {
+    std::string name;
+    std::string help;
+    MetricType type;
+    std::vector<Series> series;
+  };
+
+  /**
+   * @brief Gives the series of a name and labels, adding it without metric
+   *        if it is new. Called with the registry locked
+   *
+   * @param type Type of the metric
+   * @param name Name of the metric
+   * @param help Description of the metric
+   * @param labels Labels of the series
+   * @param sampled Whether the series is read by a sampler
+   *
+   * @return Series, nullptr if the name, labels or type are not valid
+   */
+  Series* findSeries(MetricType type, const std::string& name, \
+                     const std::string& help, const Labels& labels, \
+                     bool sampled);
+
+  /**
+   * @brief Keeps a metric that is not exported, for invalid registrations
+   *
+   * @param metric Metric to keep
+   *
+   * @return The metric
+   */
+  Metric& detach(Metric* metric);
+
+  /**
+   * @brief Renders labels as name="value" pairs separated by commas
+   *
+   * @param labels Labels to render
+   * @param rendered Filled with the labels
+   *
+   * @return false if a label name is not valid
+   */
+  static bool renderLabels(const Labels& labels, std::string& rendered);
+
+  /**
+   * @brief Escapes backslashes and line feeds, and double quotes in label
+   *        values
+   *
+   * @param text Text to escape
+   * @param quotes Whether double quotes are escaped
+   *
+   * @return Escaped text
+   */
+  static std::string escape(const std::string& text, bool quotes);
+
+  /* Guards the families, not the values of the metrics */
+  mutable std::mutex mutex;
+  /* Metrics in order of registration */
+  std::vector<Family> families;
+  /* Metrics of invalid registrations */
+  std::vector<std::unique_ptr<Metric>> detached;
+};
+
+#endif    // INCLUDE_METRICSREGISTRY_HPP_
@@ -0,0 +1,191 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MjpegAviWriter.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares MjpegAviWriter class
+ */
+
+#ifndef INCLUDE_MJPEGAVIWRITER_HPP_
+#define INCLUDE_MJPEGAVIWRITER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class writing already encoded JPEG images as an MJPEG AVI file
+ *
+ * cv::VideoWriter only accepts raw images and encodes them itself, on the
+ * calling thread. This writer only muxes, so that the images can be
+ * encoded by a pool of threads. The file has a single video stream and an
+ * idx1 index, like the files written by cv::VideoWriter with the MJPG
+ * codec. The offsets of such a file are 32 bit, and readers of AVI 1.0
+ * files expect at most 1 GB, so writeFrame refuses a frame that would
+ * make the file larger than the maximum size (1 GB by default); the
+ * caller then continues in a new file.
+ */
+class MjpegAviWriter {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  MjpegAviWriter();
+
+  /**
+   * @brief Destructor for class, closes the file if still open
+   */
+  ~MjpegAviWriter();
+
+  /**
+   * @brief Creates the file and writes the headers
+   *
+   * @param filePath Path of the file
+   * @param width Width of the frames
+   * @param height Height of the frames
+   * @param fps Frame rate of the video
+   *
+   * @return true if the file is created
+   */
+  bool open(const std::string& filePath, int width, int height, double fps);
+
+  /**
+   * @brief Checks if a file is open
+   *
+   * @return true between open and close
+   */
+  bool isOpened() const;
+
+  /**
+   * @brief Appends one JPEG image as the next frame
+   *
+   * @param jpeg Encoded image
+   * @param size Size of the encoded image in bytes
+   *
+   * @return true if the frame is written
+   */
+  bool writeFrame(const unsigned char* jpeg, size_t size);
+
+  /**
+   * @brief Checks if a frame can be added without the file, with its
+   *        index, going past the maximum size
+   *
+   * @param size Size of the encoded image in bytes
+   *
+   * @return true if the file is open and the frame fits
+   */
+  bool fits(size_t size);
+
+  /**
+   * @brief Sets the largest size of the files, used from the next frame
+   *
+   * @param bytes Size in bytes, at most 4 GB
+   *
+   * @return void
+   */
+  void setMaxFileSize(uint64_t bytes);
+
+  /**
+   * @brief Writes the index, completes the headers and closes the file
+   *
+   * @return void
+   */
+  void close();
+
+  /**
+   * @brief Number of frames written to the file
+   *
+   * @return Count of frames
+   */
+  uint32_t frameCount() const;
+
+ private:
+  /**
+   * @brief Writes a little endian 32 bit value
+   *
+   * @param value Value to write
+   *
+   * @return void
+   */
+  void writeUint32(uint32_t value);
+
+  /**
+   * @brief Writes a little endian 16 bit value
+   *
+   * @param value Value to write
+   *
+   * @return void
+   */
+  void writeUint16(uint16_t value);
+
+  /**
+   * @brief Writes a four character code
+   *
+   * @param fourcc Code, exactly four characters
+   *
+   * @return void
+   */
+  void writeFourcc(const char* fourcc);
+
+  /**
+   * @brief Overwrites a 32 bit value already written
+   *
+   * @param position Position of the value in the file
+   * @param value New value
+   *
+   * @return void
+   */
+  void patchUint32(std::streamoff position, uint32_t value);
+
+  /* Index entry of a frame */
+  struct IndexEntry {
+    /* Offset of the chunk from the movi list type */
+    uint32_t offset;
+    /* Size of the image */
+    uint32_t size;
+  };
+
+  /* Output file */
+  std::ofstream file;
+  /* Index of the frames written */
+  std::vector<IndexEntry> index;
+  /* Largest frame written, used as suggested buffer size */
+  uint32_t maxFrameSize = 0;
+  /* Largest size of the file, index included */
+  uint64_t maxFileSize = 1 << 30;
+  /* Positions of the fields completed when closing */
+  std::streamoff riffSizePosition = 0;
+  std::streamoff totalFramesPosition = 0;
+  std::streamoff avihBufferSizePosition = 0;
+  std::streamoff streamLengthPosition = 0;
+  std::streamoff strhBufferSizePosition = 0;
+  std::streamoff moviSizePosition = 0;
+  std::streamoff moviTypePosition = 0;
+};
+
+#endif    // INCLUDE_MJPEGAVIWRITER_HPP_
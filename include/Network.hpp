@@ -33,19 +33,30 @@
 #ifndef INCLUDE_NETWORK_HPP_
 #define INCLUDE_NETWORK_HPP_
 
+#include <functional>
 #include <iostream>
+#include <string>
 #include<vector>
 #include <opencv2/dnn.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/opencv.hpp>
+#include "YuvConverter.hpp"
 
 /**
  * @brief Class for Implementing Neural Network for Human Detection
  *
  */
 class Network {
+ public:
+  /**
+   * @brief Runs the forward pass of an input blob, filling one matrix per
+   *        output layer
+   */
+  typedef std::function<void(const cv::Mat& blob, \
+                             std::vector<cv::Mat>& outputs)> ForwardFunction;
+
  private:
   /* Network object */
   cv::dnn::Net yoloNetwork;
@@ -66,6 +77,39 @@ class Network {
   int imageHeight = 416;
   /* Input blob to the network */
   cv::Mat blob;
+  /* Names of the output layers of the network */
+  std::vector<cv::String> outputLayerNames;
+  /* Converter of YUV frames, reuses its resize tables between frames */
+  YuvConverter yuvConverter;
+  /* Forward pass used instead of the network when set */
+  ForwardFunction forward;
+
+  /**
+   * @brief Reads the network from the model files and finds its output
+   *        layers
+   *
+   * @return void
+   */
+  void loadNetwork();
+
+  /**
+   * @brief Checks if an image can be copied into the blob as it is
+   *
+   * @param image Input image
+   *
+   * @return true for a continuous 8 bit BGR image of the input size
+   */
+  bool isInputSized(const cv::Mat& image);
+
+  /**
+   * @brief Copies an image of the input size into the planes of the blob
+   *
+   * @param image Input image, checked by isInputSized
+   * @param planes Red, green and blue planes of the image in the blob
+   *
+   * @return void
+   */
+  void fillBlobImage(const cv::Mat& image, float* planes);
  public :
   /**
    * @brief Constructor for class
@@ -87,12 +131,147 @@ class Network {
    */
   int createNetworkInput(cv::Mat image);
 
+  /**
+   * @brief Converts several images into one batch input of the network,
+   *        so that they go through a single forward pass
+   *
+   * @param images Input images, in the order of the batch
+   *
+   * @return 1 if the blob is created, 0 if an image is not valid
+   */
+  int createNetworkInput(const std::vector<cv::Mat>& images);
+
+  /**
+   * @brief Converts a YUV frame straight into the input of the network,
+   *        without making a BGR image of it first
+   *
+   * @param image Input frame
+   *
+   * @return 1 if the blob is created, 0 if the frame is not valid
+   */
+  int createNetworkInput(const YuvImage& image);
+
+  /**
+   * @brief Gives the part of the output of a batch that belongs to one
+   *        image, without copying it
+   *
+   * @param networkOutput Output of the forward pass of the batch
+   * @param batchSize Number of images of the batch
+   * @param index Index of the image in the batch
+   * @param imageOutput Filled with one 2 dimensional matrix of boxes per
+   *                    output layer, as for a single image
+   *
+   * @return void
+   */
+  static void splitBatchOutput(const std::vector<cv::Mat>& networkOutput, \
+                               int batchSize, int index, \
+                               std::vector<cv::Mat>& imageOutput);
+
+  /**
+   * @brief Sets the size of the input of the network
+   *
+   * @param size Width and height, multiples of 32 for YOLOv3
+   *
+   * @return void
+   */
+  void setInputSize(cv::Size size);
+
+  /**
+   * @brief Sets the model files, the network being read again from them
+   *        on the next forward pass if they changed
+   *
+   * @param configuration Path of the Darknet configuration
+   * @param weights Path of the Darknet weights
+   *
+   * @return void
+   */
+  void setModelFiles(const std::string& configuration, \
+                     const std::string& weights);
+
+  /**
+   * @brief Sets the thresholds the detections of the network are kept
+   *        with, part of the description of the model
+   *
+   * @param confidence Smallest confidence of a box kept
+   * @param nms Largest overlap of a box with a box already kept
+   *
+   * @return void
+   */
+  void setThresholds(float confidence, float nms);
+
+  /**
+   * @brief Gives the size of the input of the network
+   *
+   * @return Width and height of the input, 416x416 by default
+   */
+  cv::Size getInputSize();
+
+  /**
+   * @brief Gives the input blob made by the last call to createNetworkInput
+   *
+   * @return 4 dimensional NCHW blob of the network input
+   */
+  const cv::Mat& getInputBlob();
+
+  /**
+   * @brief Gives the red, green and blue planes of the first image of the
+   *        input blob, sharing its data so that they can be filtered in
+   *        place
+   *
+   * @param planes Filled with three single channel float matrices
+   *
+   * @return void
+   */
+  void getInputPlanes(std::vector<cv::Mat>& planes);
+
   /**
    * @brief Applies the network for human detection
    *
    * @return Vector of matrices(and a Image) containing detection information
    */
   std::vector<cv::Mat> applyYOLONetwork();
+
+  /**
+   * @brief Applies the network for human detection, reusing the output
+   *        matrices of the previous forward pass
+   *
+   * @param detectedObjects Filled with the output of every YOLO layer
+   *
+   * @return void
+   */
+  void applyYOLONetwork(std::vector<cv::Mat>& detectedObjects);
+
+  /**
+   * @brief Replaces the forward pass of the network, e.g. to run the other
+   *        stages of the pipeline without loading the model
+   *
+   * @param forwardFunction Forward pass, an empty function to use the
+   *                        network again
+   *
+   * @return void
+   */
+  void setForward(ForwardFunction forwardFunction);
+
+  /**
+   * @brief Describes the model files and the settings of the network, for
+   *        telling apart the results of different models
+   *
+   * @return Paths, sizes and modification times of the configuration and
+   *         weights files, input size and thresholds
+   */
+  std::string describeModel();
+
+  /**
+   * @brief Gives the time spent in each layer during the last forward pass
+   *
+   * @param layerNames Filled with the names of the layers
+   * @param layerTimes Filled with the time spent in each layer in
+   *                   milliseconds
+   *
+   * @return Total time of the last forward pass in milliseconds
+   */
+  double getLayerTimings(std::vector<std::string>& layerNames, \
+                         std::vector<double>& layerTimes);
 };
 
 #endif    // INCLUDE_NETWORK_HPP_
@@ -0,0 +1,147 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      PerfCounters.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares PerfCounters class
+ */
+
+#ifndef INCLUDE_PERFCOUNTERS_HPP_
+#define INCLUDE_PERFCOUNTERS_HPP_
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Class for reading the hardware performance counters of a thread
+ *
+ * Opens one Linux perf_event_open group counting the cycles, instructions,
+ * cache misses and branch misses of the calling thread in user space.
+ * Counters the kernel or the CPU doesn't offer (in a virtual machine,
+ * with a strict perf_event_paranoid, on other systems) are left out, and
+ * the object stays usable with whatever could be opened.
+ */
+class PerfCounters {
+ public:
+  /* Counted events */
+  enum Counter {
+    kCycles,
+    kInstructions,
+    kCacheMisses,
+    kBranchMisses,
+    kCounterCount
+  };
+
+  /**
+   * @brief Values of the counters at one point, or between two points
+   */
+  struct Reading {
+    /* Value of every counter, scaled when the counters were multiplexed */
+    uint64_t values[kCounterCount] = {};
+    /* Bit (1 << counter) is set for every counter that was read */
+    unsigned available = 0;
+  };
+
+  /**
+   * @brief Constructor for class, opens the counters of the calling thread
+   */
+  PerfCounters();
+
+  /**
+   * @brief Destructor for class, closes the counters
+   */
+  ~PerfCounters();
+
+  /**
+   * @brief Tells whether at least one counter could be opened
+   *
+   * @return true if the counters can be read
+   */
+  bool isAvailable() const;
+
+  /**
+   * @brief Gives the reason why counters could not be opened
+   *
+   * @return Description of the first failure, empty if all were opened
+   */
+  std::string getError() const;
+
+  /**
+   * @brief Reads the current values of the counters
+   *
+   * Must be called on the thread that created the object.
+   *
+   * @param reading Filled with the values of the opened counters
+   *
+   * @return true if the counters were read, false otherwise
+   */
+  bool read(Reading& reading) const;
+
+  /**
+   * @brief Gives the counters of the calling thread, opened on first use
+   *
+   * @return Counters of the calling thread
+   */
+  static PerfCounters& forThread();
+
+  /**
+   * @brief Gives the difference between two readings
+   *
+   * @param start Reading taken first
+   * @param end Reading taken last
+   *
+   * @return Counts between the readings, for the counters of both
+   */
+  static Reading difference(const Reading& start, const Reading& end);
+
+  /**
+   * @brief Gives the name of a counter
+   *
+   * @param counter Counter to name
+   *
+   * @return Name of the counter
+   */
+  static const char* counterName(Counter counter);
+
+ private:
+  /* Copying would close the counters twice */
+  PerfCounters(const PerfCounters&);
+  PerfCounters& operator=(const PerfCounters&);
+
+  /* File descriptor of the group leader, -1 if nothing could be opened */
+  int leader = -1;
+  /* File descriptors of the counters, -1 for those not opened */
+  int descriptors[kCounterCount];
+  /* Position of every opened counter in the values read from the group */
+  int positions[kCounterCount];
+  /* Number of counters in the group */
+  int groupSize = 0;
+  /* Why counters could not be opened */
+  std::string error;
+};
+
+#endif    // INCLUDE_PERFCOUNTERS_HPP_
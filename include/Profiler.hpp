@@ -0,0 +1,464 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      Profiler.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares Profiler class and ScopedStage helper
+ */
+
+#ifndef INCLUDE_PROFILER_HPP_
+#define INCLUDE_PROFILER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "MetricsRegistry.hpp"
+#include "PerfCounters.hpp"
+
+/**
+ * @brief Class for recording per frame latency of the pipeline stages
+ *
+ * Every recorded stage duration is added to a latency histogram of that
+ * stage and kept as a trace event, so that a run can be summarized with
+ * percentiles and exported to the Chrome trace-event format (viewable in
+ * chrome://tracing or Perfetto). When hardware counters are enabled, the
+ * cycles, instructions, cache misses and branch misses of every stage are
+ * added up as well. Recording is thread safe.
+ *
+ * With a metrics registry, the durations of the stages are also observed
+ * in the histograms of hodm_stage_duration_seconds, whether recording is on
+ * or not, so that a long run can be monitored without keeping a trace.
+ * The histogram of a stage is looked up once by the address of its name,
+ * so observing the stages neither locks nor allocates.
+ */
+class Profiler {
+ public:
+  /* Clock used for all the timestamps */
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @brief Constructor for class
+   */
+  Profiler();
+
+  /**
+   * @brief Destructor for class
+   */
+  ~Profiler();
+
+  /**
+   * @brief Turns recording on or off. Recording is off by default
+   *
+   * @param enabled true to record stage timings
+   *
+   * @return void
+   */
+  void setEnabled(bool enabled);
+
+  /**
+   * @brief Tells whether recording is on
+   *
+   * @return true if stage timings are recorded
+   */
+  bool isEnabled() const;
+
+  /**
+   * @brief Turns counting of the hardware counters of the stages on or off
+   *
+   * Counting stays off when the counters of the calling thread can't be
+   * opened; the summary then gives the reason.
+   *
+   * @param enabled true to count the stages
+   *
+   * @return true if the counters are counted, false otherwise
+   */
+  bool setCountersEnabled(bool enabled);
+
+  /**
+   * @brief Tells whether the hardware counters are counted
+   *
+   * @return true if the stages are counted
+   */
+  bool countersEnabled() const;
+
+  /**
+   * @brief Sets the registry the durations of the stages are observed in
+   *
+   * @param registry Registry outliving the profiler, nullptr to stop
+   *                 observing
+   *
+   * @return void
+   */
+  void setMetrics(MetricsRegistry* registry);
+
+  /**
+   * @brief Tells whether the stages are timed, for recording or metrics
+   *
+   * @return true if the stages are timed
+   */
+  bool isTiming() const;
+
+  /**
+   * @brief Sets the frame to which the following stages belong
+   *
+   * @param frameID ID of the frame being processed
+   *
+   * @return void
+   */
+  void beginFrame(int frameID);
+
+  /**
+   * @brief Gives the ID of the frame set by beginFrame
+   *
+   * @return ID of the current frame
+   */
+  int currentFrame() const;
+
+  /**
+   * @brief Records the duration of one stage
+   *
+   * @param stage Name of the stage, kept for the life of the profiler
+   * @param frameID ID of the frame processed by the stage
+   * @param start Time at which the stage started
+   * @param end Time at which the stage finished
+   *
+   * @return void
+   */
+  void record(const char* stage, int frameID, \
+              Clock::time_point start, Clock::time_point end);
+
+  /**
+   * @brief Adds the hardware counts of one run of a stage
+   *
+   * @param stage Name of the stage
+   * @param counts Counts between the start and the end of the stage
+   *
+   * @return void
+   */
+  void recordCounters(const std::string& stage, \
+                      const PerfCounters::Reading& counts);
+
+  /**
+   * @brief Gives the hardware counts of a stage added up over the run
+   *
+   * @param stage Name of the stage
+   * @param runs Set to the number of runs of the stage that were counted
+   *
+   * @return Sum of the counts, with no counter available if none was
+   */
+  PerfCounters::Reading stageCounters(const std::string& stage, \
+                                      uint64_t& runs) const;
+
+  /**
+   * @brief Records the per layer timings of one forward pass
+   *
+   * The layers are laid out one after another starting at the given time,
+   * so that they show up nested inside the forward stage of the trace.
+   *
+   * @param frameID ID of the frame passed through the network
+   * @param start Time at which the forward pass started
+   * @param layerNames Names of the layers of the network
+   * @param layerTimes Time spent in each layer in milliseconds
+   *
+   * @return void
+   */
+  void recordLayers(int frameID, Clock::time_point start, \
+                    const std::vector<std::string>& layerNames, \
+                    const std::vector<double>& layerTimes);
+
+  /**
+   * @brief Gives the histogram of a stage
+   *
+   * @param stage Name of the stage
+   *
+   * @return Copy of the histogram, empty if the stage was never recorded
+   */
+  LatencyHistogram stageHistogram(const std::string& stage) const;
+
+  /**
+   * @brief Gives the names of the recorded stages in order of appearance
+   *
+   * @return Names of the stages
+   */
+  std::vector<std::string> stageNames() const;
+
+  /**
+   * @brief Number of trace events held for export
+   *
+   * @return Count of trace events
+   */
+  size_t traceEventCount() const;
+
+  /**
+   * @brief Sets the maximum number of trace events kept in memory
+   *
+   * Histograms keep being updated once the limit is reached, only the
+   * trace events are dropped.
+   *
+   * @param limit Maximum number of trace events
+   *
+   * @return void
+   */
+  void setTraceEventLimit(size_t limit);
+
+  /**
+   * @brief Removes all the recorded timings
+   *
+   * @return void
+   */
+  void reset();
+
+  /**
+   * @brief Prints count, mean, p50, p95, p99 and max of every stage and
+   *        of the slowest network layers, then the instructions per cycle
+   *        and misses per frame of every counted stage
+   *
+   * @param output Stream to print the summary on
+   *
+   * @return void
+   */
+  void printSummary(std::ostream& output) const;
+
+  /**
+   * @brief Writes all the trace events to a Chrome trace-event JSON file
+   *
+   * @param filePath Path of the JSON file
+   *
+   * @return true if the file is written, false otherwise
+   */
+  bool exportChromeTrace(const std::string& filePath) const;
+
+ private:
+  /**
+   * @brief One complete ("X" phase) event of the trace
+   */
+  struct TraceEvent {
+    /* Index of the stage or layer name */
+    int nameIndex;
+    /* true if the event is a network layer */
+    bool isLayer;
+    /* Start of the event in microseconds since the profiler started */
+    int64_t startMicros;
+    /* Duration of the event in microseconds */
+    int64_t durationMicros;
+    /* Frame the event belongs to */
+    int frameID;
+    /* Small integer identifying the recording thread */
+    int threadIndex;
+  };
+
+  /**
+   * @brief Histogram of the metrics registry of one stage name
+   */
+  struct StageMetric {
+    /* Address of the name, set once */
+    std::atomic<const char*> stage{nullptr};
+    /* Histogram of the stage, nullptr without registry */
+    std::atomic<MetricHistogram*> metric{nullptr};
+  };
+
+  /* Number of stage names whose histogram is looked up without locking */
+  static const size_t kStageMetricSlots = 64;
+
+  /**
+   * @brief Hardware counts of one stage added up over the run
+   */
+  struct StageCounts {
+    /* Number of counted runs of the stage */
+    uint64_t runs = 0;
+    /* Sum of the counts of every counter */
+    uint64_t values[PerfCounters::kCounterCount] = {};
+    /* Counters available in every counted run */
+    unsigned available = ~0u;
+  };
+
+  /**
+   * @brief Gives the index of a stage, adding a histogram and counts for
+   *        it if it is new
+   *
+   * @param stage Name of the stage
+   *
+   * @return Index of the stage
+   */
+  int stageIndex(const std::string& stage);
+
+  /**
+   * @brief Gives the histogram of a stage in the metrics registry, looked
+   *        up in the registry the first time the name is seen
+   *
+   * @param stage Name of the stage
+   *
+   * @return Histogram, nullptr without registry
+   */
+  MetricHistogram* stageMetric(const char* stage);
+
+  /**
+   * @brief Gives the histogram of a stage from the metrics registry, with
+   *        the mutex held
+   *
+   * @param stage Name of the stage
+   *
+   * @return Histogram, nullptr without registry
+   */
+  MetricHistogram* registryMetric(const std::string& stage);
+
+  /**
+   * @brief Prints the counts per frame of every counted stage
+   *
+   * @param output Stream to print the counts on
+   *
+   * @return void
+   */
+  void printCounters(std::ostream& output) const;
+
+  /**
+   * @brief Gives the index of a name, adding it if it is new
+   *
+   * @param name Name to look up
+   * @param names Ordered list of known names
+   * @param indexes Index of every known name
+   *
+   * @return Index of the name
+   */
+  static int nameIndex(const std::string& name, \
+                       std::vector<std::string>& names, \
+                       std::map<std::string, int>& indexes);
+
+  /**
+   * @brief Gives the small integer assigned to the calling thread
+   *
+   * @return Index of the thread
+   */
+  int threadIndex();
+
+  /**
+   * @brief Adds an event to the trace if the limit allows
+   *
+   * @return void
+   */
+  void addEvent(const TraceEvent& event);
+
+  /* Whether the stages are recorded */
+  std::atomic<bool> enabled{false};
+  /* Whether the hardware counters of the stages are counted */
+  std::atomic<bool> counting{false};
+  /* Frame the current stages belong to */
+  std::atomic<int> frameID{0};
+  /* Registry the durations are observed in */
+  std::atomic<MetricsRegistry*> metrics{nullptr};
+  /* Histogram of every stage name, found by open addressing on the
+  address of the name */
+  StageMetric stageMetrics[kStageMetricSlots];
+
+  /* Guards all the members below, and the changes of the ones above */
+  mutable std::mutex mutex;
+  /* Why the hardware counters could not be counted */
+  std::string counterError;
+  /* Time at which the profiler was created or reset */
+  Clock::time_point origin;
+  /* Names of stages and layers in order of appearance */
+  std::vector<std::string> stages;
+  std::vector<std::string> layers;
+  std::map<std::string, int> stageIndexes;
+  std::map<std::string, int> layerIndexes;
+  /* Latency histogram of every stage and layer */
+  std::vector<LatencyHistogram> stageHistograms;
+  std::vector<LatencyHistogram> layerHistograms;
+  /* Hardware counts of every stage */
+  std::vector<StageCounts> stageCounts;
+  /* Recorded trace events */
+  std::vector<TraceEvent> events;
+  /* Maximum number of trace events and number of events dropped */
+  size_t eventLimit = 1000000;
+  size_t droppedEvents = 0;
+  /* Small integers handed out to the recording threads */
+  std::map<std::thread::id, int> threadIndexes;
+};
+
+/**
+ * @brief Records the lifetime of a scope as one stage of the current frame
+ *
+ * Does nothing (not even reading the clock) when the profiler neither
+ * records nor observes the stages.
+ * Reads the hardware counters of the calling thread at both ends of the
+ * stage when the profiler counts them.
+ */
+class ScopedStage {
+ public:
+  /**
+   * @brief Constructor for class, starts timing the stage
+   *
+   * @param profiler Profiler that records the stage
+   * @param stage Name of the stage, must outlive the object
+   */
+  ScopedStage(Profiler& profiler, const char* stage);
+
+  /**
+   * @brief Destructor for class, records the stage
+   */
+  ~ScopedStage();
+
+  /**
+   * @brief Records the current stage and starts timing the next one
+   *
+   * @param nextStage Name of the next stage, must outlive the object
+   *
+   * @return void
+   */
+  void next(const char* nextStage);
+
+ private:
+  /**
+   * @brief Records the current stage as ending now
+   *
+   * @return Time at which the stage ended
+   */
+  Profiler::Clock::time_point finish();
+
+  /* Profiler that records the stage */
+  Profiler& profiler;
+  /* Name of the stage */
+  const char* stage;
+  /* Whether the profiler timed the stages when the stage started */
+  bool active;
+  /* Time at which the stage started */
+  Profiler::Clock::time_point start;
+  /* Whether the hardware counters are read */
+  bool counting;
+  /* Hardware counters when the stage started */
+  PerfCounters::Reading startCounts;
+};
+
+#endif    // INCLUDE_PROFILER_HPP_
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      RegionOfInterest.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares RegionOfInterest class
+ */
+
+#ifndef INCLUDE_REGIONOFINTEREST_HPP_
+#define INCLUDE_REGIONOFINTEREST_HPP_
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Class holding the zones of a camera where persons are detected
+ *
+ * Zones are rectangles or polygons in the coordinates of the full frame.
+ * Only the bounding regions of the zones are given to the network, and
+ * the boxes whose center is outside every zone are discarded.
+ */
+class RegionOfInterest {
+ public:
+  /**
+   * @brief Reads the zones of a file
+   *
+   * One zone per line, either "rect <x> <y> <width> <height>" or
+   * "polygon <x>,<y> <x>,<y> <x>,<y> ..." with at least three points.
+   * Empty lines and lines starting with # are skipped.
+   *
+   * @param path Path of the file
+   *
+   * @return false if the file can't be read or a line is not valid, no
+   *         zone being kept then
+   */
+  bool load(const std::string& path);
+
+  /**
+   * @brief Reads the zones of a stream, in the format of load
+   *
+   * @param input Stream to read
+   *
+   * @return false if a line is not valid, no zone being kept then
+   */
+  bool read(std::istream& input);
+
+  /**
+   * @brief Adds a rectangular zone
+   *
+   * @param zone Rectangle in frame coordinates
+   *
+   * @return void
+   */
+  void addRectangle(const cv::Rect& zone);
+
+  /**
+   * @brief Adds a polygonal zone
+   *
+   * @param zone Corners of the polygon in frame coordinates, at least three
+   *
+   * @return false if the polygon has less than three corners
+   */
+  bool addPolygon(const std::vector<cv::Point>& zone);
+
+  /**
+   * @brief Checks if no zone is configured, the whole frame being used
+   *
+   * @return true without zones
+   */
+  bool empty() const;
+
+  /**
+   * @brief Gives the zones
+   *
+   * @return Corners of every zone, rectangles having four
+   */
+  const std::vector<std::vector<cv::Point>>& getZones() const;
+
+  /**
+   * @brief Gives the parts of a frame to detect in
+   *
+   * The bounding rectangles of the zones are clipped to the frame and the
+   * overlapping ones are merged. If more regions than maxRegions are
+   * left, they are all merged into one.
+   *
+   * @param frameSize Size of the frame
+   * @param maxRegions Largest number of regions, at least 1
+   * @param regions Filled with the regions, empty if no zone is in the
+   *                frame
+   *
+   * @return void
+   */
+  void getRegions(cv::Size frameSize, int maxRegions, \
+                  std::vector<cv::Rect>& regions) const;
+
+  /**
+   * @brief Checks if a box belongs to a zone
+   *
+   * @param box Box in frame coordinates
+   *
+   * @return true if the center of the box is inside or on the border of a
+   *         zone
+   */
+  bool contains(const cv::Rect& box) const;
+
+ private:
+  /* Corners of every zone */
+  std::vector<std::vector<cv::Point>> zones;
+};
+
+#endif    // INCLUDE_REGIONOFINTEREST_HPP_
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ResultCache.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares ResultCache class
+ */
+
+#ifndef INCLUDE_RESULTCACHE_HPP_
+#define INCLUDE_RESULTCACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Lookup statistics of a ResultCache
+ */
+struct CacheStats {
+  /* Lookups that found the detections */
+  uint64_t hits = 0;
+  /* Lookups that didn't */
+  uint64_t misses = 0;
+  /* Entries dropped to stay within the capacity */
+  uint64_t evictions = 0;
+};
+
+/**
+ * @brief Class keeping the detections of the images already processed,
+ *        on disk between runs
+ *
+ * Entries are keyed by a hash of the encoded bytes of the image combined
+ * with a fingerprint of the model and the settings, so that a changed
+ * model or threshold never returns stale detections. The least recently
+ * used entries are evicted beyond the capacity.
+ *
+ * File layout (host byte order): magic "HODMRC01", entry count (64 bits),
+ * then for every entry from the most recently used: key (64 bits),
+ * detection count (32 bits) and the detections as 8 values of 32 bits.
+ */
+class ResultCache {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  ResultCache();
+
+  /**
+   * @brief Destructor for class, saves the cache if it changed
+   */
+  ~ResultCache();
+
+  /**
+   * @brief Opens a cache file, loading its entries
+   *
+   * A missing file gives an empty cache, created by save. A truncated file
+   * keeps the entries before the cut.
+   *
+   * @param path Path of the cache file
+   * @param maxEntries Largest number of entries, at least 1
+   *
+   * @return false if the file exists and is not a cache
+   */
+  bool open(const std::string& path, size_t maxEntries);
+
+  /**
+   * @brief Checks if a cache file is open
+   *
+   * @return true after a successful open
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Hashes a buffer with a fast 64 bit hash
+   *
+   * @param data Bytes to hash
+   * @param size Number of bytes
+   * @param seed Value the hash starts from
+   *
+   * @return Hash of the bytes
+   */
+  static uint64_t hash(const void* data, size_t size, uint64_t seed);
+
+  /**
+   * @brief Hashes the content of a file
+   *
+   * @param path Path of the file
+   * @param seed Value the hash starts from, e.g. the fingerprint of the
+   *             settings
+   * @param key Filled with the hash of the file
+   *
+   * @return false if the file can't be read
+   */
+  static bool hashFile(const std::string& path, uint64_t seed, \
+                       uint64_t& key);
+
+  /**
+   * @brief Looks up the detections of a key, making it the most recently
+   *        used entry
+   *
+   * @param key Key of the image
+   * @param detections Filled with the stored detections on a hit
+   *
+   * @return true on a hit
+   */
+  bool find(uint64_t key, std::vector<Detection>& detections);
+
+  /**
+   * @brief Stores the detections of a key, evicting the least recently
+   *        used entries beyond the capacity
+   *
+   * @param key Key of the image
+   * @param detections Detections of the image
+   * @param count Number of detections
+   *
+   * @return void
+   */
+  void store(uint64_t key, const Detection* detections, size_t count);
+
+  /**
+   * @brief Writes the entries to the cache file, replacing it at once
+   *
+   * @return false if the file can't be written
+   */
+  bool save();
+
+  /**
+   * @brief Gives the number of entries
+   *
+   * @return Number of entries
+   */
+  size_t size() const;
+
+  /**
+   * @brief Gives the lookup statistics
+   *
+   * @return Statistics since the cache was opened
+   */
+  const CacheStats& getStats() const;
+
+  /**
+   * @brief Prints the hits, misses, hit rate and evictions
+   *
+   * @param output Stream the report is printed to
+   *
+   * @return void
+   */
+  void printReport(std::ostream& output) const;
+
+ private:
+  /**
+   * @brief Detections of one image
+   */
+  struct Entry {
+    uint64_t key;
+    std::vector<Detection> detections;
+  };
+
+  /* Entries from the most to the least recently used */
+  std::list<Entry> entries;
+  /* Entry of every key */
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+  /* Path of the cache file, empty if no file is open */
+  std::string filePath;
+  /* Largest number of entries */
+  size_t capacity = 1;
+  /* Whether the entries changed since they were loaded or saved */
+  bool modified = false;
+  /* Lookup statistics */
+  CacheStats stats;
+
+  /**
+   * @brief Drops the least recently used entries beyond the capacity
+   *
+   * @return void
+   */
+  void evict();
+};
+
+#endif    // INCLUDE_RESULTCACHE_HPP_
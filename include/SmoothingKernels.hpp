@@ -0,0 +1,607 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      SmoothingKernels.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares smoothing kernels specialized on kernel size and pixel
+ *            type
+ */
+
+#ifndef INCLUDE_SMOOTHINGKERNELS_HPP_
+#define INCLUDE_SMOOTHINGKERNELS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Arithmetic of the pixels of a smoothing kernel
+ *
+ * Only 8 bit and float pixels are smoothed. Sums of 8 bit pixels are kept
+ * in 16 bits between the passes, the weights being small integers.
+ */
+template <typename Pixel>
+struct SmoothingPixel;
+
+template <>
+struct SmoothingPixel<uint8_t> {
+  /* Type of the sums of a column of the kernel */
+  typedef uint16_t Sum;
+  /* Type of the sums of the whole kernel */
+  typedef uint32_t Wide;
+
+  /* Quotient of a sum by the total weight, rounded half up */
+  static uint8_t divide(uint32_t sum, uint32_t total) {
+    return static_cast<uint8_t>((sum + total / 2) / total);
+  }
+};
+
+template <>
+struct SmoothingPixel<float> {
+  typedef float Sum;
+  typedef float Wide;
+
+  static float divide(float sum, uint32_t total) {
+    return sum / static_cast<float>(total);
+  }
+};
+
+/**
+ * @brief Row operations shared by the smoothing kernels
+ *
+ * The generic versions are plain loops over contiguous rows, which the
+ * compiler vectorizes for float pixels. 8 bit pixels have SSE2 versions
+ * when the target has it, the last pixels of a row going through the
+ * generic loop.
+ */
+class SmoothingRows {
+ public:
+  /**
+   * @brief Mirrors an index outside [0, size) without repeating the edge,
+   *        as BORDER_REFLECT_101 of OpenCV
+   */
+  static int reflect(int index, int size) {
+    if (size == 1) {
+      return 0;
+    }
+    while (index < 0 || index >= size) {
+      index = index < 0 ? -index : 2 * size - 2 - index;
+    }
+    return index;
+  }
+
+  /**
+   * @brief Clamps an index to [0, size), as BORDER_REPLICATE of OpenCV
+   */
+  static int clamp(int index, int size) {
+    return std::min(std::max(index, 0), size - 1);
+  }
+
+  /**
+   * @brief Buffer of the calling thread reused across calls, so that
+   *        smoothing allocates nothing in the steady state
+   */
+  template <typename T>
+  static std::vector<T>& scratch() {
+    static thread_local std::vector<T> buffer;
+    return buffer;
+  }
+
+  /**
+   * @brief Fills the borders of a padded row from its pixels
+   *
+   * @param padded Row of width + 2 * radius pixels, the pixels of the image
+   *               starting at radius
+   * @param width Number of pixels of the image in the row
+   * @param channels Number of values of a pixel
+   * @param radius Number of pixels of each border
+   * @param replicate Whether the edge is repeated rather than mirrored
+   *
+   * @return void
+   */
+  template <typename T>
+  static void padRow(T* padded, int width, int channels, int radius, \
+                     bool replicate) {
+    const T* row = padded + radius * channels;
+    for (int i = 1; i <= radius; ++i) {
+      int left = replicate ? clamp(-i, width) : reflect(-i, width);
+      int right = replicate ? clamp(width - 1 + i, width) \
+                            : reflect(width - 1 + i, width);
+      std::copy(row + left * channels, row + (left + 1) * channels, \
+                padded + (radius - i) * channels);
+      std::copy(row + right * channels, row + (right + 1) * channels, \
+                padded + (radius + width - 1 + i) * channels);
+    }
+  }
+
+  /**
+   * @brief Sums rows of pixels weighted by a column of the kernel
+   *
+   * @param rows First value of each row
+   * @param weights Weight of each row
+   * @param count Number of rows
+   * @param length Number of values of a row
+   * @param sums Filled with the weighted sums
+   *
+   * @return void
+   */
+  template <typename Pixel, typename Sum>
+  static void weightedRows(const Pixel* const* rows, const int* weights, \
+                           int count, int length, Sum* sums) {
+    for (int i = 0; i < length; ++i) {
+      sums[i] = static_cast<Sum>(weights[0] * rows[0][i]);
+    }
+    for (int k = 1; k < count; ++k) {
+      for (int i = 0; i < length; ++i) {
+        sums[i] = static_cast<Sum>(sums[i] + weights[k] * rows[k][i]);
+      }
+    }
+  }
+
+  static void weightedRows(const uint8_t* const* rows, const int* weights, \
+                           int count, int length, uint16_t* sums) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+      __m128i low = zero;
+      __m128i high = zero;
+      for (int k = 0; k < count; ++k) {
+        const __m128i weight = _mm_set1_epi16(\
+            static_cast<int16_t>(weights[k]));
+        const __m128i pixels = _mm_loadu_si128(\
+            reinterpret_cast<const __m128i*>(rows[k] + i));
+        low = _mm_add_epi16(low, \
+            _mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), weight));
+        high = _mm_add_epi16(high, \
+            _mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), weight));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i), low);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i + 8), high);
+    }
+#endif
+    for (; i < length; ++i) {
+      uint32_t sum = 0;
+      for (int k = 0; k < count; ++k) {
+        sum += weights[k] * rows[k][i];
+      }
+      sums[i] = static_cast<uint16_t>(sum);
+    }
+  }
+
+  /**
+   * @brief Moves column sums one row down, adding a row and removing another
+   *
+   * @param added Row entering the sums
+   * @param removed Row leaving the sums
+   * @param length Number of values of a row
+   * @param sums Column sums to update
+   *
+   * @return void
+   */
+  template <typename Pixel, typename Sum>
+  static void slideRows(const Pixel* added, const Pixel* removed, \
+                        int length, Sum* sums) {
+    for (int i = 0; i < length; ++i) {
+      sums[i] = static_cast<Sum>(sums[i] + added[i] - removed[i]);
+    }
+  }
+
+  static void slideRows(const uint8_t* added, const uint8_t* removed, \
+                        int length, uint16_t* sums) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+      const __m128i in = _mm_loadu_si128(\
+          reinterpret_cast<const __m128i*>(added + i));
+      const __m128i out = _mm_loadu_si128(\
+          reinterpret_cast<const __m128i*>(removed + i));
+      __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+      __m128i* high = reinterpret_cast<__m128i*>(sums + i + 8);
+      /* Wraps around in between, the final sums being positive */
+      _mm_storeu_si128(low, _mm_sub_epi16(_mm_add_epi16(\
+          _mm_loadu_si128(low), _mm_unpacklo_epi8(in, zero)), \
+          _mm_unpacklo_epi8(out, zero)));
+      _mm_storeu_si128(high, _mm_sub_epi16(_mm_add_epi16(\
+          _mm_loadu_si128(high), _mm_unpackhi_epi8(in, zero)), \
+          _mm_unpackhi_epi8(out, zero)));
+    }
+#endif
+    for (; i < length; ++i) {
+      sums[i] = static_cast<uint16_t>(sums[i] + added[i] - removed[i]);
+    }
+  }
+
+  /**
+   * @brief Sums a padded row of column sums weighted by a row of the kernel
+   *        and divides by the total weight of the kernel
+   *
+   * @param padded Column sums, starting at the first pixel of the left border
+   * @param channels Number of values of a pixel
+   * @param weights Weight of each pixel of the row of the kernel
+   * @param count Number of pixels of the row of the kernel
+   * @param total Total weight of the kernel
+   * @param length Number of values of the smoothed row
+   * @param row Filled with the smoothed row
+   *
+   * @return void
+   */
+  template <typename Sum, typename Pixel>
+  static void weightedColumns(const Sum* padded, int channels, \
+                              const int* weights, int count, \
+                              uint32_t total, int length, Pixel* row) {
+    typedef typename SmoothingPixel<Pixel>::Wide Wide;
+    for (int i = 0; i < length; ++i) {
+      Wide sum = 0;
+      for (int k = 0; k < count; ++k) {
+        sum += weights[k] * padded[i + k * channels];
+      }
+      row[i] = SmoothingPixel<Pixel>::divide(sum, total);
+    }
+  }
+
+  static void weightedColumns(const uint16_t* padded, int channels, \
+                              const int* weights, int count, \
+                              uint32_t total, int length, uint8_t* row) {
+    int i = 0;
+#if defined(__SSE2__)
+    /* Sums of the kernel stay in 16 bits up to a total weight of 257.
+     * Scaling by the inverse in float then rounds as the integer division,
+     * for the powers of two of the gaussian kernels and the odd squares of
+     * the box kernels. */
+    if (total <= 257) {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(total));
+      const __m128 half = _mm_set1_ps(0.5f);
+      for (; i + 8 <= length; i += 8) {
+        __m128i sum = zero;
+        for (int k = 0; k < count; ++k) {
+          sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_loadu_si128(\
+              reinterpret_cast<const __m128i*>(padded + i + k * channels)), \
+              _mm_set1_epi16(static_cast<int16_t>(weights[k]))));
+        }
+        const __m128 low = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(\
+            _mm_unpacklo_epi16(sum, zero)), scale), half);
+        const __m128 high = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(\
+            _mm_unpackhi_epi16(sum, zero)), scale), half);
+        const __m128i words = _mm_packs_epi32(_mm_cvttps_epi32(low), \
+                                              _mm_cvttps_epi32(high));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(row + i), \
+                         _mm_packus_epi16(words, words));
+      }
+    }
+#endif
+    for (; i < length; ++i) {
+      uint32_t sum = 0;
+      for (int k = 0; k < count; ++k) {
+        sum += weights[k] * padded[i + k * channels];
+      }
+      row[i] = SmoothingPixel<uint8_t>::divide(sum, total);
+    }
+  }
+
+  /**
+   * @brief Takes the medians of the 3x3 neighbourhoods of a row
+   *
+   * @param above Padded row above, from its first pixel of the image
+   * @param middle Padded row smoothed, from its first pixel of the image
+   * @param below Padded row below, from its first pixel of the image
+   * @param channels Number of values of a pixel
+   * @param length Number of values of the smoothed row
+   * @param row Filled with the smoothed row
+   *
+   * @return void
+   */
+  template <typename T>
+  static void median3Rows(const T* above, const T* middle, const T* below, \
+                          int channels, int length, T* row) {
+    int i = 0;
+#if defined(__SSE2__)
+    const int lanes = static_cast<int>(16 / sizeof(T));
+    for (; i + lanes <= length; i += lanes) {
+      decltype(load(row)) values[9] = {
+          load(above + i - channels), load(above + i), \
+          load(above + i + channels), load(middle + i - channels), \
+          load(middle + i), load(middle + i + channels), \
+          load(below + i - channels), load(below + i), \
+          load(below + i + channels)};
+      store(row + i, median9(values));
+    }
+#endif
+    for (; i < length; ++i) {
+      T values[9] = {above[i - channels], above[i], above[i + channels], \
+                     middle[i - channels], middle[i], middle[i + channels], \
+                     below[i - channels], below[i], below[i + channels]};
+      row[i] = median9(values);
+    }
+  }
+
+  /**
+   * @brief Takes the medians of the neighbourhoods of a row for any kernel
+   *        size
+   *
+   * @param rows Padded rows of the kernel, from their first pixel of the
+   *             image
+   * @param kernel Size of the kernel
+   * @param channels Number of values of a pixel
+   * @param length Number of values of the smoothed row
+   * @param window Buffer of kernel * kernel values
+   * @param row Filled with the smoothed row
+   *
+   * @return void
+   */
+  template <typename T>
+  static void medianRows(const T* const* rows, int kernel, int channels, \
+                         int length, T* window, T* row) {
+    const int radius = kernel / 2;
+    const int middle = kernel * kernel / 2;
+    for (int i = 0; i < length; ++i) {
+      int n = 0;
+      for (int k = 0; k < kernel; ++k) {
+        for (int j = -radius; j <= radius; ++j) {
+          window[n++] = rows[k][i + j * channels];
+        }
+      }
+      std::nth_element(window, window + middle, window + n);
+      row[i] = window[middle];
+    }
+  }
+
+ private:
+  static uint8_t lower(uint8_t a, uint8_t b) { return std::min(a, b); }
+  static uint8_t upper(uint8_t a, uint8_t b) { return std::max(a, b); }
+  static float lower(float a, float b) { return std::min(a, b); }
+  static float upper(float a, float b) { return std::max(a, b); }
+
+#if defined(__SSE2__)
+  static __m128i lower(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+  static __m128i upper(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+  static __m128 lower(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+  static __m128 upper(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+
+  static __m128i load(const uint8_t* values) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+  }
+  static __m128 load(const float* values) { return _mm_loadu_ps(values); }
+  static void store(uint8_t* values, __m128i vector) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), vector);
+  }
+  static void store(float* values, __m128 vector) {
+    _mm_storeu_ps(values, vector);
+  }
+#endif
+
+  /* Orders two values, each lane of a vector on its own */
+  template <typename V>
+  static void sort(V& a, V& b) {
+    const V smaller = lower(a, b);
+    b = upper(a, b);
+    a = smaller;
+  }
+
+  /* Median of nine values with the network of 19 exchanges of Paeth */
+  template <typename V>
+  static V median9(V* p) {
+    sort(p[1], p[2]); sort(p[4], p[5]); sort(p[7], p[8]);
+    sort(p[0], p[1]); sort(p[3], p[4]); sort(p[6], p[7]);
+    sort(p[1], p[2]); sort(p[4], p[5]); sort(p[7], p[8]);
+    sort(p[0], p[3]); sort(p[5], p[8]); sort(p[4], p[7]);
+    sort(p[3], p[6]); sort(p[1], p[4]); sort(p[2], p[5]);
+    sort(p[4], p[7]); sort(p[4], p[2]); sort(p[6], p[4]);
+    sort(p[4], p[2]);
+    return p[4];
+  }
+};
+
+/**
+ * @brief Gaussian smoothing of a kernel size fixed at compile time
+ *
+ * Uses the binomial weights OpenCV gives the 3x3 and 5x5 kernels for a
+ * sigma of 0, applied separably in integers for 8 bit pixels so that the
+ * result is exact. Borders are reflected as BORDER_REFLECT_101.
+ *
+ * @tparam K Size of the kernel, 3 or 5
+ * @tparam PixelType Type of a value of the image, uint8_t or float
+ */
+template <int K, typename PixelType>
+class GaussianKernel {
+  static_assert(K == 3 || K == 5, "Gaussian kernels are 3x3 or 5x5");
+
+ public:
+  typedef PixelType Pixel;
+
+  /**
+   * @brief Smooths an image
+   *
+   * @param source First value of the image
+   * @param sourceStep Number of values between two rows of the image
+   * @param smoothed First value of the smoothed image, not the image itself
+   * @param smoothedStep Number of values between two rows of the smoothed
+   *                     image
+   * @param width Number of pixels of a row
+   * @param height Number of rows
+   * @param channels Number of values of a pixel
+   *
+   * @return void
+   */
+  static void apply(const Pixel* source, size_t sourceStep, \
+                    Pixel* smoothed, size_t smoothedStep, \
+                    int width, int height, int channels) {
+    typedef typename SmoothingPixel<Pixel>::Sum Sum;
+    const int radius = K / 2;
+    const int length = width * channels;
+    /* Binomial coefficients, summing to 2 ^ (K - 1) */
+    int weights[K];
+    weights[0] = 1;
+    for (int k = 1; k < K; ++k) {
+      weights[k] = weights[k - 1] * (K - k) / k;
+    }
+    const uint32_t total = 1u << (2 * (K - 1));
+
+    std::vector<Sum>& padded = SmoothingRows::scratch<Sum>();
+    padded.resize((width + 2 * radius) * channels);
+    const Pixel* rows[K];
+    for (int y = 0; y < height; ++y) {
+      for (int k = 0; k < K; ++k) {
+        rows[k] = source + \
+            SmoothingRows::reflect(y + k - radius, height) * sourceStep;
+      }
+      SmoothingRows::weightedRows(rows, weights, K, length, \
+                                  padded.data() + radius * channels);
+      SmoothingRows::padRow(padded.data(), width, channels, radius, false);
+      SmoothingRows::weightedColumns(padded.data(), channels, weights, K, \
+                                     total, length, \
+                                     smoothed + y * smoothedStep);
+    }
+  }
+};
+
+/**
+ * @brief Median smoothing of a kernel size fixed at compile time
+ *
+ * The 3x3 kernel goes through a sorting network of minima and maxima,
+ * which vectorizes; larger kernels select the median of each
+ * neighbourhood. Borders are repeated as BORDER_REPLICATE, as medianBlur
+ * of OpenCV does.
+ *
+ * @tparam K Odd size of the kernel
+ * @tparam PixelType Type of a value of the image, uint8_t or float
+ */
+template <int K, typename PixelType>
+class MedianKernel {
+  static_assert(K % 2 == 1 && K >= 3, "Median kernels have an odd size");
+
+ public:
+  typedef PixelType Pixel;
+
+  /**
+   * @brief Smooths an image, as GaussianKernel::apply
+   */
+  static void apply(const Pixel* source, size_t sourceStep, \
+                    Pixel* smoothed, size_t smoothedStep, \
+                    int width, int height, int channels) {
+    const int radius = K / 2;
+    const int length = width * channels;
+    const int paddedLength = (width + 2 * radius) * channels;
+    /* Ring of K padded rows, followed by the window of a median */
+    std::vector<Pixel>& buffer = SmoothingRows::scratch<Pixel>();
+    buffer.resize(K * paddedLength + K * K);
+    Pixel* window = buffer.data() + K * paddedLength;
+    int held[K];
+    std::fill(held, held + K, -1);
+
+    const Pixel* rows[K];
+    for (int y = 0; y < height; ++y) {
+      for (int k = 0; k < K; ++k) {
+        const int index = SmoothingRows::clamp(y + k - radius, height);
+        /* The rows of a window are consecutive, so fall in distinct slots */
+        Pixel* slot = buffer.data() + (index % K) * paddedLength;
+        if (held[index % K] != index) {
+          const Pixel* row = source + index * sourceStep;
+          std::copy(row, row + length, slot + radius * channels);
+          SmoothingRows::padRow(slot, width, channels, radius, true);
+          held[index % K] = index;
+        }
+        rows[k] = slot + radius * channels;
+      }
+      Pixel* row = smoothed + y * smoothedStep;
+      if (K == 3) {
+        SmoothingRows::median3Rows(rows[0], rows[1], rows[2], channels, \
+                                   length, row);
+      } else {
+        SmoothingRows::medianRows(rows, K, channels, length, window, row);
+      }
+    }
+  }
+};
+
+/**
+ * @brief Mean smoothing of a kernel size fixed at compile time
+ *
+ * Keeps running sums of the columns of the kernel, moved down by one row
+ * each row, so each pixel costs one addition and one subtraction
+ * vertically whatever the size. Borders are reflected as
+ * BORDER_REFLECT_101, as blur of OpenCV does.
+ *
+ * @tparam K Odd size of the kernel, up to 15 for the sums of 8 bit pixels
+ *           to stay in 16 bits
+ * @tparam PixelType Type of a value of the image, uint8_t or float
+ */
+template <int K, typename PixelType>
+class BoxKernel {
+  static_assert(K % 2 == 1 && K >= 3 && K <= 15, \
+                "Box kernels have an odd size up to 15");
+
+ public:
+  typedef PixelType Pixel;
+
+  /**
+   * @brief Smooths an image, as GaussianKernel::apply
+   */
+  static void apply(const Pixel* source, size_t sourceStep, \
+                    Pixel* smoothed, size_t smoothedStep, \
+                    int width, int height, int channels) {
+    typedef typename SmoothingPixel<Pixel>::Sum Sum;
+    const int radius = K / 2;
+    const int length = width * channels;
+    int weights[K];
+    std::fill(weights, weights + K, 1);
+
+    /* Column sums, kept between the borders refilled for each row */
+    std::vector<Sum>& padded = SmoothingRows::scratch<Sum>();
+    padded.resize((width + 2 * radius) * channels);
+    Sum* sums = padded.data() + radius * channels;
+    const Pixel* rows[K];
+    for (int k = 0; k < K; ++k) {
+      rows[k] = source + \
+          SmoothingRows::reflect(k - radius, height) * sourceStep;
+    }
+    SmoothingRows::weightedRows(rows, weights, K, length, sums);
+
+    for (int y = 0; y < height; ++y) {
+      if (y > 0) {
+        SmoothingRows::slideRows(source + \
+            SmoothingRows::reflect(y + radius, height) * sourceStep, \
+            source + \
+            SmoothingRows::reflect(y - radius - 1, height) * sourceStep, \
+            length, sums);
+      }
+      SmoothingRows::padRow(padded.data(), width, channels, radius, false);
+      SmoothingRows::weightedColumns(padded.data(), channels, weights, K, \
+                                     K * K, length, \
+                                     smoothed + y * smoothedStep);
+    }
+  }
+};
+
+#endif    // INCLUDE_SMOOTHINGKERNELS_HPP_
@@ -0,0 +1,261 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+
+/**
+ * @file      ThreadPlacement.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares ThreadPlacement and ScopedPlacement classes
+ */
+
+#ifndef INCLUDE_THREADPLACEMENT_HPP_
+#define INCLUDE_THREADPLACEMENT_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Threads of the pipeline that can be pinned to their own CPUs
+ */
+enum ThreadRole {
+  /* Read the frames, and the decoder threads of the video */
+  kCaptureThreads,
+  /* Decode and convert the frames of the server requests */
+  kPreprocessThreads,
+  /* Run the network, and the OpenCV thread pool */
+  kInferenceThreads,
+  /* Encode and write the video, show the frames and serve the metrics */
+  kOutputThreads,
+  kThreadRoles
+};
+
+/**
+ * @brief Class holding the CPUs every role of thread is pinned to
+ *
+ * A role without CPUs is not pinned and runs wherever the scheduler puts
+ * it. The CPUs of a role can be shared by several workers, each worker
+ * being pinned to its own part of them: the CPUs are ordered by NUMA node
+ * before being split, so that a worker stays on one node whenever the
+ * number of CPUs allows it. Linux allocates the memory first written by a
+ * thread on the node of its CPU, and a pinned worker also prefers its
+ * node explicitly, so the network and the buffers it creates after being
+ * pinned stay local to it.
+ *
+ * Threads inherit the CPUs of the thread starting them, which is how the
+ * threads of OpenCV, of the video decoders and of the writers are placed
+ * (see ScopedPlacement).
+ */
+class ThreadPlacement {
+ public:
+  /**
+   * @brief Constructor for class, reads the NUMA nodes of the machine
+   */
+  ThreadPlacement();
+
+  /**
+   * @brief Sets the CPUs of a role
+   *
+   * @param role Role of the threads
+   * @param cpuList CPUs as in "0-3,8,10-11", empty to not pin the role
+   *
+   * @return false if the list is not valid, the role being unchanged then
+   */
+  bool setCpus(ThreadRole role, const std::string& cpuList);
+
+  /**
+   * @brief Gives the CPUs of a role
+   *
+   * @param role Role of the threads
+   *
+   * @return CPUs in the order they were given, empty if not pinned
+   */
+  const std::vector<int>& getCpus(ThreadRole role) const;
+
+  /**
+   * @brief Checks if a role is pinned
+   *
+   * @param role Role of the threads
+   *
+   * @return true if the role has CPUs
+   */
+  bool isPinned(ThreadRole role) const;
+
+  /**
+   * @brief Checks if no role is pinned
+   *
+   * @return true if no role has CPUs
+   */
+  bool empty() const;
+
+  /**
+   * @brief Gives the part of the CPUs of a role given to one worker
+   *
+   * The CPUs are ordered by node and split in parts as even as possible.
+   * With more workers than CPUs, workers share the CPUs one each.
+   *
+   * @param role Role of the threads
+   * @param worker Index of the worker, from 0
+   * @param workers Number of workers sharing the CPUs
+   *
+   * @return CPUs of the worker, empty if the role is not pinned
+   */
+  std::vector<int> workerCpus(ThreadRole role, int worker, \
+                              int workers) const;
+
+  /**
+   * @brief Gives the number of CPUs of a worker, used as its share of
+   *        the OpenCV threads
+   *
+   * @param role Role of the threads
+   * @param workers Number of workers sharing the CPUs
+   *
+   * @return At least 1, or 0 if the role is not pinned
+   */
+  int threadsPerWorker(ThreadRole role, int workers) const;
+
+  /**
+   * @brief Pins the calling thread to the CPUs of a worker, and makes it
+   *        allocate memory on their node when they are all on one node
+   *
+   * @param role Role of the threads
+   * @param worker Index of the worker, from 0
+   * @param workers Number of workers sharing the CPUs
+   *
+   * @return false if the thread can't be pinned, true if it is pinned or
+   *         the role is not pinned
+   */
+  bool pinCurrentThread(ThreadRole role, int worker = 0, \
+                        int workers = 1) const;
+
+  /**
+   * @brief Gives the NUMA node of a CPU
+   *
+   * @param cpu CPU number
+   *
+   * @return Node number, -1 if unknown
+   */
+  int nodeOf(int cpu) const;
+
+  /**
+   * @brief Reads the CPUs of the NUMA nodes, replacing those read before
+   *
+   * @param nodeDirectory Directory holding node<n>/cpulist
+   *
+   * @return false if no node could be read, every CPU being on an
+   *         unknown node then
+   */
+  bool loadTopology(const std::string& nodeDirectory);
+
+  /**
+   * @brief Describes the CPUs of the pinned roles
+   *
+   * @return Text like "capture 0-1, inference 2-7 (node 0)"
+   */
+  std::string describe() const;
+
+  /**
+   * @brief Parses a list of CPUs like "0-3,8,10-11"
+   *
+   * @param text List to parse
+   * @param cpus Filled with the CPUs, without repetitions
+   *
+   * @return false if the list is empty or not valid
+   */
+  static bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+  /**
+   * @brief Formats CPUs as a list with ranges
+   *
+   * @param cpus CPUs to format
+   *
+   * @return List like "0-3,8"
+   */
+  static std::string formatCpuList(std::vector<int> cpus);
+
+  /**
+   * @brief Gives the CPUs the calling thread may run on
+   *
+   * @return CPUs in increasing order, empty if they can't be read
+   */
+  static std::vector<int> currentCpus();
+
+  /**
+   * @brief Pins the calling thread to CPUs
+   *
+   * @param cpus CPUs to run on
+   *
+   * @return false if none of the CPUs can be used
+   */
+  static bool setCurrentCpus(const std::vector<int>& cpus);
+
+  /**
+   * @brief Makes the calling thread allocate its memory on a node first,
+   *        and on the other nodes when the node is full
+   *
+   * @param node NUMA node
+   *
+   * @return false if the policy can't be set
+   */
+  static bool preferNode(int node);
+
+ private:
+  /* CPUs of every role, indexed by the role */
+  std::vector<std::vector<int>> roleCpus;
+  /* NUMA node of every CPU */
+  std::map<int, int> cpuNodes;
+};
+
+/**
+ * @brief Pins the calling thread to the CPUs of a role for the lifetime
+ *        of a scope
+ *
+ * The threads started within the scope keep the CPUs of the role, which
+ * places the threads of libraries that can't be pinned otherwise. Does
+ * nothing when the role is not pinned.
+ */
+class ScopedPlacement {
+ public:
+  /**
+   * @brief Constructor for class, pins the calling thread to all the
+   *        CPUs of the role
+   *
+   * @param placement CPUs of the roles
+   * @param role Role of the threads started within the scope
+   */
+  ScopedPlacement(const ThreadPlacement& placement, ThreadRole role);
+
+  /**
+   * @brief Destructor for class, gives the thread its CPUs back
+   */
+  ~ScopedPlacement();
+
+ private:
+  /* CPUs of the thread before the scope, empty if it was not pinned */
+  std::vector<int> previousCpus;
+};
+
+#endif    // INCLUDE_THREADPLACEMENT_HPP_
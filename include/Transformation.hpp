@@ -102,6 +102,23 @@ class Transformation {
    */
   cv::Mat cameraToImage(cv::Mat intrinsic, cv::Mat vecCamera4d);
 
+  /**
+   * @brief Function to move an image point through the end to base
+   *        transformation
+   *
+   * Gives the same point as chaining imageToCamera, endToBase and
+   * cameraToImage, but uses fixed size matrices so that no memory is
+   * allocated.
+   *
+   * @param intrinsic Intrinsic matrix of the camera
+   * @param intrinsicInverse Inverse of the intrinsic matrix
+   * @param point Point in image coordinates
+   *
+   * @return Transformed point in image coordinates
+   */
+  cv::Point2f transformImagePoint(const cv::Matx33f& intrinsic, \
+        const cv::Matx33f& intrinsicInverse, cv::Point2f point);
+
   /**
    * @brief Function to return base frame
    *
@@ -122,5 +139,15 @@ class Transformation {
 
   /* End frame transformation matrix in Global Coordinate Frame */
   cv::Mat endFrame;
+
+  /* Transformation from end frame to base frame, computed once */
+  cv::Matx44f endToBaseFrame;
+
+  /**
+   * @brief Computes the end to base transformation from the frames
+   *
+   * @return void
+   */
+  void updateEndToBase();
 };
 #endif    // INCLUDE_TRANSFORMATION_HPP_
@@ -0,0 +1,176 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      VideoCheckpoint.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares VideoCheckpoint class
+ */
+
+#ifndef INCLUDE_VIDEOCHECKPOINT_HPP_
+#define INCLUDE_VIDEOCHECKPOINT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Detection.hpp"
+
+/**
+ * @brief Progress of a video job as of its last checkpoint
+ */
+struct CheckpointState {
+  /* First frame not processed yet */
+  int nextFrameID = 0;
+  /* Last detected key frame, -1 if none, and its detections before the
+  transformation, from which the next frames are interpolated */
+  int keyFrameID = -1;
+  std::vector<Detection> keyDetections;
+  /* Number of detections of the job committed */
+  uint64_t detectionCount = 0;
+  /* Index of the next segment of the output video */
+  int segmentIndex = 0;
+};
+
+/**
+ * @brief Class saving the progress of a long video job so that it can be
+ *        resumed after an interruption
+ *
+ * Two files are kept. The detections of the job are appended to
+ * "<path>.detections" as 8 values of 32 bits each (host byte order) and
+ * synced to disk at every commit. The state, in text, is then written to
+ * "<path>.tmp" and renamed to "<path>", so that an interrupted commit
+ * leaves the previous checkpoint. Detections appended after the last
+ * state are cut off on resume. A checkpoint only resumes the job it was
+ * made for, identified by a key of the input and the settings.
+ */
+class VideoCheckpoint {
+ public:
+  /**
+   * @brief Constructor for class
+   */
+  VideoCheckpoint();
+
+  /**
+   * @brief Destructor for class, closes the files
+   */
+  ~VideoCheckpoint();
+
+  /**
+   * @brief Starts checkpointing a job, resuming it if asked and possible
+   *
+   * Without resume, or without a checkpoint of the same job, the job
+   * starts from the first frame and an earlier checkpoint is replaced.
+   *
+   * @param path Path of the checkpoint
+   * @param jobKey Key of the input and the settings of the job
+   * @param resume true to continue from the checkpoint of the job
+   * @param state Filled with the state to continue from
+   * @param detections Filled with the committed detections of the job
+   *
+   * @return false if the files can't be written
+   */
+  bool open(const std::string& path, uint64_t jobKey, bool resume, \
+            CheckpointState& state, std::vector<Detection>& detections);
+
+  /**
+   * @brief Checks if a job is checkpointed
+   *
+   * @return true between open and finish
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Tells whether open resumed the job from a checkpoint
+   *
+   * @return true if the job continues from a checkpoint
+   */
+  bool isResumed() const;
+
+  /**
+   * @brief Commits the progress of the job
+   *
+   * @param state State to continue from, its detection count is set
+   * @param detections All the detections of the job so far, those after
+   *                   the last commit are appended
+   * @param count Number of detections of the job so far
+   *
+   * @return false if the checkpoint can't be written
+   */
+  bool commit(CheckpointState& state, const Detection* detections, \
+              size_t count);
+
+  /**
+   * @brief Ends a completed job, removing the checkpoint
+   *
+   * @return void
+   */
+  void finish();
+
+  /**
+   * @brief Closes the files, keeping the checkpoint
+   *
+   * @return void
+   */
+  void close();
+
+ private:
+  /**
+   * @brief Reads the state of a checkpoint of the job
+   *
+   * @param jobKey Key the checkpoint must have
+   * @param state Filled with the state of the checkpoint
+   *
+   * @return false if there is no valid checkpoint of the job
+   */
+  bool readState(uint64_t jobKey, CheckpointState& state) const;
+
+  /**
+   * @brief Reads the committed detections and cuts off those after them
+   *
+   * @param count Number of committed detections
+   * @param detections Filled with the committed detections
+   *
+   * @return false if fewer detections were written
+   */
+  bool readDetections(uint64_t count, std::vector<Detection>& detections);
+
+  /* Path of the state file */
+  std::string statePath;
+  /* Path of the detections file */
+  std::string detectionsPath;
+  /* Descriptor of the detections file, -1 when closed */
+  int detectionsFile = -1;
+  /* Key of the job */
+  uint64_t key = 0;
+  /* Number of detections in the detections file */
+  uint64_t committed = 0;
+  /* Whether the job continues from a checkpoint */
+  bool resumed = false;
+};
+
+#endif    // INCLUDE_VIDEOCHECKPOINT_HPP_
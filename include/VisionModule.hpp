@@ -40,6 +40,9 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/highgui/highgui.hpp>
 
+#include "Detection.hpp"
+#include "SmoothingKernels.hpp"
+
 /**
  * @brief Class for Vision based functionality
  */
@@ -101,15 +104,84 @@ class VisionModule {
    */
   cv::Mat reshape(cv::Mat image, cv::Size dim);
 
+  /**
+   * @brief Applies Gaussian Filter to given image into a given buffer
+   *
+   * The buffer is reused when it already has the size and type of the
+   * result, so that no image is allocated in the steady state.
+   *
+   * @param image Image on which the filter will be applied
+   * @param kernelDim Size of kernel matrix
+   * @param sigma Standard deviation for the Gaussian kernel
+   * @param smoothenImage Filled with the image after applying filter
+   *
+   * @return void
+   */
+  void applyGaussianFilter(const cv::Mat& image, cv::Size kernelDim, \
+      float sigma, cv::Mat& smoothenImage);
+
+  /**
+   * @brief Applies Mean Filter to given image into a given buffer
+   *
+   * @param image Image on which the filter will be applied
+   * @param kernelDim Size of kernel matrix
+   * @param smoothenImage Filled with the image after applying filter
+   *
+   * @return void
+   */
+  void applyFilter(const cv::Mat& image, cv::Size kernelDim, \
+      cv::Mat& smoothenImage);
+
+  /**
+   * @brief Applies Median Filter to given image into a given buffer
+   *
+   * @param image Image on which the filter will be applied
+   * @param kernelDim Size of kernel matrix
+   * @param smoothenImage Filled with the image after applying filter
+   *
+   * @return void
+   */
+  void applyMedianFilter(const cv::Mat& image, int kernelDim, \
+      cv::Mat& smoothenImage);
+
+  /**
+   * @brief Reshapes given image to given dimension into a given buffer
+   *
+   * @param image Image to be reshaped
+   * @param size Dimension the image has to be reshaped to
+   * @param resizedImage Filled with the image after reshaping it
+   *
+   * @return void
+   */
+  void reshape(const cv::Mat& image, cv::Size size, cv::Mat& resizedImage);
+
+  /**
+   * @brief Smooths an image with a kernel chosen at compile time
+   *
+   * The kernel size and pixel type are template arguments of the policy,
+   * so its loops are specialized for them. The smoothed image is reused
+   * when it already has the size and type of the image.
+   *
+   * @tparam SmoothingPolicy GaussianKernel, MedianKernel or BoxKernel
+   * @param image Image with the pixel type of the policy, any number of
+   *              channels
+   * @param smoothed Filled with the smoothed image, not the image itself
+   *
+   * @return false if the image is empty, not of the pixel type of the
+   *         policy or the smoothed image, true otherwise
+   */
+  template <typename SmoothingPolicy>
+  static bool smooth(const cv::Mat& image, cv::Mat& smoothed);
+
   /**
    * @brief Applies Non Maximal Suppression Algorithm
    *
    * Given a set of bounding boxes of detected objects in an
    * image, the algorithm removes overlapping boxes that may be
-   * enclosing the same object. The same function also draws the bounding
-   * boxes on the passed image.
+   * enclosing the same object. Boxes are clipped to the passed image, use
+   * drawDetections to draw them.
    *
-   * @param image Image on which the objects have been detected
+   * @param frame Image on which the objects have been detected
    * @param predictedBoxes Vector owith data type cv::rect, contains 
    *              information of all the bounding boxes detected. In order, the
    *              information comprises of upper left and bottom right points
@@ -119,17 +191,81 @@ class VisionModule {
    * @param classIds vector that contain the classIds of all the detections.
    * @param frameID denotes the frame number associated with the image.
    *
-   * @return Modified Vector of bounding box information
+   * @return Detections of the persons kept by the algorithm
    */
-  std::vector< std::vector<int> > nonMaximalSuppression(cv::Mat &frame, \
+  std::vector<Detection> nonMaximalSuppression(cv::Mat &frame, \
   std::vector<cv::Rect>& predictedBoxes, std::vector<float> confidenceScores, \
         std::vector<int> classIds, int frameID);
 
+  /**
+   * @brief Applies Non Maximal Suppression Algorithm without allocating
+   *
+   * Same selection as the other overload: boxes above the confidence
+   * threshold are visited by decreasing score and kept unless they overlap
+   * an already kept box by more than the NMS threshold. Only persons
+   * (class 0) are returned, clipped to the frame. Scratch storage is kept
+   * by the module, so nothing is allocated once the vectors have grown to
+   * the number of boxes of a frame.
+   *
+   * @param frameSize Size of the image the boxes are clipped to
+   * @param frameID ID of the frame the boxes are detected in
+   * @param predictedBoxes Boxes decoded from the network output
+   * @param confidenceScores Confidence score of each box
+   * @param classIds Class of each box
+   * @param detections Filled with the kept detections
+   *
+   * @return void
+   */
+  void nonMaximalSuppression(cv::Size frameSize, int frameID, \
+        const std::vector<cv::Rect>& predictedBoxes, \
+        const std::vector<float>& confidenceScores, \
+        const std::vector<int>& classIds, \
+        std::vector<Detection>& detections);
+
+  /**
+   * @brief Draws the bounding boxes of the detections on the image
+   *
+   * @param frame Image on which the boxes are drawn
+   * @param detections Detections as returned by nonMaximalSuppression
+   *
+   * @return void
+   */
+  void drawDetections(cv::Mat &frame, \
+        const std::vector<Detection>& detections);
+
+  /**
+   * @brief Sets the thresholds of the non maximum suppression
+   *
+   * @param confidence Smallest confidence of a box kept
+   * @param nms Largest overlap of a box with a box already kept
+   *
+   * @return void
+   */
+  void setThresholds(float confidence, float nms);
+
  private:
   /* Confidence Threshold for the detections */
   float confidenceThreshold = 0.9;
   /* NMS Threshold for the detections */
   float nmsThreshold = 0.9;
+  /* Indices of the boxes sorted by score, reused between frames */
+  std::vector<int> scoreOrder;
+  /* Indices of the boxes kept by NMS, reused between frames */
+  std::vector<int> keptIndices;
 };
 
+template <typename SmoothingPolicy>
+auto VisionModule::smooth(const cv::Mat& image, cv::Mat& smoothed) -> bool {
+  typedef typename SmoothingPolicy::Pixel Pixel;
+  if (image.empty() || image.depth() != cv::DataType<Pixel>::depth || \
+      image.data == smoothed.data) {
+    return false;
+  }
+  smoothed.create(image.size(), image.type());
+  SmoothingPolicy::apply(image.ptr<Pixel>(), image.step1(), \
+                         smoothed.ptr<Pixel>(), smoothed.step1(), \
+                         image.cols, image.rows, image.channels());
+  return true;
+}
+
 #endif    // INCLUDE_VISIONMODULE_HPP_
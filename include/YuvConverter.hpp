@@ -0,0 +1,119 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      YuvConverter.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares YuvConverter class
+ */
+
+#ifndef INCLUDE_YUVCONVERTER_HPP_
+#define INCLUDE_YUVCONVERTER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Frame in a YUV layout, as given by cameras and video decoders
+ */
+struct YuvImage {
+  /**
+   * @brief Layout of the planes
+   */
+  enum Layout {
+    /* Y plane followed by interleaved U and V at half resolution */
+    kNv12,
+    /* Y plane, U plane and V plane, chroma at half resolution */
+    kI420,
+    /* Packed Y0 U Y1 V, chroma at half horizontal resolution */
+    kYuyv
+  };
+  Layout layout = kNv12;
+  /* Planes follow each other without padding */
+  const unsigned char* data = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * @brief Class converting YUV frames straight into the planar RGB float
+ *        input of the network
+ *
+ * Color conversion, bilinear resize and scaling to [0, 1] are done in one
+ * pass over the output pixels, so the full size BGR image that cv::cvtColor
+ * would make is never built. Only the source pixels around every output
+ * pixel are read, and they are converted with the BT.601 coefficients of
+ * cv::cvtColor, so the result matches cv::cvtColor followed by cv::resize
+ * up to rounding.
+ */
+class YuvConverter {
+ public:
+  /**
+   * @brief Checks if a frame can be converted
+   *
+   * @param image Frame to check
+   *
+   * @return true for data and even, positive dimensions
+   */
+  static bool isValid(const YuvImage& image);
+
+  /**
+   * @brief Gives the size in bytes of a frame
+   *
+   * @param layout Layout of the frame
+   * @param width Width of the frame, even
+   * @param height Height of the frame, even
+   *
+   * @return Bytes of the frame
+   */
+  static size_t frameSize(YuvImage::Layout layout, int width, int height);
+
+  /**
+   * @brief Converts and resizes a frame into red, green and blue float
+   *        planes
+   *
+   * @param image Frame to convert, checked by isValid
+   * @param width Width of the planes
+   * @param height Height of the planes
+   * @param planes Red, green then blue plane of width x height values in
+   *               [0, 1]
+   *
+   * @return void
+   */
+  void convertToPlanes(const YuvImage& image, int width, int height, \
+                       float* planes);
+
+ private:
+  /* Source column and weight of the right neighbour of every output
+  column, as cv::resize with INTER_LINEAR computes them */
+  std::vector<int> columns;
+  std::vector<float> columnWeights;
+  /* Same for the rows */
+  std::vector<int> rows;
+  std::vector<float> rowWeights;
+};
+
+#endif    // INCLUDE_YUVCONVERTER_HPP_
@@ -0,0 +1,157 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      AccuracyEvaluatorTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for AccuracyEvaluator class
+ */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/AccuracyEvaluator.hpp"
+#include "TestDetections.hpp"
+
+namespace {
+/**
+ * @brief Makes the result of a configuration
+ */
+EvaluationResult makeResult(const std::string& configuration, \
+                            double averagePrecision, double rate) {
+  EvaluationResult result;
+  result.configuration = configuration;
+  result.metrics.averagePrecision = averagePrecision;
+  result.framesPerSecond = rate;
+  return result;
+}
+}  // namespace
+
+/**
+ * @brief Test the precision, recall and average precision of ranked
+ *        detections, a second detection of a label being a false positive
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AccuracyEvaluatorTest, TestMetrics) {
+  AccuracyEvaluator evaluator;
+  std::vector<Detection> labels = {makeDetection(0, 0, 0, 100, 100, 1), \
+                                   makeDetection(0, 200, 0, 300, 100, 1), \
+                                   makeDetection(0, 400, 0, 500, 100, 1, 2)};
+  /* Ranked: match, duplicate of the first label, match */
+  evaluator.addImage(labels, {makeDetection(0, 205, 5, 300, 100, 0.7f), \
+                              makeDetection(0, 0, 0, 95, 100, 0.9f), \
+                              makeDetection(0, 5, 5, 100, 100, 0.8f), \
+                              makeDetection(0, 400, 0, 500, 100, 0.95f, 2)});
+  EvaluationMetrics metrics = evaluator.getMetrics();
+  ASSERT_EQ(2u, metrics.labels);
+  ASSERT_EQ(3u, metrics.detections);
+  ASSERT_EQ(2u, metrics.truePositives);
+  ASSERT_DOUBLE_EQ(2.0 / 3.0, metrics.precision);
+  ASSERT_DOUBLE_EQ(1.0, metrics.recall);
+  ASSERT_DOUBLE_EQ((1.0 + 2.0 / 3.0) / 2.0, metrics.averagePrecision);
+
+  /* A missed label halves the recall and the average precision */
+  evaluator.addImage({makeDetection(0, 0, 0, 50, 50, 1), \
+                      makeDetection(0, 60, 60, 90, 90, 1)}, {});
+  metrics = evaluator.getMetrics();
+  ASSERT_EQ(4u, metrics.labels);
+  ASSERT_DOUBLE_EQ(0.5, metrics.recall);
+  ASSERT_DOUBLE_EQ((1.0 + 2.0 / 3.0) / 4.0, metrics.averagePrecision);
+
+  evaluator.reset();
+  metrics = evaluator.getMetrics();
+  ASSERT_EQ(0u, metrics.labels);
+  ASSERT_DOUBLE_EQ(0.0, metrics.averagePrecision);
+}
+
+/**
+ * @brief Test reading a label file
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AccuracyEvaluatorTest, TestLoadLabels) {
+  std::string path = "../test/testResults/evaluationLabels.txt";
+  {
+    std::ofstream file(path);
+    file << "# x1 y1 x2 y2 class\n10 20 30 40\n\n50 60 70 80 2\n";
+  }
+  std::vector<Detection> labels;
+  ASSERT_TRUE(AccuracyEvaluator::loadLabels(path, labels));
+  ASSERT_EQ(2u, labels.size());
+  ASSERT_EQ(10, labels[0].x1);
+  ASSERT_EQ(40, labels[0].y2);
+  ASSERT_EQ(0, labels[0].classId);
+  ASSERT_EQ(2, labels[1].classId);
+  {
+    std::ofstream file(path);
+    file << "10 20 five 40\n";
+  }
+  ASSERT_FALSE(AccuracyEvaluator::loadLabels(path, labels));
+  ASSERT_FALSE(AccuracyEvaluator::loadLabels(path + ".missing", labels));
+
+  ASSERT_EQ("images/a.txt", AccuracyEvaluator::labelPath("images/a.jpg"));
+  ASSERT_EQ("v1.0/a.txt", AccuracyEvaluator::labelPath("v1.0/a"));
+}
+
+/**
+ * @brief Test the configurations on the Pareto front and their table
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AccuracyEvaluatorTest, TestParetoFront) {
+  std::vector<EvaluationResult> results = {makeResult("accurate", 0.8, 10), \
+                                           makeResult("fast", 0.5, 30), \
+                                           makeResult("balanced", 0.7, 20), \
+                                           makeResult("worse", 0.6, 15), \
+                                           makeResult("slower", 0.8, 9)};
+  AccuracyEvaluator::markParetoFront(results);
+  ASSERT_TRUE(results[0].paretoOptimal);
+  ASSERT_TRUE(results[1].paretoOptimal);
+  ASSERT_TRUE(results[2].paretoOptimal);
+  ASSERT_FALSE(results[3].paretoOptimal);
+  ASSERT_FALSE(results[4].paretoOptimal);
+
+  std::ostringstream table;
+  AccuracyEvaluator::printTable(results, table);
+  std::string text = table.str();
+  /* By decreasing throughput */
+  ASSERT_LT(text.find("* fast"), text.find("* balanced"));
+  ASSERT_LT(text.find("* balanced"), text.find("  worse"));
+  ASSERT_LT(text.find("  worse"), text.find("* accurate"));
+
+  std::ostringstream csv;
+  AccuracyEvaluator::writeCsv(results, csv);
+  ASSERT_NE(std::string::npos, csv.str().find("fast,0,0,0,0,0,0.5,30,1"));
+}
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      AllocationCounterTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for AllocationCounter class
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "../include/AllocationCounter.hpp"
+
+/**
+ * @brief Test to check that allocations are counted
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AllocationCounterTest, TestCountsAllocations) {
+  uint64_t allocations = AllocationCounter::allocations();
+  uint64_t threadAllocations = AllocationCounter::threadAllocations();
+  uint64_t bytes = AllocationCounter::allocatedBytes();
+
+  std::unique_ptr<int> value(new int(3));
+  std::vector<double> values(100);
+
+  ASSERT_EQ(threadAllocations + 2, AllocationCounter::threadAllocations());
+  ASSERT_LE(allocations + 2, AllocationCounter::allocations());
+  ASSERT_LE(bytes + sizeof(int) + 100 * sizeof(double), \
+            AllocationCounter::allocatedBytes());
+}
+
+/**
+ * @brief Test to check that reusing memory is not counted
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AllocationCounterTest, TestReuseIsNotCounted) {
+  std::vector<int> values;
+  values.reserve(64);
+  uint64_t threadAllocations = AllocationCounter::threadAllocations();
+  for (int i = 0; i < 10; ++i) {
+    values.clear();
+    for (int j = 0; j < 64; ++j) {
+      values.push_back(j);
+    }
+  }
+  ASSERT_EQ(threadAllocations, AllocationCounter::threadAllocations());
+}
+
+/**
+ * @brief Test to check that image buffers are counted, and not the headers
+ *        of existing data or the buffers that are reused
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AllocationCounterTest, TestCountsImages) {
+  uint64_t matAllocations = AllocationCounter::threadMatAllocations();
+  cv::Mat image(48, 64, CV_8UC3);
+  ASSERT_EQ(matAllocations + 1, AllocationCounter::threadMatAllocations());
+  ASSERT_LE(matAllocations + 1, AllocationCounter::matAllocations());
+
+  image.create(48, 64, CV_8UC3);
+  cv::Mat header(48, 64, CV_8UC3, image.data);
+  cv::Mat shared = image;
+  ASSERT_EQ(matAllocations + 1, AllocationCounter::threadMatAllocations());
+  cv::Mat copy = image.clone();
+  ASSERT_EQ(matAllocations + 2, AllocationCounter::threadMatAllocations());
+}
@@ -0,0 +1,238 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AsyncDetectorTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for AsyncDetector class
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../include/AsyncDetector.hpp"
+
+namespace {
+/**
+ * @brief Detector returning one detection holding the brightness of the
+ *        frame as score, after a short delay, so that the tests don't
+ *        need a network
+ */
+AsyncDetector::DetectFunction fakeDetector() {
+  return [](const cv::Mat& frame, int frameID) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    if (frameID < 0) {
+      throw std::runtime_error("negative frame ID");
+    }
+    Detection detection = {frameID, 0, 0, frame.cols, frame.rows, \
+                           frame.at<cv::Vec3b>(0, 0)[0] / 255.0f, 0, -1};
+    return std::vector<Detection>{detection};
+  };
+}
+}  // namespace
+
+/**
+ * @brief Test futures receiving the detections of their own frame
+ */
+TEST(AsyncDetector, TestSubmitFuture) {
+  AsyncDetector detector(fakeDetector, 2, 4);
+  std::vector<std::future<std::vector<Detection>>> results;
+  cv::Mat frame(8, 16, CV_8UC3);
+  for (int i = 0; i < 20; ++i) {
+    /* The frame is reused at once, submit must have copied it */
+    frame.setTo(cv::Scalar::all(10 * i));
+    results.push_back(detector.submit(frame, i));
+  }
+  for (int i = 0; i < 20; ++i) {
+    std::vector<Detection> detections = results[i].get();
+    ASSERT_EQ(1u, detections.size());
+    ASSERT_EQ(i, detections[0].frameID);
+    ASSERT_EQ(16, detections[0].x2);
+    ASSERT_FLOAT_EQ(10 * i / 255.0f, detections[0].score);
+  }
+  AsyncDetectorStats stats = detector.getStats();
+  ASSERT_EQ(20u, stats.framesSubmitted);
+  ASSERT_EQ(20u, stats.framesCompleted);
+  ASSERT_LE(stats.maxInFlight, 4u);
+  ASSERT_GT(stats.blockedSubmits, 0u);
+}
+
+/**
+ * @brief Test callbacks and waitIdle
+ */
+TEST(AsyncDetector, TestSubmitCallback) {
+  AsyncDetector detector(fakeDetector, 3, 3);
+  std::atomic<int> delivered(0);
+  std::atomic<int> failed(0);
+  cv::Mat frame(4, 4, CV_8UC3, cv::Scalar::all(0));
+  for (int i = -2; i < 10; ++i) {
+    detector.submit(frame, i, [&delivered, &failed](int frameID, \
+        const std::vector<Detection>& detections, bool succeeded) {
+      if (!succeeded) {
+        failed += 1;
+      } else if (detections.size() == 1 && \
+                 detections[0].frameID == frameID) {
+        delivered += 1;
+      }
+    });
+  }
+  detector.waitIdle();
+  ASSERT_EQ(0u, detector.inFlight());
+  ASSERT_EQ(10, delivered.load());
+  ASSERT_EQ(2, failed.load());
+  ASSERT_EQ(2u, detector.getStats().framesFailed);
+}
+
+/**
+ * @brief Test a failed detection reported through the future
+ */
+TEST(AsyncDetector, TestFailedDetection) {
+  AsyncDetector detector(fakeDetector, 1, 1);
+  cv::Mat frame(4, 4, CV_8UC3, cv::Scalar::all(0));
+  std::future<std::vector<Detection>> result = detector.submit(frame, -1);
+  ASSERT_THROW(result.get(), std::runtime_error);
+  /* The worker keeps running */
+  ASSERT_EQ(1u, detector.submit(frame, 1).get().size());
+}
+
+/**
+ * @brief Test that the destructor completes the submitted frames
+ */
+TEST(AsyncDetector, TestDestructorDrains) {
+  std::atomic<int> delivered(0);
+  {
+    AsyncDetector detector(fakeDetector, 1, 8);
+    cv::Mat frame(4, 4, CV_8UC3, cv::Scalar::all(0));
+    for (int i = 0; i < 8; ++i) {
+      detector.submit(frame, i, [&delivered](int, \
+          const std::vector<Detection>&, bool) { delivered += 1; });
+    }
+  }
+  ASSERT_EQ(8, delivered.load());
+}
+
+namespace {
+/**
+ * @brief Batch detector returning the frame ID and the batch size of
+ *        every frame, so that the routing can be checked
+ */
+AsyncDetector::BatchDetectFunction fakeBatchDetector() {
+  return [](const std::vector<cv::Mat>& frames, \
+            const std::vector<int>& frameIDs, \
+            std::vector<std::vector<Detection>>& detections) {
+    detections.assign(frames.size(), std::vector<Detection>(1));
+    for (size_t i = 0; i < frames.size(); ++i) {
+      detections[i][0].frameID = frameIDs[i];
+      detections[i][0].classId = static_cast<int32_t>(frames.size());
+    }
+  };
+}
+}  // namespace
+
+/**
+ * @brief Test frames of several streams detected in full batches
+ */
+TEST(AsyncDetector, TestBatching) {
+  /* The wait is long enough for the batches to always fill */
+  AsyncDetector detector(fakeBatchDetector, 1, 8, 4, 5000);
+  std::vector<std::future<std::vector<Detection>>> results(8);
+  std::vector<std::thread> streams;
+  for (int s = 0; s < 2; ++s) {
+    streams.push_back(std::thread([&detector, &results, s]() {
+      cv::Mat frame(4, 4, CV_8UC3, cv::Scalar::all(s));
+      for (int i = 0; i < 4; ++i) {
+        results[4 * s + i] = detector.submit(frame, 4 * s + i);
+      }
+    }));
+  }
+  for (auto& stream : streams) {
+    stream.join();
+  }
+  for (int i = 0; i < 8; ++i) {
+    std::vector<Detection> detections = results[i].get();
+    ASSERT_EQ(1u, detections.size());
+    ASSERT_EQ(i, detections[0].frameID);
+    ASSERT_EQ(4, detections[0].classId);
+  }
+  AsyncDetectorStats stats = detector.getStats();
+  ASSERT_EQ(2u, stats.batches);
+  ASSERT_EQ(5u, stats.batchSizes.size());
+  ASSERT_EQ(2u, stats.batchSizes[4]);
+  ASSERT_EQ(8u, stats.queueDelay.count());
+}
+
+/**
+ * @brief Test a batch started by the deadline before it is full
+ */
+TEST(AsyncDetector, TestBatchDeadline) {
+  AsyncDetector detector(fakeBatchDetector, 1, 8, 8, 20);
+  cv::Mat frame(4, 4, CV_8UC3, cv::Scalar::all(0));
+  std::chrono::steady_clock::time_point start = \
+      std::chrono::steady_clock::now();
+  std::vector<Detection> detections = detector.submit(frame, 7).get();
+  double waitedMs = std::chrono::duration<double, std::milli>(\
+      std::chrono::steady_clock::now() - start).count();
+
+  ASSERT_EQ(1u, detections.size());
+  ASSERT_EQ(7, detections[0].frameID);
+  ASSERT_EQ(1, detections[0].classId);
+  ASSERT_GE(waitedMs, 19.0);
+  AsyncDetectorStats stats = detector.getStats();
+  ASSERT_EQ(1u, stats.batches);
+  ASSERT_EQ(1u, stats.batchSizes[1]);
+  ASSERT_GE(stats.queueDelay.max(), 19.0);
+}
+
+/**
+ * @brief Test the DetectionModules of the workers reporting their frames
+ *        and stages to one registry, without the warm up frames
+ */
+TEST(AsyncDetector, TestModuleMetrics) {
+  MetricsRegistry registry;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  {
+    AsyncDetector detector(RunOptions(), 2, 4, &registry);
+    std::future<std::vector<Detection>> first = detector.submit(testImage, 0);
+    std::future<std::vector<Detection>> second = \
+        detector.submit(testImage, 1);
+    size_t detected = first.get().size() + second.get().size();
+
+    ASSERT_EQ(2u, registry.counter("hodm_frames_processed_total", "").get());
+    ASSERT_EQ(detected, registry.counter("hodm_detections_total", "").get());
+    ASSERT_EQ(2u, registry.histogram("hodm_stage_duration_seconds", "", \
+                  {}, {{"stage", "forward"}}).count());
+  }
+  /* The samplers of the workers go away with them */
+  ASSERT_EQ(std::string::npos, \
+            registry.render().find("hodm_video_writer_queue_depth"));
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      AsyncVideoWriterTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for AsyncVideoWriter class
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../include/AsyncVideoWriter.hpp"
+
+namespace {
+/**
+ * @brief Writes frames of increasing brightness and checks that they are
+ *        read back in the same order
+ */
+void checkWrittenInOrder(const std::string& path, int encoderThreads) {
+  const int frameCount = 20;
+  AsyncVideoWriter writer;
+  ASSERT_TRUE(writer.open(path, 15.0, cv::Size(64, 48), 2, encoderThreads));
+  for (int i = 0; i < frameCount; ++i) {
+    cv::Mat frame(48, 64, CV_8UC3, cv::Scalar::all(10 * i));
+    ASSERT_TRUE(writer.write(i, frame));
+  }
+  writer.close();
+  VideoWriterStats stats = writer.getStats();
+  ASSERT_EQ(static_cast<uint64_t>(frameCount), stats.framesSubmitted);
+  ASSERT_EQ(static_cast<uint64_t>(frameCount), stats.framesWritten);
+  ASSERT_LE(stats.maxQueueDepth, 2u);
+
+  cv::VideoCapture video(path);
+  ASSERT_TRUE(video.isOpened());
+  cv::Mat frame;
+  int readCount = 0;
+  while (video.read(frame)) {
+    ASSERT_NEAR(10 * readCount, cv::mean(frame)[0], 3.0);
+    readCount += 1;
+  }
+  ASSERT_EQ(frameCount, readCount);
+}
+}  // namespace
+
+/**
+ * @brief Test to check the frames written by cv::VideoWriter on the writer
+ *        thread
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AsyncVideoWriterTest, TestWriterThread) {
+  checkWrittenInOrder("../test/testResults/asyncWriterTest.avi", 0);
+}
+
+/**
+ * @brief Test to check the frames encoded by a pool of JPEG encoders
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AsyncVideoWriterTest, TestEncoderPool) {
+  checkWrittenInOrder("../test/testResults/asyncEncoderTest.avi", 3);
+}
+
+/**
+ * @brief Test to check that frames out of order or of the wrong size are
+ *        refused
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AsyncVideoWriterTest, TestRefusedFrames) {
+  AsyncVideoWriter writer;
+  cv::Mat frame = cv::Mat::zeros(48, 64, CV_8UC3);
+  ASSERT_FALSE(writer.write(0, frame));
+
+  ASSERT_TRUE(writer.open("../test/testResults/asyncWriterTest.avi", 15.0, \
+                          cv::Size(64, 48), 4, 1));
+  ASSERT_TRUE(writer.write(5, frame));
+  ASSERT_FALSE(writer.write(5, frame));
+  ASSERT_FALSE(writer.write(3, frame));
+  ASSERT_FALSE(writer.write(6, cv::Mat::zeros(416, 416, CV_8UC3)));
+  ASSERT_TRUE(writer.write(6, frame));
+  writer.close();
+  ASSERT_EQ(2u, writer.getStats().framesWritten);
+}
+
+/**
+ * @brief Test to check that the video continues in a new file when the
+ *        current one is full
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(AsyncVideoWriterTest, TestFileRollover) {
+  AsyncVideoWriter writer;
+  writer.setMaxFileSize(16 * 1024);
+  ASSERT_TRUE(writer.open("../test/testResults/asyncRollover.avi", 15.0, \
+                          cv::Size(64, 48), 2, 1));
+  cv::Mat frame(48, 64, CV_8UC3);
+  for (int i = 0; i < 20; ++i) {
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    ASSERT_TRUE(writer.write(i, frame));
+  }
+  writer.close();
+  VideoWriterStats stats = writer.getStats();
+  ASSERT_EQ(20u, stats.framesWritten);
+  ASSERT_EQ(0u, stats.framesFailed);
+  ASSERT_GT(stats.files, 1u);
+
+  int readCount = 0;
+  for (uint64_t part = 1; part <= stats.files; ++part) {
+    std::string path = "../test/testResults/asyncRollover" + \
+        (part == 1 ? std::string() : "_part" + std::to_string(part)) + ".avi";
+    cv::VideoCapture video(path);
+    ASSERT_TRUE(video.isOpened());
+    cv::Mat read;
+    while (video.read(read)) {
+      readCount += 1;
+    }
+  }
+  ASSERT_EQ(20, readCount);
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      AutoTunerTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for AutoTuner class
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+#include "../include/AutoTuner.hpp"
+
+namespace {
+/**
+ * @brief Fake measurement: more threads, workers and frames per batch
+ *        give more frames per second, while threads and batches also add
+ *        latency, and the box filter is a little faster
+ */
+TuningMeasurement fakeMeasure(const RunOptions& options) {
+  TuningMeasurement measurement;
+  measurement.framesPerSecond = options.opencvThreads * \
+      options.serverWorkers * options.maxBatch + \
+      (options.filterType == 'B' ? 0.5 : 0);
+  measurement.p50Ms = 50.0 * options.maxBatch * options.opencvThreads;
+  measurement.p99Ms = 2 * measurement.p50Ms;
+  return measurement;
+}
+}  // namespace
+
+/**
+ * @brief Test that the candidates keep the threads times workers within
+ *        the cores and keep the other options
+ */
+TEST(AutoTuner, TestListCandidates) {
+  RunOptions base;
+  base.profile = true;
+  std::vector<RunOptions> candidates;
+  AutoTuner::listCandidates(base, 4, {320, 416}, candidates);
+
+  /* (1, 1), (1, 2), (1, 4), (2, 1), (2, 2), (4, 1) times 3 batches */
+  ASSERT_EQ(2u * 6 * 3, candidates.size());
+  for (const auto& candidate : candidates) {
+    ASSERT_LE(candidate.opencvThreads * candidate.serverWorkers, 4);
+    ASSERT_GE(candidate.maxBatch, 1);
+    ASSERT_LE(candidate.maxBatch, 4);
+    ASSERT_TRUE(candidate.profile);
+  }
+  ASSERT_EQ(320, candidates.front().inputSize);
+  ASSERT_EQ(416, candidates.back().inputSize);
+
+  AutoTuner::listCandidates(base, 0, {416}, candidates);
+  ASSERT_EQ(3u, candidates.size());
+}
+
+/**
+ * @brief Test that the fastest configuration under the latency cap is
+ *        chosen, then the fastest filter
+ */
+TEST(AutoTuner, TestTune) {
+  AutoTuner tuner(fakeMeasure, 250);
+  std::ostringstream log;
+  ASSERT_TRUE(tuner.tune(RunOptions(), 4, {416}, log));
+
+  /* One thread and 4 workers with batches of 2: 8 frames/s, p99 200 */
+  const RunOptions& best = tuner.getBest();
+  ASSERT_EQ(1, best.opencvThreads);
+  ASSERT_EQ(4, best.serverWorkers);
+  ASSERT_EQ(2, best.maxBatch);
+  ASSERT_EQ('B', best.filterType);
+  ASSERT_DOUBLE_EQ(8.5, tuner.getBestMeasurement().framesPerSecond);
+  ASSERT_NE(std::string::npos, log.str().find("over the cap"));
+  /* The format of the log is left as it was */
+  log.str("");
+  log << 3.14159;
+  ASSERT_EQ("3.14159", log.str());
+}
+
+/**
+ * @brief Test that the lowest latency is kept when no configuration meets
+ *        the cap
+ */
+TEST(AutoTuner, TestTuneOverCap) {
+  AutoTuner tuner(fakeMeasure, 10);
+  std::ostringstream log;
+  ASSERT_FALSE(tuner.tune(RunOptions(), 2, {416}, log));
+  ASSERT_EQ(1, tuner.getBest().opencvThreads);
+  ASSERT_EQ(1, tuner.getBest().maxBatch);
+  ASSERT_DOUBLE_EQ(100, tuner.getBestMeasurement().p99Ms);
+}
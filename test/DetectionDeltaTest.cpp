@@ -0,0 +1,197 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      DetectionDeltaTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for DeltaEncoder and DeltaDecoder classes
+ */
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/DetectionDelta.hpp"
+#include "TestDetections.hpp"
+
+namespace {
+const char kDeltaPath[] = "../test/testResults/DetectionsDelta.txt";
+
+/**
+ * @brief Detections of a scene of 50 frames: a person sitting still with
+ *        a pixel of jitter, one walking from frame 10 to 29 and none from
+ *        frame 40 to 44
+ */
+std::vector<Detection> makeScene() {
+  std::vector<Detection> detections;
+  for (int frameID = 0; frameID < 50; ++frameID) {
+    if (frameID >= 40 && frameID < 45) {
+      continue;
+    }
+    int jitter = frameID % 2;
+    detections.push_back(makeDetection(frameID, 100 + jitter, 50, \
+                                       140, 150 - jitter));
+    if (frameID >= 10 && frameID < 30) {
+      int x = 200 + 10 * (frameID - 10);
+      detections.push_back(makeDetection(frameID, x, 60, x + 40, 160));
+    }
+  }
+  return detections;
+}
+
+/**
+ * @brief Checks that the detections of one frame are those of the scene,
+ *        within the tolerance
+ */
+void expectFrame(const std::vector<Detection>& scene, int frameID, \
+                 const std::vector<Detection>& decoded, int tolerance) {
+  size_t count = 0;
+  for (const auto& expected : scene) {
+    if (expected.frameID != frameID) {
+      continue;
+    }
+    count += 1;
+    bool found = false;
+    for (const auto& detection : decoded) {
+      found = found || (detection.frameID == frameID && \
+                        std::abs(detection.x1 - expected.x1) <= tolerance && \
+                        std::abs(detection.y1 - expected.y1) <= tolerance && \
+                        std::abs(detection.x2 - expected.x2) <= tolerance && \
+                        std::abs(detection.y2 - expected.y2) <= tolerance);
+    }
+    EXPECT_TRUE(found) << "frame " << frameID;
+  }
+  EXPECT_EQ(count, decoded.size()) << "frame " << frameID;
+}
+
+/**
+ * @brief Writes the scene delta encoded
+ */
+DeltaStats writeScene(const std::vector<Detection>& scene, int tolerance) {
+  std::ofstream file(kDeltaPath);
+  DeltaEncoder encoder(file, 16, tolerance);
+  EXPECT_TRUE(encoder.encodeAll(scene));
+  encoder.finish(52);
+  return encoder.getStats();
+}
+}  // namespace
+
+/**
+ * @brief Test that the decoded frames are those encoded, within the
+ *        tolerance, while the still boxes are written once per full frame
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionDeltaTest, TestRoundTrip) {
+  std::vector<Detection> scene = makeScene();
+  DeltaStats stats = writeScene(scene, 2);
+  ASSERT_EQ(53u, stats.frames);
+  ASSERT_EQ(4u, stats.keyframes);
+  ASSERT_EQ(scene.size(), stats.boxes);
+  ASSERT_LT(stats.boxesWritten, stats.boxes / 2);
+
+  DeltaDecoder decoder;
+  ASSERT_TRUE(decoder.open(kDeltaPath));
+  ASSERT_EQ(52, decoder.getLastFrameID());
+  std::vector<Detection> decoded;
+  ASSERT_TRUE(decoder.readAll(decoded));
+  for (int frameID = 0; frameID <= 52; ++frameID) {
+    std::vector<Detection> frame;
+    for (const auto& detection : decoded) {
+      if (detection.frameID == frameID) {
+        frame.push_back(detection);
+      }
+    }
+    expectFrame(scene, frameID, frame, 2);
+  }
+}
+
+/**
+ * @brief Test the report of the boxes written, which leaves the format of
+ *        its stream as it was
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionDeltaTest, TestPrintReport) {
+  std::ostringstream file;
+  DeltaEncoder encoder(file, 16, 2);
+  ASSERT_TRUE(encoder.encodeAll({makeDetection(0, 10, 20, 50, 80), \
+                                 makeDetection(1, 10, 20, 50, 80)}));
+  encoder.finish(1);
+  std::ostringstream report;
+  encoder.printReport(report);
+  ASSERT_NE(std::string::npos, \
+            report.str().find("1 of 2 boxes written (50.0%)"));
+  report.str("");
+  report << 3.14159;
+  ASSERT_EQ("3.14159", report.str());
+}
+
+/**
+ * @brief Test that a tolerance of 0 writes every change exactly
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionDeltaTest, TestExact) {
+  std::vector<Detection> scene = makeScene();
+  writeScene(scene, 0);
+  DeltaDecoder decoder;
+  ASSERT_TRUE(decoder.open(kDeltaPath));
+  std::vector<Detection> frame;
+  for (int frameID = 0; frameID <= 52; ++frameID) {
+    ASSERT_TRUE(decoder.readFrame(frameID, frame));
+    expectFrame(scene, frameID, frame, 0);
+  }
+}
+
+/**
+ * @brief Test reading frames out of order, from their full frame
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionDeltaTest, TestRandomAccess) {
+  std::vector<Detection> scene = makeScene();
+  writeScene(scene, 2);
+  DeltaDecoder decoder;
+  ASSERT_TRUE(decoder.open(kDeltaPath));
+  std::vector<Detection> frame;
+  for (int frameID : {37, 21, 22, 5, 42, 50, 0}) {
+    ASSERT_TRUE(decoder.readFrame(frameID, frame));
+    expectFrame(scene, frameID, frame, 2);
+  }
+  ASSERT_FALSE(decoder.readFrame(53, frame));
+  ASSERT_FALSE(decoder.open("../test/testData/testImage.jpg"));
+}
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionInterpolatorTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for DetectionInterpolator class
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../include/DetectionInterpolator.hpp"
+#include "TestDetections.hpp"
+
+/**
+ * @brief Test to check the intersection over union of two boxes
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionInterpolatorTest, TestIou) {
+  Detection box = makeDetection(0, 0, 0, 10, 10, 1);
+  ASSERT_FLOAT_EQ(1.0f, DetectionInterpolator::iou(box, box));
+  ASSERT_FLOAT_EQ(50.0f / 150.0f, DetectionInterpolator::iou(box, \
+                  makeDetection(0, 5, 0, 15, 10, 1)));
+  ASSERT_FLOAT_EQ(0.0f, DetectionInterpolator::iou(box, \
+                  makeDetection(0, 10, 0, 20, 10, 1)));
+}
+
+/**
+ * @brief Test that a box paired across the key frames moves linearly
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionInterpolatorTest, TestPairedBoxMoves) {
+  DetectionInterpolator interpolator;
+  std::vector<Detection> first{makeDetection(0, 0, 0, 100, 100, 0.9f)};
+  std::vector<Detection> last{makeDetection(0, 20, 10, 120, 110, 0.5f)};
+  interpolator.setKeyFrames(4, first, 8, last);
+
+  std::vector<Detection> detections;
+  interpolator.interpolate(5, detections);
+  interpolator.interpolate(6, detections);
+  ASSERT_EQ(2u, detections.size());
+  ASSERT_EQ(5, detections[0].frameID);
+  ASSERT_EQ(5, detections[0].x1);
+  ASSERT_EQ(3, detections[0].y1);
+  ASSERT_EQ(105, detections[0].x2);
+  ASSERT_FLOAT_EQ(0.8f, detections[0].score);
+  ASSERT_EQ(6, detections[1].frameID);
+  ASSERT_EQ(10, detections[1].x1);
+  ASSERT_EQ(105, detections[1].y2);
+  ASSERT_FLOAT_EQ(0.7f, detections[1].score);
+}
+
+/**
+ * @brief Test that boxes without a pair are kept near their own key frame
+ *        and that boxes are paired by largest overlap of the same class
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionInterpolatorTest, TestUnpairedBoxes) {
+  DetectionInterpolator interpolator;
+  Detection leaving = makeDetection(0, 0, 0, 10, 10, 0.9f);
+  Detection staying = makeDetection(0, 100, 100, 150, 200, 0.9f);
+  Detection arriving = makeDetection(0, 300, 300, 320, 340, 0.9f);
+  Detection otherClass = makeDetection(0, 100, 100, 150, 200, 0.9f);
+  otherClass.classId = 2;
+  interpolator.setKeyFrames(0, {leaving, staying}, 4, \
+                            {otherClass, arriving, staying});
+
+  std::vector<Detection> detections;
+  interpolator.interpolate(1, detections);
+  /* The box of the other class is not paired with the staying person */
+  ASSERT_EQ(2u, detections.size());
+  ASSERT_EQ(staying.x2, detections[0].x2);
+  ASSERT_EQ(leaving.x2, detections[1].x2);
+
+  detections.clear();
+  interpolator.interpolate(3, detections);
+  ASSERT_EQ(3u, detections.size());
+  ASSERT_EQ(staying.x2, detections[0].x2);
+  ASSERT_EQ(2, detections[1].classId);
+  ASSERT_EQ(arriving.x2, detections[2].x2);
+}
+
+/**
+ * @brief Test that giving one key frame twice holds its boxes
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionInterpolatorTest, TestHold) {
+  DetectionInterpolator interpolator;
+  std::vector<Detection> last{makeDetection(0, 0, 0, 10, 10, 0.9f), \
+                              makeDetection(0, 2, 2, 12, 12, 0.8f)};
+  interpolator.setKeyFrames(9, last, 12, last);
+  std::vector<Detection> detections;
+  interpolator.interpolate(10, detections);
+  interpolator.interpolate(11, detections);
+  ASSERT_EQ(4u, detections.size());
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(last[i % 2].x1, detections[i].x1);
+    ASSERT_FLOAT_EQ(last[i % 2].score, detections[i].score);
+  }
+  ASSERT_EQ(11, detections[3].frameID);
+}
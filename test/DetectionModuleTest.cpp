@@ -31,9 +31,98 @@
  */
 
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 
+#include <AllocationCounter.hpp>
 #include <DetectionModule.hpp>
 
+namespace {
+/**
+ * @brief Makes a raw frame of the test image in a YUV layout of any size,
+ *        the chroma of odd sizes being rounded up as ffmpeg does
+ */
+std::string rawYuvFrame(FrameStreamReader::PixelFormat format, int width, \
+                        int height) {
+  int chromaWidth = (width + 1) / 2;
+  int chromaHeight = (height + 1) / 2;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::resize(testImage, testImage, cv::Size(2 * chromaWidth, \
+                                            2 * chromaHeight));
+  cv::Mat i420;
+  cv::cvtColor(testImage, i420, cv::COLOR_BGR2YUV_I420);
+  const unsigned char* luma = i420.data;
+  const unsigned char* u = luma + 4 * chromaWidth * chromaHeight;
+  const unsigned char* v = u + chromaWidth * chromaHeight;
+  std::string frame;
+  if (format == FrameStreamReader::kYuyv) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < chromaWidth; ++x) {
+        int chroma = (y / 2) * chromaWidth + x;
+        frame += static_cast<char>(luma[y * 2 * chromaWidth + 2 * x]);
+        frame += static_cast<char>(u[chroma]);
+        frame += static_cast<char>(luma[y * 2 * chromaWidth + 2 * x + 1]);
+        frame += static_cast<char>(v[chroma]);
+      }
+    }
+    return frame;
+  }
+  for (int y = 0; y < height; ++y) {
+    frame.append(reinterpret_cast<const char*>(luma + y * 2 * chromaWidth), \
+                 width);
+  }
+  size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+  if (format == FrameStreamReader::kYuv420p) {
+    frame.append(reinterpret_cast<const char*>(u), chromaSize);
+    frame.append(reinterpret_cast<const char*>(v), chromaSize);
+    return frame;
+  }
+  for (size_t i = 0; i < chromaSize; ++i) {
+    frame += static_cast<char>(u[i]);
+    frame += static_cast<char>(v[i]);
+  }
+  return frame;
+}
+
+/**
+ * @brief Writes two raw frames to a file and detects them as a stream
+ *
+ * @return Number of frames with detections written, -1 if the stream is
+ *         not processed
+ */
+int processRawStream(const RunOptions& options) {
+  std::string path = "../test/testResults/stream.raw";
+  {
+    std::ofstream stream(path, std::ios::binary);
+    std::string frame = rawYuvFrame(\
+        FrameStreamReader::parseFormat(options.rawFormat), \
+        options.rawWidth, options.rawHeight);
+    stream << frame << frame;
+  }
+  DetectionModule dm;
+  dm.setOptions(options);
+  testing::internal::CaptureStdout();
+  bool processed = dm.processStream(path);
+  std::string output = testing::internal::GetCapturedStdout();
+  std::remove(path.c_str());
+  if (!processed) {
+    return -1;
+  }
+  std::istringstream lines(output);
+  std::string line;
+  int frames = 0;
+  while (std::getline(lines, line)) {
+    if (line.find("{\"frame\":" + std::to_string(frames) + ",") == 0) {
+      frames += 1;
+    }
+  }
+  return frames;
+}
+}  // namespace
+
 /**
  * @brief Test to check get frame function, that executes main
  *        detection functionality
@@ -70,6 +159,274 @@ TEST(DetectionModuleTest, TestGetFrame) {
   ASSERT_EQ(416, testOutput.rows);
 }
 
+/**
+ * @brief Test that a video read with a frame stride detects the same boxes
+ *        on the key frames and gives the detections in frame order
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestGetFrameStride) {
+  std::string testFilePath = "../test/testData/testVideo.avi";
+  std::string testOutputDirectory = "../test/testResults/";
+  RunOptions options;
+  options.headless = true;
+  DetectionModule everyFrame;
+  everyFrame.setOptions(options);
+  ASSERT_EQ(1, everyFrame.getFrame(testFilePath, -1, testOutputDirectory, \
+                                   2));
+  std::vector<Detection> expected = everyFrame.takeDetections();
+
+  options.frameStride = 3;
+  DetectionModule strided;
+  strided.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(1, strided.getFrame(testFilePath, -1, testOutputDirectory, 2));
+  std::string output = testing::internal::GetCapturedStdout();
+  ASSERT_NE(std::string::npos, output.find("interpolated"));
+  std::vector<Detection> detections = strided.takeDetections();
+
+  size_t keyFrameDetections = 0;
+  for (size_t i = 0; i < detections.size(); ++i) {
+    if (i > 0) {
+      ASSERT_LE(detections[i - 1].frameID, detections[i].frameID);
+    }
+    if (detections[i].frameID % 3 == 0) {
+      keyFrameDetections += 1;
+    }
+  }
+  size_t expectedKeyFrameDetections = 0;
+  for (const auto& detection : expected) {
+    if (detection.frameID % 3 == 0) {
+      expectedKeyFrameDetections += 1;
+    }
+  }
+  ASSERT_EQ(expectedKeyFrameDetections, keyFrameDetections);
+}
+
+/**
+ * @brief Test that a checkpointed video gives the detections of a run
+ *        without checkpoints and removes its checkpoint once done
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestGetFrameCheckpoint) {
+  std::string testFilePath = "../test/testData/testVideo.avi";
+  std::string testOutputDirectory = "../test/testResults/";
+  std::string checkpointPath = testOutputDirectory + "video.checkpoint";
+  RunOptions options;
+  options.headless = true;
+  DetectionModule plain;
+  plain.setOptions(options);
+  ASSERT_EQ(1, plain.getFrame(testFilePath, -1, testOutputDirectory, 2));
+  std::vector<Detection> expected = plain.takeDetections();
+
+  options.checkpointFile = checkpointPath;
+  options.checkpointInterval = 5;
+  options.resume = true;
+  DetectionModule checkpointed;
+  checkpointed.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(1, checkpointed.getFrame(testFilePath, -1, \
+                                     testOutputDirectory, 2));
+  std::string output = testing::internal::GetCapturedStdout();
+  ASSERT_NE(std::string::npos, output.find("starting from the first frame"));
+  std::vector<Detection> detections = checkpointed.takeDetections();
+  ASSERT_EQ(expected.size(), detections.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].frameID, detections[i].frameID);
+    ASSERT_EQ(expected[i].x1, detections[i].x1);
+    ASSERT_EQ(expected[i].y1, detections[i].y1);
+    ASSERT_EQ(expected[i].x2, detections[i].x2);
+    ASSERT_EQ(expected[i].y2, detections[i].y2);
+  }
+
+  std::ifstream checkpoint(checkpointPath);
+  ASSERT_FALSE(checkpoint.is_open());
+}
+
+/**
+ * @brief Test that the checkpoint is kept when the detections can't be
+ *        written, and that the job then resumes from it
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestCheckpointKeptUntilSaved) {
+  std::string testFilePath = "../test/testData/testVideo.avi";
+  std::string checkpointPath = "../test/testResults/saved.checkpoint";
+  RunOptions options;
+  options.headless = true;
+  options.checkpointFile = checkpointPath;
+  options.checkpointInterval = 5;
+  DetectionModule failing;
+  failing.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(0, failing.getFrame(testFilePath, -1, \
+                                "../test/missingDirectory/", 2));
+  std::string output = testing::internal::GetCapturedStdout();
+  ASSERT_NE(std::string::npos, output.find("can be resumed"));
+  ASSERT_TRUE(std::ifstream(checkpointPath).is_open());
+
+  options.resume = true;
+  DetectionModule resumed;
+  resumed.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(1, resumed.getFrame(testFilePath, -1, "../test/testResults/", \
+                                2));
+  output = testing::internal::GetCapturedStdout();
+  ASSERT_NE(std::string::npos, output.find("Resuming from frame"));
+  ASSERT_FALSE(std::ifstream(checkpointPath).is_open());
+}
+
+/**
+ * @brief Test that the summary of a resumed job counts the key frames
+ *        detected since the resume only
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestResumeSummary) {
+  std::string testFilePath = "../test/testData/testVideo.avi";
+  std::string checkpointPath = "../test/testResults/summary.checkpoint";
+  RunOptions options;
+  options.headless = true;
+  options.frameStride = 3;
+  options.checkpointFile = checkpointPath;
+  options.checkpointInterval = 5;
+  DetectionModule failing;
+  failing.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(0, failing.getFrame(testFilePath, -1, \
+                                "../test/missingDirectory/", 2));
+  testing::internal::GetCapturedStdout();
+
+  options.resume = true;
+  DetectionModule resumed;
+  resumed.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(1, resumed.getFrame(testFilePath, -1, "../test/testResults/", \
+                                2));
+  std::string output = testing::internal::GetCapturedStdout();
+  int firstFrame = -1;
+  int detected = -1;
+  int frames = -1;
+  int summaryFirstFrame = -1;
+  size_t resuming = output.find("Resuming from frame");
+  size_t summary = output.find("Detected");
+  ASSERT_NE(std::string::npos, resuming);
+  ASSERT_NE(std::string::npos, summary);
+  ASSERT_EQ(1, std::sscanf(output.c_str() + resuming, \
+                           "Resuming from frame %d", &firstFrame));
+  ASSERT_EQ(3, std::sscanf(output.c_str() + summary, \
+                           "Detected %d of %d frames from frame %d", \
+                           &detected, &frames, &summaryFirstFrame));
+  ASSERT_GT(firstFrame, 0);
+  ASSERT_EQ(firstFrame, summaryFirstFrame);
+  /* Key frames are the multiples of the stride in the resumed frames */
+  int keyFrames = 0;
+  for (int frameID = firstFrame; frameID < firstFrame + frames; ++frameID) {
+    if (frameID % 3 == 0) {
+      keyFrames += 1;
+    }
+  }
+  ASSERT_EQ(keyFrames, detected);
+}
+
+/**
+ * @brief Test to check processing a directory of images as a batch
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestGetFrameBatch) {
+  DetectionModule dm;
+  std::string testOutputDirectory = "../test/testResults/";
+
+  ASSERT_EQ(1, dm.getFrame("../test/testData", -1, testOutputDirectory, 1));
+
+  cv::Mat testOutput1 = cv::imread(testOutputDirectory + \
+                                   "testImageDetection.jpg");
+  cv::Mat testOutput2 = cv::imread(testOutputDirectory + \
+                                   "demoScreenshotDetection.jpg");
+  ASSERT_EQ(416, testOutput1.cols);
+  ASSERT_EQ(416, testOutput2.cols);
+}
+
+/**
+ * @brief Test that a second run over a directory takes the detections of
+ *        the result cache and writes the same detections
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestGetFrameBatchCache) {
+  std::string testOutputDirectory = "../test/testResults/";
+  std::string cacheFile = testOutputDirectory + "results.cache";
+  std::remove(cacheFile.c_str());
+  RunOptions options;
+  options.cacheFile = cacheFile;
+  std::string detectionsPath = testOutputDirectory + "DetectionsFile.txt";
+
+  std::string firstDetections;
+  {
+    DetectionModule dm;
+    dm.setOptions(options);
+    ASSERT_EQ(1, dm.getFrame("../test/testData", -1, testOutputDirectory, \
+                             1));
+    std::ifstream detectionsFile(detectionsPath);
+    std::stringstream content;
+    content << detectionsFile.rdbuf();
+    firstDetections = content.str();
+  }
+  ResultCache cache;
+  ASSERT_TRUE(cache.open(cacheFile, 10));
+  ASSERT_EQ(2u, cache.size());
+
+  DetectionModule dm;
+  dm.setOptions(options);
+  testing::internal::CaptureStdout();
+  ASSERT_EQ(1, dm.getFrame("../test/testData", -1, testOutputDirectory, 1));
+  std::string output = testing::internal::GetCapturedStdout();
+  ASSERT_NE(std::string::npos, output.find("2 hits, 0 misses"));
+  std::ifstream detectionsFile(detectionsPath);
+  std::stringstream content;
+  content << detectionsFile.rdbuf();
+  ASSERT_EQ(firstDetections, content.str());
+  std::remove(cacheFile.c_str());
+}
+
+/**
+ * @brief Test that a headless run saves the detections without writing
+ *        annotated images
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestGetFrameHeadless) {
+  std::string testOutputDirectory = "../test/testResults/headless/";
+  mkdir(testOutputDirectory.c_str(), 0755);
+  std::string imagePath = testOutputDirectory + "testImageDetection.jpg";
+  std::remove(imagePath.c_str());
+  RunOptions options;
+  options.headless = true;
+  DetectionModule dm;
+  dm.setOptions(options);
+
+  ASSERT_EQ(1, dm.getFrame("../test/testData", -1, testOutputDirectory, 1));
+  std::ifstream detectionsFile(testOutputDirectory + "DetectionsFile.txt");
+  ASSERT_TRUE(detectionsFile.is_open());
+  ASSERT_TRUE(cv::imread(imagePath).empty());
+}
+
 /**
  * @brief Test to check pre processing steps
  *
@@ -130,3 +487,423 @@ TEST(DetectionModuleTest, TestPostProcessImage) {
   ASSERT_EQ(testImage.rows, testOutput.rows);
 }
 
+/**
+ * @brief Test to check that a box is decoded from its center X and center
+ *        Y outputs
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestDecodeNetworkOutput) {
+  DetectionModule dm;
+  /* Center at (0.25, 0.75) of the frame, a tenth wide and a fifth high */
+  std::vector<cv::Mat> testOutput{cv::Mat::zeros(1, 85, CV_32F)};
+  float* box = testOutput[0].ptr<float>(0);
+  box[0] = 0.25f;
+  box[1] = 0.75f;
+  box[2] = 0.1f;
+  box[3] = 0.2f;
+  box[5] = 0.95f;
+  std::vector<cv::Rect> boxes;
+  std::vector<float> scores;
+  std::vector<int> classIds;
+
+  dm.decodeNetworkOutput(testOutput, cv::Size(400, 200), boxes, scores, \
+                         classIds);
+
+  ASSERT_EQ(1u, boxes.size());
+  ASSERT_EQ(cv::Rect(80, 130, 40, 40), boxes[0]);
+  ASSERT_FLOAT_EQ(0.95f, scores[0]);
+  ASSERT_EQ(0, classIds[0]);
+}
+
+/**
+ * @brief Test to check that transforming detections keeps their fields
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestTransformDetections) {
+  DetectionModule dm;
+  Detection detection;
+  detection.frameID = 2;
+  detection.x1 = 10;
+  detection.y1 = 20;
+  detection.x2 = 60;
+  detection.y2 = 120;
+  detection.score = 0.93f;
+  std::vector<Detection> testDetections{detection};
+
+  dm.transformDetections(testDetections);
+
+  /* Frames and intrinsic matrix are identities */
+  ASSERT_EQ(2, testDetections[0].frameID);
+  ASSERT_EQ(10, testDetections[0].x1);
+  ASSERT_EQ(20, testDetections[0].y1);
+  ASSERT_EQ(60, testDetections[0].x2);
+  ASSERT_EQ(120, testDetections[0].y2);
+  ASSERT_FLOAT_EQ(0.93f, testDetections[0].score);
+  ASSERT_EQ(-1, testDetections[0].trackID);
+}
+
+
+/**
+ * @brief Test to check that the pre processing reuses its buffers
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestPreProcessBufferReuse) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+
+  const uchar* data = dm.preProcessImage(testImage, 'G').data;
+  uint64_t matAllocations = dm.getArena().matAllocations();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(data, dm.preProcessImage(testImage, 'G').data);
+  }
+  ASSERT_EQ(matAllocations, dm.getArena().matAllocations());
+}
+
+/**
+ * @brief Test to check that processing a frame allocates neither on the
+ *        heap nor an image buffer once warmed up
+ *
+ * The forward pass is replaced by a copy of a synthetic output into the
+ * matrices of the previous frame, the model being out of the test.
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestSteadyStateAllocations) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  /* One output layer with a confident person every 10 boxes */
+  cv::Mat testOutput = cv::Mat::zeros(507, 85, CV_32F);
+  for (int i = 0; i < testOutput.rows; i += 10) {
+    float* box = testOutput.ptr<float>(i);
+    box[0] = 0.5f;
+    box[1] = 0.5f;
+    box[2] = 0.1f + 0.001f * i;
+    box[3] = 0.2f;
+    box[5] = 0.95f;
+  }
+  dm.getNetwork().setForward([&testOutput](const cv::Mat&, \
+                                           std::vector<cv::Mat>& outputs) {
+    outputs.resize(1);
+    testOutput.copyTo(outputs[0]);
+  });
+  const int frameCount = 6;
+  /* The detections of the run are kept, room is made for them up front */
+  dm.reserveDetections(frameCount * testOutput.rows);
+
+  /* Jobs of the OpenCV thread pool are allocated by the calling thread,
+  run the filters on it so that only the frame itself is counted */
+  int threads = cv::getNumThreads();
+  cv::setNumThreads(0);
+  uint64_t allocations = 0;
+  uint64_t matAllocations = 0;
+  for (int frameID = 0; frameID < frameCount; ++frameID) {
+    /* The first frames warm up the buffers */
+    if (frameID == 3) {
+      allocations = AllocationCounter::threadAllocations();
+      matAllocations = AllocationCounter::threadMatAllocations();
+    }
+    dm.processFrame(testImage, frameID);
+  }
+  uint64_t steadyAllocations = AllocationCounter::threadAllocations();
+  uint64_t steadyMatAllocations = AllocationCounter::threadMatAllocations();
+  cv::setNumThreads(threads);
+  ASSERT_FALSE(dm.getFrameDetections().empty());
+  ASSERT_FLOAT_EQ(0.95f, dm.getFrameDetections()[0].score);
+  ASSERT_EQ(allocations, steadyAllocations);
+  ASSERT_EQ(matAllocations, steadyMatAllocations);
+}
+
+/**
+ * @brief Test that detect returns the detections of one image only
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestDetect) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+
+  std::vector<Detection> first = dm.detect(testImage, 5);
+  std::vector<Detection> second = dm.detect(testImage, 6);
+
+  ASSERT_EQ(first.size(), second.size());
+  for (const auto& detection : second) {
+    ASSERT_EQ(6, detection.frameID);
+  }
+  /* Nothing is accumulated for the detections file */
+  ASSERT_TRUE(dm.takeDetections().empty());
+}
+
+/**
+ * @brief Test that the frames, detections and stage durations are reported
+ *        to the metrics registry
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestMetrics) {
+  MetricsRegistry registry;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  {
+    DetectionModule dm;
+    dm.setMetrics(&registry);
+    std::vector<Detection> first = dm.detect(testImage, 0);
+    std::vector<Detection> second = dm.detect(testImage, 1);
+
+    ASSERT_EQ(2u, registry.counter("hodm_frames_processed_total", "").get());
+    ASSERT_EQ(first.size() + second.size(), \
+              registry.counter("hodm_detections_total", "").get());
+    ASSERT_DOUBLE_EQ(static_cast<double>(second.size()), \
+                     registry.gauge("hodm_frame_detections", "").get());
+    ASSERT_EQ(2u, registry.histogram("hodm_stage_duration_seconds", "", \
+                  {}, {{"stage", "forward"}}).count());
+    std::string text = registry.render();
+    ASSERT_NE(std::string::npos, \
+              text.find("hodm_video_writer_queue_depth 0\n"));
+    ASSERT_NE(std::string::npos, \
+              text.find("hodm_frames_dropped_total{reason=\"display\"} 0\n"));
+  }
+  /* The samplers of the module go away with it */
+  ASSERT_EQ(std::string::npos, \
+            registry.render().find("hodm_video_writer_queue_depth"));
+}
+
+/**
+ * @brief Test that a higher confidence threshold keeps fewer detections,
+ *        and that the untransformed detections of the frame are kept
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestConfidenceThreshold) {
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  RunOptions options;
+  options.confidenceThreshold = 0.5f;
+  DetectionModule permissive;
+  permissive.setOptions(options);
+  std::vector<Detection> many = permissive.detect(testImage, 1);
+  ASSERT_EQ(many.size(), permissive.getFrameDetections().size());
+  for (const auto& detection : permissive.getFrameDetections()) {
+    ASSERT_GT(detection.score, 0.5f);
+    ASSERT_LE(detection.x2, options.inputSize);
+    ASSERT_LE(detection.y2, options.inputSize);
+  }
+
+  options.confidenceThreshold = 0.99f;
+  DetectionModule strict;
+  strict.setOptions(options);
+  std::vector<Detection> few = strict.detect(testImage, 1);
+  ASSERT_LE(few.size(), many.size());
+  for (const auto& detection : strict.getFrameDetections()) {
+    ASSERT_GT(detection.score, 0.99f);
+  }
+}
+
+/**
+ * @brief Test that a YUV frame gives the detections of the same frame
+ *        converted to BGR first
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestDetectYuv) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::resize(testImage, testImage, cv::Size(640, 480));
+  cv::Mat i420;
+  cv::cvtColor(testImage, i420, cv::COLOR_BGR2YUV_I420);
+  cv::Mat bgr;
+  cv::cvtColor(i420, bgr, cv::COLOR_YUV2BGR_I420);
+
+  YuvImage image;
+  image.layout = YuvImage::kI420;
+  image.data = i420.data;
+  image.width = 640;
+  image.height = 480;
+  std::vector<Detection> expected = dm.detect(bgr, 3);
+  std::vector<Detection> detections = dm.detectYuv(image, 3);
+
+  ASSERT_EQ(expected.size(), detections.size());
+  for (size_t i = 0; i < detections.size(); ++i) {
+    ASSERT_EQ(3, detections[i].frameID);
+    ASSERT_NEAR(expected[i].x1, detections[i].x1, 4);
+    ASSERT_NEAR(expected[i].y1, detections[i].y1, 4);
+    ASSERT_NEAR(expected[i].x2, detections[i].x2, 4);
+    ASSERT_NEAR(expected[i].y2, detections[i].y2, 4);
+  }
+  ASSERT_TRUE(dm.takeDetections().empty());
+
+  /* The planes get the filter of the options, as the BGR frames do */
+  for (char filterType : {'M', 'B', 'N'}) {
+    RunOptions options;
+    options.filterType = filterType;
+    dm.setOptions(options);
+    expected = dm.detect(bgr, 5);
+    detections = dm.detectYuv(image, 5);
+    ASSERT_EQ(expected.size(), detections.size()) << filterType;
+    for (size_t i = 0; i < detections.size(); ++i) {
+      ASSERT_NEAR(expected[i].x1, detections[i].x1, 4) << filterType;
+      ASSERT_NEAR(expected[i].y2, detections[i].y2, 4) << filterType;
+    }
+  }
+
+  image.height = 479;
+  ASSERT_TRUE(dm.detectYuv(image, 4).empty());
+}
+
+/**
+ * @brief Test that a zone covering the frame gives the detections of the
+ *        whole frame, and a zone outside of it none
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestDetectZones) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  std::vector<Detection> expected = dm.detect(testImage, 2);
+
+  RunOptions options;
+  options.zones.addRectangle(cv::Rect(0, 0, testImage.cols, testImage.rows));
+  dm.setOptions(options);
+  std::vector<Detection> detections = dm.detect(testImage, 2);
+  ASSERT_EQ(expected.size(), detections.size());
+  for (size_t i = 0; i < detections.size(); ++i) {
+    ASSERT_NEAR(expected[i].x1, detections[i].x1, 2);
+    ASSERT_NEAR(expected[i].y1, detections[i].y1, 2);
+    ASSERT_NEAR(expected[i].x2, detections[i].x2, 2);
+    ASSERT_NEAR(expected[i].y2, detections[i].y2, 2);
+  }
+  cv::Mat output = dm.processFrame(testImage, 3);
+  ASSERT_EQ(416, output.cols);
+  ASSERT_EQ(416, output.rows);
+
+  RunOptions outside;
+  outside.zones.addRectangle(cv::Rect(-100, -100, 50, 50));
+  dm.setOptions(outside);
+  ASSERT_TRUE(dm.detect(testImage, 4).empty());
+}
+
+/**
+ * @brief Test that a batch gives every image the detections it gets alone
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestDetectBatch) {
+  DetectionModule dm;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::Mat blank = cv::Mat::zeros(testImage.size(), testImage.type());
+  std::vector<Detection> expected = dm.detect(testImage, 1);
+
+  std::vector<std::vector<Detection>> detections;
+  dm.detectBatch({testImage, blank, testImage}, {1, 2, 3}, detections);
+
+  ASSERT_EQ(3u, detections.size());
+  ASSERT_EQ(expected.size(), detections[0].size());
+  ASSERT_EQ(expected.size(), detections[2].size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(expected[i].x1, detections[0][i].x1, 1);
+    ASSERT_NEAR(expected[i].y2, detections[0][i].y2, 1);
+    ASSERT_EQ(3, detections[2][i].frameID);
+  }
+  ASSERT_TRUE(dm.takeDetections().empty());
+}
+
+/**
+ * @brief Test the detection of the frames of a Y4M stream, written to a
+ *        file the way ffmpeg writes it to a pipe
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestProcessStream) {
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::resize(testImage, testImage, cv::Size(320, 240));
+  cv::Mat yuv;
+  cv::cvtColor(testImage, yuv, cv::COLOR_BGR2YUV_I420);
+  std::string path = "../test/testResults/stream.y4m";
+  {
+    std::ofstream stream(path, std::ios::binary);
+    stream << "YUV4MPEG2 W320 H240 F25:1 Ip C420jpeg\n";
+    for (int i = 0; i < 2; ++i) {
+      stream << "FRAME\n";
+      stream.write(reinterpret_cast<const char*>(yuv.data), \
+                   yuv.total() * yuv.elemSize());
+    }
+  }
+  DetectionModule dm;
+  testing::internal::CaptureStdout();
+  bool processed = dm.processStream(path);
+  std::string output = testing::internal::GetCapturedStdout();
+  std::remove(path.c_str());
+
+  ASSERT_TRUE(processed);
+  std::istringstream lines(output);
+  std::string line;
+  ASSERT_TRUE(std::getline(lines, line));
+  ASSERT_EQ(0u, line.find("{\"frame\":0,\"detections\":["));
+  ASSERT_TRUE(std::getline(lines, line));
+  ASSERT_EQ(0u, line.find("{\"frame\":1,"));
+  ASSERT_FALSE(std::getline(lines, line));
+  ASSERT_FALSE(dm.processStream("../test/testResults/missing.y4m"));
+}
+
+/**
+ * @brief Test the detection of raw NV12 and YUYV streams, the frames of an
+ *        odd size being converted to BGR first
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestProcessRawYuvStream) {
+  for (const char* format : {"nv12", "yuyv422", "yuv420p"}) {
+    for (int size : {320, 321}) {
+      RunOptions options;
+      options.headless = true;
+      options.rawFormat = format;
+      options.rawWidth = size;
+      options.rawHeight = size - 79;
+      ASSERT_EQ(2, processRawStream(options)) << format << " " << size;
+    }
+  }
+}
+
+/**
+ * @brief Test that zones are detected on NV12 and YUYV streams, whose
+ *        frames are then converted to BGR
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(DetectionModuleTest, TestProcessRawYuvStreamZones) {
+  for (const char* format : {"nv12", "yuyv422"}) {
+    RunOptions options;
+    options.headless = true;
+    options.rawFormat = format;
+    options.rawWidth = 320;
+    options.rawHeight = 240;
+    options.zones.addRectangle(cv::Rect(0, 0, 160, 240));
+    ASSERT_EQ(2, processRawStream(options)) << format;
+  }
+}
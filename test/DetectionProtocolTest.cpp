@@ -0,0 +1,139 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionProtocolTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for the protocol of the detection server
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../include/DetectionProtocol.hpp"
+
+namespace {
+/**
+ * @brief Pair of connected sockets closed at the end of a test
+ */
+struct SocketPair {
+  int fds[2] = {-1, -1};
+  SocketPair() {
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  }
+  ~SocketPair() {
+    close(fds[0]);
+    close(fds[1]);
+  }
+};
+}  // namespace
+
+/**
+ * @brief Test a request going through a socket unchanged
+ */
+TEST(DetectionProtocol, TestRequestRoundTrip) {
+  SocketPair sockets;
+  ASSERT_GE(sockets.fds[0], 0);
+  std::vector<unsigned char> pixels(4 * 2 * 3);
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<unsigned char>(i);
+  }
+  protocol::RequestHeader sent;
+  sent.type = protocol::kRawBgrFrame;
+  sent.requestID = 42;
+  sent.width = 4;
+  sent.height = 2;
+  sent.payloadSize = static_cast<uint32_t>(pixels.size());
+  ASSERT_TRUE(protocol::writeRequest(sockets.fds[0], sent, pixels.data()));
+
+  protocol::RequestHeader received;
+  std::vector<unsigned char> payload;
+  bool valid = false;
+  ASSERT_TRUE(protocol::readRequest(sockets.fds[1], received, payload, \
+                                    valid));
+  ASSERT_TRUE(valid);
+  ASSERT_EQ(protocol::kRawBgrFrame, received.type);
+  ASSERT_EQ(42u, received.requestID);
+  ASSERT_EQ(4u, received.width);
+  ASSERT_EQ(2u, received.height);
+  ASSERT_EQ(pixels, payload);
+}
+
+/**
+ * @brief Test a response going through a socket unchanged
+ */
+TEST(DetectionProtocol, TestResponseRoundTrip) {
+  SocketPair sockets;
+  ASSERT_GE(sockets.fds[0], 0);
+  std::vector<Detection> detections(2);
+  detections[0] = {3, 10, 20, 30, 40, 0.75f, 0, -1};
+  detections[1] = {3, 50, 60, 70, 80, 0.5f, 0, 7};
+  protocol::ResponseHeader sent;
+  sent.requestID = 9;
+  sent.count = 2;
+  ASSERT_TRUE(protocol::writeResponse(sockets.fds[0], sent, detections));
+
+  protocol::ResponseHeader received;
+  std::vector<Detection> decoded;
+  ASSERT_TRUE(protocol::readResponse(sockets.fds[1], received, decoded));
+  ASSERT_EQ(protocol::kOk, received.status);
+  ASSERT_EQ(9u, received.requestID);
+  ASSERT_EQ(2u, decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    ASSERT_EQ(detections[i].frameID, decoded[i].frameID);
+    ASSERT_EQ(detections[i].x1, decoded[i].x1);
+    ASSERT_EQ(detections[i].y2, decoded[i].y2);
+    ASSERT_FLOAT_EQ(detections[i].score, decoded[i].score);
+    ASSERT_EQ(detections[i].trackID, decoded[i].trackID);
+  }
+}
+
+/**
+ * @brief Test the rejection of a header which isn't of the protocol
+ */
+TEST(DetectionProtocol, TestRejectBadHeader) {
+  SocketPair sockets;
+  ASSERT_GE(sockets.fds[0], 0);
+  unsigned char garbage[protocol::kRequestHeaderSize] = {'G', 'E', 'T'};
+  ASSERT_TRUE(protocol::writeExact(sockets.fds[0], garbage, \
+                                   sizeof(garbage)));
+  protocol::RequestHeader header;
+  std::vector<unsigned char> payload;
+  bool valid = true;
+  ASSERT_FALSE(protocol::readRequest(sockets.fds[1], header, payload, \
+                                     valid));
+  ASSERT_FALSE(valid);
+
+  /* A closed connection is not an invalid request */
+  close(sockets.fds[0]);
+  sockets.fds[0] = -1;
+  valid = true;
+  ASSERT_FALSE(protocol::readRequest(sockets.fds[1], header, payload, \
+                                     valid));
+  ASSERT_TRUE(valid);
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      DetectionServerTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for DetectionServer and DetectionClient
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/DetectionClient.hpp"
+#include "../include/DetectionServer.hpp"
+
+namespace {
+/**
+ * @brief Path of a socket unique to the test process
+ */
+std::string socketPath() {
+  return "/tmp/hodm-test-" + std::to_string(getpid()) + ".sock";
+}
+
+/**
+ * @brief Handler returning one detection covering the frame, so that the
+ *        tests don't need a network
+ */
+DetectionServer::RequestHandler fakeHandler() {
+  return [](const protocol::RequestHeader& header, \
+            const std::vector<unsigned char>& payload, \
+            std::vector<Detection>& detections) -> uint16_t {
+    if (header.type != protocol::kRawBgrFrame || \
+        payload.size() != header.width * header.height * 3) {
+      return protocol::kBadRequest;
+    }
+    Detection detection = {0, 0, 0, static_cast<int32_t>(header.width), \
+                           static_cast<int32_t>(header.height), \
+                           payload[0] / 255.0f, 0, -1};
+    detections.push_back(detection);
+    return protocol::kOk;
+  };
+}
+}  // namespace
+
+/**
+ * @brief Test a request answered by the server
+ */
+TEST(DetectionServer, TestRequest) {
+  DetectionServer server(fakeHandler, 1);
+  ASSERT_TRUE(server.start(socketPath()));
+  ASSERT_TRUE(server.isRunning());
+
+  DetectionClient client;
+  ASSERT_TRUE(client.connect(socketPath()));
+  std::vector<unsigned char> pixels(8 * 4 * 3, 255);
+  std::vector<Detection> detections;
+  ASSERT_EQ(protocol::kOk, client.detectRaw(pixels.data(), 8, 4, \
+                                            detections));
+  ASSERT_EQ(1u, detections.size());
+  ASSERT_EQ(8, detections[0].x2);
+  ASSERT_EQ(4, detections[0].y2);
+  ASSERT_FLOAT_EQ(1.0f, detections[0].score);
+
+  /* Errors of the handler are returned without closing the connection */
+  ASSERT_EQ(protocol::kBadRequest, client.detectEncoded(pixels.data(), \
+                                     pixels.size(), detections));
+  ASSERT_TRUE(detections.empty());
+  ASSERT_EQ(protocol::kOk, client.detectRaw(pixels.data(), 8, 4, \
+                                            detections));
+  client.disconnect();
+
+  server.stop();
+  ASSERT_FALSE(server.isRunning());
+  ASSERT_NE(0, access(socketPath().c_str(), F_OK));
+  ServerStats stats = server.getStats();
+  ASSERT_EQ(1u, stats.connections);
+  ASSERT_EQ(3u, stats.requests);
+  ASSERT_EQ(1u, stats.failedRequests);
+}
+
+/**
+ * @brief Test several clients served at the same time
+ */
+TEST(DetectionServer, TestConcurrentClients) {
+  const int workers = 3;
+  const int requests = 50;
+  DetectionServer server(fakeHandler, workers);
+  ASSERT_TRUE(server.start(socketPath()));
+
+  std::atomic<int> answered(0);
+  std::vector<std::thread> clients;
+  for (int c = 0; c < workers; ++c) {
+    clients.push_back(std::thread([&answered]() {
+      DetectionClient client;
+      if (!client.connect(socketPath())) {
+        return;
+      }
+      std::vector<unsigned char> pixels(16 * 16 * 3, 128);
+      std::vector<Detection> detections;
+      for (int i = 0; i < requests; ++i) {
+        if (client.detectRaw(pixels.data(), 16, 16, detections) == \
+            protocol::kOk && detections.size() == 1) {
+          answered += 1;
+        }
+      }
+    }));
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  server.stop();
+  ASSERT_EQ(workers * requests, answered.load());
+  ASSERT_EQ(static_cast<uint64_t>(workers), server.getStats().connections);
+}
+
+/**
+ * @brief Test a connection sending something else than the protocol
+ */
+TEST(DetectionServer, TestBadClient) {
+  DetectionServer server(fakeHandler, 1);
+  ASSERT_TRUE(server.start(socketPath()));
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socketPath().c_str(), \
+               sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, connect(fd, reinterpret_cast<sockaddr*>(&address), \
+                       sizeof(address)));
+  unsigned char garbage[protocol::kRequestHeaderSize] = {'G', 'E', 'T'};
+  ASSERT_TRUE(protocol::writeExact(fd, garbage, sizeof(garbage)));
+  /* The server answers with an error and closes the connection */
+  protocol::ResponseHeader response;
+  std::vector<Detection> detections;
+  ASSERT_TRUE(protocol::readResponse(fd, response, detections));
+  ASSERT_EQ(protocol::kBadRequest, response.status);
+  char byte;
+  ASSERT_EQ(0, read(fd, &byte, 1));
+  close(fd);
+
+  /* The worker is free again for a well behaved client */
+  DetectionClient client;
+  ASSERT_TRUE(client.connect(socketPath()));
+  std::vector<unsigned char> pixels(2 * 2 * 3, 0);
+  ASSERT_EQ(protocol::kOk, client.detectRaw(pixels.data(), 2, 2, \
+                                            detections));
+  server.stop();
+}
+
+/**
+ * @brief Test the client without a server
+ */
+TEST(DetectionServer, TestClientWithoutServer) {
+  DetectionClient client;
+  ASSERT_FALSE(client.connect("/tmp/hodm-missing.sock"));
+  std::vector<Detection> detections;
+  unsigned char pixel[3] = {0, 0, 0};
+  ASSERT_EQ(protocol::kServerError, client.detectRaw(pixel, 1, 1, \
+                                                     detections));
+}
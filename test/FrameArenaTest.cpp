@@ -0,0 +1,88 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      FrameArenaTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for FrameArena class
+ */
+
+#include <gtest/gtest.h>
+
+#include "../include/FrameArena.hpp"
+
+/**
+ * @brief Test to check that image slots are only allocated when needed
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(FrameArenaTest, TestMatReuse) {
+  FrameArena arena;
+  cv::Size size(416, 416);
+
+  cv::Mat& image = arena.mat(FrameArena::kResizedImage, size, CV_8UC3);
+  const uchar* data = image.data;
+  ASSERT_EQ(416, image.cols);
+  ASSERT_EQ(416, image.rows);
+  ASSERT_EQ(1u, arena.matAllocations());
+
+  for (int i = 0; i < 5; ++i) {
+    cv::Mat& sameImage = arena.mat(FrameArena::kResizedImage, size, CV_8UC3);
+    ASSERT_EQ(data, sameImage.data);
+  }
+  ASSERT_EQ(1u, arena.matAllocations());
+
+  arena.mat(FrameArena::kResizedImage, cv::Size(640, 480), CV_8UC3);
+  ASSERT_EQ(2u, arena.matAllocations());
+  arena.mat(FrameArena::kFilteredImage, size, CV_8UC3);
+  ASSERT_EQ(3u, arena.matAllocations());
+}
+
+/**
+ * @brief Test to check that clearing keeps the capacity of the vectors
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(FrameArenaTest, TestClearKeepsCapacity) {
+  FrameArena arena;
+  arena.reserve(100);
+  arena.predictedBoxes().push_back(cv::Rect(0, 0, 10, 10));
+  arena.confidenceScores().push_back(0.95f);
+  arena.classIds().push_back(0);
+  arena.detections().push_back(Detection());
+
+  arena.clear();
+
+  ASSERT_TRUE(arena.predictedBoxes().empty());
+  ASSERT_TRUE(arena.confidenceScores().empty());
+  ASSERT_TRUE(arena.classIds().empty());
+  ASSERT_TRUE(arena.detections().empty());
+  ASSERT_LE(100u, arena.predictedBoxes().capacity());
+  ASSERT_LE(100u, arena.detections().capacity());
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRendererTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for FrameRenderer class
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../include/FrameRenderer.hpp"
+
+namespace {
+/**
+ * @brief Window standing in for cv::imshow, waits like cv::waitKey
+ */
+struct FakeWindow {
+  std::mutex mutex;
+  std::vector<cv::Mat> shown;
+  int key = -1;
+
+  int show(const cv::Mat& image, int waitMs) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!image.empty()) {
+        shown.push_back(image.clone());
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+    return key;
+  }
+
+  size_t shownCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return shown.size();
+  }
+};
+
+/**
+ * @brief Waits up to two seconds for a condition to hold
+ */
+template <typename Condition>
+bool waitFor(Condition condition) {
+  for (int i = 0; i < 200 && !condition(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return condition();
+}
+}  // namespace
+
+/**
+ * @brief Test that the frames are shown with the detections drawn, while
+ *        the submitted frame is left as it is
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(FrameRendererTest, TestShowsDrawnFrame) {
+  FakeWindow window;
+  FrameRenderer renderer([&window](const cv::Mat& image, int waitMs) {
+    return window.show(image, waitMs);
+  });
+  cv::Mat frame = cv::Mat::zeros(48, 64, CV_8UC3);
+  Detection detection;
+  detection.x1 = 10;
+  detection.y1 = 10;
+  detection.x2 = 30;
+  detection.y2 = 30;
+
+  /* Nothing is taken before the renderer starts */
+  renderer.submit(frame, {detection}, {});
+  ASSERT_EQ(0u, renderer.getStats().framesSubmitted);
+
+  renderer.start(100);
+  ASSERT_TRUE(renderer.isRunning());
+  renderer.submit(frame, {detection}, {});
+  ASSERT_TRUE(waitFor([&window] { return window.shownCount() == 1; }));
+  renderer.stop();
+  ASSERT_FALSE(renderer.isRunning());
+
+  ASSERT_EQ(0, cv::countNonZero(frame.reshape(1)));
+  cv::Vec3b edge = window.shown[0].at<cv::Vec3b>(20, 10);
+  ASSERT_EQ(cv::Vec3b(0, 170, 50), edge);
+  RendererStats stats = renderer.getStats();
+  ASSERT_EQ(1u, stats.framesSubmitted);
+  ASSERT_EQ(1u, stats.framesShown);
+  ASSERT_FALSE(renderer.closeRequested());
+}
+
+/**
+ * @brief Test that frames submitted faster than the display rate replace
+ *        each other instead of holding back the caller
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(FrameRendererTest, TestDisplayRate) {
+  FakeWindow window;
+  FrameRenderer renderer([&window](const cv::Mat& image, int waitMs) {
+    return window.show(image, waitMs);
+  });
+  cv::Mat frame = cv::Mat::zeros(48, 64, CV_8UC3);
+  renderer.start(10);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 60; ++i) {
+    renderer.submit(frame, {}, {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  double elapsedMs = std::chrono::duration<double, std::milli>(\
+      std::chrono::steady_clock::now() - start).count();
+  renderer.stop();
+
+  /* About 300 ms at 10 frames per second */
+  RendererStats stats = renderer.getStats();
+  ASSERT_EQ(60u, stats.framesSubmitted);
+  ASSERT_GE(stats.framesShown, 1u);
+  ASSERT_LE(stats.framesShown, static_cast<uint64_t>(elapsedMs / 100 + 2));
+  ASSERT_GT(stats.framesSkipped, 40u);
+}
+
+/**
+ * @brief Test that pressing escape in the window is reported
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(FrameRendererTest, TestEscape) {
+  FakeWindow window;
+  window.key = 27;
+  FrameRenderer renderer([&window](const cv::Mat& image, int waitMs) {
+    return window.show(image, waitMs);
+  });
+  renderer.start(50);
+  renderer.submit(cv::Mat::zeros(48, 64, CV_8UC3), {}, {});
+  ASSERT_TRUE(waitFor([&renderer] { return renderer.closeRequested(); }));
+}
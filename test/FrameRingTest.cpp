@@ -0,0 +1,212 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameRingTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for FrameRing class
+ */
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "../include/FrameRing.hpp"
+
+namespace {
+/**
+ * @brief Name of a ring unique to the test process
+ */
+std::string ringName() {
+  return "/hodm-test-" + std::to_string(getpid());
+}
+
+/**
+ * @brief Writes a frame whose pixels all have the value of its ID
+ */
+void writeFrame(FrameRing& ring, int frameID) {
+  std::vector<unsigned char> pixels(ring.frameSize(), \
+                                    static_cast<unsigned char>(frameID));
+  ASSERT_TRUE(ring.write(pixels.data(), ring.width() * 3, frameID));
+}
+}  // namespace
+
+/**
+ * @brief Test frames read in order with their content
+ */
+TEST(FrameRing, TestWriteRead) {
+  FrameRing writer;
+  ASSERT_TRUE(writer.create(ringName(), 4, 8, 6));
+  FrameRing reader;
+  ASSERT_TRUE(reader.open(ringName()));
+  ASSERT_EQ(8, reader.width());
+  ASSERT_EQ(6, reader.height());
+  ASSERT_EQ(4u, reader.slotCount());
+
+  for (int i = 1; i <= 3; ++i) {
+    writeFrame(writer, i);
+  }
+  RingFrame frame;
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_EQ(FrameRing::kFrame, reader.acquire(frame, 100));
+    ASSERT_EQ(i, frame.frameID);
+    ASSERT_EQ(8, frame.width);
+    ASSERT_EQ(24u, frame.step);
+    ASSERT_EQ(i, frame.pixels[0]);
+    ASSERT_EQ(i, frame.pixels[frame.step * 6 - 1]);
+    ASSERT_TRUE(reader.release(frame));
+  }
+  ASSERT_EQ(FrameRing::kTimeout, reader.acquire(frame, 10));
+  ASSERT_EQ(0u, reader.droppedFrames());
+}
+
+/**
+ * @brief Test that frames are read in place and a frame overwritten while
+ *        in use is reported
+ */
+TEST(FrameRing, TestInPlaceAndOverwrite) {
+  FrameRing writer;
+  ASSERT_TRUE(writer.create(ringName(), 2, 4, 4));
+  FrameRing reader;
+  ASSERT_TRUE(reader.open(ringName()));
+
+  unsigned char* slot = writer.beginWrite();
+  ASSERT_NE(nullptr, slot);
+  slot[0] = 42;
+  writer.commitWrite(0);
+  RingFrame frame;
+  ASSERT_EQ(FrameRing::kFrame, reader.acquire(frame, 100));
+  ASSERT_EQ(42, frame.pixels[0]);
+
+  /* Two more frames wrap around onto the slot being read */
+  writeFrame(writer, 1);
+  writeFrame(writer, 2);
+  ASSERT_FALSE(reader.release(frame));
+  ASSERT_EQ(2, frame.pixels[0]);
+}
+
+/**
+ * @brief Test a reader falling behind by more than the ring
+ */
+TEST(FrameRing, TestReaderBehind) {
+  FrameRing writer;
+  ASSERT_TRUE(writer.create(ringName(), 4, 4, 4));
+  FrameRing reader;
+  ASSERT_TRUE(reader.open(ringName()));
+  for (int i = 0; i < 10; ++i) {
+    writeFrame(writer, i);
+  }
+  RingFrame frame;
+  ASSERT_EQ(FrameRing::kFrame, reader.acquire(frame, 100));
+  ASSERT_EQ(9, frame.frameID);
+  ASSERT_TRUE(reader.release(frame));
+  ASSERT_EQ(9u, reader.droppedFrames());
+}
+
+/**
+ * @brief Test the end of the stream when the writer closes the ring
+ */
+TEST(FrameRing, TestClose) {
+  FrameRing writer;
+  ASSERT_TRUE(writer.create(ringName(), 4, 4, 4));
+  FrameRing reader;
+  ASSERT_TRUE(reader.open(ringName()));
+  ASSERT_TRUE(reader.writerAlive());
+  writeFrame(writer, 0);
+  writer.close();
+
+  /* The mapping of the reader stays valid after the object is removed */
+  RingFrame frame;
+  ASSERT_EQ(FrameRing::kFrame, reader.acquire(frame, 100));
+  ASSERT_EQ(FrameRing::kClosed, reader.acquire(frame, 100));
+  FrameRing late;
+  ASSERT_FALSE(late.open(ringName()));
+}
+
+/**
+ * @brief Test invalid rings
+ */
+TEST(FrameRing, TestInvalid) {
+  FrameRing ring;
+  ASSERT_FALSE(ring.create(ringName(), 1, 4, 4));
+  ASSERT_FALSE(ring.create(ringName(), 4, 0, 4));
+  ASSERT_FALSE(ring.open("/hodm-missing-ring"));
+  ASSERT_EQ(nullptr, ring.beginWrite());
+  RingFrame frame;
+  ASSERT_EQ(FrameRing::kClosed, ring.acquire(frame, 10));
+}
+
+/**
+ * @brief Test frames going from one process to another
+ */
+TEST(FrameRing, TestOtherProcess) {
+  /* The name holds the pid of the parent */
+  std::string name = ringName();
+  FrameRing writer;
+  ASSERT_TRUE(writer.create(name, 8, 16, 16));
+  int opened[2];
+  ASSERT_EQ(0, pipe(opened));
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    /* Reader process, exits with 0 if every frame read is intact */
+    FrameRing reader;
+    char ready = reader.open(name) ? 1 : 0;
+    if (::write(opened[1], &ready, 1) != 1 || ready == 0) {
+      _exit(2);
+    }
+    RingFrame frame;
+    int frames = 0;
+    while (reader.acquire(frame, 2000) == FrameRing::kFrame) {
+      bool intact = frame.pixels[0] == frame.frameID % 256 && \
+          frame.pixels[frame.step * frame.height - 1] == frame.frameID % 256;
+      if (reader.release(frame)) {
+        if (!intact) {
+          _exit(3);
+        }
+        frames += 1;
+      }
+    }
+    _exit(frames > 0 ? 0 : 4);
+  }
+  /* Frames are written once the reader has the ring open */
+  char ready = 0;
+  ASSERT_EQ(1, read(opened[0], &ready, 1));
+  ASSERT_EQ(1, ready);
+  close(opened[0]);
+  close(opened[1]);
+  for (int i = 0; i < 100; ++i) {
+    writeFrame(writer, i);
+    usleep(500);
+  }
+  writer.close();
+  int status = 0;
+  ASSERT_EQ(child, waitpid(child, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+}
@@ -0,0 +1,247 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      FrameStreamReaderTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for FrameStreamReader class
+ */
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/FrameStreamReader.hpp"
+
+namespace {
+/**
+ * @brief Writes a stream into a pipe on another thread, as a producer
+ *        process would, and closes it
+ */
+class PipeWriter {
+ public:
+  explicit PipeWriter(const std::string& content) {
+    int fds[2] = {-1, -1};
+    if (pipe(fds) == 0) {
+      readFd = fds[0];
+      writer = std::thread([content, fds]() {
+        size_t written = 0;
+        while (written < content.size()) {
+          ssize_t count = write(fds[1], content.data() + written, \
+                                content.size() - written);
+          if (count <= 0) {
+            break;
+          }
+          written += static_cast<size_t>(count);
+        }
+        close(fds[1]);
+      });
+    }
+  }
+  ~PipeWriter() {
+    if (writer.joinable()) {
+      writer.join();
+    }
+    close(readFd);
+  }
+  int readFd = -1;
+
+ private:
+  std::thread writer;
+};
+
+/**
+ * @brief Frame of size bytes all equal to value
+ */
+std::string frameBytes(size_t size, char value) {
+  return std::string(size, value);
+}
+}  // namespace
+
+/**
+ * @brief Test the reading of a Y4M stream
+ */
+TEST(FrameStreamReader, TestY4m) {
+  size_t size = FrameStreamReader::frameSize(FrameStreamReader::kYuv420p, \
+                                             4, 2);
+  ASSERT_EQ(12u, size);
+  PipeWriter pipe("YUV4MPEG2 W4 H2 F30000:1001 Ip A1:1 C420jpeg XYSCSS=420\n"
+                  "FRAME\n" + frameBytes(size, 1) + \
+                  "FRAME Ixyz\n" + frameBytes(size, 2));
+  FrameStreamReader reader;
+  ASSERT_TRUE(reader.openDescriptor(pipe.readFd, \
+                                    FrameStreamReader::kUnknown, 0, 0));
+  ASSERT_EQ(FrameStreamReader::kYuv420p, reader.getFormat());
+  ASSERT_EQ(4, reader.getWidth());
+  ASSERT_EQ(2, reader.getHeight());
+  ASSERT_NEAR(29.97, reader.getFps(), 0.01);
+
+  std::vector<unsigned char> frame;
+  ASSERT_TRUE(reader.readFrame(frame));
+  ASSERT_EQ(size, frame.size());
+  ASSERT_EQ(1, frame[0]);
+  ASSERT_TRUE(reader.readFrame(frame));
+  ASSERT_EQ(2, frame[size - 1]);
+  ASSERT_FALSE(reader.readFrame(frame));
+  ASSERT_FALSE(reader.isTruncated());
+}
+
+/**
+ * @brief Test that the 8 bit 4:2:0 colourspaces are read and the more than
+ *        8 bit ones refused
+ */
+TEST(FrameStreamReader, TestY4mColourspaces) {
+  for (const char* colourspace : {"C420", "C420jpeg", "C420mpeg2", \
+                                  "C420paldv"}) {
+    PipeWriter pipe(std::string("YUV4MPEG2 W4 H2 ") + colourspace + "\n");
+    FrameStreamReader reader;
+    ASSERT_TRUE(reader.openDescriptor(pipe.readFd, \
+                                      FrameStreamReader::kUnknown, 0, 0));
+    ASSERT_EQ(FrameStreamReader::kYuv420p, reader.getFormat());
+    ASSERT_TRUE(reader.getError().empty());
+  }
+  for (const char* colourspace : {"C420p10", "C420p12", "C420p16", \
+                                  "C444"}) {
+    PipeWriter pipe(std::string("YUV4MPEG2 W4 H2 ") + colourspace + "\n" + \
+                    "FRAME\n" + frameBytes(24, 1));
+    FrameStreamReader reader;
+    ASSERT_FALSE(reader.openDescriptor(pipe.readFd, \
+                                       FrameStreamReader::kUnknown, 0, 0));
+    ASSERT_NE(std::string::npos, reader.getError().find(colourspace));
+  }
+}
+
+/**
+ * @brief Test raw frames larger than the read ahead buffer, with the last
+ *        frame cut
+ */
+TEST(FrameStreamReader, TestRawFrames) {
+  size_t size = FrameStreamReader::frameSize(FrameStreamReader::kBgr24, \
+                                             160, 160);
+  ASSERT_GT(size, 64u * 1024);
+  PipeWriter pipe(frameBytes(size, 7) + frameBytes(size, 8) + \
+                  frameBytes(size / 2, 9));
+  FrameStreamReader reader;
+  ASSERT_TRUE(reader.openDescriptor(pipe.readFd, \
+                                    FrameStreamReader::kBgr24, 160, 160));
+  std::vector<unsigned char> frame;
+  ASSERT_TRUE(reader.readFrame(frame));
+  ASSERT_EQ(size, frame.size());
+  ASSERT_EQ(7, frame[size - 1]);
+  ASSERT_TRUE(reader.readFrame(frame));
+  ASSERT_EQ(8, frame[0]);
+  ASSERT_FALSE(reader.readFrame(frame));
+  ASSERT_TRUE(reader.isTruncated());
+}
+
+/**
+ * @brief Test a grayscale Y4M stream read from a FIFO
+ */
+TEST(FrameStreamReader, TestFifo) {
+  std::string path = "/tmp/hodm-test-" + std::to_string(getpid()) + \
+                     ".fifo";
+  unlink(path.c_str());
+  ASSERT_EQ(0, mkfifo(path.c_str(), 0600));
+  std::thread producer([path]() {
+    int fd = open(path.c_str(), O_WRONLY);
+    std::string content = "YUV4MPEG2 W2 H2 Cmono\nFRAME\nabcd";
+    if (fd >= 0) {
+      ssize_t written = write(fd, content.data(), content.size());
+      (void)written;
+      close(fd);
+    }
+  });
+  FrameStreamReader reader;
+  ASSERT_TRUE(reader.open(path, FrameStreamReader::kUnknown, 0, 0));
+  ASSERT_EQ(FrameStreamReader::kGray, reader.getFormat());
+  std::vector<unsigned char> frame;
+  ASSERT_TRUE(reader.readFrame(frame));
+  ASSERT_EQ(std::string("abcd"), std::string(frame.begin(), frame.end()));
+  ASSERT_FALSE(reader.readFrame(frame));
+  producer.join();
+  unlink(path.c_str());
+}
+
+/**
+ * @brief Test streams that can't be read
+ */
+TEST(FrameStreamReader, TestInvalidStreams) {
+  FrameStreamReader reader;
+  {
+    PipeWriter pipe("P6 4 2 255\n");
+    ASSERT_FALSE(reader.openDescriptor(pipe.readFd, \
+                                       FrameStreamReader::kUnknown, 0, 0));
+  }
+  {
+    /* 4:4:4 isn't supported */
+    PipeWriter pipe("YUV4MPEG2 W4 H2 C444\n");
+    ASSERT_FALSE(reader.openDescriptor(pipe.readFd, \
+                                       FrameStreamReader::kUnknown, 0, 0));
+  }
+  {
+    PipeWriter pipe("YUV4MPEG2 W4 H2\nGARBAGE\n");
+    ASSERT_TRUE(reader.openDescriptor(pipe.readFd, \
+                                      FrameStreamReader::kUnknown, 0, 0));
+    std::vector<unsigned char> frame;
+    ASSERT_FALSE(reader.readFrame(frame));
+    ASSERT_TRUE(reader.isTruncated());
+  }
+  ASSERT_FALSE(reader.open("/tmp/hodm-missing-stream", \
+                           FrameStreamReader::kBgr24, 4, 2));
+  ASSERT_FALSE(reader.openDescriptor(0, FrameStreamReader::kBgr24, 0, 2));
+}
+
+/**
+ * @brief Test the names and sizes of the raw formats
+ */
+TEST(FrameStreamReader, TestFormats) {
+  ASSERT_EQ(FrameStreamReader::kBgr24, \
+            FrameStreamReader::parseFormat("bgr24"));
+  ASSERT_EQ(FrameStreamReader::kYuv420p, \
+            FrameStreamReader::parseFormat("i420"));
+  ASSERT_EQ(FrameStreamReader::kGray, FrameStreamReader::parseFormat("gray"));
+  ASSERT_EQ(FrameStreamReader::kUnknown, \
+            FrameStreamReader::parseFormat("rgb48"));
+  ASSERT_EQ(640u * 480 * 3 / 2, FrameStreamReader::frameSize(\
+            FrameStreamReader::kYuv420p, 640, 480));
+  ASSERT_EQ(3u * 3 + 2 * 2 * 2, FrameStreamReader::frameSize(\
+            FrameStreamReader::kYuv420p, 3, 3));
+  ASSERT_EQ(0u, FrameStreamReader::frameSize(\
+            FrameStreamReader::kUnknown, 4, 4));
+  ASSERT_EQ(FrameStreamReader::kNv12, FrameStreamReader::parseFormat("nv12"));
+  ASSERT_EQ(FrameStreamReader::kYuyv, \
+            FrameStreamReader::parseFormat("yuyv422"));
+  ASSERT_EQ(640u * 480 * 3 / 2, FrameStreamReader::frameSize(\
+            FrameStreamReader::kNv12, 640, 480));
+  ASSERT_EQ(640u * 480 * 2, FrameStreamReader::frameSize(\
+            FrameStreamReader::kYuyv, 640, 480));
+  ASSERT_EQ(4u * 2 * 3, FrameStreamReader::frameSize(\
+            FrameStreamReader::kYuyv, 3, 3));
+}
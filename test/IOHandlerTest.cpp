@@ -31,8 +31,12 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
+#include <vector>
 
+#include "../include/DetectionDelta.hpp"
 #include "../include/IOHandler.hpp"
 
 TEST(IOHandler, TestGetInputChoice) {
@@ -85,3 +89,550 @@ TEST(IOHandler, TestGetOutputFilePath) {
 
   ASSERT_EQ("output/", io.getOutputFilePath());
 }
+
+TEST(IOHandler, TestParseArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char profile[] = "--profile";
+  char unknown[] = "--unknown";
+
+  RunOptions options1;
+  char* argv1[] = {application, profile};
+  ASSERT_TRUE(io.parseArguments(2, argv1, options1));
+  ASSERT_TRUE(options1.profile);
+  ASSERT_FALSE(options1.perfCounters);
+
+  char counters[] = "--counters";
+  RunOptions options3;
+  char* argv3[] = {application, counters};
+  ASSERT_TRUE(io.parseArguments(2, argv3, options3));
+  ASSERT_TRUE(options3.profile);
+  ASSERT_TRUE(options3.perfCounters);
+
+  RunOptions options2;
+  char* argv2[] = {application, unknown};
+  ASSERT_FALSE(io.parseArguments(2, argv2, options2));
+  ASSERT_FALSE(options2.profile);
+}
+
+TEST(IOHandler, TestParseWriterArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char encoders[] = "--encoders";
+  char writeQueue[] = "--write-queue";
+  char four[] = "4";
+  char zero[] = "0";
+
+  RunOptions options1;
+  ASSERT_EQ(0, options1.encoderThreads);
+  char* argv1[] = {application, encoders, four, writeQueue, four};
+  ASSERT_TRUE(io.parseArguments(5, argv1, options1));
+  ASSERT_EQ(4, options1.encoderThreads);
+  ASSERT_EQ(4, options1.writeQueue);
+
+  RunOptions options2;
+  char* argv2[] = {application, writeQueue, zero};
+  ASSERT_FALSE(io.parseArguments(3, argv2, options2));
+  char* argv3[] = {application, encoders};
+  ASSERT_FALSE(io.parseArguments(2, argv3, options2));
+}
+
+TEST(IOHandler, TestSaveOutput) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  Detection detection;
+  detection.frameID = 3;
+  detection.x1 = 10;
+  detection.y1 = 20;
+  detection.x2 = 110;
+  detection.y2 = 220;
+  detection.score = 0.97f;
+  std::vector<Detection> detections{detection};
+  detection.trackID = 5;
+  detections.push_back(detection);
+
+  ASSERT_TRUE(io.saveOutput(detections, "../test/testResults/"));
+  ASSERT_FALSE(io.saveOutput(detections, "../test/missingDirectory/"));
+
+  std::ifstream textFile("../test/testResults/DetectionsFile.txt");
+  std::string line1, line2;
+  ASSERT_TRUE(static_cast<bool>(std::getline(textFile, line1)));
+  ASSERT_TRUE(static_cast<bool>(std::getline(textFile, line2)));
+  ASSERT_EQ("FrameID: 3 ObjectID: 0 Box_Coordinates: 10 20 110 220 " \
+            "Score: 0.9700", line1);
+  ASSERT_EQ("FrameID: 3 ObjectID: 1 Box_Coordinates: 10 20 110 220 " \
+            "Score: 0.9700 TrackID: 5", line2);
+}
+
+TEST(IOHandler, TestSaveDeltaOutput) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  Detection detection;
+  detection.x1 = 10;
+  detection.y1 = 20;
+  detection.x2 = 110;
+  detection.y2 = 220;
+  detection.score = 0.97f;
+  std::vector<Detection> detections;
+  for (int frameID = 0; frameID < 10; ++frameID) {
+    detection.frameID = frameID;
+    detection.x1 = 10 + frameID % 2;
+    detections.push_back(detection);
+  }
+
+  ASSERT_TRUE(io.saveDeltaOutput(detections, "../test/testResults/", 300, \
+                                 2));
+  ASSERT_NE(std::string::npos, mockOutputBuffer.str().find(\
+            "1 of 10 boxes written"));
+
+  DeltaDecoder decoder;
+  ASSERT_TRUE(decoder.open("../test/testResults/DetectionsDelta.txt"));
+  ASSERT_EQ(9, decoder.getLastFrameID());
+  std::vector<Detection> decoded;
+  ASSERT_TRUE(decoder.readAll(decoded));
+  ASSERT_EQ(detections.size(), decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    ASSERT_EQ(detections[i].frameID, decoded[i].frameID);
+    ASSERT_EQ(10, decoded[i].x1);
+    ASSERT_EQ(220, decoded[i].y2);
+  }
+}
+
+TEST(IOHandler, TestParseDeltaArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char delta[] = "--delta";
+  char keyframes[] = "--delta-keyframes";
+  char tolerance[] = "--delta-tolerance";
+  char hundred[] = "100";
+  char zero[] = "0";
+
+  RunOptions options;
+  ASSERT_FALSE(options.deltaOutput);
+  ASSERT_EQ(300, options.deltaKeyframes);
+  ASSERT_EQ(2, options.deltaTolerance);
+  char* argv[] = {application, delta};
+  ASSERT_TRUE(io.parseArguments(2, argv, options));
+  ASSERT_TRUE(options.deltaOutput);
+
+  RunOptions tuned;
+  char* settings[] = {application, keyframes, hundred, tolerance, zero};
+  ASSERT_TRUE(io.parseArguments(5, settings, tuned));
+  ASSERT_TRUE(tuned.deltaOutput);
+  ASSERT_EQ(100, tuned.deltaKeyframes);
+  ASSERT_EQ(0, tuned.deltaTolerance);
+
+  char* invalid[] = {application, keyframes, zero};
+  ASSERT_FALSE(io.parseArguments(3, invalid, tuned));
+}
+
+TEST(IOHandler, TestParseModelArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char confidence[] = "--confidence";
+  char half[] = "0.5";
+  char nms[] = "--nms";
+  char overlap[] = "0.4";
+  char model[] = "--model";
+  char configuration[] = "tiny.cfg";
+  char weights[] = "tiny.weights";
+  char large[] = "1.5";
+
+  RunOptions options;
+  ASSERT_FLOAT_EQ(0.9f, options.confidenceThreshold);
+  ASSERT_FLOAT_EQ(0.9f, options.nmsThreshold);
+  ASSERT_TRUE(options.modelConfiguration.empty());
+  char* argv[] = {application, confidence, half, nms, overlap, model, \
+                  configuration, weights};
+  ASSERT_TRUE(io.parseArguments(8, argv, options));
+  ASSERT_FLOAT_EQ(0.5f, options.confidenceThreshold);
+  ASSERT_FLOAT_EQ(0.4f, options.nmsThreshold);
+  ASSERT_EQ("tiny.cfg", options.modelConfiguration);
+  ASSERT_EQ("tiny.weights", options.modelWeights);
+
+  char* invalid[] = {application, confidence, large};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+  char* incomplete[] = {application, model, configuration};
+  ASSERT_FALSE(io.parseArguments(3, incomplete, options));
+}
+
+/**
+ * @brief Test to check parsing of the metrics arguments
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(IOHandler, TestParseMetricsArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char port[] = "--metrics-port";
+  char portNumber[] = "9464";
+  char file[] = "--metrics-file";
+  char path[] = "metrics.prom";
+  char interval[] = "--metrics-interval";
+  char seconds[] = "60";
+  char tooLarge[] = "70000";
+
+  RunOptions options;
+  ASSERT_EQ(-1, options.metricsPort);
+  ASSERT_TRUE(options.metricsFile.empty());
+  ASSERT_EQ(15, options.metricsInterval);
+  char* argv[] = {application, port, portNumber, file, path, interval, \
+                  seconds};
+  ASSERT_TRUE(io.parseArguments(7, argv, options));
+  ASSERT_EQ(9464, options.metricsPort);
+  ASSERT_EQ("metrics.prom", options.metricsFile);
+  ASSERT_EQ(60, options.metricsInterval);
+
+  char* invalid[] = {application, port, tooLarge};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParsePlacementArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char capture[] = "--pin-capture";
+  char captureCpus[] = "0-1";
+  char inference[] = "--pin-inference";
+  char inferenceCpus[] = "2-5,8";
+  char output[] = "--pin-output";
+  char outputCpus[] = "6";
+  char preprocess[] = "--pin-preprocess";
+  char reversed[] = "7-6";
+
+  RunOptions options;
+  ASSERT_TRUE(options.placement.empty());
+  char* argv[] = {application, capture, captureCpus, inference, \
+                  inferenceCpus, output, outputCpus};
+  ASSERT_TRUE(io.parseArguments(7, argv, options));
+  ASSERT_EQ(std::vector<int>({0, 1}), \
+            options.placement.getCpus(kCaptureThreads));
+  ASSERT_EQ(std::vector<int>({2, 3, 4, 5, 8}), \
+            options.placement.getCpus(kInferenceThreads));
+  ASSERT_EQ(std::vector<int>({6}), options.placement.getCpus(kOutputThreads));
+  ASSERT_FALSE(options.placement.isPinned(kPreprocessThreads));
+
+  char* invalid[] = {application, preprocess, reversed};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParseDecodeArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char fullDecode[] = "--full-decode";
+  char calibration[] = "--decode-calibration";
+  char zero[] = "0";
+
+  RunOptions options;
+  ASSERT_TRUE(options.reducedDecode);
+  char* argv[] = {application, fullDecode, calibration, zero};
+  ASSERT_TRUE(io.parseArguments(4, argv, options));
+  ASSERT_FALSE(options.reducedDecode);
+  ASSERT_EQ(0, options.decodeCalibration);
+}
+
+TEST(IOHandler, TestParseServerArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char serve[] = "--serve";
+  char path[] = "/tmp/hodm.sock";
+  char workers[] = "--workers";
+  char three[] = "3";
+  char zero[] = "0";
+
+  RunOptions options;
+  ASSERT_TRUE(options.serveSocket.empty());
+  char* argv[] = {application, serve, path, workers, three};
+  ASSERT_TRUE(io.parseArguments(5, argv, options));
+  ASSERT_EQ("/tmp/hodm.sock", options.serveSocket);
+  ASSERT_EQ(3, options.serverWorkers);
+
+  char* invalid[] = {application, serve, path, workers, zero};
+  ASSERT_FALSE(io.parseArguments(5, invalid, options));
+}
+
+TEST(IOHandler, TestParseBatchArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char batch[] = "--batch";
+  char four[] = "4";
+  char wait[] = "--batch-wait";
+  char ten[] = "10";
+
+  RunOptions options;
+  ASSERT_EQ(1, options.maxBatch);
+  char* argv[] = {application, batch, four, wait, ten};
+  ASSERT_TRUE(io.parseArguments(5, argv, options));
+  ASSERT_EQ(4, options.maxBatch);
+  ASSERT_EQ(10, options.batchWaitMs);
+}
+
+TEST(IOHandler, TestParseSharedMemoryArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char shm[] = "--shm";
+  char name[] = "/hodm-frames";
+
+  RunOptions options;
+  ASSERT_TRUE(options.sharedMemoryRing.empty());
+  char* argv[] = {application, shm, name};
+  ASSERT_TRUE(io.parseArguments(3, argv, options));
+  ASSERT_EQ("/hodm-frames", options.sharedMemoryRing);
+  char* missing[] = {application, shm};
+  ASSERT_FALSE(io.parseArguments(2, missing, options));
+}
+
+TEST(IOHandler, TestParseStreamArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char stream[] = "--stream";
+  char standardInput[] = "-";
+  char format[] = "--raw-format";
+  char bgr[] = "bgr24";
+  char size[] = "--raw-size";
+  char dimensions[] = "640x480";
+  char badDimensions[] = "640x";
+
+  RunOptions options;
+  char* argv[] = {application, stream, standardInput, format, bgr, size, \
+                  dimensions};
+  ASSERT_TRUE(io.parseArguments(7, argv, options));
+  ASSERT_EQ("-", options.streamInput);
+  ASSERT_EQ("bgr24", options.rawFormat);
+  ASSERT_EQ(640, options.rawWidth);
+  ASSERT_EQ(480, options.rawHeight);
+
+  char* invalid[] = {application, size, badDimensions};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParseRoiArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char roi[] = "--roi";
+  char zonesFile[] = "ioHandlerZones.txt";
+  char missingFile[] = "ioHandlerMissingZones.txt";
+  {
+    std::ofstream zones(zonesFile);
+    zones << "# entrance\nrect 10 20 100 50\n\npolygon 0,0 50,0 25,40\n";
+  }
+
+  RunOptions options;
+  ASSERT_TRUE(options.zones.empty());
+  char* argv[] = {application, roi, zonesFile};
+  ASSERT_TRUE(io.parseArguments(3, argv, options));
+  ASSERT_EQ(2u, options.zones.getZones().size());
+
+  char* missing[] = {application, roi, missingFile};
+  ASSERT_FALSE(io.parseArguments(3, missing, options));
+  std::remove(zonesFile);
+}
+
+TEST(IOHandler, TestParseCacheArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char cache[] = "--cache";
+  char cacheFile[] = "detections.cache";
+  char cacheSize[] = "--cache-size";
+  char entries[] = "500";
+  char noEntries[] = "0";
+
+  RunOptions options;
+  ASSERT_TRUE(options.cacheFile.empty());
+  ASSERT_EQ(10000, options.cacheEntries);
+  char* argv[] = {application, cache, cacheFile, cacheSize, entries};
+  ASSERT_TRUE(io.parseArguments(5, argv, options));
+  ASSERT_EQ("detections.cache", options.cacheFile);
+  ASSERT_EQ(500, options.cacheEntries);
+
+  char* invalid[] = {application, cacheSize, noEntries};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParseTuningArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char threads[] = "--threads";
+  char four[] = "4";
+  char filter[] = "--filter";
+  char median[] = "M";
+  char unknownFilter[] = "X";
+  char inputSize[] = "--input-size";
+  char size[] = "320";
+  char badSize[] = "400";
+
+  RunOptions options;
+  ASSERT_EQ(0, options.opencvThreads);
+  ASSERT_EQ('G', options.filterType);
+  ASSERT_EQ(416, options.inputSize);
+  char* argv[] = {application, threads, four, filter, median, inputSize, \
+                  size};
+  ASSERT_TRUE(io.parseArguments(7, argv, options));
+  ASSERT_EQ(4, options.opencvThreads);
+  ASSERT_EQ('M', options.filterType);
+  ASSERT_EQ(320, options.inputSize);
+
+  char* invalidFilter[] = {application, filter, unknownFilter};
+  ASSERT_FALSE(io.parseArguments(3, invalidFilter, options));
+  char* invalidSize[] = {application, inputSize, badSize};
+  ASSERT_FALSE(io.parseArguments(3, invalidSize, options));
+}
+
+TEST(IOHandler, TestTuningProfile) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char profilePath[] = "ioHandlerTuning.conf";
+
+  RunOptions tuned;
+  tuned.opencvThreads = 2;
+  tuned.serverWorkers = 3;
+  tuned.maxBatch = 4;
+  tuned.filterType = 'B';
+  tuned.inputSize = 608;
+  ASSERT_TRUE(io.saveTuningProfile(profilePath, tuned, "measured\nhere"));
+
+  RunOptions options;
+  ASSERT_TRUE(io.loadTuningProfile(profilePath, options));
+  ASSERT_EQ(2, options.opencvThreads);
+  ASSERT_EQ(3, options.serverWorkers);
+  ASSERT_EQ(4, options.maxBatch);
+  ASSERT_EQ('B', options.filterType);
+  ASSERT_EQ(608, options.inputSize);
+
+  /* The command line overrides the profile wherever it is given */
+  char application[] = "hodm-app";
+  char batch[] = "--batch";
+  char one[] = "1";
+  char tuning[] = "--tuning";
+  char* argv[] = {application, batch, one, tuning, profilePath};
+  RunOptions overridden;
+  ASSERT_TRUE(io.parseArguments(5, argv, overridden));
+  ASSERT_EQ(1, overridden.maxBatch);
+  ASSERT_EQ(3, overridden.serverWorkers);
+
+  /* A profile can't change the mode of the application */
+  {
+    std::ofstream profile(profilePath);
+    profile << "serve=/tmp/hodm.sock\n";
+  }
+  ASSERT_FALSE(io.loadTuningProfile(profilePath, options));
+  ASSERT_FALSE(io.parseArguments(5, argv, overridden));
+  std::remove(profilePath);
+  ASSERT_FALSE(io.loadTuningProfile(profilePath, options));
+}
+
+TEST(IOHandler, TestParseRenderArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char headless[] = "--headless";
+  char displayFps[] = "--display-fps";
+  char ten[] = "10";
+  char zero[] = "0";
+
+  RunOptions options;
+  ASSERT_FALSE(options.headless);
+  ASSERT_EQ(25, options.displayFps);
+  char* argv[] = {application, headless, displayFps, ten};
+  ASSERT_TRUE(io.parseArguments(4, argv, options));
+  ASSERT_TRUE(options.headless);
+  ASSERT_EQ(10, options.displayFps);
+
+  char* invalid[] = {application, displayFps, zero};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParseStrideArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char stride[] = "--stride";
+  char five[] = "5";
+  char zero[] = "0";
+
+  RunOptions options;
+  ASSERT_EQ(1, options.frameStride);
+  char* argv[] = {application, stride, five};
+  ASSERT_TRUE(io.parseArguments(3, argv, options));
+  ASSERT_EQ(5, options.frameStride);
+
+  char* invalid[] = {application, stride, zero};
+  ASSERT_FALSE(io.parseArguments(3, invalid, options));
+}
+
+TEST(IOHandler, TestParseCheckpointArguments) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  char application[] = "hodm-app";
+  char checkpoint[] = "--checkpoint";
+  char file[] = "job.checkpoint";
+  char every[] = "--checkpoint-every";
+  char fifty[] = "50";
+  char resume[] = "--resume";
+
+  RunOptions options;
+  ASSERT_TRUE(options.checkpointFile.empty());
+  ASSERT_EQ(1000, options.checkpointInterval);
+  ASSERT_FALSE(options.resume);
+  char* argv[] = {application, checkpoint, file, every, fifty, resume};
+  ASSERT_TRUE(io.parseArguments(6, argv, options));
+  ASSERT_EQ("job.checkpoint", options.checkpointFile);
+  ASSERT_EQ(50, options.checkpointInterval);
+  ASSERT_TRUE(options.resume);
+
+  RunOptions withoutFile;
+  char* invalid[] = {application, resume};
+  ASSERT_FALSE(io.parseArguments(2, invalid, withoutFile));
+}
+
+TEST(IOHandler, TestStreamDetections) {
+  std::istringstream mockInputBuffer("");
+  std::ostringstream mockOutputBuffer;
+  IOHandler io(mockInputBuffer, mockOutputBuffer);
+  Detection tracked = {4, 1, 2, 30, 40, 0.5f, 0, 3};
+  Detection untracked = {4, 5, 6, 7, 8, 0.25f, 0, -1};
+
+  io.streamDetections(4, {tracked, untracked});
+  io.streamDetections(5, {});
+
+  ASSERT_EQ("{\"frame\":4,\"detections\":["
+            "{\"x1\":1,\"y1\":2,\"x2\":30,\"y2\":40,\"score\":0.5000,"
+            "\"track\":3},"
+            "{\"x1\":5,\"y1\":6,\"x2\":7,\"y2\":8,\"score\":0.2500}]}\n"
+            "{\"frame\":5,\"detections\":[]}\n", mockOutputBuffer.str());
+}
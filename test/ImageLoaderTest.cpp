@@ -0,0 +1,137 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      ImageLoaderTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for ImageLoader class
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../include/ImageLoader.hpp"
+
+/**
+ * @brief Test to check reading the size from the header
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ImageLoaderTest, TestReadHeader) {
+  cv::Size size;
+  ImageLoader::Format format;
+
+  ASSERT_TRUE(ImageLoader::readHeader("../test/testData/testImage.jpg", \
+                                      size, format));
+  ASSERT_EQ(ImageLoader::kJpeg, format);
+  ASSERT_EQ(1200, size.width);
+  ASSERT_EQ(1800, size.height);
+
+  std::string pngPath = "../test/testResults/imageLoaderTest.png";
+  cv::imwrite(pngPath, cv::Mat::zeros(30, 50, CV_8UC3));
+  ASSERT_TRUE(ImageLoader::readHeader(pngPath, size, format));
+  ASSERT_EQ(ImageLoader::kPng, format);
+  ASSERT_EQ(50, size.width);
+  ASSERT_EQ(30, size.height);
+
+  ASSERT_FALSE(ImageLoader::readHeader("../test/testData/testVideo.avi", \
+                                       size, format));
+  ASSERT_FALSE(ImageLoader::readHeader("../test/testData/notTestImage.jpg", \
+                                       size, format));
+}
+
+/**
+ * @brief Test to check the choice of the reduction
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ImageLoaderTest, TestReducedFactor) {
+  cv::Size target(416, 416);
+
+  ASSERT_EQ(1, ImageLoader::reducedFactor(cv::Size(640, 480), target));
+  ASSERT_EQ(2, ImageLoader::reducedFactor(cv::Size(1200, 1800), target));
+  ASSERT_EQ(4, ImageLoader::reducedFactor(cv::Size(1920, 1664), target));
+  ASSERT_EQ(2, ImageLoader::reducedFactor(cv::Size(1920, 1663), target));
+  ASSERT_EQ(8, ImageLoader::reducedFactor(cv::Size(4000, 3000), target));
+  ASSERT_EQ(1, ImageLoader::reducedFactor(cv::Size(416, 416), target));
+}
+
+/**
+ * @brief Test to check listing the images of a directory
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ImageLoaderTest, TestListImages) {
+  std::vector<std::string> imagePaths;
+  ASSERT_TRUE(ImageLoader::listImages("../test/testData", imagePaths));
+  ASSERT_EQ(2u, imagePaths.size());
+  ASSERT_EQ("../test/testData/demoScreenshot.jpg", imagePaths[0]);
+  ASSERT_EQ("../test/testData/testImage.jpg", imagePaths[1]);
+
+  std::vector<std::string> none;
+  ASSERT_FALSE(ImageLoader::listImages("../test/testData/testImage.jpg", \
+                                       none));
+  ASSERT_TRUE(none.empty());
+}
+
+/**
+ * @brief Test to check loading at a reduced resolution
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ImageLoaderTest, TestLoad) {
+  ImageLoader loader;
+  loader.setCalibrationInterval(1);
+  int factor = 0;
+
+  cv::Mat image = loader.load("../test/testData/testImage.jpg", factor);
+  ASSERT_EQ(2, factor);
+  ASSERT_EQ(600, image.cols);
+  ASSERT_EQ(900, image.rows);
+  ASSERT_EQ(1u, loader.getStats().reducedImages);
+  ASSERT_EQ(1u, loader.getStats().calibratedImages);
+  ASSERT_LE(0, loader.estimatedSavedMs());
+
+  loader.setReducedDecode(false);
+  image = loader.load("../test/testData/testImage.jpg", factor);
+  ASSERT_EQ(1, factor);
+  ASSERT_EQ(1200, image.cols);
+  ASSERT_EQ(2u, loader.getStats().images);
+  ASSERT_EQ(1u, loader.getStats().reducedImages);
+
+  image = loader.load("../test/testData/notTestImage.jpg", factor);
+  ASSERT_TRUE(image.empty());
+  ASSERT_EQ(2u, loader.getStats().images);
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      LatencyHistogramTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for LatencyHistogram class
+ */
+
+#include <gtest/gtest.h>
+
+#include <LatencyHistogram.hpp>
+
+/**
+ * @brief Test to check percentiles of recorded samples
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(LatencyHistogramTest, TestPercentile) {
+  LatencyHistogram histogram;
+
+  ASSERT_EQ(0.0, histogram.percentile(0.5));
+
+  for (int i = 1; i <= 100; ++i) {
+    histogram.record(static_cast<double>(i));
+  }
+
+  ASSERT_EQ(static_cast<uint64_t>(100), histogram.count());
+  EXPECT_NEAR(50.5, histogram.mean(), 0.0001);
+  EXPECT_NEAR(1.0, histogram.min(), 0.0001);
+  EXPECT_NEAR(100.0, histogram.max(), 0.0001);
+  /* Buckets are 2% wide, so percentiles are within 2% of the sample */
+  EXPECT_NEAR(50.0, histogram.percentile(0.50), 1.0);
+  EXPECT_NEAR(95.0, histogram.percentile(0.95), 1.9);
+  EXPECT_NEAR(99.0, histogram.percentile(0.99), 2.0);
+  EXPECT_NEAR(100.0, histogram.percentile(1.0), 0.0001);
+}
+
+/**
+ * @brief Test to check merging and resetting of histograms
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(LatencyHistogramTest, TestMergeAndReset) {
+  LatencyHistogram histogram1, histogram2;
+  histogram1.record(2.0);
+  histogram2.record(8.0);
+  histogram2.record(0.0);
+
+  histogram1.merge(histogram2);
+
+  ASSERT_EQ(static_cast<uint64_t>(3), histogram1.count());
+  EXPECT_NEAR(10.0, histogram1.sum(), 0.0001);
+  EXPECT_NEAR(0.0, histogram1.min(), 0.0001);
+  EXPECT_NEAR(8.0, histogram1.max(), 0.0001);
+
+  histogram1.reset();
+
+  ASSERT_EQ(static_cast<uint64_t>(0), histogram1.count());
+  ASSERT_EQ(0.0, histogram1.percentile(0.99));
+}
@@ -0,0 +1,321 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      MetricsRegistryTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for MetricsRegistry and MetricsExporter
+ */
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/MetricsExporter.hpp"
+#include "../include/MetricsRegistry.hpp"
+
+namespace {
+/**
+ * @brief Sends a request to the exporter and gives the whole response
+ */
+std::string httpRequest(int port, const std::string& request) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  std::string response;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), \
+              sizeof(address)) == 0 && \
+      send(fd, request.data(), request.size(), 0) == \
+      static_cast<ssize_t>(request.size())) {
+    char buffer[1024];
+    ssize_t received;
+    while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+      response.append(buffer, received);
+    }
+  }
+  close(fd);
+  return response;
+}
+}  // namespace
+
+/**
+ * @brief Test the text of a counter and a gauge with labels
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestCounterAndGauge) {
+  MetricsRegistry registry;
+  MetricCounter& frames = registry.counter("hodm_frames_total", \
+                                           "Frames processed.");
+  frames.add();
+  frames.add(2);
+  MetricGauge& depth = registry.gauge("hodm_queue_depth", "Queued frames.", \
+                                      {{"queue", "writer"}});
+  depth.set(4);
+  depth.add(-1.5);
+  ASSERT_EQ(3u, frames.get());
+  ASSERT_DOUBLE_EQ(2.5, depth.get());
+  ASSERT_EQ("# HELP hodm_frames_total Frames processed.\n"
+            "# TYPE hodm_frames_total counter\n"
+            "hodm_frames_total 3\n"
+            "# HELP hodm_queue_depth Queued frames.\n"
+            "# TYPE hodm_queue_depth gauge\n"
+            "hodm_queue_depth{queue=\"writer\"} 2.5\n", registry.render());
+}
+
+/**
+ * @brief Test that registering a series again gives the same metric, and
+ *        that a series of other labels joins the same family
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestRegisterAgain) {
+  MetricsRegistry registry;
+  MetricCounter& first = registry.counter("hodm_drops_total", "Drops.", \
+                                          {{"reason", "display"}});
+  MetricCounter& again = registry.counter("hodm_drops_total", "Drops.", \
+                                          {{"reason", "display"}});
+  MetricCounter& other = registry.counter("hodm_drops_total", "Drops.", \
+                                          {{"reason", "ring"}});
+  ASSERT_EQ(&first, &again);
+  ASSERT_NE(&first, &other);
+  other.add(5);
+  std::string text = registry.render();
+  size_t type = text.find("# TYPE hodm_drops_total counter\n");
+  ASSERT_NE(std::string::npos, type);
+  ASSERT_EQ(std::string::npos, text.find("# TYPE", type + 1));
+  ASSERT_NE(std::string::npos, text.find(\
+      "hodm_drops_total{reason=\"display\"} 0\n"
+      "hodm_drops_total{reason=\"ring\"} 5\n"));
+}
+
+/**
+ * @brief Test that invalid and conflicting registrations are not exported
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestInvalidRegistration) {
+  MetricsRegistry registry;
+  registry.counter("hodm_frames_total", "Frames.").add();
+  registry.gauge("hodm_frames_total", "Frames.").set(7);
+  registry.counter("0frames", "Frames.").add();
+  registry.counter("hodm_bad_total", "Bad.", {{"le", "1"}}).add();
+  registry.counter("hodm_bad_total", "Bad.", {{"bad-name", "1"}}).add();
+  ASSERT_FALSE(registry.sample(MetricsRegistry::kHistogram, "hodm_h", "H.", \
+      MetricsRegistry::Labels(), []() { return 1.0; }));
+  ASSERT_EQ("# HELP hodm_frames_total Frames.\n"
+            "# TYPE hodm_frames_total counter\n"
+            "hodm_frames_total 1\n", registry.render());
+  ASSERT_TRUE(MetricsRegistry::isValidName("hodm:rate_5m", true));
+  ASSERT_FALSE(MetricsRegistry::isValidName("hodm:rate_5m", false));
+  ASSERT_FALSE(MetricsRegistry::isValidName("__reserved", false));
+}
+
+/**
+ * @brief Test the cumulative buckets, sum and count of a histogram
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestHistogram) {
+  MetricsRegistry registry;
+  MetricHistogram& latency = registry.histogram("hodm_stage_seconds", \
+      "Stage durations.", {0.01, 0.1}, {{"stage", "forward"}});
+  latency.observe(0.005);
+  latency.observe(0.01);
+  latency.observe(0.05);
+  latency.observe(2);
+  ASSERT_EQ(4u, latency.count());
+  ASSERT_DOUBLE_EQ(2.065, latency.sum());
+  ASSERT_EQ("# HELP hodm_stage_seconds Stage durations.\n"
+            "# TYPE hodm_stage_seconds histogram\n"
+            "hodm_stage_seconds_bucket{stage=\"forward\",le=\"0.01\"} 2\n"
+            "hodm_stage_seconds_bucket{stage=\"forward\",le=\"0.1\"} 3\n"
+            "hodm_stage_seconds_bucket{stage=\"forward\",le=\"+Inf\"} 4\n"
+            "hodm_stage_seconds_sum{stage=\"forward\"} 2.065\n"
+            "hodm_stage_seconds_count{stage=\"forward\"} 4\n", \
+            registry.render());
+}
+
+/**
+ * @brief Test the escaping of the help and of the label values
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestEscaping) {
+  MetricsRegistry registry;
+  registry.gauge("hodm_input", "Path with \\ and\nline \"quoted\".", \
+                 {{"path", "a\\b\n\"c\""}}).set(1);
+  ASSERT_EQ("# HELP hodm_input Path with \\\\ and\\nline \"quoted\".\n"
+            "# TYPE hodm_input gauge\n"
+            "hodm_input{path=\"a\\\\b\\n\\\"c\\\"\"} 1\n", registry.render());
+}
+
+/**
+ * @brief Test that sampled series are read when written and removed with
+ *        their owner
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestSampledSeries) {
+  MetricsRegistry registry;
+  int depth = 3;
+  ASSERT_TRUE(registry.sample(MetricsRegistry::kGauge, "hodm_queue_depth", \
+      "Queued frames.", MetricsRegistry::Labels(), \
+      [&depth]() { return depth; }, &depth));
+  ASSERT_NE(std::string::npos, registry.render().find("hodm_queue_depth 3\n"));
+  depth = 5;
+  ASSERT_NE(std::string::npos, registry.render().find("hodm_queue_depth 5\n"));
+  registry.removeSamples(&depth);
+  ASSERT_EQ("", registry.render());
+
+  registry.addProcessMetrics();
+  ASSERT_GT(MetricsRegistry::residentMemoryBytes(), 0);
+  ASSERT_NE(std::string::npos, registry.render().find(\
+      "# TYPE process_resident_memory_bytes gauge\n"));
+}
+
+/**
+ * @brief Test that counts of several threads add up
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsRegistryTest, TestConcurrentUpdates) {
+  MetricsRegistry registry;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back(std::thread([&registry]() {
+      MetricCounter& frames = registry.counter("hodm_frames_total", "F.");
+      MetricHistogram& latency = registry.histogram("hodm_seconds", "S.", \
+          MetricsRegistry::latencyBounds());
+      for (int j = 0; j < 10000; ++j) {
+        frames.add();
+        latency.observe(0.5);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(40000u, registry.counter("hodm_frames_total", "F.").get());
+  MetricHistogram& latency = registry.histogram("hodm_seconds", "S.", {});
+  ASSERT_EQ(40000u, latency.count());
+  ASSERT_DOUBLE_EQ(20000, latency.sum());
+}
+
+/**
+ * @brief Test the metrics served over HTTP
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsExporterTest, TestScrape) {
+  MetricsRegistry registry;
+  registry.counter("hodm_frames_total", "Frames processed.").add(42);
+  MetricsExporter exporter(registry);
+  ASSERT_TRUE(exporter.start(0));
+  ASSERT_TRUE(exporter.isRunning());
+  ASSERT_GT(exporter.getPort(), 0);
+
+  std::string response = httpRequest(exporter.getPort(), \
+      "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+  ASSERT_NE(std::string::npos, response.find(\
+      "Content-Type: text/plain; version=0.0.4"));
+  ASSERT_NE(std::string::npos, response.find("\r\n\r\n# HELP "));
+  ASSERT_NE(std::string::npos, response.find("hodm_frames_total 42\n"));
+
+  response = httpRequest(exporter.getPort(), "GET / HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 404 Not Found\r\n"));
+  response = httpRequest(exporter.getPort(), "POST /metrics HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 405 Method Not Allowed\r\n"));
+  response = httpRequest(exporter.getPort(), "nonsense\r\n\r\n");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 400 Bad Request\r\n"));
+  ASSERT_EQ(4u, exporter.getRequests());
+
+  exporter.stop();
+  ASSERT_FALSE(exporter.isRunning());
+  ASSERT_EQ(-1, exporter.getPort());
+}
+
+/**
+ * @brief Test the metrics dumped to a file at intervals and when stopping
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MetricsExporterTest, TestDumpFile) {
+  std::string dumpPath = "/tmp/hodm-metrics-" + std::to_string(getpid()) + \
+                         ".prom";
+  MetricsRegistry registry;
+  MetricCounter& frames = registry.counter("hodm_frames_total", "Frames.");
+  MetricsExporter exporter(registry);
+  ASSERT_FALSE(exporter.start(-1));
+  ASSERT_TRUE(exporter.start(-1, dumpPath, 0.05));
+  ASSERT_EQ(-1, exporter.getPort());
+  frames.add(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  {
+    std::ifstream dumped(dumpPath.c_str());
+    std::stringstream text;
+    text << dumped.rdbuf();
+    ASSERT_NE(std::string::npos, text.str().find("hodm_frames_total 1\n"));
+  }
+  frames.add(1);
+  exporter.stop();
+  std::ifstream dumped(dumpPath.c_str());
+  std::stringstream text;
+  text << dumped.rdbuf();
+  ASSERT_NE(std::string::npos, text.str().find("hodm_frames_total 2\n"));
+  std::remove(dumpPath.c_str());
+}
@@ -0,0 +1,166 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+/**
+ * @file      MjpegAviWriterTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for MjpegAviWriter class
+ */
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../include/MjpegAviWriter.hpp"
+
+namespace {
+/**
+ * @brief Reads a little endian 32 bit value of a file content
+ */
+uint32_t readUint32(const std::vector<char>& bytes, size_t position) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) {
+    value = (value << 8) | static_cast<unsigned char>(bytes[position + i]);
+  }
+  return value;
+}
+
+/**
+ * @brief Finds a four character code in a file content
+ */
+size_t findFourcc(const std::vector<char>& bytes, const std::string& fourcc) {
+  std::string content(bytes.begin(), bytes.end());
+  return content.find(fourcc);
+}
+}  // namespace
+
+/**
+ * @brief Test to check the structure of the written file
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MjpegAviWriterTest, TestFileStructure) {
+  const std::string path = "../test/testResults/mjpegWriterTest.avi";
+  MjpegAviWriter writer;
+  ASSERT_TRUE(writer.open(path, 416, 416, 15.0));
+  const unsigned char frame1[] = {0xFF, 0xD8, 1, 2, 3, 0xFF, 0xD9};
+  const unsigned char frame2[] = {0xFF, 0xD8, 4, 5, 0xFF, 0xD9};
+  ASSERT_TRUE(writer.writeFrame(frame1, sizeof(frame1)));
+  ASSERT_TRUE(writer.writeFrame(frame2, sizeof(frame2)));
+  ASSERT_EQ(2u, writer.frameCount());
+  writer.close();
+  ASSERT_FALSE(writer.isOpened());
+
+  std::ifstream file(path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)), \
+                          std::istreambuf_iterator<char>());
+  ASSERT_EQ("RIFF", std::string(bytes.begin(), bytes.begin() + 4));
+  ASSERT_EQ(bytes.size() - 8, readUint32(bytes, 4));
+  ASSERT_EQ("AVI ", std::string(bytes.begin() + 8, bytes.begin() + 12));
+
+  /* Frame count of the main and of the stream header */
+  size_t avih = findFourcc(bytes, "avih");
+  ASSERT_EQ(2u, readUint32(bytes, avih + 8 + 16));
+  size_t strh = findFourcc(bytes, "strh");
+  ASSERT_EQ(2u, readUint32(bytes, strh + 8 + 32));
+
+  /* Odd sized frame is padded, the index points to both chunks */
+  size_t movi = findFourcc(bytes, "movi");
+  size_t idx1 = findFourcc(bytes, "idx1");
+  ASSERT_EQ(idx1 - movi, readUint32(bytes, movi - 4));
+  ASSERT_EQ(32u, readUint32(bytes, idx1 + 4));
+  ASSERT_EQ(4u, readUint32(bytes, idx1 + 8 + 8));
+  ASSERT_EQ(sizeof(frame1), readUint32(bytes, idx1 + 8 + 12));
+  ASSERT_EQ(4u + 8 + sizeof(frame1) + 1, readUint32(bytes, idx1 + 24 + 8));
+  ASSERT_EQ(sizeof(frame2), readUint32(bytes, idx1 + 24 + 12));
+  ASSERT_EQ(0xD8, static_cast<unsigned char>(bytes[movi + 4 + 8 + 1]));
+}
+
+/**
+ * @brief Test that a frame that would take the file past its maximum
+ *        size is refused, the file staying valid
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MjpegAviWriterTest, TestMaxFileSize) {
+  const std::string path = "../test/testResults/mjpegWriterLimit.avi";
+  const unsigned char frame[100] = {0xFF, 0xD8};
+  MjpegAviWriter writer;
+  ASSERT_TRUE(writer.open(path, 416, 416, 15.0));
+  writer.close();
+  std::ifstream empty(path, std::ios::binary | std::ios::ate);
+  /* An empty video, two chunks and two index entries */
+  uint64_t twoFrames = static_cast<uint64_t>(empty.tellg()) + \
+                       2 * (8 + sizeof(frame)) + 2 * 16;
+  writer.setMaxFileSize(twoFrames);
+  ASSERT_TRUE(writer.open(path, 416, 416, 15.0));
+  ASSERT_TRUE(writer.fits(sizeof(frame)));
+  ASSERT_TRUE(writer.writeFrame(frame, sizeof(frame)));
+  ASSERT_FALSE(writer.fits(sizeof(frame) + 1));
+  ASSERT_FALSE(writer.writeFrame(frame, sizeof(frame) + 1));
+  ASSERT_TRUE(writer.writeFrame(frame, sizeof(frame)));
+  ASSERT_FALSE(writer.fits(0));
+  ASSERT_FALSE(writer.writeFrame(frame, 2));
+  ASSERT_EQ(2u, writer.frameCount());
+  writer.close();
+
+  std::ifstream file(path, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)), \
+                          std::istreambuf_iterator<char>());
+  ASSERT_EQ(twoFrames, bytes.size());
+  ASSERT_EQ(bytes.size() - 8, readUint32(bytes, 4));
+  ASSERT_EQ(32u, readUint32(bytes, findFourcc(bytes, "idx1") + 4));
+
+  /* Never more than the 32 bit offsets can address */
+  writer.setMaxFileSize(UINT64_C(8) << 30);
+  ASSERT_TRUE(writer.open(path, 416, 416, 15.0));
+  ASSERT_TRUE(writer.fits(UINT32_MAX - 4096));
+  ASSERT_FALSE(writer.fits(UINT32_MAX));
+  writer.close();
+}
+
+/**
+ * @brief Test to check invalid parameters
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(MjpegAviWriterTest, TestInvalidOpen) {
+  MjpegAviWriter writer;
+  const unsigned char frame[] = {0xFF, 0xD8, 0xFF, 0xD9};
+
+  ASSERT_FALSE(writer.open("../test/testResults/mjpegWriterTest.avi", \
+                           0, 416, 15.0));
+  ASSERT_FALSE(writer.open("../test/notADirectory/mjpegWriterTest.avi", \
+                           416, 416, 15.0));
+  ASSERT_FALSE(writer.writeFrame(frame, sizeof(frame)));
+}
@@ -53,6 +53,31 @@ TEST(NetworkTest, TestCreateNetworkInput) {
   ASSERT_EQ(0, testFlag2);
 }
 
+/**
+ * @brief Test to check that the blob filled in place for images of the
+ *        network size matches blobFromImage and is reused
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(NetworkTest, TestCreateNetworkInputInPlace) {
+  Network network;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::resize(testImage, testImage, cv::Size(416, 416));
+  cv::Mat expectedBlob = cv::dnn::blobFromImage(testImage, 1/255.0, \
+      cv::Size(416, 416), cv::Scalar(0, 0, 0), true, false);
+
+  ASSERT_EQ(1, network.createNetworkInput(testImage));
+  const cv::Mat& blob = network.getInputBlob();
+  const uchar* data = blob.data;
+  ASSERT_EQ(expectedBlob.total(), blob.total());
+  ASSERT_EQ(0, cv::norm(expectedBlob, blob, cv::NORM_INF));
+
+  ASSERT_EQ(1, network.createNetworkInput(testImage));
+  ASSERT_EQ(data, network.getInputBlob().data);
+}
+
 /**
  * @brief Test to check network execution
  *
@@ -71,3 +96,125 @@ TEST(NetworkTest, TestApplyYOLONetwork) {
 
   ASSERT_GE(testDetections.size(), static_cast<unsigned>(1));
 }
+
+/**
+ * @brief Test to check that a batch input holds every image as a single
+ *        input would
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(NetworkTest, TestCreateBatchInput) {
+  Network network;
+  cv::Mat testImage = cv::imread("../test/testData/testImage.jpg");
+  cv::resize(testImage, testImage, cv::Size(416, 416));
+  cv::Mat flipped;
+  cv::flip(testImage, flipped, 1);
+  std::vector<cv::Mat> images{testImage, flipped};
+  cv::Mat expectedBlob = cv::dnn::blobFromImages(images, 1/255.0, \
+      cv::Size(416, 416), cv::Scalar(0, 0, 0), true, false);
+
+  ASSERT_EQ(1, network.createNetworkInput(images));
+  const cv::Mat& blob = network.getInputBlob();
+  ASSERT_EQ(2, blob.size[0]);
+  ASSERT_EQ(0, cv::norm(expectedBlob, blob, cv::NORM_INF));
+
+  /* Images of other sizes go through blobFromImages */
+  std::vector<cv::Mat> original{cv::imread("../test/testData/testImage.jpg"),
+                                testImage};
+  ASSERT_EQ(1, network.createNetworkInput(original));
+  ASSERT_EQ(2, network.getInputBlob().size[0]);
+
+  std::vector<cv::Mat> invalid{testImage, cv::Mat()};
+  ASSERT_EQ(0, network.createNetworkInput(invalid));
+}
+
+/**
+ * @brief Test to check the split of the output of a batch per image
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(NetworkTest, TestSplitBatchOutput) {
+  /* Batch of 2 images, 3 boxes of 6 values each */
+  int shape[] = {2, 3, 6};
+  cv::Mat batched(3, shape, CV_32F);
+  float* values = reinterpret_cast<float*>(batched.data);
+  for (int i = 0; i < 2 * 3 * 6; ++i) {
+    values[i] = static_cast<float>(i);
+  }
+  /* Same boxes as one matrix with the images one after the other */
+  cv::Mat stacked(6, 6, CV_32F, values);
+  std::vector<cv::Mat> output{batched, stacked};
+
+  std::vector<cv::Mat> imageOutput;
+  Network::splitBatchOutput(output, 2, 1, imageOutput);
+  ASSERT_EQ(2u, imageOutput.size());
+  for (const auto& boxes : imageOutput) {
+    ASSERT_EQ(3, boxes.rows);
+    ASSERT_EQ(6, boxes.cols);
+    ASSERT_FLOAT_EQ(18.0f, boxes.at<float>(0, 0));
+    ASSERT_FLOAT_EQ(35.0f, boxes.at<float>(2, 5));
+  }
+}
+
+/**
+ * @brief Test that an I420 and an NV12 frame converted straight into the
+ *        blob match cvtColor, resize and blobFromImage on the same frame
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(NetworkTest, TestCreateYuvNetworkInput) {
+  Network network;
+  /* Synthetic frame with color gradients and sharp edges */
+  cv::Mat testImage(480, 640, CV_8UC3);
+  for (int y = 0; y < testImage.rows; ++y) {
+    for (int x = 0; x < testImage.cols; ++x) {
+      testImage.at<cv::Vec3b>(y, x) = cv::Vec3b(x * 255 / 640, \
+          y * 255 / 480, ((x / 40 + y / 40) % 2) * 200 + 20);
+    }
+  }
+  cv::Mat i420;
+  cv::cvtColor(testImage, i420, cv::COLOR_BGR2YUV_I420);
+  cv::Mat bgr;
+  cv::cvtColor(i420, bgr, cv::COLOR_YUV2BGR_I420);
+  cv::Mat expectedBlob = cv::dnn::blobFromImage(bgr, 1/255.0, \
+      cv::Size(416, 416), cv::Scalar(0, 0, 0), true, false);
+
+  YuvImage image;
+  image.layout = YuvImage::kI420;
+  image.data = i420.data;
+  image.width = 640;
+  image.height = 480;
+  ASSERT_EQ(1, network.createNetworkInput(image));
+  ASSERT_EQ(expectedBlob.total(), network.getInputBlob().total());
+  ASSERT_LT(cv::norm(expectedBlob, network.getInputBlob(), cv::NORM_INF), \
+            2 / 255.0);
+
+  /* NV12 interleaves the U and V planes of I420 */
+  cv::Mat nv12 = i420.clone();
+  const uchar* u = i420.data + 640 * 480;
+  const uchar* v = u + 320 * 240;
+  uchar* uv = nv12.data + 640 * 480;
+  for (int i = 0; i < 320 * 240; ++i) {
+    uv[2 * i] = u[i];
+    uv[2 * i + 1] = v[i];
+  }
+  image.layout = YuvImage::kNv12;
+  image.data = nv12.data;
+  ASSERT_EQ(1, network.createNetworkInput(image));
+  ASSERT_LT(cv::norm(expectedBlob, network.getInputBlob(), cv::NORM_INF), \
+            2 / 255.0);
+
+  std::vector<cv::Mat> planes;
+  network.getInputPlanes(planes);
+  ASSERT_EQ(3u, planes.size());
+  ASSERT_EQ(network.getInputBlob().data, planes[0].data);
+
+  image.width = 639;
+  ASSERT_EQ(0, network.createNetworkInput(image));
+}
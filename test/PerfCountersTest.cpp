@@ -0,0 +1,97 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      PerfCountersTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for PerfCounters class
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../include/PerfCounters.hpp"
+
+/**
+ * @brief Test to check that the counters are either read or explain why
+ *        they can't be
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(PerfCountersTest, TestRead) {
+  PerfCounters& counters = PerfCounters::forThread();
+  ASSERT_EQ(&counters, &PerfCounters::forThread());
+
+  PerfCounters::Reading start;
+  PerfCounters::Reading end;
+  bool read = counters.read(start);
+  ASSERT_EQ(counters.isAvailable(), read);
+  if (!read) {
+    /* Counters may be missing in virtual machines and containers */
+    ASSERT_FALSE(counters.getError().empty());
+    ASSERT_EQ(0u, start.available);
+    return;
+  }
+  volatile uint64_t sum = 0;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    sum += i;
+  }
+  ASSERT_TRUE(counters.read(end));
+  PerfCounters::Reading counts = PerfCounters::difference(start, end);
+  ASSERT_NE(0u, counts.available);
+  if (counts.available & (1u << PerfCounters::kInstructions)) {
+    ASSERT_GT(counts.values[PerfCounters::kInstructions], 100000u);
+  }
+}
+
+/**
+ * @brief Test to check the difference of two readings
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(PerfCountersTest, TestDifference) {
+  PerfCounters::Reading start;
+  PerfCounters::Reading end;
+  start.values[PerfCounters::kCycles] = 100;
+  end.values[PerfCounters::kCycles] = 350;
+  start.values[PerfCounters::kBranchMisses] = 7;
+  end.values[PerfCounters::kBranchMisses] = 9;
+  start.available = (1u << PerfCounters::kCycles) | \
+                    (1u << PerfCounters::kBranchMisses);
+  end.available = 1u << PerfCounters::kCycles;
+
+  PerfCounters::Reading counts = PerfCounters::difference(start, end);
+  ASSERT_EQ(1u << PerfCounters::kCycles, counts.available);
+  ASSERT_EQ(250u, counts.values[PerfCounters::kCycles]);
+  ASSERT_EQ(0u, counts.values[PerfCounters::kBranchMisses]);
+  ASSERT_EQ(std::string("cache misses"), \
+            PerfCounters::counterName(PerfCounters::kCacheMisses));
+}
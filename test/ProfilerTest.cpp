@@ -0,0 +1,258 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ProfilerTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for Profiler class
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <AllocationCounter.hpp>
+#include <Profiler.hpp>
+
+/**
+ * @brief Test to check that nothing is recorded while disabled
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestDisabled) {
+  Profiler profiler;
+  {
+    ScopedStage stage(profiler, "capture");
+  }
+
+  ASSERT_FALSE(profiler.isEnabled());
+  ASSERT_EQ(static_cast<size_t>(0), profiler.traceEventCount());
+  ASSERT_EQ(static_cast<uint64_t>(0), \
+            profiler.stageHistogram("capture").count());
+}
+
+/**
+ * @brief Test to check recording of stages and layers
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestRecordStages) {
+  Profiler profiler;
+  profiler.setEnabled(true);
+  for (int frameID = 0; frameID < 3; ++frameID) {
+    profiler.beginFrame(frameID);
+    ScopedStage stage(profiler, "decode");
+    stage.next("nms");
+  }
+  Profiler::Clock::time_point start = Profiler::Clock::now();
+  profiler.record("forward", 2, start, start + std::chrono::milliseconds(5));
+  profiler.recordLayers(2, start, {"conv_0", "yolo_82"}, {3.0, 2.0});
+
+  std::vector<std::string> stages = profiler.stageNames();
+  ASSERT_EQ(static_cast<size_t>(3), stages.size());
+  ASSERT_EQ("decode", stages[0]);
+  ASSERT_EQ("nms", stages[1]);
+  ASSERT_EQ(static_cast<uint64_t>(3), profiler.stageHistogram("nms").count());
+  EXPECT_NEAR(5.0, profiler.stageHistogram("forward").max(), 0.001);
+  ASSERT_EQ(static_cast<size_t>(9), profiler.traceEventCount());
+
+  std::ostringstream summary;
+  profiler.printSummary(summary);
+  ASSERT_NE(std::string::npos, summary.str().find("forward"));
+  ASSERT_NE(std::string::npos, summary.str().find("conv_0"));
+
+  profiler.reset();
+  ASSERT_EQ(static_cast<size_t>(0), profiler.traceEventCount());
+}
+
+/**
+ * @brief Test to check trace event limit and Chrome trace export
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestExportChromeTrace) {
+  Profiler profiler;
+  profiler.setEnabled(true);
+  profiler.setTraceEventLimit(2);
+  for (int i = 0; i < 4; ++i) {
+    ScopedStage stage(profiler, "write");
+  }
+
+  ASSERT_EQ(static_cast<size_t>(2), profiler.traceEventCount());
+  ASSERT_EQ(static_cast<uint64_t>(4), \
+            profiler.stageHistogram("write").count());
+
+  std::string tracePath = "../test/testResults/trace.json";
+  ASSERT_TRUE(profiler.exportChromeTrace(tracePath));
+  ASSERT_FALSE(profiler.exportChromeTrace("../notADirectory/trace.json"));
+
+  std::ifstream traceFile(tracePath);
+  std::stringstream trace;
+  trace << traceFile.rdbuf();
+  ASSERT_EQ(0u, trace.str().find("{\"displayTimeUnit\""));
+  ASSERT_NE(std::string::npos, trace.str().find("\"ph\":\"X\""));
+  ASSERT_NE(std::string::npos, trace.str().find("\"name\":\"write\""));
+}
+
+/**
+ * @brief Test to check that the hardware counts of the stages are added up
+ *        and reported per frame
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestRecordCounters) {
+  Profiler profiler;
+  profiler.setEnabled(true);
+  PerfCounters::Reading counts;
+  counts.values[PerfCounters::kCycles] = 2000000;
+  counts.values[PerfCounters::kInstructions] = 5000000;
+  counts.values[PerfCounters::kCacheMisses] = 300;
+  counts.available = (1u << PerfCounters::kCycles) | \
+                     (1u << PerfCounters::kInstructions) | \
+                     (1u << PerfCounters::kCacheMisses);
+  profiler.recordCounters("nms", counts);
+  profiler.recordCounters("nms", counts);
+
+  uint64_t runs = 0;
+  PerfCounters::Reading sum = profiler.stageCounters("nms", runs);
+  ASSERT_EQ(2u, runs);
+  ASSERT_EQ(counts.available, sum.available);
+  ASSERT_EQ(10000000u, sum.values[PerfCounters::kInstructions]);
+  profiler.stageCounters("decode", runs);
+  ASSERT_EQ(0u, runs);
+
+  std::ostringstream summary;
+  profiler.printSummary(summary);
+  ASSERT_NE(std::string::npos, summary.str().find("IPC"));
+  /* 2 Mcycles, 5 Minstr, IPC 2.5 and 300 cache misses per frame, the
+  branch misses were not counted */
+  ASSERT_NE(std::string::npos, summary.str().find("2.500"));
+  ASSERT_NE(std::string::npos, summary.str().find("300.000"));
+  ASSERT_NE(std::string::npos, summary.str().find("-\n"));
+
+  /* Without hardware counters only the timings are recorded */
+  profiler.reset();
+  bool counting = profiler.setCountersEnabled(true);
+  ASSERT_EQ(PerfCounters::forThread().isAvailable(), counting);
+  {
+    ScopedStage stage(profiler, "forward");
+  }
+  profiler.stageCounters("forward", runs);
+  ASSERT_EQ(counting ? 1u : 0u, runs);
+  ASSERT_EQ(1u, profiler.stageHistogram("forward").count());
+  std::ostringstream reasons;
+  profiler.printSummary(reasons);
+  if (!counting) {
+    ASSERT_NE(std::string::npos, \
+              reasons.str().find("Hardware counters unavailable"));
+  }
+}
+
+/**
+ * @brief Test that the stages are observed in the metrics registry without
+ *        being recorded
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestStageMetrics) {
+  Profiler profiler;
+  MetricsRegistry registry;
+  ASSERT_FALSE(profiler.isTiming());
+  profiler.setMetrics(&registry);
+  ASSERT_TRUE(profiler.isTiming());
+  {
+    ScopedStage stage(profiler, "capture");
+    stage.next("forward");
+  }
+  Profiler::Clock::time_point start = Profiler::Clock::now();
+  profiler.record("forward", 0, start, start + std::chrono::milliseconds(20));
+
+  ASSERT_EQ(static_cast<size_t>(0), profiler.traceEventCount());
+  ASSERT_EQ(static_cast<uint64_t>(0), \
+            profiler.stageHistogram("forward").count());
+  MetricHistogram& forward = registry.histogram(\
+      "hodm_stage_duration_seconds", "", {}, {{"stage", "forward"}});
+  ASSERT_EQ(static_cast<uint64_t>(2), forward.count());
+  ASSERT_GE(forward.sum(), 0.02);
+  ASSERT_EQ(static_cast<uint64_t>(1), registry.histogram(\
+      "hodm_stage_duration_seconds", "", {}, \
+      {{"stage", "capture"}}).count());
+
+  profiler.setMetrics(nullptr);
+  ASSERT_FALSE(profiler.isTiming());
+  profiler.record("forward", 1, start, start);
+  ASSERT_EQ(static_cast<uint64_t>(2), forward.count());
+}
+
+/**
+ * @brief Test that observing the stages in the metrics registry neither
+ *        allocates nor misses a change of registry
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(ProfilerTest, TestStageMetricsWithoutAllocation) {
+  Profiler profiler;
+  MetricsRegistry registry;
+  profiler.setMetrics(&registry);
+  const char* stages[] = {"capture", "forward", "decode", "nms"};
+  for (const char* name : stages) {
+    ScopedStage stage(profiler, name);
+  }
+  uint64_t allocations = AllocationCounter::threadAllocations();
+  for (int frame = 0; frame < 100; ++frame) {
+    profiler.beginFrame(frame);
+    ScopedStage stage(profiler, stages[0]);
+    for (size_t i = 1; i < sizeof(stages) / sizeof(stages[0]); ++i) {
+      stage.next(stages[i]);
+    }
+  }
+  ASSERT_EQ(allocations, AllocationCounter::threadAllocations());
+  ASSERT_EQ(static_cast<uint64_t>(101), registry.histogram(\
+      "hodm_stage_duration_seconds", "", {}, {{"stage", "nms"}}).count());
+
+  MetricsRegistry other;
+  profiler.setMetrics(&other);
+  {
+    ScopedStage stage(profiler, stages[3]);
+  }
+  ASSERT_EQ(static_cast<uint64_t>(1), other.histogram(\
+      "hodm_stage_duration_seconds", "", {}, {{"stage", "nms"}}).count());
+}
@@ -0,0 +1,123 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      RegionOfInterestTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for RegionOfInterest class
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+#include "../include/RegionOfInterest.hpp"
+
+/**
+ * @brief Test the reading of rectangles and polygons, and the rejection
+ *        of files with an invalid line
+ */
+TEST(RegionOfInterest, TestRead) {
+  RegionOfInterest zones;
+  std::istringstream valid("# door\n"
+                           "rect 10 20 30 40\n"
+                           "\n"
+                           "polygon 0,0 100,0 50,80\n");
+  ASSERT_TRUE(zones.read(valid));
+  ASSERT_FALSE(zones.empty());
+  ASSERT_EQ(2u, zones.getZones().size());
+  ASSERT_EQ(4u, zones.getZones()[0].size());
+  ASSERT_EQ(cv::Point(40, 60), zones.getZones()[0][2]);
+  ASSERT_EQ(3u, zones.getZones()[1].size());
+
+  std::istringstream twoCorners("polygon 0,0 100,0\n");
+  ASSERT_FALSE(zones.read(twoCorners));
+  ASSERT_TRUE(zones.empty());
+  std::istringstream badCorner("polygon 0,0 100;0 50,80\n");
+  ASSERT_FALSE(zones.read(badCorner));
+  std::istringstream emptyRect("rect 10 20 0 40\n");
+  ASSERT_FALSE(zones.read(emptyRect));
+  std::istringstream extraField("rect 10 20 30 40 50\n");
+  ASSERT_FALSE(zones.read(extraField));
+  std::istringstream unknownKind("circle 10 20 30\n");
+  ASSERT_FALSE(zones.read(unknownKind));
+  ASSERT_FALSE(zones.load("missingZones.txt"));
+}
+
+/**
+ * @brief Test that the regions are clipped to the frame, merged when they
+ *        overlap and merged into one beyond the largest number
+ */
+TEST(RegionOfInterest, TestRegions) {
+  RegionOfInterest zones;
+  zones.addRectangle(cv::Rect(-10, -10, 50, 50));
+  zones.addRectangle(cv::Rect(20, 20, 40, 40));
+  zones.addRectangle(cv::Rect(200, 100, 50, 50));
+  zones.addRectangle(cv::Rect(1000, 1000, 50, 50));
+  std::vector<cv::Rect> regions;
+
+  zones.getRegions(cv::Size(640, 480), 4, regions);
+  ASSERT_EQ(2u, regions.size());
+  ASSERT_EQ(0, regions[0].x);
+  ASSERT_EQ(0, regions[0].y);
+  ASSERT_GE(regions[0].br().x, 60);
+  ASSERT_GE(regions[1].width, 50);
+  for (const auto& region : regions) {
+    ASSERT_EQ(region, region & cv::Rect(0, 0, 640, 480));
+  }
+
+  zones.getRegions(cv::Size(640, 480), 1, regions);
+  ASSERT_EQ(1u, regions.size());
+  ASSERT_EQ(0, regions[0].x);
+  ASSERT_GE(regions[0].br().x, 250);
+  ASSERT_GE(regions[0].br().y, 150);
+
+  zones.getRegions(cv::Size(10, 10), 4, regions);
+  ASSERT_EQ(1u, regions.size());
+  ASSERT_EQ(cv::Rect(0, 0, 10, 10), regions[0]);
+
+  RegionOfInterest outside;
+  outside.addRectangle(cv::Rect(-100, -100, 50, 50));
+  outside.getRegions(cv::Size(640, 480), 4, regions);
+  ASSERT_TRUE(regions.empty());
+}
+
+/**
+ * @brief Test that boxes belong to a zone by their center
+ */
+TEST(RegionOfInterest, TestContains) {
+  RegionOfInterest zones;
+  ASSERT_TRUE(zones.addPolygon({cv::Point(0, 0), cv::Point(100, 0), \
+                                cv::Point(0, 100)}));
+  ASSERT_FALSE(zones.addPolygon({cv::Point(0, 0), cv::Point(100, 0)}));
+  zones.addRectangle(cv::Rect(200, 200, 20, 20));
+
+  ASSERT_TRUE(zones.contains(cv::Rect(10, 10, 20, 20)));
+  ASSERT_FALSE(zones.contains(cv::Rect(60, 60, 20, 20)));
+  /* Only the center counts, not the overlap */
+  ASSERT_TRUE(zones.contains(cv::Rect(190, 190, 40, 40)));
+  ASSERT_FALSE(zones.contains(cv::Rect(150, 150, 50, 50)));
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      ResultCacheTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for ResultCache class
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/ResultCache.hpp"
+
+namespace {
+/**
+ * @brief Makes the detections of a fake image
+ */
+std::vector<Detection> makeDetections(int count, int32_t x) {
+  std::vector<Detection> detections(count);
+  for (int i = 0; i < count; ++i) {
+    detections[i].x1 = x;
+    detections[i].y1 = i;
+    detections[i].x2 = x + 10;
+    detections[i].y2 = i + 20;
+    detections[i].score = 0.95f;
+  }
+  return detections;
+}
+
+/**
+ * @brief Writes bytes to a file
+ */
+void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << content;
+}
+}  // namespace
+
+/**
+ * @brief Test that a file hashes as its bytes do, across the chunk size,
+ *        and that the seed and every byte change the hash
+ */
+TEST(ResultCache, TestHash) {
+  const std::string path = "resultCacheHash.bin";
+  for (size_t size : {0u, 7u, 8u, 65536u, 65541u, 200003u}) {
+    std::string content(size, 'a');
+    for (size_t i = 0; i < size; ++i) {
+      content[i] = static_cast<char>(i * 31 + i / 7);
+    }
+    writeFile(path, content);
+    uint64_t key = 0;
+    ASSERT_TRUE(ResultCache::hashFile(path, 5, key));
+    ASSERT_EQ(ResultCache::hash(content.data(), size, 5), key);
+    ASSERT_NE(ResultCache::hash(content.data(), size, 6), key);
+    if (size > 0) {
+      content[size / 2] ^= 1;
+      ASSERT_NE(ResultCache::hash(content.data(), size, 5), key);
+    }
+  }
+  std::remove(path.c_str());
+  uint64_t key = 0;
+  ASSERT_FALSE(ResultCache::hashFile(path, 5, key));
+  /* The length is part of the hash */
+  std::string zeros(16, '\0');
+  ASSERT_NE(ResultCache::hash(zeros.data(), 8, 0), \
+            ResultCache::hash(zeros.data(), 16, 0));
+}
+
+/**
+ * @brief Test the hits, misses and least recently used eviction
+ */
+TEST(ResultCache, TestEviction) {
+  const std::string path = "resultCacheEviction.bin";
+  std::remove(path.c_str());
+  ResultCache cache;
+  ASSERT_FALSE(cache.isOpen());
+  ASSERT_TRUE(cache.open(path, 2));
+  ASSERT_TRUE(cache.isOpen());
+  std::vector<Detection> detections;
+  ASSERT_FALSE(cache.find(1, detections));
+
+  std::vector<Detection> first = makeDetections(2, 1);
+  std::vector<Detection> second = makeDetections(0, 2);
+  cache.store(1, first.data(), first.size());
+  cache.store(2, second.data(), second.size());
+  ASSERT_TRUE(cache.find(1, detections));
+  ASSERT_EQ(2u, detections.size());
+  ASSERT_EQ(1, detections[1].x1);
+  ASSERT_EQ(1, detections[1].y1);
+  ASSERT_TRUE(cache.find(2, detections));
+  ASSERT_TRUE(detections.empty());
+
+  /* 1 is the least recently used */
+  std::vector<Detection> third = makeDetections(1, 3);
+  cache.store(3, third.data(), third.size());
+  ASSERT_EQ(2u, cache.size());
+  ASSERT_FALSE(cache.find(1, detections));
+  ASSERT_TRUE(cache.find(3, detections));
+  ASSERT_EQ(3, detections[0].x1);
+
+  ASSERT_EQ(3u, cache.getStats().hits);
+  ASSERT_EQ(2u, cache.getStats().misses);
+  ASSERT_EQ(1u, cache.getStats().evictions);
+  std::ostringstream report;
+  cache.printReport(report);
+  ASSERT_NE(std::string::npos, report.str().find("60.0% hit rate"));
+  /* The format of the stream is left as it was */
+  report.str("");
+  report << 3.14159;
+  ASSERT_EQ("3.14159", report.str());
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Test that the entries and their order are kept between runs
+ */
+TEST(ResultCache, TestPersistence) {
+  const std::string path = "resultCachePersistence.bin";
+  std::remove(path.c_str());
+  std::vector<Detection> detections;
+  {
+    ResultCache cache;
+    ASSERT_TRUE(cache.open(path, 3));
+    for (int key = 1; key <= 3; ++key) {
+      std::vector<Detection> stored = makeDetections(key, key * 100);
+      cache.store(key, stored.data(), stored.size());
+    }
+    ASSERT_TRUE(cache.find(1, detections));
+    ASSERT_TRUE(cache.save());
+    /* Saved again by the destructor */
+    cache.find(2, detections);
+  }
+  ResultCache cache;
+  ASSERT_TRUE(cache.open(path, 3));
+  ASSERT_EQ(3u, cache.size());
+  ASSERT_EQ(0u, cache.getStats().hits);
+  ASSERT_TRUE(cache.find(3, detections));
+  ASSERT_EQ(3u, detections.size());
+  ASSERT_EQ(300, detections[2].x1);
+  ASSERT_EQ(0.95f, detections[2].score);
+
+  /* 1 is now the least recently used, after 3 and 2 */
+  std::vector<Detection> stored = makeDetections(1, 4);
+  cache.store(4, stored.data(), stored.size());
+  ASSERT_FALSE(cache.find(1, detections));
+  ASSERT_TRUE(cache.find(2, detections));
+
+  /* A smaller capacity keeps the most recently used entries */
+  ASSERT_TRUE(cache.save());
+  ASSERT_TRUE(cache.open(path, 1));
+  ASSERT_EQ(1u, cache.size());
+  ASSERT_TRUE(cache.find(2, detections));
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Test that other files are not taken for a cache and truncated
+ *        caches keep their complete entries
+ */
+TEST(ResultCache, TestInvalidFiles) {
+  const std::string path = "resultCacheInvalid.bin";
+  writeFile(path, "not a cache file at all");
+  ResultCache cache;
+  ASSERT_FALSE(cache.open(path, 4));
+  ASSERT_FALSE(cache.isOpen());
+
+  std::remove(path.c_str());
+  ASSERT_TRUE(cache.open(path, 4));
+  std::vector<Detection> stored = makeDetections(3, 7);
+  cache.store(1, stored.data(), stored.size());
+  cache.store(2, stored.data(), stored.size());
+  ASSERT_TRUE(cache.save());
+  std::ifstream file(path, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), \
+                      std::istreambuf_iterator<char>());
+  writeFile(path, content.substr(0, content.size() - 5));
+
+  ASSERT_TRUE(cache.open(path, 4));
+  ASSERT_EQ(1u, cache.size());
+  std::vector<Detection> detections;
+  ASSERT_TRUE(cache.find(2, detections));
+  std::remove(path.c_str());
+}
@@ -0,0 +1,203 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      SmoothingKernelsTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for the smoothing kernels
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../include/SmoothingKernels.hpp"
+
+namespace {
+/**
+ * @brief Smooths one value of an image the slow way
+ *
+ * @param kind 'G' for gaussian, 'M' for median, 'B' for box
+ */
+template <typename Pixel>
+double referenceValue(char kind, int kernel, const std::vector<Pixel>& \
+                      image, size_t step, int width, int height, \
+                      int channels, int x, int y, int channel) {
+  const int radius = kernel / 2;
+  std::vector<int> weights(kernel, 1);
+  if (kind == 'G') {
+    for (int k = 1; k < kernel; ++k) {
+      weights[k] = weights[k - 1] * (kernel - k) / k;
+    }
+  }
+  std::vector<double> window;
+  double sum = 0;
+  double total = 0;
+  for (int i = -radius; i <= radius; ++i) {
+    for (int j = -radius; j <= radius; ++j) {
+      int row = kind == 'M' ? SmoothingRows::clamp(y + i, height) \
+                            : SmoothingRows::reflect(y + i, height);
+      int column = kind == 'M' ? SmoothingRows::clamp(x + j, width) \
+                               : SmoothingRows::reflect(x + j, width);
+      double value = image[row * step + column * channels + channel];
+      double weight = weights[i + radius] * weights[j + radius];
+      window.push_back(value);
+      sum += weight * value;
+      total += weight;
+    }
+  }
+  if (kind == 'M') {
+    std::nth_element(window.begin(), window.begin() + window.size() / 2, \
+                     window.end());
+    return window[window.size() / 2];
+  }
+  if (sizeof(Pixel) == 1) {
+    /* Integer division rounding half up */
+    return static_cast<int>((sum + total / 2) / total);
+  }
+  return sum / total;
+}
+
+/**
+ * @brief Checks a kernel against the slow smoothing on random images of
+ *        odd sizes, with rows longer than the pixels they hold
+ */
+template <typename Policy>
+void expectMatchesReference(char kind, int kernel, double tolerance) {
+  typedef typename Policy::Pixel Pixel;
+  std::mt19937 generator(kernel);
+  std::uniform_int_distribution<int> values(0, 255);
+  const int sizes[][2] = {{1, 1}, {2, 3}, {7, 5}, {37, 13}, {64, 9}};
+  for (const auto& size : sizes) {
+    for (int channels : {1, 3}) {
+      const int width = size[0];
+      const int height = size[1];
+      const size_t step = width * channels + 5;
+      std::vector<Pixel> image(step * height);
+      for (Pixel& value : image) {
+        value = static_cast<Pixel>(values(generator));
+      }
+      std::vector<Pixel> smoothed(step * height);
+      Policy::apply(image.data(), step, smoothed.data(), step, width, \
+                    height, channels);
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          for (int c = 0; c < channels; ++c) {
+            ASSERT_NEAR(referenceValue(kind, kernel, image, step, width, \
+                        height, channels, x, y, c), \
+                        smoothed[y * step + x * channels + c], tolerance) \
+                << width << "x" << height << "x" << channels << " at " \
+                << x << "," << y << "," << c;
+          }
+        }
+      }
+    }
+  }
+}
+}  // namespace
+
+/**
+ * @brief Test the mirrored and clamped indices of the borders
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(SmoothingKernelsTest, TestBorders) {
+  ASSERT_EQ(1, SmoothingRows::reflect(-1, 5));
+  ASSERT_EQ(3, SmoothingRows::reflect(5, 5));
+  ASSERT_EQ(0, SmoothingRows::reflect(-2, 1));
+  ASSERT_EQ(0, SmoothingRows::clamp(-2, 5));
+  ASSERT_EQ(4, SmoothingRows::clamp(6, 5));
+}
+
+/**
+ * @brief Test that the gaussian kernels give the exact smoothing
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(SmoothingKernelsTest, TestGaussianKernel) {
+  expectMatchesReference<GaussianKernel<3, uint8_t>>('G', 3, 0);
+  expectMatchesReference<GaussianKernel<5, uint8_t>>('G', 5, 0);
+  expectMatchesReference<GaussianKernel<3, float>>('G', 3, 1e-3);
+  expectMatchesReference<GaussianKernel<5, float>>('G', 5, 1e-3);
+}
+
+/**
+ * @brief Test that the median kernels give the exact medians, through the
+ *        sorting network and the selection
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(SmoothingKernelsTest, TestMedianKernel) {
+  expectMatchesReference<MedianKernel<3, uint8_t>>('M', 3, 0);
+  expectMatchesReference<MedianKernel<5, uint8_t>>('M', 5, 0);
+  expectMatchesReference<MedianKernel<3, float>>('M', 3, 0);
+  expectMatchesReference<MedianKernel<5, float>>('M', 5, 0);
+}
+
+/**
+ * @brief Test that the box kernels give the exact means with their running
+ *        sums
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(SmoothingKernelsTest, TestBoxKernel) {
+  expectMatchesReference<BoxKernel<3, uint8_t>>('B', 3, 0);
+  expectMatchesReference<BoxKernel<5, uint8_t>>('B', 5, 0);
+  expectMatchesReference<BoxKernel<15, uint8_t>>('B', 15, 0);
+  expectMatchesReference<BoxKernel<3, float>>('B', 3, 1e-3);
+  expectMatchesReference<BoxKernel<5, float>>('B', 5, 1e-3);
+}
+
+/**
+ * @brief Test that an image of one value is left as it is
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(SmoothingKernelsTest, TestConstantImage) {
+  std::vector<uint8_t> image(40 * 30 * 3, 200);
+  std::vector<uint8_t> smoothed(image.size());
+  GaussianKernel<5, uint8_t>::apply(image.data(), 40 * 3, smoothed.data(), \
+                                    40 * 3, 40, 30, 3);
+  ASSERT_EQ(image, smoothed);
+  BoxKernel<3, uint8_t>::apply(image.data(), 40 * 3, smoothed.data(), \
+                               40 * 3, 40, 30, 3);
+  ASSERT_EQ(image, smoothed);
+  MedianKernel<3, uint8_t>::apply(image.data(), 40 * 3, smoothed.data(), \
+                                  40 * 3, 40, 30, 3);
+  ASSERT_EQ(image, smoothed);
+}
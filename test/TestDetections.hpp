@@ -0,0 +1,66 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      TestDetections.hpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Declares the detections shared by the Unit Tests
+ */
+
+#ifndef TEST_TESTDETECTIONS_HPP_
+#define TEST_TESTDETECTIONS_HPP_
+
+#include <cstdint>
+
+#include "../include/Detection.hpp"
+
+/**
+ * @brief Makes a detection of a frame
+ *
+ * @param frameID ID of the frame of the detection
+ * @param x1 Left of the box
+ * @param y1 Top of the box
+ * @param x2 Right of the box
+ * @param y2 Bottom of the box
+ * @param score Confidence score
+ * @param classId Class of the object, a person by default
+ *
+ * @return Detection, not tracked
+ */
+inline Detection makeDetection(int frameID, int x1, int y1, int x2, int y2, \
+                               float score = 0.9f, int32_t classId = 0) {
+  Detection detection;
+  detection.frameID = frameID;
+  detection.x1 = x1;
+  detection.y1 = y1;
+  detection.x2 = x2;
+  detection.y2 = y2;
+  detection.score = score;
+  detection.classId = classId;
+  return detection;
+}
+
+#endif    // TEST_TESTDETECTIONS_HPP_
@@ -0,0 +1,160 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+
+/**
+ * @file      ThreadPlacementTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for ThreadPlacement class
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/ThreadPlacement.hpp"
+
+namespace {
+/* Two nodes of four CPUs and a node with memory only */
+const char kNodeDirectory[] = "../test/testData/numaNodes";
+}  // namespace
+
+/**
+ * @brief Test the parsing and formatting of CPU lists
+ */
+TEST(ThreadPlacementTest, TestCpuList) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(ThreadPlacement::parseCpuList("0-3,8,10-11\n", cpus));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), cpus);
+  ASSERT_EQ("0-3,8,10-11", ThreadPlacement::formatCpuList(cpus));
+  ASSERT_TRUE(ThreadPlacement::parseCpuList("5,1-2,2", cpus));
+  ASSERT_EQ(std::vector<int>({5, 1, 2}), cpus);
+  ASSERT_EQ("1-2,5", ThreadPlacement::formatCpuList(cpus));
+
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("", cpus));
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("1,,2", cpus));
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("3-1", cpus));
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("-1", cpus));
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("a", cpus));
+  ASSERT_FALSE(ThreadPlacement::parseCpuList("99999", cpus));
+}
+
+/**
+ * @brief Test that the roles keep their CPUs and that an invalid list
+ *        leaves a role unchanged
+ */
+TEST(ThreadPlacementTest, TestRoles) {
+  ThreadPlacement placement;
+  ASSERT_TRUE(placement.empty());
+  ASSERT_EQ(0, placement.threadsPerWorker(kInferenceThreads, 2));
+  ASSERT_TRUE(placement.pinCurrentThread(kInferenceThreads));
+
+  ASSERT_TRUE(placement.setCpus(kInferenceThreads, "2-7"));
+  ASSERT_FALSE(placement.setCpus(kInferenceThreads, "7-2"));
+  ASSERT_FALSE(placement.empty());
+  ASSERT_TRUE(placement.isPinned(kInferenceThreads));
+  ASSERT_FALSE(placement.isPinned(kCaptureThreads));
+  ASSERT_EQ(6u, placement.getCpus(kInferenceThreads).size());
+  ASSERT_EQ(3, placement.threadsPerWorker(kInferenceThreads, 2));
+  ASSERT_EQ(1, placement.threadsPerWorker(kInferenceThreads, 8));
+
+  ASSERT_TRUE(placement.setCpus(kInferenceThreads, ""));
+  ASSERT_TRUE(placement.empty());
+}
+
+/**
+ * @brief Test that workers are given CPUs of a single node when the
+ *        number of CPUs allows it
+ */
+TEST(ThreadPlacementTest, TestWorkersStayOnTheirNode) {
+  ThreadPlacement placement;
+  ASSERT_TRUE(placement.loadTopology(kNodeDirectory));
+  ASSERT_EQ(0, placement.nodeOf(3));
+  ASSERT_EQ(1, placement.nodeOf(4));
+  ASSERT_EQ(-1, placement.nodeOf(8));
+
+  /* Interleaved nodes are grouped before the split */
+  ASSERT_TRUE(placement.setCpus(kInferenceThreads, "0,4,1,5,2,6,3,7"));
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3}), \
+            placement.workerCpus(kInferenceThreads, 0, 2));
+  ASSERT_EQ(std::vector<int>({4, 5, 6, 7}), \
+            placement.workerCpus(kInferenceThreads, 1, 2));
+  ASSERT_EQ(std::vector<int>({6, 7}), \
+            placement.workerCpus(kInferenceThreads, 3, 4));
+  /* Uneven parts differ by one CPU at most */
+  ASSERT_EQ(std::vector<int>({0, 1}), \
+            placement.workerCpus(kInferenceThreads, 0, 3));
+  ASSERT_EQ(std::vector<int>({5, 6, 7}), \
+            placement.workerCpus(kInferenceThreads, 2, 3));
+  /* More workers than CPUs share them */
+  ASSERT_EQ(std::vector<int>({1}), \
+            placement.workerCpus(kInferenceThreads, 9, 10));
+
+  ASSERT_TRUE(placement.setCpus(kOutputThreads, "8"));
+  ASSERT_EQ("inference 0-7 (nodes 0-1), output 8", placement.describe());
+
+  ASSERT_FALSE(placement.loadTopology("missingNodes"));
+  ASSERT_EQ(-1, placement.nodeOf(0));
+}
+
+/**
+ * @brief Test that a thread is pinned to its CPUs and gets its own CPUs
+ *        back at the end of a scope
+ */
+TEST(ThreadPlacementTest, TestPinning) {
+  std::vector<int> allowed = ThreadPlacement::currentCpus();
+  ASSERT_FALSE(allowed.empty());
+  ThreadPlacement placement;
+  ASSERT_TRUE(placement.setCpus(kOutputThreads, \
+                                std::to_string(allowed.back())));
+  ASSERT_TRUE(placement.setCpus(kCaptureThreads, \
+                                std::to_string(allowed.front())));
+
+  /* On threads of their own, so that the test thread is not pinned */
+  std::vector<int> pinned, inScope, started, restored;
+  std::thread([&]() {
+    ASSERT_TRUE(placement.pinCurrentThread(kOutputThreads));
+    pinned = ThreadPlacement::currentCpus();
+    {
+      ScopedPlacement scope(placement, kCaptureThreads);
+      inScope = ThreadPlacement::currentCpus();
+      /* Threads inherit the CPUs of the thread starting them */
+      std::thread([&]() {
+        started = ThreadPlacement::currentCpus();
+      }).join();
+    }
+    restored = ThreadPlacement::currentCpus();
+  }).join();
+  ASSERT_EQ(std::vector<int>({allowed.back()}), pinned);
+  ASSERT_EQ(std::vector<int>({allowed.front()}), inScope);
+  ASSERT_EQ(inScope, started);
+  ASSERT_EQ(pinned, restored);
+  ASSERT_EQ(allowed, ThreadPlacement::currentCpus());
+
+  ASSERT_FALSE(ThreadPlacement::setCurrentCpus(std::vector<int>()));
+}
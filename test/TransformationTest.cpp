@@ -180,3 +180,33 @@ TEST(TransformationTest, TestGetFunctions) {
   ASSERT_EQ(4, testBase.cols);
   ASSERT_EQ(4, testBase.rows);
 }
+
+/**
+ * @brief Test to check the fixed size image point transformation against
+ *        the chain of transformations
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(TransformationTest, TestTransformImagePoint) {
+  cv::Mat testEnd = cv::Mat::eye(4, 4, CV_32F);
+  testEnd.at<float>(0, 3) = 0.5;
+  testEnd.at<float>(1, 3) = -0.25;
+  Transformation tf(cv::Mat::eye(4, 4, CV_32F), testEnd);
+  cv::Mat intrinsic = cv::Mat::eye(3, 3, CV_32F);
+  intrinsic.at<float>(0, 0) = 400.0;
+  intrinsic.at<float>(1, 1) = 400.0;
+  intrinsic.at<float>(0, 2) = 208.0;
+  intrinsic.at<float>(1, 2) = 208.0;
+  cv::Matx33f intrinsicMatx = intrinsic;
+
+  cv::Mat point = cv::Mat(2, 1, CV_32F, {120.0f, 300.0f});
+  cv::Mat expected = tf.cameraToImage(intrinsic, \
+      tf.endToBase(tf.imageToCamera(intrinsic, point)));
+  cv::Point2f output = tf.transformImagePoint(intrinsicMatx, \
+      intrinsicMatx.inv(), cv::Point2f(120.0f, 300.0f));
+
+  EXPECT_NEAR(expected.at<float>(0, 0), output.x, 0.001);
+  EXPECT_NEAR(expected.at<float>(1, 0), output.y, 0.001);
+}
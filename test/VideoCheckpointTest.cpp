@@ -0,0 +1,238 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      VideoCheckpointTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for VideoCheckpoint class
+ */
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../include/VideoCheckpoint.hpp"
+#include "TestDetections.hpp"
+
+namespace {
+/* Checkpoint written by the tests */
+const char kCheckpointPath[] = "videoCheckpointTest.ckpt";
+
+/**
+ * @brief Makes a detection of a frame, its box moving with the frame
+ */
+Detection frameDetection(int frameID, float score) {
+  return makeDetection(frameID, frameID, 2 * frameID, frameID + 40, \
+                       2 * frameID + 80, score);
+}
+
+/**
+ * @brief Removes the files of the checkpoint
+ */
+void removeCheckpoint() {
+  std::string path = kCheckpointPath;
+  std::remove(path.c_str());
+  std::remove((path + ".detections").c_str());
+  std::remove((path + ".tmp").c_str());
+}
+}  // namespace
+
+/**
+ * @brief Test that a resumed job continues from its last commit, without
+ *        the detections appended after it
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VideoCheckpointTest, TestResume) {
+  removeCheckpoint();
+  std::vector<Detection> detections;
+  CheckpointState state;
+  {
+    VideoCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.open(kCheckpointPath, 42, true, state, \
+                                detections));
+    ASSERT_FALSE(checkpoint.isResumed());
+    ASSERT_EQ(0, state.nextFrameID);
+    detections.push_back(frameDetection(3, 0.75f));
+    detections.push_back(frameDetection(5, 0.123456789f));
+    state.nextFrameID = 6;
+    state.keyFrameID = 5;
+    state.keyDetections.assign(detections.begin() + 1, detections.end());
+    state.segmentIndex = 1;
+    ASSERT_TRUE(checkpoint.commit(state, detections.data(), \
+                                  detections.size()));
+    ASSERT_EQ(2u, state.detectionCount);
+    checkpoint.close();
+    /* Appended but never committed, as when a run is killed */
+    Detection uncommitted = frameDetection(7, 0.5f);
+    std::ofstream appended(std::string(kCheckpointPath) + ".detections", \
+                           std::ios::binary | std::ios::app);
+    appended.write(reinterpret_cast<const char*>(&uncommitted), \
+                   sizeof(uncommitted));
+  }
+
+  VideoCheckpoint checkpoint;
+  std::vector<Detection> resumedDetections;
+  CheckpointState resumedState;
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 42, true, resumedState, \
+                              resumedDetections));
+  ASSERT_TRUE(checkpoint.isResumed());
+  ASSERT_EQ(6, resumedState.nextFrameID);
+  ASSERT_EQ(5, resumedState.keyFrameID);
+  ASSERT_EQ(1, resumedState.segmentIndex);
+  ASSERT_EQ(2u, resumedState.detectionCount);
+  ASSERT_EQ(1u, resumedState.keyDetections.size());
+  ASSERT_FLOAT_EQ(0.123456789f, resumedState.keyDetections[0].score);
+  ASSERT_EQ(45, resumedState.keyDetections[0].x2);
+  ASSERT_EQ(2u, resumedDetections.size());
+  ASSERT_EQ(3, resumedDetections[0].frameID);
+  ASSERT_EQ(5, resumedDetections[1].frameID);
+
+  /* Later commits append after the committed detections */
+  resumedDetections.push_back(frameDetection(9, 0.6f));
+  resumedState.nextFrameID = 10;
+  ASSERT_TRUE(checkpoint.commit(resumedState, resumedDetections.data(), \
+                                  resumedDetections.size()));
+  checkpoint.close();
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 42, true, resumedState, \
+                              resumedDetections));
+  ASSERT_EQ(3u, resumedDetections.size());
+  ASSERT_EQ(9, resumedDetections[2].frameID);
+
+  /* A completed job leaves nothing to resume */
+  checkpoint.finish();
+  ASSERT_FALSE(std::ifstream(kCheckpointPath).good());
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 42, true, resumedState, \
+                              resumedDetections));
+  ASSERT_FALSE(checkpoint.isResumed());
+  checkpoint.finish();
+}
+
+/**
+ * @brief Test that a commit failing partway through the detections is
+ *        overwritten by the next commit rather than followed by it
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VideoCheckpointTest, TestFailedCommit) {
+  removeCheckpoint();
+  std::vector<Detection> detections;
+  CheckpointState state;
+  VideoCheckpoint checkpoint;
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 7, true, state, detections));
+  detections.push_back(frameDetection(1, 0.5f));
+  ASSERT_TRUE(checkpoint.commit(state, detections.data(), 1));
+  for (int frameID = 2; frameID < 6; ++frameID) {
+    detections.push_back(frameDetection(frameID, 0.5f));
+  }
+
+  /* The file can't grow past half of the second detection, as on a full
+  disk */
+  struct rlimit previousLimit;
+  ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &previousLimit));
+  struct rlimit limit = previousLimit;
+  limit.rlim_cur = sizeof(Detection) + sizeof(Detection) / 2;
+  void (*previousHandler)(int) = signal(SIGXFSZ, SIG_IGN);
+  ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+  bool committed = checkpoint.commit(state, detections.data(), 3);
+  setrlimit(RLIMIT_FSIZE, &previousLimit);
+  signal(SIGXFSZ, previousHandler);
+  ASSERT_FALSE(committed);
+
+  state.nextFrameID = 6;
+  ASSERT_TRUE(checkpoint.commit(state, detections.data(), \
+                                detections.size()));
+  checkpoint.close();
+  std::vector<Detection> resumedDetections;
+  CheckpointState resumedState;
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 7, true, resumedState, \
+                              resumedDetections));
+  ASSERT_EQ(5u, resumedDetections.size());
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(i + 1, resumedDetections[i].frameID);
+    ASSERT_EQ(i + 41, resumedDetections[i].x2);
+  }
+  checkpoint.finish();
+}
+
+/**
+ * @brief Test that a checkpoint of another job, or no resume asked, starts
+ *        the job over
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VideoCheckpointTest, TestStartOver) {
+  removeCheckpoint();
+  std::vector<Detection> detections{frameDetection(1, 0.9f)};
+  CheckpointState state;
+  {
+    VideoCheckpoint checkpoint;
+    std::vector<Detection> none;
+    ASSERT_TRUE(checkpoint.open(kCheckpointPath, 7, false, state, none));
+    state.nextFrameID = 2;
+    ASSERT_TRUE(checkpoint.commit(state, detections.data(), \
+                                  detections.size()));
+  }
+
+  VideoCheckpoint checkpoint;
+  std::vector<Detection> resumedDetections;
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 8, true, state, \
+                              resumedDetections));
+  ASSERT_FALSE(checkpoint.isResumed());
+  ASSERT_EQ(0, state.nextFrameID);
+  ASSERT_TRUE(resumedDetections.empty());
+
+  /* Opening the other job replaced the checkpoint */
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 7, true, state, \
+                              resumedDetections));
+  ASSERT_FALSE(checkpoint.isResumed());
+
+  /* A state without its detections is not resumed */
+  state.nextFrameID = 4;
+  ASSERT_TRUE(checkpoint.commit(state, detections.data(), \
+                                  detections.size()));
+  checkpoint.close();
+  std::ofstream truncated(std::string(kCheckpointPath) + ".detections", \
+                          std::ios::trunc);
+  truncated.close();
+  ASSERT_TRUE(checkpoint.open(kCheckpointPath, 7, true, state, \
+                              resumedDetections));
+  ASSERT_FALSE(checkpoint.isResumed());
+  checkpoint.finish();
+  ASSERT_FALSE(checkpoint.open("../notADirectory/test.ckpt", 7, false, \
+                               state, resumedDetections));
+}
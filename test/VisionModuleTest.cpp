@@ -88,6 +88,62 @@ TEST(VisionModuleTest, TestApplyMedianFilter) {
   ASSERT_EQ(testImage.rows, testOutput.rows);
 }
 
+/**
+ * @brief Test that the specialized kernels smooth as the OpenCV filters,
+ *        within one level of rounding
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VisionModuleTest, TestSmoothMatchesOpenCV) {
+  VisionModule vm;
+  cv::Mat testImage, expected, smoothed;
+  testImage = cv::imread("../test/testData/testImage.jpg");
+
+  ASSERT_TRUE((VisionModule::smooth<GaussianKernel<3, uint8_t>>(\
+      testImage, smoothed)));
+  vm.applyGaussianFilter(testImage, cv::Size(3, 3), 0, expected);
+  ASSERT_LE(cv::norm(expected, smoothed, cv::NORM_INF), 1);
+
+  ASSERT_TRUE((VisionModule::smooth<MedianKernel<3, uint8_t>>(\
+      testImage, smoothed)));
+  vm.applyMedianFilter(testImage, 3, expected);
+  ASSERT_EQ(0, cv::norm(expected, smoothed, cv::NORM_INF));
+
+  ASSERT_TRUE((VisionModule::smooth<BoxKernel<3, uint8_t>>(\
+      testImage, smoothed)));
+  vm.applyFilter(testImage, cv::Size(3, 3), expected);
+  ASSERT_LE(cv::norm(expected, smoothed, cv::NORM_INF), 1);
+
+  cv::Mat floatImage;
+  testImage.convertTo(floatImage, CV_32F);
+  ASSERT_TRUE((VisionModule::smooth<MedianKernel<3, float>>(\
+      floatImage, smoothed)));
+  vm.applyMedianFilter(floatImage, 3, expected);
+  ASSERT_EQ(0, cv::norm(expected, smoothed, cv::NORM_INF));
+}
+
+/**
+ * @brief Test that images the kernels cannot smooth are refused
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VisionModuleTest, TestSmoothRefusesImage) {
+  cv::Mat testImage, floatImage, smoothed;
+  testImage = cv::imread("../test/testData/testImage.jpg");
+  testImage.convertTo(floatImage, CV_32F);
+
+  ASSERT_FALSE((VisionModule::smooth<GaussianKernel<3, uint8_t>>(\
+      floatImage, smoothed)));
+  ASSERT_FALSE((VisionModule::smooth<GaussianKernel<3, uint8_t>>(\
+      testImage, testImage)));
+  ASSERT_FALSE((VisionModule::smooth<GaussianKernel<3, uint8_t>>(\
+      cv::Mat(), smoothed)));
+}
+
 /**
  * @brief Test to check image reshape function
  *
@@ -117,7 +173,7 @@ TEST(VisionModuleTest, TestNonMaximalSuppression) {
   VisionModule vm;
   cv::Mat testImage;
   std::vector<cv::Rect> testPredictedBoxes;
-  std::vector< std::vector<int> > testFinalBoxes;
+  std::vector<Detection> testFinalBoxes;
   std::vector<float> testConfidenceScores;
   std::vector<int> classIds{0, 0};
   int frameID = 0;
@@ -130,5 +186,67 @@ TEST(VisionModuleTest, TestNonMaximalSuppression) {
                     testConfidenceScores, classIds, frameID);
 
   ASSERT_EQ(1, static_cast<signed>(testFinalBoxes.size()));
-  ASSERT_EQ(200, testFinalBoxes[0][1]);
+  ASSERT_EQ(200, testFinalBoxes[0].x1);
+  ASSERT_FLOAT_EQ(0.95f, testFinalBoxes[0].score);
+}
+
+/**
+ * @brief Test to check drawing of detections
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VisionModuleTest, TestDrawDetections) {
+  VisionModule vm;
+  cv::Mat testImage = cv::Mat::zeros(416, 416, CV_8UC3);
+  Detection testDetection;
+  testDetection.x1 = 100;
+  testDetection.y1 = 100;
+  testDetection.x2 = 200;
+  testDetection.y2 = 200;
+  std::vector<Detection> testDetections{testDetection};
+
+  vm.drawDetections(testImage, testDetections);
+
+  ASSERT_EQ(170, testImage.at<cv::Vec3b>(100, 150)[1]);
+  ASSERT_EQ(0, testImage.at<cv::Vec3b>(150, 150)[1]);
+}
+
+/**
+ * @brief Test to check that the allocation free non-maximal suppression
+ *        keeps the same boxes as the other overload
+ *
+ * @param none
+ *
+ * @return none
+ */
+TEST(VisionModuleTest, TestNonMaximalSuppressionInPlace) {
+  VisionModule vm;
+  cv::Mat testImage = cv::Mat::zeros(416, 416, CV_8UC3);
+  cv::RNG rng(7);
+  std::vector<cv::Rect> testPredictedBoxes;
+  std::vector<float> testConfidenceScores;
+  std::vector<int> classIds;
+  for (int i = 0; i < 200; ++i) {
+    testPredictedBoxes.push_back(cv::Rect(rng.uniform(0, 400), \
+        rng.uniform(0, 400), rng.uniform(10, 120), rng.uniform(10, 120)));
+    testConfidenceScores.push_back(rng.uniform(0.8f, 1.0f));
+    classIds.push_back(rng.uniform(0, 3));
+  }
+  std::vector<Detection> expectedBoxes = vm.nonMaximalSuppression(\
+      testImage, testPredictedBoxes, testConfidenceScores, classIds, 4);
+  std::vector<Detection> testDetections;
+  vm.nonMaximalSuppression(testImage.size(), 4, testPredictedBoxes, \
+      testConfidenceScores, classIds, testDetections);
+
+  ASSERT_EQ(expectedBoxes.size(), testDetections.size());
+  for (size_t i = 0; i < expectedBoxes.size(); ++i) {
+    ASSERT_EQ(4, testDetections[i].frameID);
+    ASSERT_EQ(expectedBoxes[i].x1, testDetections[i].x1);
+    ASSERT_EQ(expectedBoxes[i].y1, testDetections[i].y1);
+    ASSERT_EQ(expectedBoxes[i].x2, testDetections[i].x2);
+    ASSERT_EQ(expectedBoxes[i].y2, testDetections[i].y2);
+    ASSERT_EQ(expectedBoxes[i].score, testDetections[i].score);
+  }
 }
@@ -0,0 +1,177 @@
+/******************************************************************************
+ *  MIT License
+ *
+ *  Copyright (c) 2019 Rohan Singh, Arjun Gupta
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+/**
+ * @file      YuvConverterTest.cpp
+ * @author    Rohan Singh
+ * @author    Arjun Gupta
+ * @copyright MIT License (c) 2019 Rohan Singh, Arjun Gupta
+ * @brief     Contains Unit Tests for YuvConverter class
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include "../include/YuvConverter.hpp"
+
+namespace {
+/**
+ * @brief Makes a synthetic I420 frame with gradients in the three planes
+ */
+std::vector<unsigned char> makeI420(int width, int height) {
+  std::vector<unsigned char> frame(YuvConverter::frameSize(\
+      YuvImage::kI420, width, height));
+  unsigned char* u = frame.data() + width * height;
+  unsigned char* v = u + (width / 2) * (height / 2);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      frame[y * width + x] = static_cast<unsigned char>(16 + (x * 7 + y * 3) \
+                                                        % 220);
+    }
+  }
+  for (int y = 0; y < height / 2; ++y) {
+    for (int x = 0; x < width / 2; ++x) {
+      u[y * (width / 2) + x] = static_cast<unsigned char>(64 + x * 4 % 128);
+      v[y * (width / 2) + x] = static_cast<unsigned char>(192 - y * 5 % 128);
+    }
+  }
+  return frame;
+}
+
+/**
+ * @brief Converts an I420 frame to NV12 or to YUYV, the chroma of a pair
+ *        of rows being repeated on both rows for YUYV
+ */
+std::vector<unsigned char> convertI420(const std::vector<unsigned char>& i420, \
+                                       YuvImage::Layout layout, int width, \
+                                       int height) {
+  const unsigned char* u = i420.data() + width * height;
+  const unsigned char* v = u + (width / 2) * (height / 2);
+  std::vector<unsigned char> frame(YuvConverter::frameSize(layout, width, \
+                                                           height));
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int chroma = (y / 2) * (width / 2) + x / 2;
+      if (layout == YuvImage::kNv12) {
+        frame[y * width + x] = i420[y * width + x];
+        unsigned char* uv = frame.data() + width * height + \
+                            (y / 2) * width + (x / 2) * 2;
+        uv[0] = u[chroma];
+        uv[1] = v[chroma];
+      } else {
+        unsigned char* pair = frame.data() + y * width * 2 + (x / 2) * 4;
+        pair[(x & 1) * 2] = i420[y * width + x];
+        pair[1] = u[chroma];
+        pair[3] = v[chroma];
+      }
+    }
+  }
+  return frame;
+}
+
+/**
+ * @brief Converts a frame into 416 x 416 planes
+ */
+std::vector<float> toPlanes(const std::vector<unsigned char>& frame, \
+                            YuvImage::Layout layout, int width, int height) {
+  YuvImage image;
+  image.layout = layout;
+  image.data = frame.data();
+  image.width = width;
+  image.height = height;
+  std::vector<float> planes(3 * 416 * 416);
+  YuvConverter converter;
+  converter.convertToPlanes(image, 416, 416, planes.data());
+  return planes;
+}
+}  // namespace
+
+/**
+ * @brief Test that only frames with data and even sizes are converted
+ */
+TEST(YuvConverter, TestIsValid) {
+  std::vector<unsigned char> frame(YuvConverter::frameSize(\
+      YuvImage::kNv12, 4, 4));
+  YuvImage image;
+  ASSERT_FALSE(YuvConverter::isValid(image));
+  image.data = frame.data();
+  image.width = 4;
+  image.height = 4;
+  ASSERT_TRUE(YuvConverter::isValid(image));
+  image.width = 3;
+  ASSERT_FALSE(YuvConverter::isValid(image));
+  image.width = 4;
+  image.height = 0;
+  ASSERT_FALSE(YuvConverter::isValid(image));
+  ASSERT_EQ(24u, frame.size());
+  ASSERT_EQ(32u, YuvConverter::frameSize(YuvImage::kYuyv, 4, 4));
+}
+
+/**
+ * @brief Test that limited range black and white and a saturated color
+ *        give the values of the BT.601 conversion
+ */
+TEST(YuvConverter, TestUniformFrames) {
+  std::vector<unsigned char> frame(YuvConverter::frameSize(\
+      YuvImage::kI420, 8, 8), 128);
+  std::fill(frame.begin(), frame.begin() + 64, 235);
+  std::vector<float> planes = toPlanes(frame, YuvImage::kI420, 8, 8);
+  for (float value : planes) {
+    ASSERT_NEAR(1.0f, value, 0.01f);
+  }
+  std::fill(frame.begin(), frame.begin() + 64, 16);
+  planes = toPlanes(frame, YuvImage::kI420, 8, 8);
+  for (float value : planes) {
+    ASSERT_FLOAT_EQ(0.0f, value);
+  }
+  /* Red is Y 81, U 90, V 240 */
+  std::fill(frame.begin(), frame.begin() + 64, 81);
+  std::fill(frame.begin() + 64, frame.begin() + 80, 90);
+  std::fill(frame.begin() + 80, frame.end(), 240);
+  planes = toPlanes(frame, YuvImage::kI420, 8, 8);
+  ASSERT_NEAR(1.0f, planes[0], 0.01f);
+  ASSERT_NEAR(0.0f, planes[416 * 416], 0.01f);
+  ASSERT_NEAR(0.0f, planes[2 * 416 * 416], 0.01f);
+}
+
+/**
+ * @brief Test that the three layouts of the same frame give the same
+ *        planes
+ */
+TEST(YuvConverter, TestLayoutsAgree) {
+  const int width = 64;
+  const int height = 48;
+  std::vector<unsigned char> i420 = makeI420(width, height);
+  std::vector<float> expected = toPlanes(i420, YuvImage::kI420, width, \
+                                         height);
+  ASSERT_EQ(expected, toPlanes(convertI420(i420, YuvImage::kNv12, width, \
+                               height), YuvImage::kNv12, width, height));
+  ASSERT_EQ(expected, toPlanes(convertI420(i420, YuvImage::kYuyv, width, \
+                               height), YuvImage::kYuyv, width, height));
+  for (float value : expected) {
+    ASSERT_GE(value, 0.0f);
+    ASSERT_LE(value, 1.0f + 1e-5f);
+  }
+}